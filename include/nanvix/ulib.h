@@ -29,7 +29,9 @@
 	#include <posix/sys/types.h>
 	#include <posix/stddef.h>
 	#include <posix/stdarg.h>
+	#include <posix/stdint.h>
 	#include <nanvix/barelib.h>
+	#include <nanvix/sys/thread.h>
 
 /*============================================================================*
  * Glue                                                                       *
@@ -56,6 +58,11 @@
 	 */
 	extern ssize_t __nanvix_write(int fd, const void *buf, size_t n);
 
+	/**
+	 * @brief Stub read() function.
+	 */
+	extern ssize_t __nanvix_read(int fd, void *buf, size_t n);
+
 /**@}*/
 
 /*============================================================================*
@@ -145,6 +152,31 @@
 	 */
 	extern void ufree(void *ptr);
 
+	/**
+	 * @brief Statistics of the heap.
+	 */
+	struct umalloc_stats
+	{
+		size_t heap_size; /**< Bytes obtained from the kernel.          */
+		size_t used_size; /**< Bytes in allocated blocks.               */
+		size_t used_peak; /**< Peak of used bytes since the last check. */
+		size_t free_size; /**< Bytes in free blocks.                    */
+		size_t free_max;  /**< Size of the largest free block.          */
+		unsigned nfree;   /**< Number of free blocks.                   */
+	};
+
+	/**
+	 * @brief Checks the integrity of the heap.
+	 *
+	 * @param stats Store location for statistics of the heap.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note Byte counts include the meta-information of blocks.
+	 */
+	extern int umalloc_check(struct umalloc_stats *stats);
+
 /**@}*/
 
 /*============================================================================*
@@ -229,6 +261,86 @@
 
 /**@}*/
 
+/*============================================================================*
+ * Number Parsing                                                             *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-parsing Number Parsing
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Converts a string to a long integer.
+	 *
+	 * @param nptr   Target string.
+	 * @param endptr Stores a pointer to the first unparsed character.
+	 * @param base   Base of the number (zero to detect it).
+	 *
+	 * @returns The converted value. Upon overflow, the closest limit
+	 * is returned instead and errno is set to ERANGE.
+	 */
+	extern long ustrtol(const char *nptr, char **endptr, int base);
+
+	/**
+	 * @brief Converts a string to an unsigned long integer.
+	 *
+	 * @param nptr   Target string.
+	 * @param endptr Stores a pointer to the first unparsed character.
+	 * @param base   Base of the number (zero to detect it).
+	 *
+	 * @returns The converted value. Upon overflow, the largest value
+	 * is returned instead and errno is set to ERANGE.
+	 */
+	extern unsigned long ustrtoul(const char *nptr, char **endptr, int base);
+
+	/**
+	 * @brief Converts a string to a long long integer.
+	 *
+	 * @param nptr   Target string.
+	 * @param endptr Stores a pointer to the first unparsed character.
+	 * @param base   Base of the number (zero to detect it).
+	 *
+	 * @returns The converted value. Upon overflow, the closest limit
+	 * is returned instead and errno is set to ERANGE.
+	 */
+	extern long long ustrtoll(const char *nptr, char **endptr, int base);
+
+	/**
+	 * @brief Converts a string to an unsigned long long integer.
+	 *
+	 * @param nptr   Target string.
+	 * @param endptr Stores a pointer to the first unparsed character.
+	 * @param base   Base of the number (zero to detect it).
+	 *
+	 * @returns The converted value. Upon overflow, the largest value
+	 * is returned instead and errno is set to ERANGE.
+	 */
+	extern unsigned long long ustrtoull(const char *nptr, char **endptr, int base);
+
+	/**
+	 * @brief Converts a string to an integer.
+	 *
+	 * @param nptr Target string.
+	 *
+	 * @returns The converted value.
+	 */
+	extern int uatoi(const char *nptr);
+
+	/**
+	 * @brief Converts a string to a double-precision number.
+	 *
+	 * @param nptr   Target string.
+	 * @param endptr Stores a pointer to the first unparsed character.
+	 *
+	 * @returns The converted value, correctly rounded. Upon overflow,
+	 * an infinity is returned instead and errno is set to ERANGE.
+	 */
+	extern double ustrtod(const char *nptr, char **endptr);
+
+/**@}*/
+
 /*============================================================================*
  * String Formatting                                                          *
  *============================================================================*/
@@ -240,19 +352,104 @@
 /**@{*/
 
 	/**
-	 * @see __vsnprintf().
+	 * @brief Maximum length of a number converted by uutoa(), uitoa()
+	 * or uxtoa(), including the sign and the terminating null byte.
+	 */
+	#define UITOA_BUFSIZ 22
+
+	/**
+	 * @brief Converts an unsigned number to decimal.
+	 *
+	 * @param val Target number.
+	 * @param buf Target buffer (at least UITOA_BUFSIZ bytes long).
+	 *
+	 * @returns The number of characters written to @p buf, not
+	 * counting the terminating null byte.
+	 */
+	extern size_t uutoa(uint64_t val, char *buf);
+
+	/**
+	 * @brief Converts a signed number to decimal.
+	 *
+	 * @param val Target number.
+	 * @param buf Target buffer (at least UITOA_BUFSIZ bytes long).
+	 *
+	 * @returns The number of characters written to @p buf, not
+	 * counting the terminating null byte.
+	 */
+	extern size_t uitoa(int64_t val, char *buf);
+
+	/**
+	 * @brief Converts an unsigned number to hexadecimal.
+	 *
+	 * @param val   Target number.
+	 * @param buf   Target buffer (at least UITOA_BUFSIZ bytes long).
+	 * @param upper Use uppercase digits?
+	 *
+	 * @returns The number of characters written to @p buf, not
+	 * counting the terminating null byte.
+	 */
+	extern size_t uxtoa(uint64_t val, char *buf, int upper);
+
+	/**
+	 * @brief Maximum length of a number converted by udtoa(),
+	 * including the sign and the terminating null byte.
+	 */
+	#define UDTOA_BUFSIZ 32
+
+	/**
+	 * @brief Converts a double to its shortest decimal representation.
+	 *
+	 * @param v   Target number.
+	 * @param buf Target buffer (at least UDTOA_BUFSIZ bytes long).
+	 *
+	 * @returns The number of characters written to @p buf, not
+	 * counting the terminating null byte.
+	 */
+	extern size_t udtoa(double v, char *buf);
+
+	/**
+	 * @brief Writes a formatted string to a buffer.
+	 *
+	 * @param str  Target buffer.
+	 * @param size Size of @p str.
+	 * @param fmt  Formatted string.
+	 * @param args Variable arguments list.
+	 *
+	 * @returns The number of characters that would have been written
+	 * if @p size had been large enough, not counting the terminating
+	 * null byte.
+	 */
+	extern int uvsnprintf(char *str, size_t size, const char *fmt, va_list args);
+
+	/**
+	 * @see uvsnprintf().
 	 */
-	#define uvsprintf(str,size,fmt,args) __vsnprintf(str,size,fmt,args)
+	#define uvsprintf(str,size,fmt,args) uvsnprintf(str,size,fmt,args)
 
 	/**
-	 * @see __sprintf().
+	 * @brief Writes a formatted string to a buffer.
+	 *
+	 * @param str Target buffer.
+	 * @param fmt Formatted string.
+	 *
+	 * @returns The number of characters written to @p str, not
+	 * counting the terminating null byte.
 	 */
-	#define usprintf(str,fmt,...) __sprintf(str,fmt,__VA_ARGS__)
+	extern int usprintf(char *str, const char * restrict fmt, ...);
 
 	/**
-	 * @todo: TODO implement this function.
+	 * @brief Writes a formatted string to a bounded buffer.
+	 *
+	 * @param s   Target buffer.
+	 * @param n   Size of @p s.
+	 * @param fmt Formatted string.
+	 *
+	 * @returns The number of characters that would have been written
+	 * if @p n had been large enough, not counting the terminating null
+	 * byte.
 	 */
-	extern int usnprintf(char *s, size_t n, const char * restrict format, ...);
+	extern int usnprintf(char *s, size_t n, const char * restrict fmt, ...);
 
 /**@}*/
 
@@ -321,6 +518,249 @@
 
 /**@}*/
 
+/*============================================================================*
+ * Output Buffering                                                           *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-buffering Output Buffering
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @name Buffering Modes
+	 */
+	/**@{*/
+	#define UBUF_NONE 0 /**< Unbuffered.     */
+	#define UBUF_LINE 1 /**< Line buffered.  */
+	#define UBUF_FULL 2 /**< Fully buffered. */
+	/**@}*/
+
+	/**
+	 * @brief Maximum size (in bytes) of an output buffer.
+	 */
+	#define UBUFSIZ 1024
+
+	/**
+	 * @brief Default size (in bytes) of an output buffer.
+	 */
+	#define UBUFSIZ_DEFAULT UBUFSIZ
+
+	/**
+	 * @brief Flushes the output buffer of the calling thread.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note Pending output is also flushed when the thread exits, or
+	 * when it returns from a start routine run by uthread_create().
+	 */
+	extern int uflush(void);
+
+	/**
+	 * @brief Configures the output buffer of the calling thread.
+	 *
+	 * @param mode  Buffering mode (UBUF_NONE, UBUF_LINE or UBUF_FULL).
+	 * @param size  Size of the buffer (at most UBUFSIZ bytes).
+	 * @param lines Number of newlines that trigger a flush in
+	 *              UBUF_LINE mode.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note Pending output is flushed before the new settings apply.
+	 */
+	extern int usetvbuf(int mode, size_t size, unsigned lines);
+
+	/**
+	 * @brief Flushes the output buffers of all threads.
+	 *
+	 * @note This function is intended to be called at process
+	 * termination, when no other thread is writing.
+	 */
+	extern void __ubuffer_flush_all(void);
+
+	/**
+	 * @brief Flushes and releases the output buffer of the calling
+	 * thread.
+	 */
+	extern void __ubuffer_release(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Scatter-Gather Output                                                      *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-uio Scatter-Gather Output
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Output fragment.
+	 */
+	struct uiovec
+	{
+		const void *iov_base; /**< Base address. */
+		size_t iov_len;       /**< Length.       */
+	};
+
+	/**
+	 * @brief Maximum number of fragments in a uwritev() call.
+	 */
+	#define UIOV_MAX 1024
+
+	/**
+	 * @brief Writes multiple buffers to a file.
+	 *
+	 * @param fd  Target file descriptor.
+	 * @param iov Buffers to write.
+	 * @param n   Number of buffers in @p iov.
+	 *
+	 * @returns Upon successful completion, the number of bytes written
+	 * is returned. Upon failure, a negative error code is returned
+	 * instead. If some bytes were written before the failure, their
+	 * number is returned instead, and they are the leading bytes of
+	 * the buffers.
+	 */
+	extern ssize_t uwritev(int fd, const struct uiovec *iov, int n);
+
+	/**
+	 * @brief Writes multiple buffers to a file with an output routine.
+	 *
+	 * @param output Output routine, called with at most KBUFFER_SIZE
+	 *               bytes at a time.
+	 * @param fd     Target file descriptor.
+	 * @param iov    Buffers to write.
+	 * @param n      Number of buffers in @p iov.
+	 *
+	 * @returns Same as uwritev().
+	 */
+	extern ssize_t uwritev_to(
+		ssize_t (*output)(int fd, const void *buf, size_t n),
+		int fd,
+		const struct uiovec *iov,
+		int n
+	);
+
+/**@}*/
+
+/*============================================================================*
+ * Deferred Logging                                                           *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-log Deferred Logging
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Maximum number of arguments recorded in a log entry.
+	 */
+	#define ULOG_ARGS_MAX 7
+
+	/**
+	 * @brief Maximum length of a formatted log entry (including the
+	 * null byte).
+	 */
+	#define ULOG_LINE_MAX 256
+
+	/**
+	 * @brief Number of entries in the log ring of a thread (power of two).
+	 */
+	#ifndef ULOG_ENTRIES
+	#define ULOG_ENTRIES 32
+	#endif
+
+	/**
+	 * @brief Log call site.
+	 *
+	 * @details The types of the arguments of a call site are parsed
+	 * from its format string on the first call only.
+	 */
+	struct ulog_site
+	{
+		const char *fmt;                     /**< Format string.    */
+		int nargs;                           /**< Number of args.   */
+		unsigned char types[ULOG_ARGS_MAX];  /**< Types of args.    */
+	};
+
+	/**
+	 * @brief Records a log entry.
+	 *
+	 * @param site Call site.
+	 * @param fmt  Formatted string.
+	 *
+	 * @note Use ulog() instead.
+	 */
+	extern void __ulog(struct ulog_site *site, const char *fmt, ...);
+
+	/**
+	 * @brief Records a log entry to be formatted later.
+	 *
+	 * @details The format string pointer and the raw arguments are
+	 * stored in the log ring of the calling thread, which is formatted
+	 * only when ulog_flush() or ulog_dump() is called. The format
+	 * string and any string argument must therefore remain valid until
+	 * then. If the ring is full, the entry is dropped and accounted.
+	 */
+	#define ulog(...)                                                 \
+		do                                                            \
+		{                                                             \
+			static struct ulog_site __ulog_site = { NULL, 0, { 0 } }; \
+			__ulog(&__ulog_site, __VA_ARGS__);                        \
+		} while (0)
+
+	/**
+	 * @brief Formats pending log entries to the output buffer.
+	 *
+	 * @returns The number of entries that were formatted.
+	 */
+	extern int ulog_flush(void);
+
+	/**
+	 * @brief Formats pending log entries to an output routine.
+	 *
+	 * @param emit Output routine, called once per formatted entry
+	 * with the null-terminated entry and its length.
+	 *
+	 * @returns Upon successful completion, the number of entries that
+	 * were formatted is returned. Upon failure, a negative error code
+	 * is returned instead.
+	 */
+	extern int ulog_flush_to(void (*emit)(const char *buf, size_t n));
+
+	/**
+	 * @brief Formats pending log entries straight to the output device.
+	 *
+	 * @returns The number of entries that were formatted.
+	 *
+	 * @note This function does not take any lock nor touch output
+	 * buffers, so it may be used for post-mortem dumps.
+	 */
+	extern int ulog_dump(void);
+
+	/**
+	 * @brief Gets the number of dropped log entries.
+	 *
+	 * @returns The number of log entries dropped because the log ring
+	 * was full or no ring was available.
+	 */
+	extern unsigned ulog_dropped(void);
+
+	/**
+	 * @brief Releases the log ring of the calling thread.
+	 *
+	 * @note Pending entries are kept until flushed.
+	 */
+	extern void __ulog_release(void);
+
+/**@}*/
+
 /*============================================================================*
  * Random Numbers                                                             *
  *============================================================================*/
@@ -341,7 +781,8 @@
 	/**
 	 * @brief Generates a pseudo-random number.
 	 *
-	 * @returns A pseudo-random number.
+	 * @returns A pseudo-random number in [0, 2^31 - 1], drawn from the
+	 * default generator of the calling thread.
 	 */
 	extern int urand(void);
 
@@ -356,6 +797,2307 @@
 	 */
 	extern int urand_r(unsigned *state);
 
+	/**
+	 * @brief State of a random number generator.
+	 *
+	 * @details The generator is xoshiro256**, which has a period of
+	 * 2^256 - 1. Each state is an independent generator, so threads
+	 * should not share states.
+	 */
+	struct urand_state
+	{
+		uint64_t s[4]; /**< Internal state. */
+	};
+
+	/**
+	 * @brief Seeds a random number generator.
+	 *
+	 * @param state Target generator.
+	 * @param seed  Seed.
+	 */
+	extern void urand_seed(struct urand_state *state, uint64_t seed);
+
+	/**
+	 * @brief Generates a 32-bit random number.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A uniformly distributed 32-bit random number.
+	 */
+	extern uint32_t urand32(struct urand_state *state);
+
+	/**
+	 * @brief Generates a 64-bit random number.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A uniformly distributed 64-bit random number.
+	 */
+	extern uint64_t urand64(struct urand_state *state);
+
+	/**
+	 * @brief Fills a buffer with random bytes.
+	 *
+	 * @param state Target generator.
+	 * @param buf   Target buffer.
+	 * @param n     Number of bytes to fill.
+	 */
+	extern void urand_fill(struct urand_state *state, void *buf, size_t n);
+
+	/**
+	 * @brief Advances a random number generator by 2^128 outputs.
+	 *
+	 * @param state Target generator.
+	 */
+	extern void urand_jump(struct urand_state *state);
+
+	/**
+	 * @brief Advances a random number generator by 2^192 outputs.
+	 *
+	 * @param state Target generator.
+	 */
+	extern void urand_long_jump(struct urand_state *state);
+
+	/**
+	 * @brief Initializes non-overlapping random number generators.
+	 *
+	 * @param streams Target generators.
+	 * @param n       Number of generators in @p streams.
+	 * @param seed    Seed.
+	 */
+	extern void urand_streams(struct urand_state *streams, int n, uint64_t seed);
+
+	/**
+	 * @brief Gets the default random number generator of the calling
+	 * thread.
+	 *
+	 * @returns The default generator of the calling thread. It is
+	 * seeded by usrand(), and the n-th thread to draw after a seed
+	 * gets stream n of urand_streams(), so that threads never share
+	 * a stream. If all slots are taken, a NULL pointer is returned
+	 * instead.
+	 */
+	extern struct urand_state *urand_self(void);
+
+	/**
+	 * @brief Draws from the shared generator.
+	 *
+	 * @returns A 32-bit random number.
+	 */
+	extern uint32_t __urand_shared(void);
+
+	/**
+	 * @brief Reseeds the default generators of all threads.
+	 *
+	 * @param seed Seed.
+	 */
+	extern void __urand_reseed(uint64_t seed);
+
+	/**
+	 * @brief Releases the default generator of the calling thread.
+	 */
+	extern void __urand_release(void);
+
+	/**
+	 * @brief Generates a bounded random number.
+	 *
+	 * @param state Target generator.
+	 * @param n     Upper bound (exclusive).
+	 *
+	 * @returns A uniformly distributed random number in [0, @p n).
+	 */
+	extern uint32_t urand_range(struct urand_state *state, uint32_t n);
+
+	/**
+	 * @brief Generates a bounded 64-bit random number.
+	 *
+	 * @param state Target generator.
+	 * @param n     Upper bound (exclusive).
+	 *
+	 * @returns A uniformly distributed random number in [0, @p n).
+	 */
+	extern uint64_t urand_range64(struct urand_state *state, uint64_t n);
+
+	/**
+	 * @brief Generates a random number within an interval.
+	 *
+	 * @param state Target generator.
+	 * @param lo    Lower bound (inclusive).
+	 * @param hi    Upper bound (inclusive).
+	 *
+	 * @returns A uniformly distributed random number in [@p lo, @p hi].
+	 */
+	extern int32_t urand_between(struct urand_state *state, int32_t lo, int32_t hi);
+
+	/**
+	 * @brief Generates a random double.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A uniformly distributed random number in [0, 1).
+	 */
+	extern double urand_double(struct urand_state *state);
+
+	/**
+	 * @brief Generates a random float.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A uniformly distributed random number in [0, 1).
+	 */
+	extern float urand_float(struct urand_state *state);
+
+	/**
+	 * @brief Generates a normally distributed random number.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A random number with mean zero and standard deviation
+	 * one.
+	 */
+	extern double urand_normal(struct urand_state *state);
+
+	/**
+	 * @brief Generates an exponentially distributed random number.
+	 *
+	 * @param state Target generator.
+	 *
+	 * @returns A random number with rate one.
+	 */
+	extern double urand_exponential(struct urand_state *state);
+
+	/**
+	 * @brief Randomly permutes an array.
+	 *
+	 * @param state Target generator.
+	 * @param base  Target array.
+	 * @param nmemb Number of elements in @p base.
+	 * @param size  Size of an element.
+	 */
+	extern void ushuffle(struct urand_state *state, void *base, size_t nmemb, size_t size);
+
+	/**
+	 * @brief Takes a random sample of an array.
+	 *
+	 * @param state Target generator.
+	 * @param dst   Sampled elements.
+	 * @param k     Number of elements to sample.
+	 * @param src   Source array.
+	 * @param n     Number of elements in @p src.
+	 * @param size  Size of an element.
+	 *
+	 * @returns The number of elements written to @p dst.
+	 */
+	extern size_t usample(struct urand_state *state, void *dst, size_t k, const void *src, size_t n, size_t size);
+
+/**@}*/
+
+/*============================================================================*
+ * Synchronization                                                            *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-sync Synchronization
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Hints the processor that the caller is spinning.
+	 */
+	#if defined(__i386__) || defined(__x86_64__)
+		#define ucpu_relax() __asm__ __volatile__ ("pause" ::: "memory")
+	#else
+		#define ucpu_relax() __asm__ __volatile__ ("" ::: "memory")
+	#endif
+
+	/**
+	 * @brief Maximum number of spins between attempts to take a lock.
+	 */
+	#define ULOCK_BACKOFF_MAX 1024
+
+	/**
+	 * @brief Test-and-test-and-set spinlock.
+	 */
+	struct uspinlock
+	{
+		int locked; /**< Is the lock taken? */
+	};
+
+	/**
+	 * @brief Static initializer for spinlocks.
+	 */
+	#define USPINLOCK_INITIALIZER { 0 }
+
+	/**
+	 * @brief Ticket lock.
+	 *
+	 * @details Threads take the lock in arrival order.
+	 */
+	struct uticketlock
+	{
+		unsigned next;  /**< Next ticket to hand out. */
+		unsigned owner; /**< Ticket being served.     */
+	};
+
+	/**
+	 * @brief Static initializer for ticket locks.
+	 */
+	#define UTICKETLOCK_INITIALIZER { 0, 0 }
+
+	/**
+	 * @brief Queue node of an MCS lock.
+	 *
+	 * @details Each thread waiting for or holding the lock owns one
+	 * node, usually on its stack, and spins on it only.
+	 */
+	struct umcs_node
+	{
+		struct umcs_node *next; /**< Next waiting thread. */
+		int locked;             /**< Still waiting?       */
+	};
+
+	/**
+	 * @brief MCS queued lock.
+	 */
+	struct umcslock
+	{
+		struct umcs_node *tail; /**< Last waiting thread. */
+	};
+
+	/**
+	 * @brief Static initializer for MCS locks.
+	 */
+	#define UMCSLOCK_INITIALIZER { NULL }
+
+	/**
+	 * @brief Initializes a spinlock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uspinlock_init(struct uspinlock *lock);
+
+	/**
+	 * @brief Acquires a spinlock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uspinlock_lock(struct uspinlock *lock);
+
+	/**
+	 * @brief Attempts to acquire a spinlock.
+	 *
+	 * @param lock Target lock.
+	 *
+	 * @returns Zero if the lock was acquired, and -EBUSY otherwise.
+	 */
+	extern int uspinlock_trylock(struct uspinlock *lock);
+
+	/**
+	 * @brief Releases a spinlock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uspinlock_unlock(struct uspinlock *lock);
+
+	/**
+	 * @brief Initializes a ticket lock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uticketlock_init(struct uticketlock *lock);
+
+	/**
+	 * @brief Acquires a ticket lock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uticketlock_lock(struct uticketlock *lock);
+
+	/**
+	 * @brief Attempts to acquire a ticket lock.
+	 *
+	 * @param lock Target lock.
+	 *
+	 * @returns Zero if the lock was acquired, and -EBUSY otherwise.
+	 */
+	extern int uticketlock_trylock(struct uticketlock *lock);
+
+	/**
+	 * @brief Releases a ticket lock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void uticketlock_unlock(struct uticketlock *lock);
+
+	/**
+	 * @brief Initializes an MCS lock.
+	 *
+	 * @param lock Target lock.
+	 */
+	extern void umcslock_init(struct umcslock *lock);
+
+	/**
+	 * @brief Acquires an MCS lock.
+	 *
+	 * @param lock Target lock.
+	 * @param node Queue node of the calling thread.
+	 */
+	extern void umcslock_lock(struct umcslock *lock, struct umcs_node *node);
+
+	/**
+	 * @brief Attempts to acquire an MCS lock.
+	 *
+	 * @param lock Target lock.
+	 * @param node Queue node of the calling thread.
+	 *
+	 * @returns Zero if the lock was acquired, and -EBUSY otherwise.
+	 */
+	extern int umcslock_trylock(struct umcslock *lock, struct umcs_node *node);
+
+	/**
+	 * @brief Releases an MCS lock.
+	 *
+	 * @param lock Target lock.
+	 * @param node Queue node passed when acquiring the lock.
+	 */
+	extern void umcslock_unlock(struct umcslock *lock, struct umcs_node *node);
+
+/**@}*/
+
+/*============================================================================*
+ * Queues                                                                     *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-queue Queues
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Cache line size (in bytes).
+	 */
+	#define UCACHE_LINE_SIZE 64
+
+	/**
+	 * @brief Maximum capacity of a queue.
+	 */
+	#define UQUEUE_CAPACITY_MAX (1U << 30)
+
+	/**
+	 * @brief Single-producer single-consumer queue.
+	 *
+	 * @details Bounded ring buffer of pointers. The producer and the
+	 * consumer indexes sit on different cache lines, and each side keeps
+	 * a cached copy of the other index, so that it only reads the shared
+	 * one when the queue looks full (or empty).
+	 */
+	struct uspsc
+	{
+		void **slots;                 /**< Ring buffer.               */
+		unsigned mask;                /**< Capacity minus one.        */
+		char pad0[UCACHE_LINE_SIZE];  /**< Padding.                   */
+		unsigned tail;                /**< Next slot to write.        */
+		unsigned head_cache;          /**< Producer copy of head.     */
+		char pad1[UCACHE_LINE_SIZE];  /**< Padding.                   */
+		unsigned head;                /**< Next slot to read.         */
+		unsigned tail_cache;          /**< Consumer copy of tail.     */
+		char pad2[UCACHE_LINE_SIZE];  /**< Padding.                   */
+	};
+
+	/**
+	 * @brief Cell of a multi-producer multi-consumer queue.
+	 */
+	struct umpmc_cell
+	{
+		unsigned seq; /**< Sequence number. */
+		void *data;   /**< Item.            */
+	};
+
+	/**
+	 * @brief Multi-producer multi-consumer queue.
+	 *
+	 * @details Bounded array of cells tagged with sequence numbers
+	 * (Vyukov). Producers and consumers claim cells by advancing their
+	 * index with a compare-and-swap, and then hand them over through the
+	 * sequence number of the cell.
+	 */
+	struct umpmc
+	{
+		struct umpmc_cell *cells;     /**< Cells.                     */
+		unsigned mask;                /**< Capacity minus one.        */
+		char pad0[UCACHE_LINE_SIZE];  /**< Padding.                   */
+		unsigned tail;                /**< Next cell to write.        */
+		char pad1[UCACHE_LINE_SIZE];  /**< Padding.                   */
+		unsigned head;                /**< Next cell to read.         */
+		char pad2[UCACHE_LINE_SIZE];  /**< Padding.                   */
+	};
+
+	/**
+	 * @brief Initializes a single-producer single-consumer queue.
+	 *
+	 * @param q        Target queue.
+	 * @param capacity Minimum number of items that the queue holds. It
+	 * is rounded up to a power of two.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int uspsc_init(struct uspsc *q, size_t capacity);
+
+	/**
+	 * @brief Releases the storage of a single-producer single-consumer
+	 * queue.
+	 *
+	 * @param q Target queue.
+	 */
+	extern void uspsc_destroy(struct uspsc *q);
+
+	/**
+	 * @brief Enqueues an item in a single-producer single-consumer queue.
+	 *
+	 * @param q    Target queue.
+	 * @param item Item.
+	 *
+	 * @returns Zero if the item was enqueued, and -EAGAIN if the queue
+	 * is full.
+	 */
+	extern int uspsc_push(struct uspsc *q, void *item);
+
+	/**
+	 * @brief Dequeues an item from a single-producer single-consumer
+	 * queue.
+	 *
+	 * @param q    Target queue.
+	 * @param item Store location for the item.
+	 *
+	 * @returns Zero if an item was dequeued, and -EAGAIN if the queue is
+	 * empty.
+	 */
+	extern int uspsc_pop(struct uspsc *q, void **item);
+
+	/**
+	 * @brief Enqueues several items in a single-producer single-consumer
+	 * queue.
+	 *
+	 * @param q     Target queue.
+	 * @param items Items.
+	 * @param n     Number of items.
+	 *
+	 * @returns The number of items enqueued.
+	 */
+	extern size_t uspsc_push_batch(struct uspsc *q, void *const *items, size_t n);
+
+	/**
+	 * @brief Dequeues several items from a single-producer
+	 * single-consumer queue.
+	 *
+	 * @param q     Target queue.
+	 * @param items Store location for the items.
+	 * @param n     Maximum number of items.
+	 *
+	 * @returns The number of items dequeued.
+	 */
+	extern size_t uspsc_pop_batch(struct uspsc *q, void **items, size_t n);
+
+	/**
+	 * @brief Initializes a multi-producer multi-consumer queue.
+	 *
+	 * @param q        Target queue.
+	 * @param capacity Minimum number of items that the queue holds. It
+	 * is rounded up to a power of two.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int umpmc_init(struct umpmc *q, size_t capacity);
+
+	/**
+	 * @brief Releases the storage of a multi-producer multi-consumer
+	 * queue.
+	 *
+	 * @param q Target queue.
+	 */
+	extern void umpmc_destroy(struct umpmc *q);
+
+	/**
+	 * @brief Enqueues an item in a multi-producer multi-consumer queue.
+	 *
+	 * @param q    Target queue.
+	 * @param item Item.
+	 *
+	 * @returns Zero if the item was enqueued, and -EAGAIN if the queue
+	 * is full.
+	 */
+	extern int umpmc_push(struct umpmc *q, void *item);
+
+	/**
+	 * @brief Dequeues an item from a multi-producer multi-consumer queue.
+	 *
+	 * @param q    Target queue.
+	 * @param item Store location for the item.
+	 *
+	 * @returns Zero if an item was dequeued, and -EAGAIN if the queue is
+	 * empty.
+	 */
+	extern int umpmc_pop(struct umpmc *q, void **item);
+
+	/**
+	 * @brief Enqueues several items in a multi-producer multi-consumer
+	 * queue.
+	 *
+	 * @param q     Target queue.
+	 * @param items Items.
+	 * @param n     Number of items.
+	 *
+	 * @returns The number of items enqueued.
+	 */
+	extern size_t umpmc_push_batch(struct umpmc *q, void *const *items, size_t n);
+
+	/**
+	 * @brief Dequeues several items from a multi-producer multi-consumer
+	 * queue.
+	 *
+	 * @param q     Target queue.
+	 * @param items Store location for the items.
+	 * @param n     Maximum number of items.
+	 *
+	 * @returns The number of items dequeued.
+	 */
+	extern size_t umpmc_pop_batch(struct umpmc *q, void **items, size_t n);
+
+/**@}*/
+
+/*============================================================================*
+ * Thread Pool                                                                *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-pool Thread Pool
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Number of worker threads in the pool.
+	 */
+	#define UPOOL_WORKERS_MAX (THREAD_MAX - 1)
+
+	/**
+	 * @brief Capacity of the deque of a worker thread.
+	 */
+	#define UPOOL_DEQUE_SIZE 256
+
+	/**
+	 * @brief Maximum number of pending tasks.
+	 */
+	#define UPOOL_TASKS_MAX 512
+
+	/**
+	 * @brief Group of tasks.
+	 */
+	struct upool_group
+	{
+		unsigned pending; /**< Number of unfinished tasks. */
+	};
+
+	/**
+	 * @brief Static initializer for groups of tasks.
+	 */
+	#define UPOOL_GROUP_INITIALIZER { 0 }
+
+	/**
+	 * @brief Submits a task to the thread pool.
+	 *
+	 * @param group Group of the task.
+	 * @param fn    Task function.
+	 * @param arg   Argument of @p fn.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note The task runs at once in the calling thread if the pool has
+	 * no room for it.
+	 */
+	extern int upool_submit(struct upool_group *group, void (*fn)(void *), void *arg);
+
+	/**
+	 * @brief Waits for the tasks of a group to complete.
+	 *
+	 * @param group Target group.
+	 */
+	extern void upool_wait(struct upool_group *group);
+
+	/**
+	 * @brief Runs a loop in parallel.
+	 *
+	 * @param begin First iteration.
+	 * @param end   Iteration past the last one.
+	 * @param grain Maximum number of iterations in a chunk. Zero picks a
+	 * grain that yields a few chunks per worker thread.
+	 * @param fn    Loop body, called on chunks of iterations.
+	 * @param arg   Argument of @p fn.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int uparallel_for(
+		size_t begin,
+		size_t end,
+		size_t grain,
+		void (*fn)(size_t, size_t, void *),
+		void *arg
+	);
+
+	/**
+	 * @brief Stops the worker threads of the pool.
+	 *
+	 * @note All submitted tasks must have completed.
+	 */
+	extern void upool_shutdown(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Fibers                                                                     *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-fiber Fibers
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Maximum number of fibers.
+	 */
+	#define UFIBER_MAX 32
+
+	/**
+	 * @brief Stack size of a fiber (in bytes).
+	 */
+	#define UFIBER_STACK_SIZE (8*1024)
+
+	/**
+	 * @brief Fiber.
+	 */
+	struct ufiber;
+
+	/**
+	 * @brief Creates a fiber.
+	 *
+	 * @param fiber Store location for the fiber.
+	 * @param start Start routine.
+	 * @param arg   Argument of @p start.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note The fiber belongs to the calling thread, and it first runs
+	 * when the caller yields or joins.
+	 */
+	extern int ufiber_create(struct ufiber **fiber, void *(*start)(void *), void *arg);
+
+	/**
+	 * @brief Yields the processor to the next ready fiber.
+	 */
+	extern void ufiber_yield(void);
+
+	/**
+	 * @brief Waits for a fiber to terminate.
+	 *
+	 * @param fiber  Target fiber.
+	 * @param retval Store location for the return value of @p fiber.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int ufiber_join(struct ufiber *fiber, void **retval);
+
+	/**
+	 * @brief Terminates the calling fiber.
+	 *
+	 * @param retval Return value.
+	 */
+	extern NORETURN void ufiber_exit(void *retval);
+
+	/**
+	 * @brief Returns the calling fiber.
+	 *
+	 * @returns The calling fiber, or NULL if the calling thread runs no
+	 * fibers.
+	 */
+	extern struct ufiber *ufiber_self(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Thread-Local Storage                                                       *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-tls Thread-Local Storage
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Storage class of static thread-local variables.
+	 *
+	 * @details Only defined on targets that build with
+	 * __NANVIX_HAS_TLS=1, that is, whose toolchain and kernel set up a
+	 * thread pointer for each thread.
+	 */
+	#if defined(__NANVIX_HAS_TLS) && (__NANVIX_HAS_TLS)
+		#define UTLS_THREAD __thread
+	#endif
+
+	/**
+	 * @brief Maximum number of keys.
+	 */
+	#define UTLS_KEYS_MAX 16
+
+	/**
+	 * @name Keys Reserved for the Library
+	 */
+	/**@{*/
+	#define UTLS_KEY_BUFFER    0 /**< Output buffer.     */
+	#define UTLS_KEY_LOG       1 /**< Log ring.          */
+	#define UTLS_KEY_RAND      2 /**< Random stream.     */
+	#define UTLS_KEY_FIBER     3 /**< Fiber scheduler.   */
+	#define UTLS_KEY_POOL      4 /**< Pool worker.       */
+	#define UTLS_KEYS_RESERVED 5 /**< Number of keys.    */
+	/**@}*/
+
+	/**
+	 * @brief Creates a thread-local storage key.
+	 *
+	 * @param key        Store location for the key.
+	 * @param destructor Function called on the non-NULL values of
+	 * exiting threads (may be NULL).
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int utls_key_create(unsigned *key, void (*destructor)(void *));
+
+	/**
+	 * @brief Deletes a thread-local storage key.
+	 *
+	 * @param key Target key.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int utls_key_delete(unsigned key);
+
+	/**
+	 * @brief Gets the value of a key for the calling thread.
+	 *
+	 * @param key Target key.
+	 *
+	 * @returns The value of @p key for the calling thread, or NULL if
+	 * it has none.
+	 */
+	extern void *utls_get(unsigned key);
+
+	/**
+	 * @brief Sets the value of a key for the calling thread.
+	 *
+	 * @param key   Target key.
+	 * @param value Value.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int utls_set(unsigned key, const void *value);
+
+	/**
+	 * @brief Initializes thread-local storage.
+	 */
+	extern void __utls_init(void);
+
+	/**
+	 * @brief Releases the thread-local storage of the calling thread.
+	 */
+	extern void __utls_release(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Threads                                                                    *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-thread Threads
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Creates a thread.
+	 *
+	 * @param tid   Store location for the ID of the new thread.
+	 * @param start Start routine.
+	 * @param arg   Argument of @p start.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @details The resources that the library holds for the new
+	 * thread are released when @p start returns, as they are when
+	 * the thread calls ___nanvix_exit(). Threads created with
+	 * kthread_create() must call ___nanvix_exit() instead of
+	 * returning, otherwise their output buffer, log ring, random
+	 * stream and thread-local storage are never released. Threads
+	 * are joined with kthread_join().
+	 */
+	extern int uthread_create(kthread_t *tid, void *(*start)(void *), void *arg);
+
+	/**
+	 * @brief Releases the resources of the calling thread.
+	 */
+	extern void __uthread_release(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Profiling                                                                  *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-prof Profiling
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Maximum number of probes.
+	 */
+	#define UPROF_PROBES_MAX 64
+
+	/**
+	 * @brief Reads the clock through the kernel.
+	 *
+	 * @returns The current value of the clock, in cycles.
+	 */
+	extern uint64_t __ucycles(void);
+
+	/**
+	 * @brief Reads the cycle counter.
+	 *
+	 * @returns The current value of the cycle counter.
+	 *
+	 * @note Targets without a cycle counter readable from user mode
+	 * fall back to the kernel clock, which costs a system call.
+	 */
+	static inline uint64_t ucycles(void)
+	{
+	#if defined(__i386__) || defined(__x86_64__)
+		uint32_t lo, hi;
+
+		__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+
+		return (((uint64_t) hi << 32) | lo);
+	#elif defined(__riscv) && (__riscv_xlen == 32)
+		uint32_t lo, hi, tmp;
+
+		/* Read the upper half twice, in case the lower half wraps. */
+		do
+		{
+			__asm__ __volatile__ ("rdcycleh %0" : "=r" (hi));
+			__asm__ __volatile__ ("rdcycle %0" : "=r" (lo));
+			__asm__ __volatile__ ("rdcycleh %0" : "=r" (tmp));
+		} while (hi != tmp);
+
+		return (((uint64_t) hi << 32) | lo);
+	#else
+		return (__ucycles());
+	#endif
+	}
+
+	/**
+	 * @brief Probe region in progress.
+	 */
+	struct uprof_region
+	{
+		int probe;      /**< Probe (negative if none).    */
+		uint64_t start; /**< Start time (in cycles).      */
+	};
+
+	/**
+	 * @brief Enters a probe region.
+	 *
+	 * @param region Store location for the region.
+	 * @param name   Name of the probe. The address of the name identifies
+	 * the probe, thus it should be a string literal.
+	 *
+	 * @note The overhead of a probe region is reported by the profiling
+	 * benchmark of the test driver.
+	 */
+	extern void uprof_begin(struct uprof_region *region, const char *name);
+
+	/**
+	 * @brief Leaves a probe region.
+	 *
+	 * @param region Target region.
+	 */
+	extern void uprof_end(struct uprof_region *region);
+
+	/**
+	 * @brief Prints the statistics of all probes.
+	 */
+	extern void uprof_report(void);
+
+	/**
+	 * @brief Clears the statistics of all probes.
+	 */
+	extern void uprof_reset(void);
+
+	/**
+	 * @brief Prints the statistics of all probes, if any was entered.
+	 */
+	extern void __uprof_exit(void);
+
+/**@}*/
+
+/*============================================================================*
+ * Sorting and Searching                                                      *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-sort Sorting and Searching
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Partitions up to this size are sorted by insertion.
+	 */
+	#define USORT_THRESHOLD 16
+
+	/**
+	 * @brief Sorts an array.
+	 *
+	 * @param base   Target array.
+	 * @param nmemb  Number of elements in @p base.
+	 * @param size   Size of an element.
+	 * @param compar Comparison function, which returns a negative
+	 * number, zero or a positive number if its first argument is less
+	 * than, equal to or greater than the second one.
+	 *
+	 * @note The sort is not stable.
+	 */
+	extern void uqsort(
+		void *base,
+		size_t nmemb,
+		size_t size,
+		int (*compar)(const void *, const void *)
+	);
+
+	/**
+	 * @brief Searches a sorted array.
+	 *
+	 * @param key    Key to search for.
+	 * @param base   Target array, sorted in ascending order.
+	 * @param nmemb  Number of elements in @p base.
+	 * @param size   Size of an element.
+	 * @param compar Comparison function (see uqsort()).
+	 *
+	 * @returns A pointer to an element equal to @p key, or NULL if
+	 * there is none.
+	 */
+	extern void *ubsearch(
+		const void *key,
+		const void *base,
+		size_t nmemb,
+		size_t size,
+		int (*compar)(const void *, const void *)
+	);
+
+	/**
+	 * @brief Compares two scalars.
+	 */
+	#define USORT_LESS(a, b) ((a) < (b))
+
+	/**
+	 * @brief Declares a type-specialised sort and search.
+	 *
+	 * @param name Suffix of the functions.
+	 * @param type Type of the elements.
+	 */
+	#define USORT_DECLARE(name, type)                                        \
+		extern void usort_##name(type *base, size_t nmemb);                  \
+		extern type *ubsearch_##name(type key, type const *base, size_t nmemb)
+
+	/**
+	 * @brief Defines a type-specialised sort and search.
+	 *
+	 * @param scope Storage class of the functions (e.g. static).
+	 * @param name  Suffix of the functions.
+	 * @param type  Type of the elements.
+	 * @param lt    Function-like macro or function that tells whether
+	 * its first argument is less than the second one.
+	 *
+	 * @details This defines usort_name() and ubsearch_name(), which work
+	 * like uqsort() and ubsearch() on arrays of @p type. Elements are
+	 * moved by assignment and compared with @p lt, which the compiler
+	 * inlines, instead of through a callback.
+	 */
+	#define USORT_DEFINE(scope, name, type, lt)                              \
+		static inline void usort_##name##_swap(type *a, type *b)             \
+		{                                                                    \
+			type t = *a;                                                     \
+			*a = *b;                                                         \
+			*b = t;                                                          \
+		}                                                                    \
+		static inline void usort_##name##_insertion(type *a, size_t n)       \
+		{                                                                    \
+			for (size_t i = 1; i < n; i++)                                   \
+			{                                                                \
+				type x = a[i];                                               \
+				size_t j = i;                                                \
+				for (/* noop */; (j > 0) && lt(x, a[j - 1]); j--)            \
+					a[j] = a[j - 1];                                         \
+				a[j] = x;                                                    \
+			}                                                                \
+		}                                                                    \
+		static inline void usort_##name##_sift(type *a, size_t i, size_t n)  \
+		{                                                                    \
+			type x = a[i];                                                   \
+			for (size_t c = 2*i + 1; c < n; i = c, c = 2*i + 1)              \
+			{                                                                \
+				if ((c + 1 < n) && lt(a[c], a[c + 1]))                       \
+					c++;                                                     \
+				if (!lt(x, a[c]))                                            \
+					break;                                                   \
+				a[i] = a[c];                                                 \
+			}                                                                \
+			a[i] = x;                                                        \
+		}                                                                    \
+		static inline void usort_##name##_heap(type *a, size_t n)            \
+		{                                                                    \
+			for (size_t i = n/2; i > 0; i--)                                 \
+				usort_##name##_sift(a, i - 1, n);                            \
+			for (size_t i = n; i > 1; i--)                                   \
+			{                                                                \
+				usort_##name##_swap(&a[0], &a[i - 1]);                       \
+				usort_##name##_sift(a, 0, i - 1);                            \
+			}                                                                \
+		}                                                                    \
+		static inline void usort_##name##_intro(type *a, size_t n, int depth)\
+		{                                                                    \
+			while (n > USORT_THRESHOLD)                                      \
+			{                                                                \
+				size_t i, j, m = n/2;                                        \
+				type v;                                                      \
+				if (depth-- == 0)                                            \
+				{                                                            \
+					usort_##name##_heap(a, n);                               \
+					return;                                                  \
+				}                                                            \
+				/* Median of three at a[0], maximum at a[n - 1]. */          \
+				if (lt(a[m], a[0]))                                          \
+					usort_##name##_swap(&a[m], &a[0]);                       \
+				if (lt(a[n - 1], a[m]))                                      \
+					usort_##name##_swap(&a[n - 1], &a[m]);                   \
+				if (lt(a[m], a[0]))                                          \
+					usort_##name##_swap(&a[m], &a[0]);                       \
+				usort_##name##_swap(&a[m], &a[0]);                           \
+				v = a[0];                                                    \
+				/* Hoare partition, a[n - 1] bounds the first scan. */       \
+				for (i = 1, j = n - 1; /* noop */; i++, j--)                 \
+				{                                                            \
+					while (lt(a[i], v))                                      \
+						i++;                                                 \
+					while (lt(v, a[j]))                                      \
+						j--;                                                 \
+					if (i >= j)                                              \
+						break;                                               \
+					usort_##name##_swap(&a[i], &a[j]);                       \
+				}                                                            \
+				a[0] = a[j]; a[j] = v;                                       \
+				/* Recurse into the smaller side, loop on the larger. */     \
+				if (j < n - j - 1)                                           \
+				{                                                            \
+					usort_##name##_intro(a, j, depth);                       \
+					a += j + 1;                                              \
+					n -= j + 1;                                              \
+				}                                                            \
+				else                                                         \
+				{                                                            \
+					usort_##name##_intro(a + j + 1, n - j - 1, depth);       \
+					n = j;                                                   \
+				}                                                            \
+			}                                                                \
+			usort_##name##_insertion(a, n);                                  \
+		}                                                                    \
+		scope void usort_##name(type *base, size_t nmemb)                    \
+		{                                                                    \
+			int depth = 0;                                                   \
+			for (size_t m = nmemb; m > 1; m >>= 1)                           \
+				depth += 2;                                                  \
+			usort_##name##_intro(base, nmemb, depth);                        \
+		}                                                                    \
+		scope type *ubsearch_##name(type key, type const *base, size_t nmemb)\
+		{                                                                    \
+			type const *p = base;                                            \
+			size_t n = nmemb;                                                \
+			if (n == 0)                                                      \
+				return (NULL);                                               \
+			/* Branch-free lower bound. */                                   \
+			while (n > 1)                                                    \
+			{                                                                \
+				size_t half = n/2;                                           \
+				p = lt(p[half - 1], key) ? p + half : p;                     \
+				n -= half;                                                   \
+			}                                                                \
+			if (lt(*p, key))                                                 \
+				p++;                                                         \
+			if ((p == base + nmemb) || lt(key, *p))                          \
+				return (NULL);                                               \
+			return ((type *) (uintptr_t) p);                                 \
+		}
+
+	/**
+	 * @brief Compares two pointers by address.
+	 */
+	#define USORT_LESS_PTR(a, b) ((uintptr_t) (a) < (uintptr_t) (b))
+
+	/**
+	 * @name Type-Specialised Sort and Search
+	 */
+	/**@{*/
+	USORT_DECLARE(int, int);
+	USORT_DECLARE(u32, uint32_t);
+	USORT_DECLARE(u64, uint64_t);
+	USORT_DECLARE(ptr, void *);
+	/**@}*/
+
+	/**
+	 * @brief Number of bits in a digit of radix sorts.
+	 */
+	#define URADIX_BITS 8
+
+	/**
+	 * @brief Number of digits in a key of @p keysize bytes.
+	 */
+	#define URADIX_DIGITS(keysize) (((keysize)*8)/URADIX_BITS)
+
+	/**
+	 * @brief Size of the scratch buffer of a radix sort (in bytes).
+	 *
+	 * @param n         Number of keys.
+	 * @param keysize   Size of a key.
+	 * @param valuesize Size of a value (zero if there are none).
+	 *
+	 * @details The buffer holds the histograms of all digits and a copy
+	 * of keys and values. It should be aligned like a key.
+	 */
+	#define URADIX_SCRATCH_SIZE(n, keysize, valuesize)                \
+		(URADIX_DIGITS(keysize)*(1 << URADIX_BITS)*sizeof(size_t) +   \
+		(n)*((keysize) + (valuesize)))
+
+	/**
+	 * @brief Sorts 32-bit keys.
+	 *
+	 * @param keys    Target keys.
+	 * @param n       Number of keys.
+	 * @param scratch Scratch buffer of URADIX_SCRATCH_SIZE(n, 4, 0)
+	 * bytes, or NULL to allocate one.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int uradix_sort_u32(uint32_t *keys, size_t n, void *scratch);
+
+	/**
+	 * @brief Sorts 64-bit keys.
+	 *
+	 * @param keys    Target keys.
+	 * @param n       Number of keys.
+	 * @param scratch Scratch buffer of URADIX_SCRATCH_SIZE(n, 8, 0)
+	 * bytes, or NULL to allocate one.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int uradix_sort_u64(uint64_t *keys, size_t n, void *scratch);
+
+	/**
+	 * @brief Sorts 32-bit keys along with 32-bit values.
+	 *
+	 * @param keys    Target keys.
+	 * @param vals    Values of @p keys.
+	 * @param n       Number of keys.
+	 * @param scratch Scratch buffer of URADIX_SCRATCH_SIZE(n, 4, 4)
+	 * bytes, or NULL to allocate one.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note The sort is stable.
+	 */
+	extern int uradix_sort_u32_kv(uint32_t *keys, uint32_t *vals, size_t n, void *scratch);
+
+	/**
+	 * @brief Sorts 64-bit keys along with 64-bit values.
+	 *
+	 * @param keys    Target keys.
+	 * @param vals    Values of @p keys.
+	 * @param n       Number of keys.
+	 * @param scratch Scratch buffer of URADIX_SCRATCH_SIZE(n, 8, 8)
+	 * bytes, or NULL to allocate one.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note The sort is stable.
+	 */
+	extern int uradix_sort_u64_kv(uint64_t *keys, uint64_t *vals, size_t n, void *scratch);
+
+/**@}*/
+
+/*============================================================================*
+ * Hash Maps                                                                  *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-hmap Hash Maps
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Minimum number of slots in a hash map.
+	 */
+	#define UHMAP_SLOTS_MIN 8
+
+	/**
+	 * @brief Maximum number of slots in a hash map.
+	 */
+	#define UHMAP_SLOTS_MAX (1U << 30)
+
+	/**
+	 * @brief Maximum number of items in a hash map of @p slots slots.
+	 *
+	 * @details The maximum load factor is 7/8.
+	 */
+	#define UHMAP_LOAD_MAX(slots) ((slots) - (slots)/8)
+
+	/**
+	 * @brief Maximum probe distance in a hash map.
+	 */
+	#define UHMAP_DIST_MAX 255
+
+	/**
+	 * @brief Slots of the old table moved by each update while a hash
+	 * map is being resized.
+	 */
+	#define UHMAP_MIGRATE 8
+
+	/**
+	 * @brief Memory allocator of a hash map.
+	 *
+	 * @details Allocated blocks should be aligned like any of the keys
+	 * and values. The free() function may be NULL, if the arena is
+	 * released as a whole.
+	 */
+	struct uhmap_allocator
+	{
+		void *(*alloc)(void *arena, size_t size); /**< Allocates a block. */
+		void (*free)(void *arena, void *ptr);     /**< Releases a block.  */
+		void *arena;                              /**< Memory arena.      */
+	};
+
+	/**
+	 * @brief Allocates memory for a hash map.
+	 *
+	 * @param allocator Target allocator, or NULL to use umalloc().
+	 * @param size      Number of bytes to allocate.
+	 *
+	 * @returns The allocated block, or NULL if there is no memory left.
+	 */
+	static inline void *uhmap_alloc(const struct uhmap_allocator *allocator, size_t size)
+	{
+		return ((allocator != NULL) ?
+			allocator->alloc(allocator->arena, size) : umalloc(size));
+	}
+
+	/**
+	 * @brief Releases memory of a hash map.
+	 *
+	 * @param allocator Target allocator, or NULL to use ufree().
+	 * @param ptr       Block to release.
+	 */
+	static inline void uhmap_free(const struct uhmap_allocator *allocator, void *ptr)
+	{
+		if (allocator == NULL)
+			ufree(ptr);
+		else if (allocator->free != NULL)
+			allocator->free(allocator->arena, ptr);
+	}
+
+	/**
+	 * @brief Hashes a 32-bit integer.
+	 *
+	 * @details Hash maps index their tables with the high bits of hash
+	 * values, which a multiplication by the golden ratio mixes well.
+	 */
+	#define UHMAP_HASH_U32(k) ((uint32_t) (k)*0x9e3779b9U)
+
+	/**
+	 * @brief Hashes a 64-bit integer.
+	 */
+	#define UHMAP_HASH_U64(k) \
+		((uint32_t) (((uint64_t) (k)*0x9e3779b97f4a7c15ULL) >> 32))
+
+	/**
+	 * @brief Hashes a pointer.
+	 */
+	#define UHMAP_HASH_PTR(k)                         \
+		((sizeof(uintptr_t) > sizeof(uint32_t)) ?     \
+			UHMAP_HASH_U64((uintptr_t) (k)) :         \
+			UHMAP_HASH_U32((uintptr_t) (k)))
+
+	/**
+	 * @brief Hashes a string.
+	 *
+	 * @param str Target string.
+	 *
+	 * @returns The hash value of @p str.
+	 */
+	extern uint32_t uhmap_hash_str(const char *str);
+
+	/**
+	 * @brief Compares two scalars for equality.
+	 */
+	#define UHMAP_EQ(a, b) ((a) == (b))
+
+	/**
+	 * @brief Compares two strings for equality.
+	 */
+	#define UHMAP_EQ_STR(a, b) (((a) == (b)) || (ustrcmp((a), (b)) == 0))
+
+	/**
+	 * @brief Declares the types of a hash map.
+	 *
+	 * @param name  Suffix of the types.
+	 * @param ktype Type of keys.
+	 * @param vtype Type of values.
+	 *
+	 * @details A table is an array of entries and an array of probe
+	 * distances, which are kept in Robin Hood order. While the map is
+	 * being resized, entries live either in the old table or in the
+	 * current one.
+	 */
+	#define UHMAP_STRUCT(name, ktype, vtype)                                 \
+		struct uhmap_##name##_entry                                          \
+		{                                                                    \
+			ktype key; /**< Key.   */                                        \
+			vtype val; /**< Value. */                                        \
+		};                                                                   \
+		struct uhmap_##name##_table                                          \
+		{                                                                    \
+			struct uhmap_##name##_entry *entries; /**< Entries.          */  \
+			uint8_t *dists; /**< Probe distances plus one, zero if empty. */ \
+			size_t mask;    /**< Number of slots minus one.             */   \
+			int shift;      /**< Shift from hash values to slots.       */   \
+		};                                                                   \
+		struct uhmap_##name                                                  \
+		{                                                                    \
+			struct uhmap_##name##_table cur; /**< Current table.        */   \
+			struct uhmap_##name##_table old; /**< Table being migrated. */   \
+			size_t count;  /**< Number of entries.                      */   \
+			size_t cursor; /**< Next slot of the old table to migrate.  */   \
+			const struct uhmap_allocator *allocator; /**< Allocator.    */   \
+		}
+
+	/**
+	 * @brief Declares a type-specialised hash map.
+	 *
+	 * @param name  Suffix of the types and functions.
+	 * @param ktype Type of keys.
+	 * @param vtype Type of values.
+	 */
+	#define UHMAP_DECLARE(name, ktype, vtype)                                \
+		UHMAP_STRUCT(name, ktype, vtype);                                    \
+		extern int uhmap_##name##_init(struct uhmap_##name *map,             \
+			size_t capacity, const struct uhmap_allocator *allocator);       \
+		extern void uhmap_##name##_destroy(struct uhmap_##name *map);        \
+		extern int uhmap_##name##_put(struct uhmap_##name *map,              \
+			ktype key, vtype val);                                           \
+		extern vtype *uhmap_##name##_get(struct uhmap_##name *map,           \
+			ktype key);                                                      \
+		extern int uhmap_##name##_remove(struct uhmap_##name *map,           \
+			ktype key, vtype *val);                                          \
+		extern struct uhmap_##name##_entry *uhmap_##name##_next(             \
+			struct uhmap_##name *map, size_t *iter)
+
+	/**
+	 * @brief Defines a type-specialised hash map.
+	 *
+	 * @param scope Storage class of the functions (e.g. static).
+	 * @param name  Suffix of the types and functions.
+	 * @param ktype Type of keys.
+	 * @param vtype Type of values.
+	 * @param hash  Function-like macro or function that returns the
+	 * 32-bit hash value of a key.
+	 * @param eq    Function-like macro or function that tells whether
+	 * two keys are equal.
+	 *
+	 * @details This defines, for the types of UHMAP_STRUCT():
+	 *
+	 * - uhmap_name_init(), which initializes a map that holds at least
+	 *   @p capacity entries before it grows, with memory from an
+	 *   allocator or from umalloc() if it is NULL.
+	 * - uhmap_name_destroy(), which releases the storage of a map.
+	 * - uhmap_name_put(), which inserts an entry or replaces the value
+	 *   of a key, and returns zero or -ENOMEM.
+	 * - uhmap_name_get(), which returns a pointer to the value of a key,
+	 *   or NULL if there is none. The pointer is valid until the next
+	 *   update of the map.
+	 * - uhmap_name_remove(), which removes a key and stores its value in
+	 *   @p val, if it is not NULL, and returns zero or -ENOENT.
+	 * - uhmap_name_next(), which returns the entry that follows the
+	 *   iterator @p iter (initially zero), or NULL at the end. The map
+	 *   must not be updated during the iteration.
+	 *
+	 * The map uses open addressing with linear probing in Robin Hood
+	 * order: entries are inserted by shifting the rest of their cluster
+	 * and removed by shifting it back, so lookups stop at the first
+	 * entry that is closer to its home slot than the key would be and
+	 * no tombstones are needed. When the map grows, a table of twice the
+	 * size is allocated and each update moves UHMAP_MIGRATE slots of the
+	 * old table into it, instead of rehashing all entries at once.
+	 *
+	 * @note The file that defines a map must include <posix/errno.h>.
+	 */
+	#define UHMAP_DEFINE(scope, name, ktype, vtype, hash, eq)                \
+		static inline size_t uhmap_##name##_find(                            \
+			const struct uhmap_##name##_table *t, ktype key, uint32_t h)     \
+		{                                                                    \
+			size_t i = h >> t->shift;                                        \
+			for (unsigned d = 1; t->dists[i] >= d; d++)                      \
+			{                                                                \
+				if ((t->dists[i] == d) && eq(t->entries[i].key, key))        \
+					return (i);                                              \
+				i = (i + 1) & t->mask;                                       \
+			}                                                                \
+			return ((size_t) -1);                                            \
+		}                                                                    \
+		static inline int uhmap_##name##_insert(                             \
+			struct uhmap_##name##_table *t,                                  \
+			const struct uhmap_##name##_entry *e, uint32_t h)                \
+		{                                                                    \
+			size_t i = h >> t->shift, j;                                     \
+			unsigned d = 1;                                                  \
+			/* Skip entries that are farther from home. */                   \
+			for (/* noop */; t->dists[i] >= d; d++)                          \
+				i = (i + 1) & t->mask;                                       \
+			if (d > UHMAP_DIST_MAX)                                          \
+				return (-EOVERFLOW);                                         \
+			/* End of the cluster. */                                        \
+			for (j = i; t->dists[j] != 0; j = (j + 1) & t->mask)             \
+			{                                                                \
+				if (t->dists[j] == UHMAP_DIST_MAX)                           \
+					return (-EOVERFLOW);                                     \
+			}                                                                \
+			/* Shift the rest of the cluster forward. */                     \
+			for (/* noop */; j != i; j = (j - 1) & t->mask)                  \
+			{                                                                \
+				t->entries[j] = t->entries[(j - 1) & t->mask];               \
+				t->dists[j] = t->dists[(j - 1) & t->mask] + 1;               \
+			}                                                                \
+			t->entries[i] = *e;                                              \
+			t->dists[i] = d;                                                 \
+			return (0);                                                      \
+		}                                                                    \
+		static inline void uhmap_##name##_erase(                             \
+			struct uhmap_##name##_table *t, size_t i)                        \
+		{                                                                    \
+			/* Shift the rest of the cluster back. */                        \
+			for (size_t j = (i + 1) & t->mask; t->dists[j] > 1;              \
+				i = j, j = (j + 1) & t->mask)                                \
+			{                                                                \
+				t->entries[i] = t->entries[j];                               \
+				t->dists[i] = t->dists[j] - 1;                               \
+			}                                                                \
+			t->dists[i] = 0;                                                 \
+		}                                                                    \
+		static inline int uhmap_##name##_alloc(struct uhmap_##name *map,     \
+			struct uhmap_##name##_table *t, size_t slots)                    \
+		{                                                                    \
+			int bits = 0;                                                    \
+			if ((slots > UHMAP_SLOTS_MAX) ||                                 \
+				(slots > ((size_t) -1)/(sizeof(*t->entries) + 1)))           \
+				return (-ENOMEM);                                            \
+			t->entries = uhmap_alloc(map->allocator,                         \
+				slots*(sizeof(*t->entries) + 1));                            \
+			if (t->entries == NULL)                                          \
+				return (-ENOMEM);                                            \
+			while ((1UL << bits) < slots)                                    \
+				bits++;                                                      \
+			t->dists = (uint8_t *) &t->entries[slots];                       \
+			t->mask = slots - 1;                                             \
+			t->shift = 32 - bits;                                            \
+			umemset(t->dists, 0, slots);                                     \
+			return (0);                                                      \
+		}                                                                    \
+		static inline void uhmap_##name##_release(struct uhmap_##name *map,  \
+			struct uhmap_##name##_table *t)                                  \
+		{                                                                    \
+			if (t->entries != NULL)                                          \
+				uhmap_free(map->allocator, t->entries);                      \
+			t->entries = NULL;                                               \
+			t->dists = NULL;                                                 \
+			t->mask = 0;                                                     \
+		}                                                                    \
+		static int uhmap_##name##_rebuild(struct uhmap_##name *map,          \
+			size_t slots)                                                    \
+		{                                                                    \
+			struct uhmap_##name##_table t;                                   \
+			struct uhmap_##name##_table *src[2] = { &map->old, &map->cur };  \
+			/* Copy all entries into a new table, growing it on overflow. */ \
+		again:                                                               \
+			if (uhmap_##name##_alloc(map, &t, slots) < 0)                    \
+				return (-ENOMEM);                                            \
+			for (int s = 0; s < 2; s++)                                      \
+			{                                                                \
+				if (src[s]->entries == NULL)                                 \
+					continue;                                                \
+				for (size_t i = 0; i <= src[s]->mask; i++)                   \
+				{                                                            \
+					struct uhmap_##name##_entry *e = &src[s]->entries[i];    \
+					if (src[s]->dists[i] == 0)                               \
+						continue;                                            \
+					if (uhmap_##name##_insert(&t, e, hash(e->key)) < 0)      \
+					{                                                        \
+						uhmap_##name##_release(map, &t);                     \
+						slots *= 2;                                          \
+						goto again;                                          \
+					}                                                        \
+				}                                                            \
+			}                                                                \
+			uhmap_##name##_release(map, &map->old);                          \
+			uhmap_##name##_release(map, &map->cur);                          \
+			map->cur = t;                                                    \
+			map->cursor = 0;                                                 \
+			return (0);                                                      \
+		}                                                                    \
+		static void uhmap_##name##_migrate(struct uhmap_##name *map)         \
+		{                                                                    \
+			struct uhmap_##name##_table *t = &map->old;                      \
+			/* Slots before the cursor are empty. */                         \
+			for (int n = 0; n < UHMAP_MIGRATE; n++)                          \
+			{                                                                \
+				struct uhmap_##name##_entry *e = &t->entries[map->cursor];   \
+				if (t->dists[map->cursor] != 0)                              \
+				{                                                            \
+					if (uhmap_##name##_insert(&map->cur, e, hash(e->key)) < 0)\
+					{                                                        \
+						uhmap_##name##_rebuild(map, 2*(map->cur.mask + 1));  \
+						return;                                              \
+					}                                                        \
+					uhmap_##name##_erase(t, map->cursor);                    \
+				}                                                            \
+				else if (++map->cursor > t->mask)                            \
+				{                                                            \
+					uhmap_##name##_release(map, t);                          \
+					map->cursor = 0;                                         \
+					return;                                                  \
+				}                                                            \
+			}                                                                \
+		}                                                                    \
+		scope int uhmap_##name##_init(struct uhmap_##name *map,              \
+			size_t capacity, const struct uhmap_allocator *allocator)        \
+		{                                                                    \
+			size_t slots = UHMAP_SLOTS_MIN;                                  \
+			if ((map == NULL) || (capacity > UHMAP_LOAD_MAX(UHMAP_SLOTS_MAX)))\
+				return (-EINVAL);                                            \
+			if ((allocator != NULL) && (allocator->alloc == NULL))           \
+				return (-EINVAL);                                            \
+			while (UHMAP_LOAD_MAX(slots) < capacity)                         \
+				slots *= 2;                                                  \
+			umemset(map, 0, sizeof(struct uhmap_##name));                    \
+			map->allocator = allocator;                                      \
+			return (uhmap_##name##_alloc(map, &map->cur, slots));            \
+		}                                                                    \
+		scope void uhmap_##name##_destroy(struct uhmap_##name *map)          \
+		{                                                                    \
+			uhmap_##name##_release(map, &map->old);                          \
+			uhmap_##name##_release(map, &map->cur);                          \
+			map->count = 0;                                                  \
+		}                                                                    \
+		scope vtype *uhmap_##name##_get(struct uhmap_##name *map, ktype key) \
+		{                                                                    \
+			uint32_t h = hash(key);                                          \
+			size_t i;                                                        \
+			if ((i = uhmap_##name##_find(&map->cur, key, h)) != (size_t) -1) \
+				return (&map->cur.entries[i].val);                           \
+			if (map->old.entries == NULL)                                    \
+				return (NULL);                                               \
+			if ((i = uhmap_##name##_find(&map->old, key, h)) != (size_t) -1) \
+				return (&map->old.entries[i].val);                           \
+			return (NULL);                                                   \
+		}                                                                    \
+		scope int uhmap_##name##_put(struct uhmap_##name *map,               \
+			ktype key, vtype val)                                            \
+		{                                                                    \
+			struct uhmap_##name##_entry e;                                   \
+			uint32_t h = hash(key);                                          \
+			size_t i;                                                        \
+			/* Replace. */                                                   \
+			if ((i = uhmap_##name##_find(&map->cur, key, h)) != (size_t) -1) \
+			{                                                                \
+				map->cur.entries[i].val = val;                               \
+				return (0);                                                  \
+			}                                                                \
+			if ((map->old.entries != NULL) &&                                \
+				((i = uhmap_##name##_find(&map->old, key, h)) != (size_t) -1))\
+			{                                                                \
+				map->old.entries[i].val = val;                               \
+				return (0);                                                  \
+			}                                                                \
+			/* Grow. */                                                      \
+			if (map->count >= UHMAP_LOAD_MAX(map->cur.mask + 1))             \
+			{                                                                \
+				size_t slots = 2*(map->cur.mask + 1);                        \
+				if (map->old.entries != NULL)                                \
+				{                                                            \
+					if (uhmap_##name##_rebuild(map, slots) < 0)              \
+						return (-ENOMEM);                                    \
+				}                                                            \
+				else                                                         \
+				{                                                            \
+					struct uhmap_##name##_table t;                           \
+					if (uhmap_##name##_alloc(map, &t, slots) < 0)            \
+						return (-ENOMEM);                                    \
+					map->old = map->cur;                                     \
+					map->cur = t;                                            \
+					map->cursor = 0;                                         \
+				}                                                            \
+			}                                                                \
+			/* Insert. */                                                    \
+			e.key = key;                                                     \
+			e.val = val;                                                     \
+			while (uhmap_##name##_insert(&map->cur, &e, h) < 0)              \
+			{                                                                \
+				if (uhmap_##name##_rebuild(map, 2*(map->cur.mask + 1)) < 0)  \
+					return (-ENOMEM);                                        \
+			}                                                                \
+			map->count++;                                                    \
+			if (map->old.entries != NULL)                                    \
+				uhmap_##name##_migrate(map);                                 \
+			return (0);                                                      \
+		}                                                                    \
+		scope int uhmap_##name##_remove(struct uhmap_##name *map,            \
+			ktype key, vtype *val)                                           \
+		{                                                                    \
+			uint32_t h = hash(key);                                          \
+			struct uhmap_##name##_table *t = &map->cur;                      \
+			size_t i = uhmap_##name##_find(t, key, h);                       \
+			if ((i == (size_t) -1) && (map->old.entries != NULL))            \
+			{                                                                \
+				t = &map->old;                                               \
+				i = uhmap_##name##_find(t, key, h);                          \
+			}                                                                \
+			if (i == (size_t) -1)                                            \
+				return (-ENOENT);                                            \
+			if (val != NULL)                                                 \
+				*val = t->entries[i].val;                                    \
+			uhmap_##name##_erase(t, i);                                      \
+			map->count--;                                                    \
+			if (map->old.entries != NULL)                                    \
+				uhmap_##name##_migrate(map);                                 \
+			return (0);                                                      \
+		}                                                                    \
+		scope struct uhmap_##name##_entry *uhmap_##name##_next(              \
+			struct uhmap_##name *map, size_t *iter)                          \
+		{                                                                    \
+			size_t nold = (map->old.entries != NULL) ? map->old.mask + 1 : 0;\
+			for (size_t i = *iter; i < nold + map->cur.mask + 1; i++)        \
+			{                                                                \
+				struct uhmap_##name##_table *t = &map->cur;                  \
+				size_t j = i - nold;                                         \
+				if (i < nold)                                                \
+				{                                                            \
+					t = &map->old;                                           \
+					j = i;                                                   \
+				}                                                            \
+				if (t->dists[j] != 0)                                        \
+				{                                                            \
+					*iter = i + 1;                                           \
+					return (&t->entries[j]);                                 \
+				}                                                            \
+			}                                                                \
+			*iter = nold + map->cur.mask + 1;                                \
+			return (NULL);                                                   \
+		}
+
+	/**
+	 * @name Type-Specialised Hash Maps
+	 */
+	/**@{*/
+	UHMAP_DECLARE(u32, uint32_t, uint32_t);
+	UHMAP_DECLARE(u64, uint64_t, uint64_t);
+	UHMAP_DECLARE(ptr, void *, void *);
+	UHMAP_DECLARE(str, const char *, void *);
+	/**@}*/
+
+/**@}*/
+
+/*============================================================================*
+ * Hashing and Checksums                                                      *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-hash Hashing and Checksums
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Number of bytes mixed at a time by 64-bit hashes.
+	 */
+	#define UHASH64_STRIPE 32
+
+	/**
+	 * @brief State of an incremental 64-bit hash.
+	 */
+	struct uhash64_state
+	{
+		uint64_t acc[4];                   /**< Accumulators.   */
+		uint64_t total;                    /**< Bytes mixed in. */
+		unsigned char buf[UHASH64_STRIPE]; /**< Partial stripe. */
+		size_t buflen;                     /**< Bytes in buf.   */
+	};
+
+	/**
+	 * @brief Computes a 64-bit hash value.
+	 *
+	 * @param data Target data.
+	 * @param len  Number of bytes in @p data.
+	 * @param seed Seed.
+	 *
+	 * @returns The hash value of @p data.
+	 *
+	 * @note The hash is not cryptographic.
+	 */
+	extern uint64_t uhash64(const void *data, size_t len, uint64_t seed);
+
+	/**
+	 * @brief Initializes an incremental 64-bit hash.
+	 *
+	 * @param state Target state.
+	 * @param seed  Seed.
+	 */
+	extern void uhash64_init(struct uhash64_state *state, uint64_t seed);
+
+	/**
+	 * @brief Mixes data into an incremental 64-bit hash.
+	 *
+	 * @param state Target state.
+	 * @param data  Target data.
+	 * @param len   Number of bytes in @p data.
+	 */
+	extern void uhash64_update(struct uhash64_state *state, const void *data, size_t len);
+
+	/**
+	 * @brief Computes the value of an incremental 64-bit hash.
+	 *
+	 * @param state Target state.
+	 *
+	 * @returns The value that uhash64() returns for all data mixed into
+	 * @p state.
+	 */
+	extern uint64_t uhash64_final(const struct uhash64_state *state);
+
+	/**
+	 * @brief Computes a CRC-32 checksum.
+	 *
+	 * @param crc  Checksum of previous data, or zero.
+	 * @param data Target data.
+	 * @param len  Number of bytes in @p data.
+	 *
+	 * @returns The checksum of the previous data followed by @p data.
+	 */
+	extern uint32_t ucrc32(uint32_t crc, const void *data, size_t len);
+
+	/**
+	 * @brief Computes a CRC-32C (Castagnoli) checksum.
+	 *
+	 * @param crc  Checksum of previous data, or zero.
+	 * @param data Target data.
+	 * @param len  Number of bytes in @p data.
+	 *
+	 * @returns The checksum of the previous data followed by @p data.
+	 */
+	extern uint32_t ucrc32c(uint32_t crc, const void *data, size_t len);
+
+/**@}*/
+
+/*============================================================================*
+ * Bitsets                                                                    *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-bitset Bitsets
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @brief Does the target count trailing zeros in hardware?
+	 *
+	 * @details Otherwise, __builtin_ctzll() may become a call to the
+	 * compiler runtime, and a branch-free fallback is used instead.
+	 */
+	#ifndef UBIT_HAS_CTZ
+		#if defined(__i386__) || defined(__x86_64__) || \
+			defined(__aarch64__) || defined(__riscv_zbb)
+			#define UBIT_HAS_CTZ 1
+		#else
+			#define UBIT_HAS_CTZ 0
+		#endif
+	#endif
+
+	/**
+	 * @brief Does the target count set bits in hardware?
+	 */
+	#ifndef UBIT_HAS_POPCOUNT
+		#if defined(__POPCNT__) || defined(__aarch64__) || defined(__riscv_zbb)
+			#define UBIT_HAS_POPCOUNT 1
+		#else
+			#define UBIT_HAS_POPCOUNT 0
+		#endif
+	#endif
+
+	/**
+	 * @brief Counts set bits in a 64-bit word.
+	 *
+	 * @param x Target word.
+	 *
+	 * @returns The number of bits set in @p x.
+	 */
+	static inline unsigned ubit_popcount64(uint64_t x)
+	{
+	#if (UBIT_HAS_POPCOUNT)
+		return ((unsigned) __builtin_popcountll(x));
+	#elif defined(__LP64__)
+		x = x - ((x >> 1) & 0x5555555555555555ULL);
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+		return ((unsigned) ((x*0x0101010101010101ULL) >> 56));
+	#else
+		uint32_t lo = (uint32_t) x;
+		uint32_t hi = (uint32_t) (x >> 32);
+		lo = lo - ((lo >> 1) & 0x55555555U);
+		hi = hi - ((hi >> 1) & 0x55555555U);
+		lo = (lo & 0x33333333U) + ((lo >> 2) & 0x33333333U);
+		hi = (hi & 0x33333333U) + ((hi >> 2) & 0x33333333U);
+		lo = (lo + (lo >> 4)) & 0x0f0f0f0fU;
+		hi = (hi + (hi >> 4)) & 0x0f0f0f0fU;
+		return (((lo + hi)*0x01010101U) >> 24);
+	#endif
+	}
+
+	/**
+	 * @brief Counts trailing zeros in a 64-bit word.
+	 *
+	 * @param x Target word, which must not be zero.
+	 *
+	 * @returns The index of the lowest bit set in @p x.
+	 */
+	static inline unsigned ubit_ctz64(uint64_t x)
+	{
+	#if (UBIT_HAS_CTZ)
+		return ((unsigned) __builtin_ctzll(x));
+	#else
+		/* Bits below the lowest set one. */
+		return (ubit_popcount64((x & -x) - 1));
+	#endif
+	}
+
+	/**
+	 * @brief Number of bits in a word of a bitset.
+	 */
+	#define UBITSET_WORD_BIT 64
+
+	/**
+	 * @brief Number of words in a bitset of @p nbits bits.
+	 */
+	#define UBITSET_WORDS(nbits) \
+		(((nbits) + UBITSET_WORD_BIT - 1)/UBITSET_WORD_BIT)
+
+	/**
+	 * @brief Iterator over the bits set in a bitset.
+	 */
+	struct ubitset_iter
+	{
+		const uint64_t *set; /**< Target bitset.                  */
+		size_t nwords;       /**< Number of words in the bitset.  */
+		size_t w;            /**< Index of the current word.      */
+		uint64_t word;       /**< Bits of the word left to visit. */
+	};
+
+	/**
+	 * @brief Initializes an iterator over the bits set in a bitset.
+	 *
+	 * @param set   Target bitset.
+	 * @param nbits Number of bits in @p set.
+	 *
+	 * @returns An iterator positioned before the first set bit.
+	 */
+	static inline struct ubitset_iter ubitset_iter(const uint64_t *set, size_t nbits)
+	{
+		struct ubitset_iter it;
+
+		it.set = set;
+		it.nwords = UBITSET_WORDS(nbits);
+		it.w = (size_t) -1;
+		it.word = 0;
+
+		return (it);
+	}
+
+	/**
+	 * @brief Advances an iterator over the bits set in a bitset.
+	 *
+	 * @param it Target iterator.
+	 * @param i  Store location for the index of the next set bit.
+	 *
+	 * @returns Non-zero if a set bit was found, and zero at the end of
+	 * the bitset.
+	 *
+	 * @details Empty words are skipped, and the lowest bit of the
+	 * current word is cleared on each step.
+	 */
+	static inline int ubitset_iter_next(struct ubitset_iter *it, size_t *i)
+	{
+		while (it->word == 0)
+		{
+			if (++it->w >= it->nwords)
+				return (0);
+			it->word = it->set[it->w];
+		}
+
+		*i = it->w*UBITSET_WORD_BIT + ubit_ctz64(it->word);
+		it->word &= it->word - 1;
+
+		return (1);
+	}
+
+	/**
+	 * @brief Iterates over the bits set in a bitset.
+	 *
+	 * @param i     Index of the current bit, a size_t variable.
+	 * @param set   Target bitset.
+	 * @param nbits Number of bits in @p set.
+	 *
+	 * @note The bitset must not be changed during the iteration.
+	 */
+	#define UBITSET_FOREACH(i, set, nbits)                                 \
+		for (struct ubitset_iter i##_it = ubitset_iter((set), (nbits));    \
+			ubitset_iter_next(&i##_it, &(i)); /* noop */)
+
+	/**
+	 * @brief Sets a bit in a bitset.
+	 *
+	 * @param set Target bitset.
+	 * @param i   Index of the target bit.
+	 */
+	static inline void ubitset_set(uint64_t *set, size_t i)
+	{
+		set[i/UBITSET_WORD_BIT] |= 1ULL << (i % UBITSET_WORD_BIT);
+	}
+
+	/**
+	 * @brief Clears a bit in a bitset.
+	 *
+	 * @param set Target bitset.
+	 * @param i   Index of the target bit.
+	 */
+	static inline void ubitset_clear(uint64_t *set, size_t i)
+	{
+		set[i/UBITSET_WORD_BIT] &= ~(1ULL << (i % UBITSET_WORD_BIT));
+	}
+
+	/**
+	 * @brief Tests a bit in a bitset.
+	 *
+	 * @param set Target bitset.
+	 * @param i   Index of the target bit.
+	 *
+	 * @returns Non-zero if the bit is set, and zero otherwise.
+	 */
+	static inline int ubitset_test(const uint64_t *set, size_t i)
+	{
+		return ((set[i/UBITSET_WORD_BIT] >> (i % UBITSET_WORD_BIT)) & 1);
+	}
+
+	/**
+	 * @brief Sets or clears all bits in a bitset.
+	 *
+	 * @param set   Target bitset.
+	 * @param nbits Number of bits in @p set.
+	 * @param value Set bits?
+	 *
+	 * @note Bits of the last word past @p nbits are always cleared.
+	 * Other functions expect them to be clear.
+	 */
+	extern void ubitset_fill(uint64_t *set, size_t nbits, int value);
+
+	/**
+	 * @brief Finds the first set bit in a bitset.
+	 *
+	 * @param set   Target bitset.
+	 * @param nbits Number of bits in @p set.
+	 * @param from  Index of the first bit to look at.
+	 *
+	 * @returns The index of the first bit set at or after @p from, or
+	 * @p nbits if there is none.
+	 */
+	extern size_t ubitset_ffs(const uint64_t *set, size_t nbits, size_t from);
+
+	/**
+	 * @brief Finds the first clear bit in a bitset.
+	 *
+	 * @param set   Target bitset.
+	 * @param nbits Number of bits in @p set.
+	 * @param from  Index of the first bit to look at.
+	 *
+	 * @returns The index of the first bit clear at or after @p from, or
+	 * @p nbits if there is none.
+	 */
+	extern size_t ubitset_ffz(const uint64_t *set, size_t nbits, size_t from);
+
+	/**
+	 * @brief Counts set bits in a range of a bitset.
+	 *
+	 * @param set  Target bitset.
+	 * @param from Index of the first bit in the range.
+	 * @param to   Index of the bit past the range.
+	 *
+	 * @returns The number of bits set in [@p from, @p to).
+	 */
+	extern size_t ubitset_count(const uint64_t *set, size_t from, size_t to);
+
+	/**
+	 * @brief Intersects two bitsets.
+	 *
+	 * @param dst   Target bitset, which may be @p a or @p b.
+	 * @param a     First bitset.
+	 * @param b     Second bitset.
+	 * @param nbits Number of bits in the bitsets.
+	 */
+	extern void ubitset_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits);
+
+	/**
+	 * @brief Unites two bitsets.
+	 *
+	 * @param dst   Target bitset, which may be @p a or @p b.
+	 * @param a     First bitset.
+	 * @param b     Second bitset.
+	 * @param nbits Number of bits in the bitsets.
+	 */
+	extern void ubitset_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits);
+
+	/**
+	 * @brief Computes the symmetric difference of two bitsets.
+	 *
+	 * @param dst   Target bitset, which may be @p a or @p b.
+	 * @param a     First bitset.
+	 * @param b     Second bitset.
+	 * @param nbits Number of bits in the bitsets.
+	 */
+	extern void ubitset_xor(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits);
+
+/**@}*/
+
+/*============================================================================*
+ * Buffered Streams                                                           *
+ *============================================================================*/
+
+/**
+ * @addtogroup ulib-stream Buffered Streams
+ * @ingroup ulib
+ */
+/**@{*/
+
+	/**
+	 * @name Stream Modes
+	 */
+	/**@{*/
+	#define USTREAM_READ  1 /**< Input stream.  */
+	#define USTREAM_WRITE 2 /**< Output stream. */
+	/**@}*/
+
+	/**
+	 * @brief Default size (in bytes) of a stream buffer.
+	 */
+	#define USTREAM_BUFSIZ_DEFAULT 1024
+
+	/**
+	 * @brief Input and output routines of a stream.
+	 *
+	 * @details Both return the number of bytes transferred, zero at the
+	 * end of the input, or a negative error code.
+	 */
+	struct ustream_io
+	{
+		ssize_t (*read)(int fd, void *buf, size_t n);        /**< Reads.  */
+		ssize_t (*write)(int fd, const void *buf, size_t n); /**< Writes. */
+	};
+
+	/**
+	 * @brief Buffered stream on a file descriptor.
+	 *
+	 * @details Input streams read ahead as many bytes as fit in the
+	 * buffer, and output streams write the buffer when it fills up, so
+	 * that each call to the file amortises over many small records.
+	 * Bytes in [pos, len) of the buffer are pending: not yet consumed
+	 * from an input stream, or not yet written from an output one.
+	 *
+	 * @note Streams are not thread-safe.
+	 */
+	struct ustream
+	{
+		int fd;                      /**< File descriptor.                */
+		int mode;                    /**< USTREAM_READ or USTREAM_WRITE.  */
+		int eof;                     /**< End of input reached?           */
+		char *buf;                   /**< Buffer.                         */
+		size_t size;                 /**< Size of the buffer.             */
+		size_t pos;                  /**< First pending byte.             */
+		size_t len;                  /**< End of pending bytes.           */
+		void *allocated;             /**< Buffer allocated by the stream. */
+		const struct ustream_io *io; /**< Input and output routines.      */
+	};
+
+	/**
+	 * @brief Opens a stream on a file descriptor.
+	 *
+	 * @param s    Target stream.
+	 * @param fd   Target file descriptor.
+	 * @param mode Stream mode (USTREAM_READ or USTREAM_WRITE).
+	 * @param buf  Buffer, or NULL to allocate one.
+	 * @param size Size of the buffer, or zero for the default size.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note Streams transfer data with __nanvix_read() and
+	 * __nanvix_write(), unless ustream_setio() says otherwise. The
+	 * kernel has no input path for files yet, and __nanvix_read()
+	 * always fails with -ENOTSUP, thus read streams only work with
+	 * input routines set by ustream_setio().
+	 */
+	extern int ustream_open(struct ustream *s, int fd, int mode, void *buf, size_t size);
+
+	/**
+	 * @brief Sets the input and output routines of a stream.
+	 *
+	 * @param s  Target stream.
+	 * @param io Input and output routines, or NULL for the default ones.
+	 */
+	extern void ustream_setio(struct ustream *s, const struct ustream_io *io);
+
+	/**
+	 * @brief Flushes and closes a stream.
+	 *
+	 * @param s Target stream.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 *
+	 * @note The file descriptor is left open.
+	 */
+	extern int ustream_close(struct ustream *s);
+
+	/**
+	 * @brief Reads from a stream.
+	 *
+	 * @param s   Target stream.
+	 * @param buf Store location for the data.
+	 * @param n   Number of bytes to read.
+	 *
+	 * @returns Upon successful completion, the number of bytes read is
+	 * returned, which is less than @p n only at the end of the input.
+	 * Upon failure, a negative error code is returned instead.
+	 */
+	extern ssize_t ustream_read(struct ustream *s, void *buf, size_t n);
+
+	/**
+	 * @brief Reads a line from a stream.
+	 *
+	 * @param s    Target stream.
+	 * @param line Store location for the line.
+	 * @param size Size of @p line.
+	 *
+	 * @returns Upon successful completion, the length of the line,
+	 * including its newline, is returned. Zero is returned at the end of
+	 * the input. Upon failure, a negative error code is returned
+	 * instead.
+	 *
+	 * @details The line is terminated with a null character. If it does
+	 * not fit in @p line, the first @p size - 1 bytes are returned, and
+	 * the rest is left for the next call.
+	 */
+	extern ssize_t ustream_getline(struct ustream *s, char *line, size_t size);
+
+	/**
+	 * @brief Peeks into the buffer of a stream.
+	 *
+	 * @param s    Target stream.
+	 * @param data Store location for the address of the pending bytes.
+	 * @param n    Minimum number of bytes wanted, at most the size of
+	 * the buffer.
+	 *
+	 * @returns Upon successful completion, the number of pending bytes
+	 * is returned, which is less than @p n only at the end of the input.
+	 * Upon failure, a negative error code is returned instead.
+	 *
+	 * @details The bytes are not copied nor consumed. They remain valid
+	 * until the next call on the stream, other than ustream_consume().
+	 */
+	extern ssize_t ustream_peek(struct ustream *s, const char **data, size_t n);
+
+	/**
+	 * @brief Consumes peeked bytes of a stream.
+	 *
+	 * @param s Target stream.
+	 * @param n Number of bytes to consume.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int ustream_consume(struct ustream *s, size_t n);
+
+	/**
+	 * @brief Writes to a stream.
+	 *
+	 * @param s   Target stream.
+	 * @param buf Data to write.
+	 * @param n   Number of bytes to write.
+	 *
+	 * @returns Upon successful completion, @p n is returned. If the
+	 * stream fails after accepting some bytes, the number of accepted
+	 * bytes is returned. Upon failure, a negative error code is
+	 * returned instead.
+	 */
+	extern ssize_t ustream_write(struct ustream *s, const void *buf, size_t n);
+
+	/**
+	 * @brief Writes pending bytes of a stream.
+	 *
+	 * @param s Target stream.
+	 *
+	 * @returns Upon successful completion, zero is returned. Upon
+	 * failure, a negative error code is returned instead.
+	 */
+	extern int ustream_flush(struct ustream *s);
+
 /**@}*/
 
 #endif /* NANVIX_ULIB_H_ */
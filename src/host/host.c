@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Host backend: implements the kernel calls that the glue layer of
+ * ulibc relies on with plain Linux user space, so that ulibc and its
+ * test driver run as a native process.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nanvix/barelib.h>
+#include <nanvix/sys/dev.h>
+#include <nanvix/sys/noc.h>
+#include <nanvix/sys/perf.h>
+#include <nanvix/sys/thread.h>
+
+/**
+ * @brief System-level entry point.
+ */
+extern void ___start(int argc, const char *argv[], char **envp);
+
+/*============================================================================*
+ * Threads                                                                    *
+ *============================================================================*/
+
+/**
+ * @brief Table of threads.
+ */
+static struct
+{
+	kthread_t tid;           /**< Thread ID (0 if free). */
+	pthread_t thread;        /**< Host thread.           */
+	void *(*start)(void *);  /**< Start routine.         */
+	void *arg;               /**< Argument.              */
+} threads[THREAD_MAX];
+
+/**
+ * @brief Lock of the table of threads.
+ */
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Next thread ID.
+ */
+static kthread_t next_tid = KTHREAD_LEADER_TID + 1;
+
+/**
+ * @brief ID of the calling thread (0 for the leader).
+ */
+static __thread kthread_t self = 0;
+
+/**
+ * @brief Runs a thread.
+ */
+static void *kthread_trampoline(void *arg)
+{
+	int i = (int) (intptr_t) arg;
+
+	self = threads[i].tid;
+
+	return (threads[i].start(threads[i].arg));
+}
+
+/**
+ * The kthread_self() function returns the ID of the calling thread.
+ */
+kthread_t kthread_self(void)
+{
+	return ((self == 0) ? KTHREAD_LEADER_TID : self);
+}
+
+/**
+ * The kthread_create() function creates a thread that runs @p start
+ * with @p arg. Thread IDs are never reused.
+ */
+int kthread_create(kthread_t *tid, void *(*start)(void *), void *arg)
+{
+	int i;
+
+	/* Invalid arguments. */
+	if ((tid == NULL) || (start == NULL))
+		return (-EINVAL);
+
+	pthread_mutex_lock(&threads_lock);
+
+	/* The leader takes one thread. */
+	for (i = 0; i < THREAD_MAX - 1; i++)
+	{
+		if (threads[i].tid == 0)
+			break;
+	}
+
+	/* Too many threads. */
+	if (i == THREAD_MAX - 1)
+		goto error;
+
+	threads[i].tid = next_tid;
+	threads[i].start = start;
+	threads[i].arg = arg;
+
+	if (pthread_create(&threads[i].thread, NULL, kthread_trampoline, (void *) (intptr_t) i) != 0)
+	{
+		threads[i].tid = 0;
+		goto error;
+	}
+
+	*tid = next_tid++;
+
+	pthread_mutex_unlock(&threads_lock);
+
+	return (0);
+
+error:
+	pthread_mutex_unlock(&threads_lock);
+	return (-EAGAIN);
+}
+
+/**
+ * The kthread_join() function waits for the thread @p tid to
+ * terminate, and releases its entry in the table of threads.
+ */
+int kthread_join(kthread_t tid, void **retval)
+{
+	int i;
+
+	pthread_mutex_lock(&threads_lock);
+	for (i = 0; i < THREAD_MAX - 1; i++)
+	{
+		if (threads[i].tid == tid)
+			break;
+	}
+	pthread_mutex_unlock(&threads_lock);
+
+	/* Invalid thread. */
+	if ((i == THREAD_MAX - 1) || (tid == kthread_self()))
+		return (-EINVAL);
+
+	if (pthread_join(threads[i].thread, retval) != 0)
+		return (-EINVAL);
+
+	pthread_mutex_lock(&threads_lock);
+	threads[i].tid = 0;
+	pthread_mutex_unlock(&threads_lock);
+
+	return (0);
+}
+
+/**
+ * The kthread_exit() function terminates the calling thread.
+ */
+NORETURN void kthread_exit(void *retval)
+{
+	pthread_exit(retval);
+}
+
+/**
+ * The kthread_yield() function releases the processor.
+ */
+int kthread_yield(void)
+{
+	return (sched_yield());
+}
+
+/**
+ * The _kexit() function terminates the process.
+ */
+NORETURN void _kexit(int status)
+{
+	_exit(status);
+}
+
+/*============================================================================*
+ * Devices and Clock                                                          *
+ *============================================================================*/
+
+/**
+ * The nanvix_write() function writes @p n bytes of @p buf to the file
+ * @p fd of the host. The console of Nanvix is file 0, so writes to it
+ * go to the standard output of the host instead.
+ */
+ssize_t nanvix_write(int fd, const void *buf, size_t n)
+{
+	ssize_t ret;
+
+	if (fd == 0)
+		fd = STDOUT_FILENO;
+
+	if ((ret = write(fd, buf, n)) < 0)
+		return (-errno);
+
+	return (ret);
+}
+
+/**
+ * The kclock() function reads the monotonic clock of the host, in
+ * nanoseconds.
+ */
+int kclock(uint64_t *buffer)
+{
+	struct timespec ts;
+
+	if (buffer == NULL)
+		return (-EINVAL);
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	*buffer = (uint64_t) ts.tv_sec*1000000000ULL + (uint64_t) ts.tv_nsec;
+
+	return (0);
+}
+
+/**
+ * There is no network-on-chip on the host.
+ */
+void knoc_init(void)
+{
+}
+
+/*============================================================================*
+ * Memory, String and Formatting Routines                                     *
+ *============================================================================*/
+
+/*
+ * Unlike the C library of the host, memory routines of Nanvix accept
+ * NULL pointers when there is nothing to be done, and ulibc relies on
+ * that.
+ */
+void *__memchr(const void *s, int c, size_t n) { return ((n == 0) ? NULL : memchr(s, c, n)); }
+int __memcmp(const void *s1, const void *s2, size_t n) { return ((n == 0) ? 0 : memcmp(s1, s2, n)); }
+void *__memcpy(void *s1, const void *s2, size_t n) { return ((n == 0) ? s1 : memcpy(s1, s2, n)); }
+void *__memmove(void *s1, const void *s2, size_t n) { return ((n == 0) ? s1 : memmove(s1, s2, n)); }
+void *__memset(void *s, int c, size_t n) { return ((n == 0) ? s : memset(s, c, n)); }
+
+char *__strcat(char *s1, const char *s2) { return (strcat(s1, s2)); }
+char *__strchr(const char *s, int c) { return (strchr(s, c)); }
+int __strcmp(const char *s1, const char *s2) { return (strcmp(s1, s2)); }
+char *__strcpy(char *s1, const char *s2) { return (strcpy(s1, s2)); }
+size_t __strcspn(const char *s1, const char *s2) { return (strcspn(s1, s2)); }
+size_t __strlen(const char *s) { return (strlen(s)); }
+char *__strncat(char *s1, const char *s2, size_t n) { return (strncat(s1, s2, n)); }
+int __strncmp(const char *s1, const char *s2, size_t n) { return (strncmp(s1, s2, n)); }
+char *__strncpy(char *s1, const char *s2, size_t n) { return (strncpy(s1, s2, n)); }
+size_t __strnlen(const char *s, size_t maxlen) { return (strnlen(s, maxlen)); }
+char *__strpbrk(const char *s1, const char *s2) { return (strpbrk(s1, s2)); }
+char *__strrchr(const char *s, int c) { return (strrchr(s, c)); }
+size_t __strspn(const char *s1, const char *s2) { return (strspn(s1, s2)); }
+char *__strstr(const char *s1, const char *s2) { return (strstr(s1, s2)); }
+
+int __vsnprintf(char *str, size_t size, const char *fmt, va_list args)
+{
+	return (vsnprintf(str, size, fmt, args));
+}
+
+int __sprintf(char *str, const char *fmt, ...)
+{
+	int ret;
+	va_list args;
+
+	va_start(args, fmt);
+	ret = vsprintf(str, fmt, args);
+	va_end(args);
+
+	return (ret);
+}
+
+/*============================================================================*
+ * Entry Point                                                                *
+ *============================================================================*/
+
+/**
+ * @brief Hands the process over to ulibc.
+ */
+int main(int argc, const char *argv[], char **envp)
+{
+	___start(argc, argv, envp);
+
+	/* Never gets here. */
+	return (0);
+}
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef NANVIX_BARELIB_H_
+#define NANVIX_BARELIB_H_
+
+	#include <posix/stddef.h>
+	#include <posix/stdarg.h>
+
+	/**
+	 * @name Memory, String and Formatting Routines
+	 *
+	 * @brief On the host, these forward to the C library of the host.
+	 */
+	/**@{*/
+	extern void *__memchr(const void *s, int c, size_t n);
+	extern int __memcmp(const void *s1, const void *s2, size_t n);
+	extern void *__memcpy(void *s1, const void *s2, size_t n);
+	extern void *__memmove(void *s1, const void *s2, size_t n);
+	extern void *__memset(void *s, int c, size_t n);
+	extern char *__strcat(char *s1, const char *s2);
+	extern char *__strchr(const char *s, int c);
+	extern int __strcmp(const char *s1, const char *s2);
+	extern char *__strcpy(char *s1, const char *s2);
+	extern size_t __strcspn(const char *s1, const char *s2);
+	extern size_t __strlen(const char *s);
+	extern char *__strncat(char *s1, const char *s2, size_t n);
+	extern int __strncmp(const char *s1, const char *s2, size_t n);
+	extern char *__strncpy(char *s1, const char *s2, size_t n);
+	extern size_t __strnlen(const char *s, size_t maxlen);
+	extern char *__strpbrk(const char *s1, const char *s2);
+	extern char *__strrchr(const char *s, int c);
+	extern size_t __strspn(const char *s1, const char *s2);
+	extern char *__strstr(const char *s1, const char *s2);
+	extern int __vsnprintf(char *str, size_t size, const char *fmt, va_list args);
+	extern int __sprintf(char *str, const char *fmt, ...);
+	/**@}*/
+
+#endif /* NANVIX_BARELIB_H_ */
@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef NANVIX_CONST_H_
+#define NANVIX_CONST_H_
+
+	#include <posix/stddef.h>
+
+	/**
+	 * @name Size Units
+	 */
+	/**@{*/
+	#define KB (1024)    /**< Kilobyte. */
+	#define MB (1024*KB) /**< Megabyte. */
+	/**@}*/
+
+	/**
+	 * @brief Declares a function that does not return.
+	 */
+	#define NORETURN __attribute__((noreturn))
+
+	/**
+	 * @brief Declares an unused variable.
+	 */
+	#define UNUSED(x) ((void)(x))
+
+	/**
+	 * @brief Marks unreachable code.
+	 */
+	#define UNREACHABLE() __builtin_unreachable()
+
+	/**
+	 * @brief Rounds @p x up to a multiple of @p a, a power of two.
+	 */
+	#define TRUNCATE(x, a) (((x) + ((a) - 1)) & ~((a) - 1))
+
+	/**
+	 * @brief Asserts whether @p x lies in [@p a, @p b).
+	 */
+	#define WITHIN(x, a, b) (((x) >= (a)) && ((x) < (b)))
+
+#endif /* NANVIX_CONST_H_ */
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef NANVIX_SYS_THREAD_H_
+#define NANVIX_SYS_THREAD_H_
+
+	#include <nanvix/const.h>
+
+	/**
+	 * @brief Maximum number of threads.
+	 */
+	#define THREAD_MAX 16
+
+	/**
+	 * @brief ID of the leader thread.
+	 */
+	#define KTHREAD_LEADER_TID 1
+
+	/**
+	 * @brief Thread ID.
+	 */
+	typedef int kthread_t;
+
+	/**
+	 * @name Thread Management
+	 *
+	 * @brief On the host, threads are POSIX threads.
+	 */
+	/**@{*/
+	extern kthread_t kthread_self(void);
+	extern int kthread_create(kthread_t *tid, void *(*start)(void *), void *arg);
+	extern NORETURN void kthread_exit(void *retval);
+	extern int kthread_join(kthread_t tid, void **retval);
+	extern int kthread_yield(void);
+	extern NORETURN void _kexit(int status);
+	/**@}*/
+
+#endif /* NANVIX_SYS_THREAD_H_ */
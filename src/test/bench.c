@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Sorts samples in ascending order.
+ *
+ * @param samples Target samples.
+ * @param n       Number of samples.
+ */
+static void bench_sort(uint64_t *samples, int n)
+{
+	for (int i = 1; i < n; i++)
+	{
+		uint64_t x = samples[i];
+		int j;
+
+		for (j = i; (j > 0) && (samples[j - 1] > x); j--)
+			samples[j] = samples[j - 1];
+
+		samples[j] = x;
+	}
+}
+
+/**
+ * The bench_run_n() function runs the @p nbenchs benchmarks in the
+ * array pointed to by @p benchs, timing @p nruns runs of each, and
+ * prints one line per benchmark:
+ *
+ *   [benchmark] group=G name=B ops=N runs=R min=A median=M p99=P
+ *
+ * where N is the number of operations per run, R is the number of
+ * timed runs, and A, M and P are cycles per run.
+ */
+void bench_run_n(const char *group, const struct bench *benchs, int nbenchs, int nruns)
+{
+	uint64_t samples[BENCH_RUNS];
+	uint64_t t0, t1;
+
+	uassert((nruns > 0) && (nruns <= BENCH_RUNS));
+
+	for (int i = 0; i < nbenchs; i++)
+	{
+		const struct bench *b = &benchs[i];
+
+		/* Warm up caches and lazy initialization. */
+		for (int r = 0; r < BENCH_WARMUP; r++)
+			b->fn(b->nops);
+
+		for (int r = 0; r < nruns; r++)
+		{
+			t0 = bench_clock();
+			b->fn(b->nops);
+			t1 = bench_clock();
+			samples[r] = t1 - t0;
+		}
+
+		bench_sort(samples, nruns);
+
+		uprintf("[benchmark] group=%s name=%s ops=%d runs=%d min=%llu median=%llu p99=%llu\n",
+			group, b->name, b->nops, nruns,
+			(unsigned long long) samples[0],
+			(unsigned long long) samples[nruns/2],
+			(unsigned long long) samples[(nruns*99 + 99)/100 - 1]
+		);
+	}
+}
+
+/**
+ * The bench_run() function runs the @p nbenchs benchmarks in the array
+ * pointed to by @p benchs, timing BENCH_RUNS runs of each.
+ */
+void bench_run(const char *group, const struct bench *benchs, int nbenchs)
+{
+	bench_run_n(group, benchs, nbenchs, BENCH_RUNS);
+}
+
+/**
+ * The bench_metric() function prints a measurement other than time of
+ * the benchmark @p name in group @p group, in the same format as
+ * bench_run_n():
+ *
+ *   [benchmark] group=G name=B key=V
+ */
+void bench_metric(const char *group, const char *name, const char *key, uint64_t value)
+{
+	uprintf("[benchmark] group=%s name=%s %s=%llu\n",
+		group, name, key, (unsigned long long) value
+	);
+}
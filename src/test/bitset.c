@@ -0,0 +1,313 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of bits in test bitsets (not a multiple of words).
+ */
+#define NBITS 1000
+
+/**
+ * @brief Number of bits in benchmark bitsets.
+ */
+#define NBENCH (64*1024)
+
+/**
+ * @name Bitsets
+ */
+/**@{*/
+static uint64_t set[UBITSET_WORDS(NBENCH)];
+static uint64_t set2[UBITSET_WORDS(NBENCH)];
+static uint64_t dst[UBITSET_WORDS(NBENCH)];
+static char ref[NBITS];
+static char ref2[NBITS];
+/**@}*/
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile size_t sink;
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks bit counting helpers.
+ */
+static void test_bit_helpers(void)
+{
+	uassert(ubit_popcount64(0) == 0);
+	uassert(ubit_popcount64(~0ULL) == 64);
+	uassert(ubit_popcount64(0x8000000000000001ULL) == 2);
+	uassert(ubit_popcount64(0x00000000ffffffffULL) == 32);
+
+	for (unsigned i = 0; i < 64; i++)
+	{
+		uassert(ubit_ctz64(1ULL << i) == i);
+		uassert(ubit_ctz64(~0ULL << i) == i);
+		uassert(ubit_popcount64(~0ULL << i) == 64 - i);
+	}
+}
+
+/**
+ * @brief Checks a bitset against its reference.
+ */
+static void check_set(const uint64_t *s, const char *r)
+{
+	size_t i, n = 0;
+
+	for (i = 0; i < NBITS; i++)
+		uassert(!ubitset_test(s, i) == !r[i]);
+
+	/* Iteration. */
+	UBITSET_FOREACH(i, s, NBITS)
+	{
+		uassert(r[i]);
+		n++;
+	}
+	uassert(n == ubitset_count(s, 0, NBITS));
+
+	/* Searches and counts from every position. */
+	for (size_t from = 0; from <= NBITS; from++)
+	{
+		size_t s1 = from, z1 = from;
+
+		while ((s1 < NBITS) && !r[s1])
+			s1++;
+		while ((z1 < NBITS) && r[z1])
+			z1++;
+
+		uassert(ubitset_ffs(s, NBITS, from) == s1);
+		uassert(ubitset_ffz(s, NBITS, from) == z1);
+		uassert(ubitset_count(s, from, NBITS) + ubitset_count(s, 0, from) == n);
+	}
+}
+
+/**
+ * @brief Checks bitsets against references.
+ */
+static void test_bitset(void)
+{
+	struct urand_state state;
+
+	urand_seed(&state, 3);
+
+	/* Empty and full sets. */
+	ubitset_fill(set, NBITS, 0);
+	umemset(ref, 0, sizeof(ref));
+	check_set(set, ref);
+	ubitset_fill(set, NBITS, 1);
+	umemset(ref, 1, sizeof(ref));
+	check_set(set, ref);
+	uassert(set[UBITSET_WORDS(NBITS) - 1] >> (NBITS % UBITSET_WORD_BIT) == 0);
+
+	/* Random sets of several densities. */
+	for (uint32_t density = 1; density < 64; density *= 2)
+	{
+		ubitset_fill(set, NBITS, 0);
+		ubitset_fill(set2, NBITS, 1);
+
+		for (size_t i = 0; i < NBITS; i++)
+		{
+			ref[i] = (urand_range(&state, 64) < density);
+			ref2[i] = (urand_range(&state, 64) >= density);
+			if (ref[i])
+				ubitset_set(set, i);
+			if (!ref2[i])
+				ubitset_clear(set2, i);
+		}
+
+		check_set(set, ref);
+		check_set(set2, ref2);
+
+		/* Ranges within and across words. */
+		for (size_t k = 0; k < 200; k++)
+		{
+			size_t from = urand_range(&state, NBITS + 1);
+			size_t to = from + urand_range(&state, NBITS + 1 - from);
+			size_t n = 0;
+
+			for (size_t i = from; i < to; i++)
+				n += ref[i];
+			uassert(ubitset_count(set, from, to) == n);
+		}
+
+		/* Set operations. */
+		ubitset_and(dst, set, set2, NBITS);
+		for (size_t i = 0; i < NBITS; i++)
+			uassert(!ubitset_test(dst, i) == !(ref[i] && ref2[i]));
+		ubitset_or(dst, set, set2, NBITS);
+		for (size_t i = 0; i < NBITS; i++)
+			uassert(!ubitset_test(dst, i) == !(ref[i] || ref2[i]));
+		ubitset_xor(dst, set, set2, NBITS);
+		for (size_t i = 0; i < NBITS; i++)
+			uassert(!ubitset_test(dst, i) == !(!ref[i] != !ref2[i]));
+		ubitset_xor(set, set, set, NBITS);
+		uassert(ubitset_ffs(set, NBITS, 0) == NBITS);
+	}
+
+	/* Empty bitset. */
+	uassert(ubitset_ffs(set, 0, 0) == 0);
+	uassert(ubitset_ffz(set, 0, 0) == 0);
+	uassert(ubitset_count(set, 5, 5) == 0);
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Fills the benchmark bitset.
+ *
+ * @param density Out of 1024 bits, how many are set.
+ */
+static void fill(uint32_t density)
+{
+	struct urand_state state;
+
+	urand_seed(&state, density);
+
+	ubitset_fill(set, NBENCH, 0);
+	for (size_t i = 0; i < NBENCH; i++)
+	{
+		if (urand_range(&state, 1024) < density)
+			ubitset_set(set, i);
+	}
+
+	ubitset_fill(set2, NBENCH, 1);
+}
+
+/**
+ * @brief Iterates over set bits, one bit at a time.
+ */
+static void bench_iterate_bitwise(int nbits)
+{
+	size_t acc = 0;
+
+	for (int i = 0; i < nbits; i++)
+	{
+		if (ubitset_test(set, i))
+			acc += i;
+	}
+
+	sink = acc;
+}
+
+/**
+ * @brief Iterates over set bits, one word at a time.
+ */
+static void bench_iterate(int nbits)
+{
+	size_t acc = 0, i;
+
+	UBITSET_FOREACH(i, set, (size_t) nbits)
+		acc += i;
+
+	sink = acc;
+}
+
+/**
+ * @brief Counts set bits, one bit at a time.
+ */
+static void bench_count_bitwise(int nbits)
+{
+	size_t acc = 0;
+
+	for (int i = 0; i < nbits; i++)
+		acc += ubitset_test(set, i);
+
+	sink = acc;
+}
+
+/**
+ * @brief Counts set bits, one word at a time.
+ */
+static void bench_count(int nbits)
+{
+	sink = ubitset_count(set, 0, nbits);
+}
+
+/**
+ * @brief Finds the first clear bit past the set ones, one bit at a time.
+ */
+static void bench_ffz_bitwise(int nbits)
+{
+	int i;
+
+	for (i = 0; (i < nbits) && ubitset_test(set2, i); i++)
+		/* noop */;
+
+	sink = i;
+}
+
+/**
+ * @brief Finds the first clear bit past the set ones, one word at a time.
+ */
+static void bench_ffz(int nbits)
+{
+	sink = ubitset_ffz(set2, nbits, 0);
+}
+
+/**
+ * @brief Intersects bitsets.
+ */
+static void bench_and(int nbits)
+{
+	ubitset_and(dst, set, set2, nbits);
+	sink = dst[0];
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "iterate-bitwise", bench_iterate_bitwise, NBENCH },
+	{ "UBITSET_FOREACH", bench_iterate,         NBENCH },
+	{ "count-bitwise",   bench_count_bitwise,   NBENCH },
+	{ "ubitset_count",   bench_count,           NBENCH },
+	{ "ffz-bitwise",     bench_ffz_bitwise,     NBENCH },
+	{ "ubitset_ffz",     bench_ffz,             NBENCH },
+	{ "ubitset_and",     bench_and,             NBENCH },
+};
+
+/**
+ * @brief Benchmarks bitsets.
+ */
+void benchmark_bitset(void)
+{
+	test_bit_helpers();
+	test_bitset();
+
+	/* About one bit in a hundred. */
+	fill(10);
+	bench_run("bitset-sparse", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	/* About nine bits in ten. */
+	fill(920);
+	bench_run("bitset-dense", benchs, sizeof(benchs)/sizeof(benchs[0]));
+}
@@ -0,0 +1,250 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of fibers in the scheduling test.
+ */
+#define NFIBERS 3
+
+/**
+ * @brief Number of steps run by each fiber in the scheduling test.
+ */
+#define NSTEPS 4
+
+/**
+ * @brief Number of context switches in a benchmark run.
+ */
+#define NSWITCHES (NOPERATIONS/100)
+
+/**
+ * @brief Number of handoffs between threads in a benchmark run.
+ */
+#define NHANDOFFS (NOPERATIONS/100)
+
+/**
+ * @brief Order in which fibers ran.
+ */
+static int trace[NFIBERS*NSTEPS];
+
+/**
+ * @brief Number of entries in the trace.
+ */
+static int ntrace;
+
+/**
+ * @brief Thread whose turn it is.
+ */
+static int turn;
+
+/**
+ * @brief Number of handoffs in the current benchmark run.
+ */
+static int nhandoffs;
+
+/**
+ * @brief Records steps of a fiber.
+ */
+static void *stepper(void *arg)
+{
+	for (int i = 0; i < NSTEPS; i++)
+	{
+		trace[ntrace++] = (int) (intptr_t) arg;
+		ufiber_yield();
+	}
+
+	return (arg);
+}
+
+/**
+ * @brief Formats a floating-point number.
+ */
+static void *formatter(void *arg)
+{
+	char buf[32];
+
+	((void) arg);
+
+	usnprintf(buf, sizeof(buf), "%g", 0.1 + 0.2);
+	uassert(ustrcmp(buf, "0.3") == 0);
+
+	ufiber_exit(ufiber_self());
+
+	return (NULL);
+}
+
+/**
+ * @brief Does nothing.
+ */
+static void *idle(void *arg)
+{
+	return (arg);
+}
+
+/**
+ * @brief Checks fibers.
+ */
+static void test_fiber_api(void)
+{
+	struct ufiber *fibers[UFIBER_MAX + 1];
+	void *ret;
+
+	uassert(ufiber_self() == NULL);
+	uassert(ufiber_join(NULL, NULL) == -EINVAL);
+	uassert(ufiber_create(&fibers[0], NULL, NULL) == -EINVAL);
+
+	/* Nothing else to run. */
+	ufiber_yield();
+
+	/* Fibers take turns in creation order. */
+	ntrace = 0;
+	for (intptr_t i = 0; i < NFIBERS; i++)
+		uassert(ufiber_create(&fibers[i], stepper, (void *) i) == 0);
+	for (intptr_t i = 0; i < NFIBERS; i++)
+	{
+		uassert(ufiber_join(fibers[i], &ret) == 0);
+		uassert(ret == (void *) i);
+	}
+	uassert(ntrace == NFIBERS*NSTEPS);
+	for (int i = 0; i < NFIBERS*NSTEPS; i++)
+		uassert(trace[i] == (i % NFIBERS));
+	uassert(ufiber_self() == NULL);
+
+	/* Fibers may exit early and call into the library. */
+	uassert(ufiber_create(&fibers[0], formatter, NULL) == 0);
+	uassert(ufiber_self() != NULL);
+	uassert(ufiber_join(ufiber_self(), NULL) == -EINVAL);
+	uassert(ufiber_join(fibers[0], &ret) == 0);
+	uassert(ret == fibers[0]);
+
+	/* Stacks are pooled and recycled. */
+	for (int round = 0; round < 2; round++)
+	{
+		for (int i = 0; i < UFIBER_MAX; i++)
+			uassert(ufiber_create(&fibers[i], idle, NULL) == 0);
+		uassert(ufiber_create(&fibers[UFIBER_MAX], idle, NULL) == -EAGAIN);
+		for (int i = UFIBER_MAX - 1; i >= 0; i--)
+			uassert(ufiber_join(fibers[i], NULL) == 0);
+	}
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Yields repeatedly.
+ *
+ * @param arg Number of yields.
+ */
+static void *yielder(void *arg)
+{
+	for (intptr_t i = 0; i < (intptr_t) arg; i++)
+		ufiber_yield();
+
+	return (NULL);
+}
+
+/**
+ * @brief Switches contexts between two fibers.
+ *
+ * @param nops Number of context switches.
+ */
+static void bench_yield(int nops)
+{
+	struct ufiber *f1, *f2;
+
+	uassert(ufiber_create(&f1, yielder, (void *) (intptr_t) (nops/2)) == 0);
+	uassert(ufiber_create(&f2, yielder, (void *) (intptr_t) (nops/2)) == 0);
+	uassert(ufiber_join(f1, NULL) == 0);
+	uassert(ufiber_join(f2, NULL) == 0);
+}
+
+/**
+ * @brief Hands the turn over to the other thread repeatedly.
+ *
+ * @param arg Turn of the calling thread.
+ */
+static void *pingpong(void *arg)
+{
+	int me = (int) (intptr_t) arg;
+
+	for (int i = 0; i < nhandoffs/2; i++)
+	{
+		while (__atomic_load_n(&turn, __ATOMIC_ACQUIRE) != me)
+			kthread_yield();
+
+		__atomic_store_n(&turn, !me, __ATOMIC_RELEASE);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Hands the turn over between two threads.
+ *
+ * @param nops Number of handoffs.
+ */
+static void bench_handoff(int nops)
+{
+	kthread_t tid;
+
+	turn = 0;
+	nhandoffs = nops;
+
+	uassert(uthread_create(&tid, pingpong, (void *) 1) == 0);
+	pingpong((void *) 0);
+	uassert(kthread_join(tid, NULL) == 0);
+}
+
+/**
+ * @brief Registered benchmarks of fibers.
+ */
+static const struct bench benchs_fiber[] = {
+	{ "ufiber_yield", bench_yield, NSWITCHES },
+};
+
+/**
+ * @brief Registered benchmarks of threads.
+ */
+static const struct bench benchs_thread[] = {
+	{ "kthread-handoff", bench_handoff, NHANDOFFS },
+};
+
+/**
+ * @brief Benchmarks fibers.
+ */
+void benchmark_fiber(void)
+{
+	test_fiber_api();
+
+	bench_run("fiber", benchs_fiber, sizeof(benchs_fiber)/sizeof(benchs_fiber[0]));
+	bench_run_n("fiber", benchs_thread, sizeof(benchs_thread)/sizeof(benchs_thread[0]), BENCH_RUNS_THREADS);
+}
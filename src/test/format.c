@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Sink that keeps the compiler from discarding conversions.
+ */
+static volatile size_t sink;
+
+/**
+ * @brief Number of doubles converted by floating-point benchmarks.
+ */
+#define NDOUBLES 256
+
+/**
+ * @brief Doubles converted by floating-point benchmarks.
+ */
+static double doubles[NDOUBLES];
+
+/**
+ * @brief Asserts that a conversion matches the expected string.
+ */
+#define check_format(str, expected) \
+	uassert(ustrcmp((str), (expected)) == 0)
+
+/**
+ * @brief Checks integer conversions.
+ */
+static void test_format_api(void)
+{
+	char buf[64];
+
+	uutoa(0, buf);
+	check_format(buf, "0");
+	uutoa(4294967295ULL, buf);
+	check_format(buf, "4294967295");
+	uutoa(18446744073709551615ULL, buf);
+	check_format(buf, "18446744073709551615");
+	uitoa(-9223372036854775807LL - 1, buf);
+	check_format(buf, "-9223372036854775808");
+	uxtoa(0xdeadbeefcafeULL, buf, 0);
+	check_format(buf, "deadbeefcafe");
+	uassert(uxtoa(0, buf, 0) == 1);
+	check_format(buf, "0");
+	uassert(uxtoa(0x10, buf, 0) == 2);
+	check_format(buf, "10");
+	uassert(uxtoa(0xffffffffULL, buf, 1) == 8);
+	check_format(buf, "FFFFFFFF");
+	uassert(uxtoa(0x100000000ULL, buf, 0) == 9);
+	check_format(buf, "100000000");
+	uassert(uxtoa(0xffffffffffffffffULL, buf, 0) == 16);
+	check_format(buf, "ffffffffffffffff");
+
+	usnprintf(buf, sizeof(buf), "%5d|%-5d|%05d|%+d", 42, 42, 42, 42);
+	check_format(buf, "   42|42   |00042|+42");
+	usnprintf(buf, sizeof(buf), "%#x|%#o|%.3u|%llu", 255, 8, 7U, 1ULL << 40);
+	check_format(buf, "0xff|010|007|1099511627776");
+	uassert(usnprintf(buf, 4, "%d", 123456) == 6);
+	check_format(buf, "123");
+}
+
+/**
+ * @brief Checks floating-point conversions.
+ */
+static void test_format_float_api(void)
+{
+	char buf[64];
+
+	udtoa(0.1, buf);
+	check_format(buf, "0.1");
+	udtoa(-1.5e-7, buf);
+	check_format(buf, "-1.5e-07");
+	udtoa(1e21, buf);
+	check_format(buf, "1e+21");
+	udtoa(5e-324, buf);
+	check_format(buf, "5e-324");
+	udtoa(1.7976931348623157e308, buf);
+	check_format(buf, "1.7976931348623157e+308");
+	udtoa(0.1 + 0.2, buf);
+	check_format(buf, "0.30000000000000004");
+
+	usnprintf(buf, sizeof(buf), "%f|%.2f|%.0f|%.0f", 1.5, 2.675, 0.5, 1.5);
+	check_format(buf, "1.500000|2.67|0|2");
+	usnprintf(buf, sizeof(buf), "%e|%.3E|%g|%g", 12345.678, -0.000123, 1e-5, 100000.0);
+	check_format(buf, "1.234568e+04|-1.230E-04|1e-05|100000");
+	usnprintf(buf, sizeof(buf), "%+08.2f|%-7.1f|%#g|%.20f", 3.14159, -2.0, 1.0, 0.1);
+	check_format(buf, "+0003.14|-2.0   |1.00000|0.10000000000000000555");
+}
+
+/**
+ * @brief Buffers output and returns.
+ */
+static void *buffered(void *arg)
+{
+	((void) arg);
+
+	/* Pending output is flushed when the thread returns. */
+	uassert(usetvbuf(UBUF_FULL, UBUFSIZ, 0) == 0);
+	uassert(uprintf("%s", "") == 0);
+
+	return (NULL);
+}
+
+/**
+ * @brief Checks output buffers.
+ */
+static void test_format_buffer_api(void)
+{
+	kthread_t tid;
+
+	uassert(usetvbuf(-1, UBUFSIZ, 1) == -EINVAL);
+	uassert(usetvbuf(UBUF_FULL, 0, 0) == -EINVAL);
+	uassert(usetvbuf(UBUF_FULL, UBUFSIZ + 1, 0) == -EINVAL);
+	uassert(usetvbuf(UBUF_LINE, UBUFSIZ, 0) == -EINVAL);
+
+	/* Threads that return give their buffer back. */
+	for (int i = 0; i < 2*THREAD_MAX; i++)
+	{
+		uassert(uthread_create(&tid, buffered, NULL) == 0);
+		uassert(kthread_join(tid, NULL) == 0);
+	}
+}
+
+/**
+ * @brief Initializes doubles converted by floating-point benchmarks.
+ *
+ * @details Numbers are built from random bits, so that they span the
+ * whole range of exponents and have full-length shortest digits.
+ */
+static void doubles_init(void)
+{
+	uint64_t bits;
+
+	bits = 0x9e3779b97f4a7c15ULL;
+	for (int i = 0; i < NDOUBLES; i++)
+	{
+		/* Skip infinities and not a number. */
+		do
+		{
+			bits ^= bits << 13;
+			bits ^= bits >> 7;
+			bits ^= bits << 17;
+		} while (((bits >> 52) & 0x7ff) == 0x7ff);
+
+		umemcpy(&doubles[i], &bits, sizeof(double));
+	}
+}
+
+/**
+ * @brief Number of conversions in a benchmark run.
+ */
+#define NOPS 1000
+
+/**
+ * @brief Defines a benchmark of a conversion routine.
+ *
+ * @param fn   Benchmark function.
+ * @param conv Conversion (receives the operation index and a buffer).
+ */
+#define BENCH_CONVERSION(fn, conv)               \
+	static void fn(int nops)                     \
+	{                                            \
+		size_t len = 0;                          \
+		char buf[64];                            \
+                                                 \
+		for (unsigned i = 0; i < (unsigned) nops; i++) \
+			len += conv;                         \
+                                                 \
+		sink = len;                              \
+	}
+
+/**
+ * @name Conversion Benchmarks
+ */
+/**@{*/
+BENCH_CONVERSION(bench_uutoa32, uutoa(i*2654435761U, buf))
+BENCH_CONVERSION(bench_uutoa64, uutoa(i*11400714819323198485ULL, buf))
+BENCH_CONVERSION(bench_uitoa64, uitoa((int64_t) (i*11400714819323198485ULL), buf))
+BENCH_CONVERSION(bench_uxtoa64, uxtoa(i*11400714819323198485ULL, buf, 0))
+BENCH_CONVERSION(bench_usprintf, (size_t) usprintf(buf, "%u", i*2654435761U))
+BENCH_CONVERSION(bench___sprintf, (size_t) __sprintf(buf, "%d", (int) (i*2654435761U)))
+BENCH_CONVERSION(bench_udtoa, udtoa(doubles[i % NDOUBLES], buf))
+BENCH_CONVERSION(bench_usprintf_g, (size_t) usprintf(buf, "%g", doubles[i % NDOUBLES]))
+BENCH_CONVERSION(bench_usprintf_e, (size_t) usprintf(buf, "%e", doubles[i % NDOUBLES]))
+BENCH_CONVERSION(bench_usprintf_f, (size_t) usprintf(buf, "%.3f", (double) (i*2654435761U)/1024))
+/**@}*/
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "uutoa32",    bench_uutoa32,    NOPS },
+	{ "uutoa64",    bench_uutoa64,    NOPS },
+	{ "uitoa64",    bench_uitoa64,    NOPS },
+	{ "uxtoa64",    bench_uxtoa64,    NOPS },
+	{ "usprintf",   bench_usprintf,   NOPS },
+	{ "__sprintf",  bench___sprintf,  NOPS },
+	{ "udtoa",      bench_udtoa,      NOPS },
+	{ "usprintf-g", bench_usprintf_g, NOPS },
+	{ "usprintf-e", bench_usprintf_e, NOPS },
+	{ "usprintf-f", bench_usprintf_f, NOPS },
+};
+
+/**
+ * @brief Benchmarks integer and floating-point formatting.
+ */
+void benchmark_format(void)
+{
+	test_format_api();
+	test_format_float_api();
+	test_format_buffer_api();
+	doubles_init();
+
+	bench_run("format", benchs, sizeof(benchs)/sizeof(benchs[0]));
+}
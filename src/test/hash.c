@@ -0,0 +1,297 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Size of the test buffer (in bytes).
+ */
+#define NBYTES 4096
+
+/**
+ * @brief Test buffer.
+ */
+static union
+{
+	uint64_t align;              /**< Alignment. */
+	unsigned char data[NBYTES];  /**< Bytes.     */
+} buf;
+
+/**
+ * @brief Byte-at-a-time CRC-32 table.
+ */
+static uint32_t crc_table[256];
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile uint64_t sink;
+
+/**
+ * @brief Fills the test buffer.
+ */
+static void fill(void)
+{
+	for (int i = 0; i < NBYTES; i++)
+		buf.data[i] = (unsigned char) (i*131 + 7);
+}
+
+/**
+ * @brief Computes a CRC bit by bit.
+ *
+ * @param poly Reflected polynomial.
+ * @param p    Target data.
+ * @param len  Number of bytes in @p p.
+ */
+static uint32_t crc_bitwise(uint32_t poly, const unsigned char *p, size_t len)
+{
+	uint32_t crc = ~0U;
+
+	while (len-- > 0)
+	{
+		crc ^= *p++;
+		for (int k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+	}
+
+	return (~crc);
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks 64-bit hashes against reference values.
+ */
+static void test_hash_vectors(void)
+{
+	static const struct
+	{
+		const char *str;
+		uint64_t seed;
+		uint64_t hash;
+	} vectors[] = {
+		{ "",    0, 0xef46db3751d8e999ULL },
+		{ "a",   0, 0xd24ec4f1a98c6e5bULL },
+		{ "abc", 0, 0x44bc2cf5ad770999ULL },
+		{ "abc", 1, 0xbea9ca8199328908ULL },
+		{ "Nobody inspects the spammish repetition", 0, 0xfbcea83c8a378bf1ULL },
+		{ "The quick brown fox jumps over the lazy dog", 0, 0x0b242d361fda71bcULL },
+	};
+	uint64_t sum = 0;
+
+	for (int i = 0; i < (int) (sizeof(vectors)/sizeof(vectors[0])); i++)
+	{
+		const char *str = vectors[i].str;
+		uassert(uhash64(str, ustrlen(str), vectors[i].seed) == vectors[i].hash);
+	}
+
+	/* All tail lengths, with and without stripes. */
+	for (size_t n = 0; n <= 300; n++)
+		sum += uhash64(buf.data, n, n);
+	uassert(sum == 0x6607a9e9ba3db7edULL);
+	uassert(uhash64(buf.data, 300, 0) == 0xc68e7ef39b5ca10eULL);
+
+	/* Unaligned data. */
+	for (int off = 1; off < 8; off++)
+	{
+		umemmove(buf.data + off, buf.data, 300);
+		uassert(uhash64(buf.data + off, 300, 0) == 0xc68e7ef39b5ca10eULL);
+		fill();
+	}
+}
+
+/**
+ * @brief Checks incremental 64-bit hashes.
+ */
+static void test_hash_incremental(void)
+{
+	struct uhash64_state state;
+
+	for (size_t chunk = 1; chunk <= 2*UHASH64_STRIPE + 1; chunk++)
+	{
+		size_t len = 0;
+
+		uhash64_init(&state, chunk);
+		uassert(uhash64_final(&state) == uhash64(buf.data, 0, chunk));
+
+		while (len < 300)
+		{
+			size_t n = (len + chunk > 300) ? 300 - len : chunk;
+
+			uhash64_update(&state, buf.data + len, n);
+			len += n;
+
+			uassert(uhash64_final(&state) == uhash64(buf.data, len, chunk));
+		}
+	}
+}
+
+/**
+ * @brief Checks CRCs.
+ */
+static void test_crc(void)
+{
+	const char *check = "123456789";
+
+	/* Check values. */
+	uassert(ucrc32(0, check, 9) == 0xcbf43926U);
+	uassert(ucrc32c(0, check, 9) == 0xe3069283U);
+	uassert(ucrc32(0, check, 0) == 0);
+	uassert(ucrc32c(0, NULL, 0) == 0);
+
+	/* All alignments and lengths against bitwise CRCs. */
+	for (int off = 0; off < 8; off++)
+	{
+		for (size_t n = 0; n <= 100; n++)
+		{
+			uassert(ucrc32(0, buf.data + off, n) ==
+				crc_bitwise(0xedb88320U, buf.data + off, n));
+			uassert(ucrc32c(0, buf.data + off, n) ==
+				crc_bitwise(0x82f63b78U, buf.data + off, n));
+		}
+	}
+
+	/* Incremental updates. */
+	for (size_t k = 0; k <= 300; k += 7)
+	{
+		uassert(ucrc32(ucrc32(0, buf.data, k), buf.data + k, 300 - k) ==
+			ucrc32(0, buf.data, 300));
+		uassert(ucrc32c(ucrc32c(0, buf.data, k), buf.data + k, 300 - k) ==
+			ucrc32c(0, buf.data, 300));
+	}
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Hashes bytes with FNV-1a, one byte at a time.
+ */
+static void bench_fnv1a(int nbytes)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	for (int i = 0; i < nbytes; i++)
+	{
+		h ^= buf.data[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	sink = h;
+}
+
+/**
+ * @brief Hashes bytes with uhash64().
+ */
+static void bench_uhash64(int nbytes)
+{
+	sink = uhash64(buf.data, nbytes, 0);
+}
+
+/**
+ * @brief Hashes bytes with an incremental hash, in 64-byte chunks.
+ */
+static void bench_uhash64_update(int nbytes)
+{
+	struct uhash64_state state;
+
+	uhash64_init(&state, 0);
+	for (int i = 0; i < nbytes; i += 64)
+		uhash64_update(&state, buf.data + i, (nbytes - i < 64) ? nbytes - i : 64);
+
+	sink = uhash64_final(&state);
+}
+
+/**
+ * @brief Computes a CRC-32 one byte at a time.
+ */
+static void bench_crc32_bytewise(int nbytes)
+{
+	uint32_t crc = ~0U;
+
+	for (int i = 0; i < nbytes; i++)
+		crc = crc_table[(crc ^ buf.data[i]) & 0xff] ^ (crc >> 8);
+
+	sink = ~crc;
+}
+
+/**
+ * @brief Computes a CRC-32 with slicing-by-8.
+ */
+static void bench_ucrc32(int nbytes)
+{
+	sink = ucrc32(0, buf.data, nbytes);
+}
+
+/**
+ * @brief Computes a CRC-32C with slicing-by-8.
+ */
+static void bench_ucrc32c(int nbytes)
+{
+	sink = ucrc32c(0, buf.data, nbytes);
+}
+
+/**
+ * @brief Benchmarks hashing and checksums.
+ */
+void benchmark_hash(void)
+{
+	static const int sizes[] = { 16, 64, 256, NBYTES };
+
+	fill();
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t c = i;
+		for (int k = 0; k < 8; k++)
+			c = (c >> 1) ^ ((c & 1) ? 0xedb88320U : 0);
+		crc_table[i] = c;
+	}
+
+	test_hash_vectors();
+	test_hash_incremental();
+	test_crc();
+
+	for (int s = 0; s < (int) (sizeof(sizes)/sizeof(sizes[0])); s++)
+	{
+		char group[16];
+		int n = sizes[s];
+		struct bench benchs[] = {
+			{ "fnv1a",          bench_fnv1a,          n },
+			{ "uhash64",        bench_uhash64,        n },
+			{ "uhash64_update", bench_uhash64_update, n },
+			{ "crc32-bytewise", bench_crc32_bytewise, n },
+			{ "ucrc32",         bench_ucrc32,         n },
+			{ "ucrc32c",        bench_ucrc32c,        n },
+		};
+
+		usnprintf(group, sizeof(group), "hash-%d", n);
+		bench_run(group, benchs, sizeof(benchs)/sizeof(benchs[0]));
+	}
+}
@@ -0,0 +1,534 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Size of the key universe of tests.
+ */
+#define NKEYS 1024
+
+/**
+ * @brief Number of keys in string tests.
+ */
+#define NNAMES (NKEYS/4)
+
+/**
+ * @brief Number of random operations in tests.
+ */
+#define NOPS 20000
+
+/**
+ * @brief Number of slots in benchmark tables.
+ */
+#define NSLOTS 4096
+
+/**
+ * @brief Size of the memory arena (in bytes).
+ */
+#define ARENA_SIZE (96*1024)
+
+/**
+ * @brief Memory arena.
+ */
+static struct
+{
+	uint64_t data[ARENA_SIZE/sizeof(uint64_t)]; /**< Storage.          */
+	size_t used;                                /**< Bytes handed out. */
+} arena;
+
+/**
+ * @name Keys and Values
+ */
+/**@{*/
+static uint32_t keys[NSLOTS];
+static uint32_t misses[NSLOTS];
+static uint32_t vals[NKEYS];
+static char present[NKEYS];
+static char names[NNAMES][8];
+/**@}*/
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile uintptr_t sink;
+
+/**
+ * @brief Hashes every key to the same slot.
+ */
+#define HASH_ZERO(k) ((void) (k), 0U)
+
+/**
+ * @brief Instance with colliding keys.
+ */
+UHMAP_STRUCT(zero, uint32_t, uint32_t);
+UHMAP_DEFINE(static, zero, uint32_t, uint32_t, HASH_ZERO, UHMAP_EQ)
+
+/**
+ * @brief Instance with helpers in reach of benchmarks.
+ */
+UHMAP_STRUCT(test, uint32_t, uint32_t);
+UHMAP_DEFINE(static, test, uint32_t, uint32_t, UHMAP_HASH_U32, UHMAP_EQ)
+
+/**
+ * @brief Allocates memory from the arena.
+ */
+static void *arena_alloc(void *ctx, size_t size)
+{
+	void *ptr;
+
+	((void) ctx);
+
+	size = (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+	if (size > ARENA_SIZE - arena.used)
+		return (NULL);
+
+	ptr = (char *) arena.data + arena.used;
+	arena.used += size;
+
+	return (ptr);
+}
+
+/**
+ * @brief Arena allocator, which releases memory as a whole.
+ */
+static const struct uhmap_allocator allocator = {
+	arena_alloc, NULL, &arena
+};
+
+/**
+ * @brief Returns the number of bytes in use in the heap.
+ */
+static size_t heap_used(void)
+{
+	struct umalloc_stats stats;
+
+	uassert(umalloc_check(&stats) == 0);
+
+	return (stats.used_size);
+}
+
+/**
+ * @brief Fills keys and keys that are not in tables.
+ *
+ * @param n Number of keys.
+ */
+static void fill(int n)
+{
+	struct urand_state state;
+
+	urand_seed(&state, 7);
+
+	for (int i = 0; i < n; i++)
+	{
+		keys[i] = urand32(&state) | 1;
+		misses[i] = keys[i] & ~1U;
+	}
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks that a map matches the reference.
+ */
+static void check_map(struct uhmap_u32 *map)
+{
+	struct uhmap_u32_entry *e;
+	size_t iter = 0, count = 0;
+
+	for (uint32_t k = 0; k < NKEYS; k++)
+	{
+		uint32_t *v = uhmap_u32_get(map, k);
+
+		if (present[k])
+			uassert((v != NULL) && (*v == vals[k]));
+		else
+			uassert(v == NULL);
+	}
+
+	while ((e = uhmap_u32_next(map, &iter)) != NULL)
+	{
+		uassert((e->key < NKEYS) && present[e->key]);
+		uassert(e->val == vals[e->key]);
+		count++;
+	}
+
+	uassert(count == map->count);
+}
+
+/**
+ * @brief Checks random updates against a reference.
+ */
+static void test_hmap_random(void)
+{
+	struct uhmap_u32 map;
+	struct urand_state state;
+	size_t used = heap_used();
+	size_t count = 0;
+
+	urand_seed(&state, 1);
+	umemset(present, 0, sizeof(present));
+
+	uassert(uhmap_u32_init(&map, 0, NULL) == 0);
+
+	for (int i = 0; i < NOPS; i++)
+	{
+		uint32_t k = urand_range(&state, NKEYS);
+		uint32_t v;
+
+		/* Inserts first prevail, and then removals do. */
+		if (urand_range(&state, NOPS) >= (uint32_t) i)
+		{
+			vals[k] = urand32(&state);
+			uassert(uhmap_u32_put(&map, k, vals[k]) == 0);
+			count += !present[k];
+			present[k] = 1;
+		}
+		else if (present[k])
+		{
+			uassert(uhmap_u32_remove(&map, k, &v) == 0);
+			uassert(v == vals[k]);
+			present[k] = 0;
+			count--;
+		}
+		else
+			uassert(uhmap_u32_remove(&map, k, &v) == -ENOENT);
+
+		uassert(map.count == count);
+
+		if ((i % 1000) == 0)
+			check_map(&map);
+	}
+
+	check_map(&map);
+
+	/* Remove everything. */
+	for (uint32_t k = 0; k < NKEYS; k++)
+	{
+		if (present[k])
+		{
+			uassert(uhmap_u32_remove(&map, k, NULL) == 0);
+			present[k] = 0;
+		}
+	}
+	check_map(&map);
+	uassert(map.count == 0);
+
+	uhmap_u32_destroy(&map);
+	uassert(heap_used() == used);
+}
+
+/**
+ * @brief Checks lookups while the map is being resized.
+ */
+static void test_hmap_resize(void)
+{
+	struct uhmap_u32 map;
+
+	umemset(present, 0, sizeof(present));
+	uassert(uhmap_u32_init(&map, 0, NULL) == 0);
+
+	for (uint32_t k = 0; k < NKEYS; k++)
+	{
+		vals[k] = ~k;
+		present[k] = 1;
+		uassert(uhmap_u32_put(&map, k, vals[k]) == 0);
+
+		/* Entries are split across both tables. */
+		if (map.old.entries != NULL)
+		{
+			uassert(map.cursor <= map.old.mask);
+			uassert(uhmap_u32_get(&map, 0) != NULL);
+		}
+	}
+	check_map(&map);
+
+	uhmap_u32_destroy(&map);
+}
+
+/**
+ * @brief Checks the arena allocator.
+ */
+static void test_hmap_arena(void)
+{
+	struct uhmap_u64 map;
+	size_t used = heap_used();
+
+	arena.used = 0;
+
+	uassert(uhmap_u64_init(&map, 16, &allocator) == 0);
+	for (uint64_t k = 0; k < NKEYS; k++)
+		uassert(uhmap_u64_put(&map, k << 32, k) == 0);
+	for (uint64_t k = 0; k < NKEYS; k++)
+	{
+		uint64_t *v = uhmap_u64_get(&map, k << 32);
+		uassert((v != NULL) && (*v == k));
+		uassert(uhmap_u64_get(&map, k) == ((k == 0) ? v : NULL));
+	}
+	uhmap_u64_destroy(&map);
+
+	uassert(arena.used > 0);
+	uassert(heap_used() == used);
+}
+
+/**
+ * @brief Checks string and pointer keys.
+ */
+static void test_hmap_str(void)
+{
+	struct uhmap_str map;
+	struct uhmap_ptr pmap;
+	char name[8];
+
+	uassert(uhmap_str_init(&map, NNAMES, NULL) == 0);
+	uassert(uhmap_ptr_init(&pmap, 0, NULL) == 0);
+
+	for (int i = 0; i < NNAMES; i++)
+	{
+		usnprintf(names[i], sizeof(names[i]), "n%d", i);
+		uassert(uhmap_str_put(&map, names[i], &names[i]) == 0);
+		uassert(uhmap_ptr_put(&pmap, &names[i], names[i]) == 0);
+	}
+
+	/* Keys are compared by contents. */
+	for (int i = 0; i < NNAMES; i++)
+	{
+		void **v;
+
+		usnprintf(name, sizeof(name), "n%d", i);
+		uassert(((v = uhmap_str_get(&map, name)) != NULL) && (*v == &names[i]));
+		uassert(((v = uhmap_ptr_get(&pmap, &names[i])) != NULL) && (*v == names[i]));
+	}
+	uassert(uhmap_str_get(&map, "x") == NULL);
+	uassert(uhmap_ptr_get(&pmap, name) == NULL);
+
+	uhmap_ptr_destroy(&pmap);
+	uhmap_str_destroy(&map);
+}
+
+/**
+ * @brief Checks probe distance overflows.
+ */
+static void test_hmap_overflow(void)
+{
+	struct uhmap_zero map;
+	size_t used = heap_used();
+
+	uassert(uhmap_zero_init(&map, 0, NULL) == 0);
+
+	/* All keys share a cluster. */
+	for (uint32_t k = 0; k < UHMAP_DIST_MAX; k++)
+		uassert(uhmap_zero_put(&map, k, k) == 0);
+
+	/* Larger tables do not help, and the map stays intact. */
+	uassert(uhmap_zero_put(&map, UHMAP_DIST_MAX, 0) == -ENOMEM);
+	uassert(map.count == UHMAP_DIST_MAX);
+	for (uint32_t k = 0; k < UHMAP_DIST_MAX; k++)
+	{
+		uint32_t *v = uhmap_zero_get(&map, k);
+		uassert((v != NULL) && (*v == k));
+	}
+	uassert(uhmap_zero_get(&map, UHMAP_DIST_MAX) == NULL);
+
+	/* Removals make room again. */
+	uassert(uhmap_zero_remove(&map, 0, NULL) == 0);
+	uassert(uhmap_zero_put(&map, UHMAP_DIST_MAX, 0) == 0);
+
+	uhmap_zero_destroy(&map);
+	uassert(heap_used() == used);
+
+	/* Invalid arguments. */
+	uassert(uhmap_zero_init(NULL, 0, NULL) == -EINVAL);
+	uassert(uhmap_zero_init(&map, UHMAP_SLOTS_MAX, NULL) == -EINVAL);
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Benchmark map.
+ */
+static struct uhmap_u32 map;
+
+/**
+ * @brief Initializes the benchmark map in the arena.
+ *
+ * @param capacity Capacity of the map.
+ */
+static void map_init(size_t capacity)
+{
+	arena.used = 0;
+	uassert(uhmap_u32_init(&map, capacity, &allocator) == 0);
+}
+
+/**
+ * @brief Inserts keys into a table of fixed size.
+ */
+static void bench_put(int nops)
+{
+	map_init(UHMAP_LOAD_MAX(NSLOTS));
+
+	for (int i = 0; i < nops; i++)
+		uhmap_u32_put(&map, keys[i], i);
+
+	sink = map.count;
+}
+
+/**
+ * @brief Inserts keys into a table that grows.
+ */
+static void bench_put_grow(int nops)
+{
+	map_init(0);
+
+	for (int i = 0; i < nops; i++)
+		uhmap_u32_put(&map, keys[i], i);
+
+	sink = map.count;
+}
+
+/**
+ * @brief Looks up keys that are in the table.
+ */
+static void bench_get_hit(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += (uintptr_t) uhmap_u32_get(&map, keys[i]);
+
+	sink = acc;
+}
+
+/**
+ * @brief Looks up keys that are not in the table.
+ */
+static void bench_get_miss(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += (uintptr_t) uhmap_u32_get(&map, misses[i]);
+
+	sink = acc;
+}
+
+/**
+ * @brief Removes keys and inserts them back.
+ */
+static void bench_remove_put(int nops)
+{
+	for (int i = 0; i < nops; i++)
+	{
+		uhmap_u32_remove(&map, keys[i], NULL);
+		uhmap_u32_put(&map, keys[i], i);
+	}
+
+	sink = map.count;
+}
+
+/**
+ * @brief Benchmarks hash maps.
+ */
+void benchmark_hmap(void)
+{
+	static const int loads[] = { 25, 50, 75, 87 };
+	uint64_t worst = 0;
+
+	test_hmap_random();
+	test_hmap_resize();
+	test_hmap_arena();
+	test_hmap_str();
+	test_hmap_overflow();
+
+	fill(NSLOTS);
+
+	for (int l = 0; l < (int) (sizeof(loads)/sizeof(loads[0])); l++)
+	{
+		char group[16];
+		int n = (NSLOTS*loads[l])/100;
+		struct bench benchs[] = {
+			{ "put",          bench_put,        n },
+			{ "get-hit",      bench_get_hit,    n },
+			{ "get-miss",     bench_get_miss,   n },
+			{ "remove+put",   bench_remove_put, n },
+		};
+
+		usnprintf(group, sizeof(group), "hmap-%d%%", loads[l]);
+		bench_run(group, benchs, sizeof(benchs)/sizeof(benchs[0]));
+	}
+
+	/* Growing tables. */
+	{
+		struct bench benchs[] = {
+			{ "put-grow", bench_put_grow, UHMAP_LOAD_MAX(NSLOTS) },
+		};
+
+		bench_run("hmap-grow", benchs, 1);
+	}
+
+	/* Worst-case insertion while growing, over a few rounds. */
+	for (int r = 0; r < 5; r++)
+	{
+		uint64_t max = 0;
+
+		map_init(0);
+		for (int i = 0; i < UHMAP_LOAD_MAX(NSLOTS); i++)
+		{
+			uint64_t t0 = bench_clock();
+			uhmap_u32_put(&map, keys[i], i);
+			t0 = bench_clock() - t0;
+			if (t0 > max)
+				max = t0;
+		}
+
+		if ((r == 0) || (max < worst))
+			worst = max;
+	}
+	bench_metric("hmap-grow", "put-max", "max", worst);
+
+	/* Rehashing all entries at once instead. */
+	{
+		struct uhmap_test tmap;
+		uint64_t t0;
+
+		arena.used = 0;
+		uassert(uhmap_test_init(&tmap, UHMAP_LOAD_MAX(NSLOTS/2), &allocator) == 0);
+		for (int i = 0; i < UHMAP_LOAD_MAX(NSLOTS/2); i++)
+			uhmap_test_put(&tmap, keys[i], i);
+
+		t0 = bench_clock();
+		uassert(uhmap_test_rebuild(&tmap, NSLOTS) == 0);
+		t0 = bench_clock() - t0;
+
+		bench_metric("hmap-grow", "rehash", "ops", tmap.count);
+		bench_metric("hmap-grow", "rehash", "cycles", t0);
+	}
+}
@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of operations per run.
+ */
+#define NOPS 1000
+
+/**
+ * @brief Size of blocks in memory benchmarks (in bytes).
+ */
+#define BLOCK_SIZE 256
+
+/**
+ * @brief Size of strings in string benchmarks (in bytes).
+ */
+#define TEXT_SIZE 64
+
+/**
+ * @name Buffers
+ */
+/**@{*/
+static char src[BLOCK_SIZE];
+static char dst[BLOCK_SIZE];
+static char text[TEXT_SIZE];
+/**@}*/
+
+/**
+ * @brief Sink for benchmark results.
+ */
+static volatile uintptr_t sink;
+
+/*============================================================================*
+ * Memory Allocation                                                          *
+ *============================================================================*/
+
+/**
+ * @brief Allocates and releases a block.
+ */
+static void bench_umalloc(int nops)
+{
+	void *ptr;
+
+	for (int i = 0; i < nops; i++)
+	{
+		uassert((ptr = umalloc(64)) != NULL);
+		ufree(ptr);
+	}
+}
+
+/**
+ * @brief Allocates a block, grows it and releases it.
+ */
+static void bench_urealloc(int nops)
+{
+	void *ptr;
+
+	for (int i = 0; i < nops; i++)
+	{
+		uassert((ptr = umalloc(64)) != NULL);
+		uassert((ptr = urealloc(ptr, 128)) != NULL);
+		ufree(ptr);
+	}
+}
+
+/*============================================================================*
+ * Memory and String Routines                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Copies blocks.
+ */
+static void bench_umemcpy(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		umemcpy(dst, src, BLOCK_SIZE);
+
+	sink = dst[BLOCK_SIZE - 1];
+}
+
+/**
+ * @brief Fills blocks.
+ */
+static void bench_umemset(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		umemset(dst, i, BLOCK_SIZE);
+
+	sink = dst[BLOCK_SIZE - 1];
+}
+
+/**
+ * @brief Compares equal blocks.
+ */
+static void bench_umemcmp(int nops)
+{
+	uintptr_t acc = 0;
+
+	umemcpy(dst, src, BLOCK_SIZE);
+
+	for (int i = 0; i < nops; i++)
+		acc += umemcmp(dst, src, BLOCK_SIZE);
+
+	sink = acc;
+}
+
+/**
+ * @brief Measures the length of a string.
+ */
+static void bench_ustrlen(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += ustrlen(text);
+
+	sink = acc;
+}
+
+/**
+ * @brief Compares equal strings.
+ */
+static void bench_ustrcmp(int nops)
+{
+	uintptr_t acc = 0;
+
+	ustrcpy(dst, text);
+
+	for (int i = 0; i < nops; i++)
+		acc += ustrcmp(dst, text);
+
+	sink = acc;
+}
+
+/**
+ * @brief Copies a string.
+ */
+static void bench_ustrcpy(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		ustrcpy(dst, text);
+
+	sink = dst[0];
+}
+
+/*============================================================================*
+ * Formatting and Random Numbers                                              *
+ *============================================================================*/
+
+/**
+ * @brief Formats a line.
+ */
+static void bench_usprintf(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		usprintf(dst, "%s %d %x", "value", i, i);
+
+	sink = dst[0];
+}
+
+/**
+ * @brief Formats an empty line to the output buffer.
+ */
+static void bench_uprintf(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		uprintf("%s", "");
+}
+
+/**
+ * @brief Draws random numbers.
+ */
+static void bench_urand(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += urand();
+
+	sink = acc;
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "umalloc+ufree",       bench_umalloc,       NOPS },
+	{ "umalloc+urealloc",    bench_urealloc,      NOPS },
+	{ "umemcpy-256",         bench_umemcpy,       NOPS },
+	{ "umemset-256",         bench_umemset,       NOPS },
+	{ "umemcmp-256",         bench_umemcmp,       NOPS },
+	{ "ustrlen",             bench_ustrlen,       NOPS },
+	{ "ustrcmp",             bench_ustrcmp,       NOPS },
+	{ "ustrcpy",             bench_ustrcpy,       NOPS },
+	{ "usprintf",            bench_usprintf,      NOPS },
+	{ "uprintf-empty",       bench_uprintf,       NOPS },
+	{ "urand",               bench_urand,         NOPS },
+};
+
+/**
+ * @brief Benchmarks the memory allocator and string routines.
+ */
+void benchmark_libc(void)
+{
+	for (int i = 0; i < BLOCK_SIZE; i++)
+		src[i] = (char) i;
+
+	for (int i = 0; i < TEXT_SIZE - 1; i++)
+		text[i] = 'a' + (i % 26);
+	text[TEXT_SIZE - 1] = '\0';
+
+	bench_run("libc", benchs, sizeof(benchs)/sizeof(benchs[0]));
+}
@@ -0,0 +1,186 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Maximum number of contending threads.
+ */
+#define NTHREADS (((THREAD_MAX - 1) < 4) ? (THREAD_MAX - 1) : 4)
+
+/**
+ * @brief Number of acquisitions per thread.
+ */
+#define NACQUIRES (NOPERATIONS/40)
+
+/**
+ * @name Lock Kinds
+ */
+/**@{*/
+#define LOCK_SPIN   0 /**< Spinlock.    */
+#define LOCK_TICKET 1 /**< Ticket lock. */
+#define LOCK_MCS    2 /**< MCS lock.    */
+/**@}*/
+
+/**
+ * @brief Names of lock kinds.
+ */
+static const char *lock_names[] = { "uspinlock", "uticketlock", "umcslock" };
+
+/**
+ * @name Contended Locks
+ */
+/**@{*/
+static struct uspinlock spin = USPINLOCK_INITIALIZER;
+static struct uticketlock ticket = UTICKETLOCK_INITIALIZER;
+static struct umcslock mcs = UMCSLOCK_INITIALIZER;
+/**@}*/
+
+/**
+ * @brief Counter protected by the contended lock.
+ */
+static volatile unsigned counter;
+
+/**
+ * @name Parameters of the Contention Benchmark
+ */
+/**@{*/
+static int bench_kind;     /**< Lock kind.                   */
+static int bench_nthreads; /**< Number of contending threads. */
+/**@}*/
+
+/**
+ * @brief Checks locking primitives.
+ */
+static void test_lock_api(void)
+{
+	struct umcs_node node, other;
+
+	uassert(uspinlock_trylock(&spin) == 0);
+	uassert(uspinlock_trylock(&spin) < 0);
+	uspinlock_unlock(&spin);
+	uspinlock_lock(&spin);
+	uspinlock_unlock(&spin);
+
+	uassert(uticketlock_trylock(&ticket) == 0);
+	uassert(uticketlock_trylock(&ticket) < 0);
+	uticketlock_unlock(&ticket);
+	uticketlock_lock(&ticket);
+	uticketlock_unlock(&ticket);
+
+	uassert(umcslock_trylock(&mcs, &node) == 0);
+	uassert(umcslock_trylock(&mcs, &other) < 0);
+	umcslock_unlock(&mcs, &node);
+	umcslock_lock(&mcs, &node);
+	umcslock_unlock(&mcs, &node);
+}
+
+/**
+ * @brief Acquires and releases a lock repeatedly.
+ *
+ * @param arg Lock kind.
+ */
+static void *contend(void *arg)
+{
+	struct umcs_node node;
+
+	switch ((int) (intptr_t) arg)
+	{
+		case LOCK_SPIN:
+			for (int i = 0; i < NACQUIRES; i++)
+			{
+				uspinlock_lock(&spin);
+				counter++;
+				uspinlock_unlock(&spin);
+			}
+			break;
+
+		case LOCK_TICKET:
+			for (int i = 0; i < NACQUIRES; i++)
+			{
+				uticketlock_lock(&ticket);
+				counter++;
+				uticketlock_unlock(&ticket);
+			}
+			break;
+
+		default:
+			for (int i = 0; i < NACQUIRES; i++)
+			{
+				umcslock_lock(&mcs, &node);
+				counter++;
+				umcslock_unlock(&mcs, &node);
+			}
+			break;
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Contends for a lock with bench_nthreads threads.
+ *
+ * @param nops Total number of acquisitions.
+ */
+static void bench_contention(int nops)
+{
+	kthread_t tids[NTHREADS];
+
+	counter = 0;
+
+	for (int i = 0; i < bench_nthreads; i++)
+		uassert(uthread_create(&tids[i], contend, (void *) (intptr_t) bench_kind) == 0);
+	for (int i = 0; i < bench_nthreads; i++)
+		uassert(kthread_join(tids[i], NULL) == 0);
+
+	/* No increment was lost. */
+	uassert(counter == (unsigned) nops);
+}
+
+/**
+ * @brief Benchmarks locking primitives.
+ */
+void benchmark_lock(void)
+{
+	struct bench bench;
+	char name[32];
+
+	test_lock_api();
+
+	for (bench_kind = LOCK_SPIN; bench_kind <= LOCK_MCS; bench_kind++)
+	{
+		for (bench_nthreads = 1; bench_nthreads <= NTHREADS; bench_nthreads++)
+		{
+			usnprintf(name, sizeof(name), "%s-%dt", lock_names[bench_kind], bench_nthreads);
+			bench.name = name;
+			bench.fn = bench_contention;
+			bench.nops = bench_nthreads*NACQUIRES;
+			bench_run_n("lock", &bench, 1, BENCH_RUNS_THREADS);
+		}
+	}
+}
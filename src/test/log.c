@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of threads that log concurrently.
+ */
+#define NTHREADS (((THREAD_MAX - 1) < 4) ? (THREAD_MAX - 1) : 4)
+
+/**
+ * @brief Last entry seen by the sink.
+ */
+static char last[ULOG_LINE_MAX];
+
+/**
+ * @brief Number of entries seen by the sink.
+ */
+static unsigned nemitted;
+
+/**
+ * @brief Sink that keeps the compiler from discarding formatted lines.
+ */
+static volatile size_t sink;
+
+/**
+ * @brief Discards a formatted log entry.
+ */
+static void emit(const char *buf, size_t n)
+{
+	umemcpy(last, buf, n + 1);
+	nemitted++;
+}
+
+/**
+ * @brief Threads seen by the sink.
+ */
+static unsigned seen;
+
+/**
+ * @brief Start flag of logging threads.
+ */
+static int go;
+
+/**
+ * @brief Records which thread logged an entry.
+ */
+static void emit_thread(const char *buf, size_t n)
+{
+	uassert(n == 15);
+	uassert(ustrncmp(buf, "[log] thread ", 13) == 0);
+	seen |= 1U << (buf[13] - '0');
+}
+
+/**
+ * @brief Logs from a call site shared with other threads.
+ *
+ * @param arg Index of the thread.
+ */
+static void *logger(void *arg)
+{
+	while (!__atomic_load_n(&go, __ATOMIC_ACQUIRE))
+		kthread_yield();
+
+	ulog("[log] thread %d\n", (int) (intptr_t) arg);
+
+	return (NULL);
+}
+
+/**
+ * @brief Checks deferred logging.
+ */
+static void test_log_api(void)
+{
+	kthread_t tids[NTHREADS];
+
+	uassert(ulog_flush_to(NULL) == -EINVAL);
+
+	/* Nothing pending. */
+	nemitted = 0;
+	uassert(ulog_flush_to(emit) == 0);
+	uassert(nemitted == 0);
+
+	ulog("[log] pkt %u len %d flags %x\n", 7U, -1, 0xabc);
+	uassert(ulog_flush_to(emit) == 1);
+	uassert(nemitted == 1);
+	uassert(ustrcmp(last, "[log] pkt 7 len -1 flags abc\n") == 0);
+
+	/* Threads reach a call site for the first time together. */
+	go = 0;
+	for (int i = 0; i < NTHREADS; i++)
+		uassert(uthread_create(&tids[i], logger, (void *) (intptr_t) i) == 0);
+	__atomic_store_n(&go, 1, __ATOMIC_RELEASE);
+	for (int i = 0; i < NTHREADS; i++)
+		uassert(kthread_join(tids[i], NULL) == 0);
+
+	seen = 0;
+	uassert(ulog_flush_to(emit_thread) == NTHREADS);
+	uassert(seen == (1U << NTHREADS) - 1);
+}
+
+/**
+ * @brief Records log entries and drains them.
+ *
+ * Entries are drained in the same run so that the ring never fills
+ * up; the figure covers both the hot path and the flush.
+ */
+static void bench_ulog(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		ulog("[log] pkt %u len %d flags %x\n", (unsigned) i, 64 + i, i & 7);
+
+	nemitted = 0;
+	uassert(ulog_flush_to(emit) == nops);
+	uassert(nemitted == (unsigned) nops);
+}
+
+/**
+ * @brief Formats log entries in place.
+ */
+static void bench_usnprintf(int nops)
+{
+	char buf[ULOG_LINE_MAX];
+
+	for (int i = 0; i < nops; i++)
+		sink += usnprintf(buf, sizeof(buf), "[log] pkt %u len %d flags %x\n", (unsigned) i, 64 + i, i & 7);
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "ulog+ulog_flush_to", bench_ulog,      ULOG_ENTRIES },
+	{ "usnprintf",          bench_usnprintf, ULOG_ENTRIES },
+};
+
+/**
+ * @brief Benchmarks deferred logging against formatting in place.
+ */
+void benchmark_log(void)
+{
+	unsigned dropped;
+
+	test_log_api();
+
+	dropped = ulog_dropped();
+
+	bench_run("log", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	uassert(ulog_dropped() == dropped);
+}
@@ -38,13 +38,35 @@ size_t strlen(const char *str)
 
 #endif
 
+#include "test.h"
+
 /**
- * @brief Dummy test driver.
+ * @brief Test driver.
  */
 int __main2(int argc, const char *argv[])
 {
 	((void) argc);
 	((void) argv);
 
+	benchmark_libc();
+	benchmark_malloc();
+	benchmark_format();
+	benchmark_log();
+	benchmark_writev();
+	benchmark_parse();
+	benchmark_random();
+	benchmark_lock();
+	benchmark_queue();
+	benchmark_pool();
+	benchmark_fiber();
+	benchmark_tls();
+	benchmark_prof();
+	benchmark_sort();
+	benchmark_radix();
+	benchmark_hmap();
+	benchmark_hash();
+	benchmark_bitset();
+	benchmark_stream();
+
 	return (0);
 }
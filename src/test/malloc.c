@@ -0,0 +1,481 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of live blocks.
+ */
+#define NSLOTS 128
+
+/**
+ * @brief Number of operations in a workload.
+ */
+#define NOPS (NOPERATIONS/10)
+
+/**
+ * @brief Number of interleaved growth chains.
+ */
+#define NCHAINS 8
+
+/**
+ * @brief Largest block of a growth chain (in bytes).
+ */
+#define CHAIN_SIZE_MAX 2048
+
+/**
+ * @brief Capacity of the producer/consumer queue.
+ */
+#define CAPACITY 64
+
+/**
+ * @brief Budget of heap growth, relative to the peak of used bytes
+ * (in percent).
+ */
+#define SBRK_BUDGET 150
+
+/**
+ * @brief Live blocks.
+ */
+static struct
+{
+	unsigned char *ptr; /**< Block.           */
+	size_t size;        /**< Requested size.  */
+} slots[NSLOTS];
+
+/**
+ * @brief Requested bytes in live blocks.
+ */
+/**@{*/
+static size_t live;
+static size_t live_peak;
+/**@}*/
+
+/**
+ * @brief Queue of the producer/consumer workload.
+ */
+static struct uspsc queue;
+
+/**
+ * @brief State of the pseudo-random generator.
+ */
+static uint32_t seed = 1;
+
+/**
+ * @brief Generates a pseudo-random number.
+ */
+static uint32_t next(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	return (seed);
+}
+
+/*============================================================================*
+ * Blocks                                                                     *
+ *============================================================================*/
+
+/**
+ * @brief Fills a block with a tag.
+ */
+static void fill(unsigned char *ptr, size_t size)
+{
+	umemset(ptr, (unsigned char) size, size);
+}
+
+/**
+ * @brief Checks that a block still holds its tag.
+ */
+static void check(const unsigned char *ptr, size_t size)
+{
+	uassert(ptr[0] == (unsigned char) size);
+	uassert(ptr[size/2] == (unsigned char) size);
+	uassert(ptr[size - 1] == (unsigned char) size);
+}
+
+/**
+ * @brief Allocates a block in a slot.
+ */
+static void slot_alloc(int i, size_t size)
+{
+	uassert(slots[i].ptr == NULL);
+	uassert((slots[i].ptr = umalloc(size)) != NULL);
+	fill(slots[i].ptr, size);
+	slots[i].size = size;
+
+	live += size;
+	if (live > live_peak)
+		live_peak = live;
+}
+
+/**
+ * @brief Grows or shrinks the block of a slot.
+ */
+static void slot_realloc(int i, size_t size)
+{
+	size_t n = (size < slots[i].size) ? size : slots[i].size;
+
+	uassert((slots[i].ptr = urealloc(slots[i].ptr, size)) != NULL);
+	check(slots[i].ptr, n);
+	fill(slots[i].ptr, size);
+
+	live += size - slots[i].size;
+	slots[i].size = size;
+	if (live > live_peak)
+		live_peak = live;
+}
+
+/**
+ * @brief Releases the block of a slot.
+ */
+static void slot_free(int i)
+{
+	check(slots[i].ptr, slots[i].size);
+	ufree(slots[i].ptr);
+
+	live -= slots[i].size;
+	slots[i].ptr = NULL;
+}
+
+/*============================================================================*
+ * Workloads                                                                  *
+ *============================================================================*/
+
+/**
+ * @brief Draws a size from a power-law distribution.
+ *
+ * @details Sizes are powers of two from 8 to 2048 bytes, and each
+ * size is half as likely as the one before it.
+ */
+static size_t powerlaw(void)
+{
+	size_t size = 8;
+
+	for (uint32_t r = next(); (r & 1) && (size < 2048); r >>= 1)
+		size <<= 1;
+
+	return (size);
+}
+
+/**
+ * @brief Allocates blocks and releases them in reverse order.
+ */
+static int workload_lifo(struct umalloc_stats *stats)
+{
+	int nops = 0;
+
+	while (nops < NOPS)
+	{
+		for (int i = 0; i < NSLOTS; i++, nops++)
+			slot_alloc(i, 1 + (next() & 255));
+
+		if (nops >= NOPS)
+			uassert(umalloc_check(stats) == 0);
+
+		for (int i = NSLOTS - 1; i >= 0; i--, nops++)
+			slot_free(i);
+	}
+
+	return (nops);
+}
+
+/**
+ * @brief Allocates blocks and releases them in the same order.
+ */
+static int workload_fifo(struct umalloc_stats *stats)
+{
+	int nops = 0;
+
+	while (nops < NOPS)
+	{
+		for (int i = 0; i < NSLOTS; i++, nops++)
+			slot_alloc(i, 1 + (next() & 255));
+
+		if (nops >= NOPS)
+			uassert(umalloc_check(stats) == 0);
+
+		for (int i = 0; i < NSLOTS; i++, nops++)
+			slot_free(i);
+	}
+
+	return (nops);
+}
+
+/**
+ * @brief Allocates and releases blocks of random sizes in random order.
+ */
+static int workload_random(struct umalloc_stats *stats)
+{
+	for (int n = 0; n < NOPS; n++)
+	{
+		int i = next() % NSLOTS;
+
+		if (slots[i].ptr == NULL)
+			slot_alloc(i, 1 + (next() % 512));
+		else
+			slot_free(i);
+	}
+
+	uassert(umalloc_check(stats) == 0);
+
+	for (int i = 0; i < NSLOTS; i++)
+	{
+		if (slots[i].ptr != NULL)
+			slot_free(i);
+	}
+
+	return (NOPS);
+}
+
+/**
+ * @brief Allocates and releases blocks of power-law sizes in random
+ * order.
+ */
+static int workload_powerlaw(struct umalloc_stats *stats)
+{
+	for (int n = 0; n < NOPS; n++)
+	{
+		int i = next() % NSLOTS;
+
+		if (slots[i].ptr == NULL)
+			slot_alloc(i, powerlaw());
+		else
+			slot_free(i);
+	}
+
+	uassert(umalloc_check(stats) == 0);
+
+	for (int i = 0; i < NSLOTS; i++)
+	{
+		if (slots[i].ptr != NULL)
+			slot_free(i);
+	}
+
+	return (NOPS);
+}
+
+/**
+ * @brief Grows interleaved blocks with urealloc().
+ */
+static int workload_realloc(struct umalloc_stats *stats)
+{
+	int nops = 0;
+
+	while (nops < NOPS)
+	{
+		for (int i = 0; i < NCHAINS; i++, nops++)
+			slot_alloc(i, 16);
+
+		/* Grow by half at each step, so that blocks rarely fit in place. */
+		for (size_t size = 24; size <= CHAIN_SIZE_MAX; size += size/2)
+		{
+			for (int i = 0; i < NCHAINS; i++, nops++)
+				slot_realloc(i, size + (next() & 7));
+		}
+
+		if (nops >= NOPS)
+			uassert(umalloc_check(stats) == 0);
+
+		for (int i = 0; i < NCHAINS; i++, nops++)
+			slot_free(i);
+	}
+
+	return (nops);
+}
+
+/**
+ * @brief Allocates blocks to be released by another thread.
+ */
+static void *producer(void *arg)
+{
+	uint32_t x = 1;
+
+	((void) arg);
+
+	for (int i = 0; i < NOPS; i++)
+	{
+		unsigned char *ptr;
+		size_t size, n;
+
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		size = 16 + (x % 240);
+
+		uassert((ptr = umalloc(size)) != NULL);
+		fill(ptr, size);
+
+		/* Only the producer grows the live set. */
+		n = __atomic_add_fetch(&live, size, __ATOMIC_RELAXED);
+		if (n > live_peak)
+			live_peak = n;
+
+		while (uspsc_push(&queue, ptr) != 0)
+			kthread_yield();
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Releases blocks allocated by another thread.
+ */
+static int workload_prodcons(struct umalloc_stats *stats)
+{
+	kthread_t tid;
+	void *item;
+
+	uassert(uspsc_init(&queue, CAPACITY) == 0);
+	uassert(uthread_create(&tid, producer, NULL) == 0);
+
+	for (int n = 0; n < NOPS; n++)
+	{
+		unsigned char *ptr;
+		size_t size;
+
+		while (uspsc_pop(&queue, &item) != 0)
+			kthread_yield();
+
+		/* Blocks are tagged with their size. */
+		ptr = item;
+		size = ptr[0];
+		check(ptr, size);
+		ufree(ptr);
+		__atomic_sub_fetch(&live, size, __ATOMIC_RELAXED);
+	}
+
+	uassert(kthread_join(tid, NULL) == 0);
+
+	uassert(umalloc_check(stats) == 0);
+	uspsc_destroy(&queue);
+
+	return (2*NOPS);
+}
+
+/**
+ * @brief Registered workloads.
+ */
+static const struct
+{
+	const char *name;                  /**< Workload name.                   */
+	int (*fn)(struct umalloc_stats *); /**< Runs the workload.               */
+	unsigned overhead;                 /**< Budget of used bytes (in %).     */
+	unsigned frag;                     /**< Budget of fragmentation (in %).  */
+} workloads[] = {
+	{ "lifo",     workload_lifo,     150, 25 },
+	{ "fifo",     workload_fifo,     150, 25 },
+	{ "random",   workload_random,   150, 95 },
+	{ "powerlaw", workload_powerlaw, 400, 90 },
+	{ "realloc",  workload_realloc,  200, 50 },
+	{ "prodcons", workload_prodcons, 150, 50 },
+};
+
+/**
+ * @brief Workload under benchmark.
+ */
+static int current;
+
+/**
+ * @brief Runs the workload under benchmark.
+ */
+static void bench_workload(int nops)
+{
+	struct umalloc_stats peak;
+
+	((void) nops);
+
+	live = live_peak = 0;
+	workloads[current].fn(&peak);
+	uassert(live == 0);
+}
+
+/**
+ * @brief Runs a workload and checks it against budgets.
+ *
+ * @details Integrity of the heap is checked at the peak of the
+ * workload and after all of its blocks are released. The peak of
+ * used bytes and external fragmentation at the peak must stay within
+ * the budgets of the workload. If the heap grows, it must stay within
+ * SBRK_BUDGET of the peak of used bytes. The workload is then timed
+ * over a few more runs.
+ */
+static void run(int w)
+{
+	struct umalloc_stats before, peak, after;
+	struct bench bench;
+	size_t used;
+	unsigned frag;
+
+	live = live_peak = 0;
+	uassert(umalloc_check(&before) == 0);
+
+	bench.name = workloads[w].name;
+	bench.fn = bench_workload;
+	bench.nops = workloads[w].fn(&peak);
+
+	uassert(umalloc_check(&after) == 0);
+
+	/* All blocks were released. */
+	uassert(live == 0);
+	uassert(after.used_size == before.used_size);
+
+	/* Checks restart the peak, so take it at the peak of the workload. */
+	used = peak.used_peak - before.used_size;
+
+	frag = (peak.free_size == 0) ? 0 :
+		100 - (unsigned)((peak.free_max*100)/peak.free_size);
+
+	bench_metric("malloc", bench.name, "live", live_peak);
+	bench_metric("malloc", bench.name, "used", used);
+	bench_metric("malloc", bench.name, "sbrk", after.heap_size);
+	bench_metric("malloc", bench.name, "frag", frag);
+
+	uassert(used*100 <= live_peak*workloads[w].overhead);
+	uassert(frag <= workloads[w].frag);
+	uassert((after.heap_size == before.heap_size) ||
+		(after.heap_size*100 <= peak.used_peak*SBRK_BUDGET));
+
+	current = w;
+	bench_run_n("malloc", &bench, 1, BENCH_RUNS_THREADS);
+}
+
+/**
+ * @brief Runs allocator workloads.
+ */
+void benchmark_malloc(void)
+{
+	struct umalloc_stats stats;
+
+	uassert(umalloc_check(NULL) < 0);
+	uassert(umalloc_check(&stats) == 0);
+
+	for (int w = 0; w < (int)(sizeof(workloads)/sizeof(workloads[0])); w++)
+		run(w);
+}
@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of records in the input.
+ */
+#define NRECORDS 512
+
+/**
+ * @brief Maximum length of a record.
+ */
+#define RECORD_MAX 32
+
+/**
+ * @brief Input records.
+ */
+static char records[NRECORDS*RECORD_MAX];
+
+/**
+ * @brief Sink that keeps the compiler from discarding conversions.
+ */
+static volatile uint64_t sink;
+
+/**
+ * @brief Builds input records.
+ *
+ * @param floats Build floating-point records?
+ */
+static void build_records(int floats)
+{
+	char *p;
+	uint64_t x;
+
+	x = 88172645463325252ULL;
+	p = records;
+
+	for (int i = 0; i < NRECORDS; i++)
+	{
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+
+		if (floats)
+			p += usprintf(p, "%u.%u ", (unsigned) (x >> 40), (unsigned) (x & 0xffff));
+		else
+			p += usprintf(p, "%llu ", (unsigned long long) (x >> (i & 63)));
+	}
+}
+
+/**
+ * @brief Parses a number digit by digit.
+ *
+ * @param s   Target string.
+ * @param end End of the number.
+ *
+ * @returns The parsed number.
+ */
+static uint64_t naive_strtoull(const char *s, char **end)
+{
+	uint64_t v;
+
+	for (v = 0; (*s >= '0') && (*s <= '9'); s++)
+		v = v*10 + (*s - '0');
+
+	*end = (char *) s;
+
+	return (v);
+}
+
+/**
+ * @brief Defines a benchmark of a parsing routine over the input
+ * records.
+ *
+ * @param fn    Benchmark function.
+ * @param parse Parsing expression (reads from p, advances end).
+ */
+#define BENCH_PARSER(fn, parse)                            \
+	static void fn(int nops)                               \
+	{                                                      \
+		uint64_t acc = 0;                                  \
+		const char *p = records;                           \
+		char *end;                                         \
+                                                           \
+		for (int i = 0; i < nops; i++, p = end + 1)        \
+			acc += (uint64_t) (parse);                     \
+                                                           \
+		sink = acc;                                        \
+	}
+
+/**
+ * @name Parsing Benchmarks
+ */
+/**@{*/
+BENCH_PARSER(bench_naive, naive_strtoull(p, &end))
+BENCH_PARSER(bench_ustrtoull, ustrtoull(p, &end, 10))
+BENCH_PARSER(bench_ustrtoull16, ustrtoull(p, &end, 16))
+BENCH_PARSER(bench_ustrtod, ustrtod(p, &end))
+/**@}*/
+
+/**
+ * @brief Registered benchmarks of integer parsing.
+ */
+static const struct bench benchs_int[] = {
+	{ "naive",       bench_naive,       NRECORDS },
+	{ "ustrtoull",   bench_ustrtoull,   NRECORDS },
+	{ "ustrtoull16", bench_ustrtoull16, NRECORDS },
+};
+
+/**
+ * @brief Registered benchmarks of floating-point parsing.
+ */
+static const struct bench benchs_float[] = {
+	{ "ustrtod", bench_ustrtod, NRECORDS },
+};
+
+/**
+ * @brief Checks number parsing.
+ */
+static void test_parse_api(void)
+{
+	char *end;
+	double d;
+	uint64_t bits;
+
+	uassert(ustrtoull("18446744073709551615", NULL, 10) == 18446744073709551615ULL);
+	uassert(ustrtoll("-9223372036854775808", NULL, 10) == -9223372036854775807LL - 1);
+	uassert(ustrtol("  0x1f", &end, 0) == 31);
+	uassert(*end == '\0');
+	uassert(ustrtoul("777", NULL, 8) == 511);
+	uassert(uatoi("-42abc") == -42);
+
+	d = ustrtod("1.25e2", &end);
+	uassert((d > 124.999) && (d < 125.001));
+	uassert(*end == '\0');
+	d = ustrtod("0.1", NULL);
+	umemcpy(&bits, &d, sizeof(uint64_t));
+	uassert(bits == 0x3fb999999999999aULL);
+}
+
+/**
+ * @brief Benchmarks number parsing.
+ */
+void benchmark_parse(void)
+{
+	test_parse_api();
+
+	build_records(0);
+	bench_run("parse", benchs_int, sizeof(benchs_int)/sizeof(benchs_int[0]));
+
+	build_records(1);
+	bench_run("parse", benchs_float, sizeof(benchs_float)/sizeof(benchs_float[0]));
+}
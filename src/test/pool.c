@@ -0,0 +1,266 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of loop iterations.
+ */
+#define NITERATIONS 4096
+
+/**
+ * @brief Number of submitted tasks.
+ */
+#define NTASKS 256
+
+/**
+ * @brief Number of rounds of work in an iteration.
+ */
+#define NROUNDS 64
+
+/**
+ * @brief Visits of loop iterations.
+ */
+static unsigned char visits[NITERATIONS];
+
+/**
+ * @brief Results of loop iterations.
+ */
+static uint32_t results[NITERATIONS];
+
+/**
+ * @brief Number of completed tasks.
+ */
+static unsigned completed;
+
+/**
+ * @brief Burns some cycles.
+ *
+ * @param x      Initial value.
+ * @param rounds Number of rounds.
+ *
+ * @returns A value that depends on all rounds.
+ */
+static uint32_t work(uint32_t x, int rounds)
+{
+	x |= 1;
+
+	for (int i = 0; i < rounds; i++)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+	}
+
+	return (x);
+}
+
+/**
+ * @brief Marks iterations as visited.
+ */
+static void visit(size_t begin, size_t end, void *arg)
+{
+	((void) arg);
+
+	for (size_t i = begin; i < end; i++)
+		__atomic_add_fetch(&visits[i], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Runs iterations of even cost.
+ */
+static void even(size_t begin, size_t end, void *arg)
+{
+	((void) arg);
+
+	for (size_t i = begin; i < end; i++)
+		results[i] = work(i, NROUNDS);
+}
+
+/**
+ * @brief Runs iterations of growing cost.
+ */
+static void uneven(size_t begin, size_t end, void *arg)
+{
+	((void) arg);
+
+	for (size_t i = begin; i < end; i++)
+		results[i] = work(i, (2*NROUNDS*i)/NITERATIONS);
+}
+
+/**
+ * @brief Completes a task.
+ */
+static void task(void *arg)
+{
+	uassert(arg == &completed);
+
+	__atomic_add_fetch(&completed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Runs a nested parallel loop.
+ */
+static void nested(void *arg)
+{
+	((void) arg);
+
+	uassert(uparallel_for(0, NITERATIONS, 16, visit, NULL) == 0);
+
+	__atomic_add_fetch(&completed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Checks the thread pool.
+ */
+static void test_pool_api(void)
+{
+	struct upool_group group = UPOOL_GROUP_INITIALIZER;
+
+	uassert(uparallel_for(0, NITERATIONS, 1, NULL, NULL) < 0);
+	uassert(uparallel_for(1, 0, 1, visit, NULL) < 0);
+	uassert(upool_submit(&group, NULL, NULL) < 0);
+
+	/* Each iteration runs exactly once, whatever the grain. */
+	for (size_t grain = 0; grain <= NITERATIONS; grain = 2*grain + 1)
+	{
+		umemset(visits, 0, sizeof(visits));
+		uassert(uparallel_for(0, NITERATIONS, grain, visit, NULL) == 0);
+		for (int i = 0; i < NITERATIONS; i++)
+			uassert(visits[i] == 1);
+	}
+
+	/* Each task runs exactly once. */
+	completed = 0;
+	for (int i = 0; i < NTASKS; i++)
+		uassert(upool_submit(&group, task, &completed) == 0);
+	upool_wait(&group);
+	uassert(completed == NTASKS);
+
+	/* Tasks may wait for loops that they spawn. */
+	completed = 0;
+	umemset(visits, 0, sizeof(visits));
+	for (int i = 0; i < 4; i++)
+		uassert(upool_submit(&group, nested, NULL) == 0);
+	upool_wait(&group);
+	uassert(completed == 4);
+	for (int i = 0; i < NITERATIONS; i++)
+		uassert(visits[i] == 4);
+}
+
+/**
+ * @brief Loop body under test.
+ */
+static void (*body)(size_t, size_t, void *);
+
+/**
+ * @brief Runs a loop in the calling thread.
+ */
+static void bench_serial(int nops)
+{
+	body(0, nops, NULL);
+}
+
+/**
+ * @brief Runs a loop in the thread pool.
+ */
+static void bench_parallel(int nops)
+{
+	uassert(uparallel_for(0, nops, 0, body, NULL) == 0);
+}
+
+/**
+ * @brief Submits tasks to the thread pool and waits for them.
+ */
+static void bench_submit(int nops)
+{
+	struct upool_group group = UPOOL_GROUP_INITIALIZER;
+
+	completed = 0;
+
+	for (int i = 0; i < nops; i++)
+		uassert(upool_submit(&group, task, &completed) == 0);
+	upool_wait(&group);
+
+	uassert(completed == (unsigned) nops);
+}
+
+/**
+ * @brief Benchmarks a loop.
+ *
+ * @param name Benchmark name.
+ * @param fn   Loop body.
+ */
+static void benchmark_loop(const char *name, void (*fn)(size_t, size_t, void *))
+{
+	uint32_t expected[8];
+	char label[32];
+	struct bench bench = { label, NULL, NITERATIONS };
+
+	body = fn;
+
+	bench.fn = bench_serial;
+	usnprintf(label, sizeof(label), "%s-serial", name);
+	bench_run_n("pool", &bench, 1, BENCH_RUNS_THREADS);
+
+	for (int i = 0; i < 8; i++)
+		expected[i] = results[(i*NITERATIONS)/8];
+	umemset(results, 0, sizeof(results));
+
+	bench.fn = bench_parallel;
+	usnprintf(label, sizeof(label), "%s-uparallel_for", name);
+	bench_run_n("pool", &bench, 1, BENCH_RUNS_THREADS);
+
+	for (int i = 0; i < 8; i++)
+		uassert(results[(i*NITERATIONS)/8] == expected[i]);
+}
+
+/**
+ * @brief Benchmarks task submission.
+ */
+static void benchmark_submit(void)
+{
+	static const struct bench benchs[] = {
+		{ "upool_submit", bench_submit, NTASKS },
+	};
+
+	bench_run_n("pool", benchs, sizeof(benchs)/sizeof(benchs[0]), BENCH_RUNS_THREADS);
+}
+
+/**
+ * @brief Benchmarks the thread pool.
+ */
+void benchmark_pool(void)
+{
+	test_pool_api();
+
+	benchmark_loop("even", even);
+	benchmark_loop("uneven", uneven);
+	benchmark_submit();
+
+	upool_shutdown();
+}
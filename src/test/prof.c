@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of operations in a benchmark run.
+ */
+#define NOPS 1000
+
+/**
+ * @brief Sink for benchmark results.
+ */
+static volatile uint64_t sink;
+
+/**
+ * @brief Checks the profiling interface.
+ */
+static void test_prof_api(void)
+{
+	struct uprof_region outer, inner;
+	uint64_t t0, t1;
+
+	/* Cycle counter does not go backwards. */
+	t0 = ucycles();
+	for (int i = 0; i < 1000; i++)
+	{
+		t1 = ucycles();
+		uassert(t1 >= t0);
+		t0 = t1;
+	}
+
+	/* Regions nest, and may be left without a report. */
+	for (int i = 0; i < 10; i++)
+	{
+		uprof_begin(&outer, "prof-outer");
+		uprof_begin(&inner, "prof-inner");
+		uassert(inner.probe >= 0);
+		uassert(inner.probe != outer.probe);
+		uprof_end(&inner);
+		uprof_end(&outer);
+	}
+
+	/* Probes are identified by the address of their name. */
+	uprof_begin(&inner, "prof-inner");
+	uassert(inner.probe >= 0);
+	uprof_end(&inner);
+	uprof_begin(&outer, "prof-outer");
+	uassert(outer.probe >= 0);
+	uassert(inner.probe != outer.probe);
+	uprof_end(&outer);
+
+	uprof_reset();
+}
+
+/**
+ * @brief Reads the cycle counter.
+ */
+static void bench_ucycles(int nops)
+{
+	uint64_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += ucycles();
+
+	sink = acc;
+}
+
+/**
+ * @brief Runs empty probe regions.
+ */
+static void bench_uprof(int nops)
+{
+	struct uprof_region region;
+
+	for (int i = 0; i < nops; i++)
+	{
+		uprof_begin(&region, "prof-empty");
+		uprof_end(&region);
+	}
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "ucycles",               bench_ucycles, NOPS },
+	{ "uprof_begin+uprof_end", bench_uprof,   NOPS },
+};
+
+/**
+ * @brief Benchmarks the profiling interface.
+ */
+void benchmark_prof(void)
+{
+	test_prof_api();
+
+	bench_run("prof", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	uprof_reset();
+}
@@ -0,0 +1,471 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Maximum number of producers (and consumers).
+ */
+#define NPEERS (((THREAD_MAX - 1)/2 < 2) ? (THREAD_MAX - 1)/2 : 2)
+
+/**
+ * @brief Number of items passed through a queue.
+ */
+#define NITEMS (NOPERATIONS/10)
+
+/**
+ * @brief Capacity of queues.
+ */
+#define CAPACITY 256
+
+/**
+ * @brief Number of items in a batch.
+ */
+#define BATCH 16
+
+/**
+ * @brief Number of round trips in the latency benchmark.
+ */
+#define NROUNDS (NOPERATIONS/100)
+
+/**
+ * @brief Number of failed attempts before a peer yields the processor.
+ */
+#define SPINS_MAX 64
+
+/**
+ * @name Queues Under Test
+ */
+/**@{*/
+static struct uspsc spsc;
+static struct uspsc spsc_back;
+static struct umpmc mpmc;
+/**@}*/
+
+/**
+ * @brief Parameters of a producer or consumer.
+ */
+struct peer
+{
+	int batch;         /**< Use batch operations?   */
+	unsigned first;    /**< First item to produce.  */
+	unsigned nitems;   /**< Number of items.        */
+	uint64_t sum;      /**< Sum of consumed items.  */
+};
+
+/**
+ * @brief Waits for a queue to make progress.
+ *
+ * @param spins Number of failed attempts in a row.
+ *
+ * @details Peers spin for a while and then yield the processor, so
+ * that they do not burn whole time slices when they share it.
+ */
+static void backoff(unsigned *spins)
+{
+	if (++(*spins) < SPINS_MAX)
+		ucpu_relax();
+	else
+		kthread_yield();
+}
+
+/**
+ * @brief Checks queues.
+ */
+static void test_queue_api(void)
+{
+	void *items[CAPACITY + 1];
+	void *item;
+
+	uassert(uspsc_init(&spsc, 0) == -EINVAL);
+	uassert(umpmc_init(&mpmc, 0) == -EINVAL);
+
+	uassert(uspsc_init(&spsc, 3) == 0);
+	uassert(umpmc_init(&mpmc, 3) == 0);
+
+	/* Capacity is rounded up and items come out in order. */
+	for (uintptr_t i = 1; i <= 4; i++)
+	{
+		uassert(uspsc_push(&spsc, (void *) i) == 0);
+		uassert(umpmc_push(&mpmc, (void *) i) == 0);
+	}
+	uassert(uspsc_push(&spsc, items) == -EAGAIN);
+	uassert(umpmc_push(&mpmc, items) == -EAGAIN);
+	for (uintptr_t i = 1; i <= 4; i++)
+	{
+		uassert((uspsc_pop(&spsc, &item) == 0) && (item == (void *) i));
+		uassert((umpmc_pop(&mpmc, &item) == 0) && (item == (void *) i));
+	}
+	uassert(uspsc_pop(&spsc, &item) == -EAGAIN);
+	uassert(umpmc_pop(&mpmc, &item) == -EAGAIN);
+
+	uspsc_destroy(&spsc);
+	umpmc_destroy(&mpmc);
+
+	/* Batches are cut at the capacity of the queue. */
+	uassert(uspsc_init(&spsc, CAPACITY) == 0);
+	uassert(umpmc_init(&mpmc, CAPACITY) == 0);
+	for (uintptr_t i = 0; i <= CAPACITY; i++)
+		items[i] = (void *) i;
+	for (int lap = 0; lap < 3; lap++)
+	{
+		uassert(uspsc_push_batch(&spsc, items, 3) == 3);
+		uassert(uspsc_push_batch(&spsc, items, CAPACITY + 1) == CAPACITY - 3);
+		uassert(uspsc_pop_batch(&spsc, items, 2) == 2);
+		uassert(uspsc_pop_batch(&spsc, items, CAPACITY + 1) == CAPACITY - 2);
+		uassert((items[0] == (void *) 2) && (items[1] == (void *) 0));
+
+		for (uintptr_t i = 0; i <= CAPACITY; i++)
+			items[i] = (void *) i;
+
+		uassert(umpmc_push_batch(&mpmc, items, 3) == 3);
+		uassert(umpmc_push_batch(&mpmc, items, CAPACITY + 1) == CAPACITY - 3);
+		uassert(umpmc_pop_batch(&mpmc, items, 2) == 2);
+		uassert(umpmc_pop_batch(&mpmc, items, CAPACITY + 1) == CAPACITY - 2);
+		uassert((items[0] == (void *) 2) && (items[1] == (void *) 0));
+
+		for (uintptr_t i = 0; i <= CAPACITY; i++)
+			items[i] = (void *) i;
+	}
+
+	uspsc_destroy(&spsc);
+	umpmc_destroy(&mpmc);
+}
+
+/*============================================================================*
+ * Throughput                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Produces items in the single-producer single-consumer queue.
+ */
+static void *spsc_producer(void *arg)
+{
+	struct peer *p = arg;
+	void *items[BATCH];
+	unsigned spins = 0;
+	unsigned i, n;
+
+	for (i = 0; i < p->nitems; i += n)
+	{
+		n = (p->batch && ((p->nitems - i) >= BATCH)) ? BATCH : 1;
+
+		for (unsigned j = 0; j < n; j++)
+			items[j] = (void *) (uintptr_t) (p->first + i + j);
+
+		for (unsigned sent = 0; sent < n; /* noop */)
+		{
+			size_t k = uspsc_push_batch(&spsc, &items[sent], n - sent);
+
+			if (k == 0)
+				backoff(&spins);
+			else
+				spins = 0;
+			sent += k;
+		}
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Consumes items from the single-producer single-consumer queue.
+ */
+static void *spsc_consumer(void *arg)
+{
+	struct peer *p = arg;
+	void *items[BATCH];
+	unsigned spins = 0;
+	unsigned i;
+	size_t n;
+
+	for (i = 0; i < p->nitems; i += n)
+	{
+		if (p->batch)
+			n = uspsc_pop_batch(&spsc, items, BATCH);
+		else
+			n = (uspsc_pop(&spsc, &items[0]) == 0) ? 1 : 0;
+
+		if (n == 0)
+			backoff(&spins);
+		else
+			spins = 0;
+
+		for (size_t j = 0; j < n; j++)
+			p->sum += (uintptr_t) items[j];
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Produces items in the multi-producer multi-consumer queue.
+ */
+static void *mpmc_producer(void *arg)
+{
+	struct peer *p = arg;
+	void *items[BATCH];
+	unsigned spins = 0;
+	unsigned i, n;
+
+	for (i = 0; i < p->nitems; i += n)
+	{
+		n = (p->batch && ((p->nitems - i) >= BATCH)) ? BATCH : 1;
+
+		for (unsigned j = 0; j < n; j++)
+			items[j] = (void *) (uintptr_t) (p->first + i + j);
+
+		for (unsigned sent = 0; sent < n; /* noop */)
+		{
+			size_t k = umpmc_push_batch(&mpmc, &items[sent], n - sent);
+
+			if (k == 0)
+				backoff(&spins);
+			else
+				spins = 0;
+			sent += k;
+		}
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Consumes items from the multi-producer multi-consumer queue.
+ */
+static void *mpmc_consumer(void *arg)
+{
+	struct peer *p = arg;
+	void *items[BATCH];
+	unsigned spins = 0;
+	unsigned i;
+	size_t n;
+
+	for (i = 0; i < p->nitems; i += n)
+	{
+		/* Do not take items of other consumers. */
+		n = (p->batch && ((p->nitems - i) >= BATCH)) ? BATCH : 1;
+		n = umpmc_pop_batch(&mpmc, items, n);
+
+		if (n == 0)
+			backoff(&spins);
+		else
+			spins = 0;
+
+		for (size_t j = 0; j < n; j++)
+			p->sum += (uintptr_t) items[j];
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Configuration of the throughput benchmark.
+ */
+static struct
+{
+	void *(*producer)(void *); /**< Producer routine.        */
+	void *(*consumer)(void *); /**< Consumer routine.        */
+	int nproducers;            /**< Number of producers.     */
+	int nconsumers;            /**< Number of consumers.     */
+	int batch;                 /**< Use batch operations?    */
+} throughput;
+
+/**
+ * @brief Moves items from producers to consumers.
+ *
+ * @param nops Number of items.
+ */
+static void bench_throughput(int nops)
+{
+	uint64_t sum;
+	kthread_t tids[2*NPEERS];
+	struct peer peers[2*NPEERS];
+	int nproducers = throughput.nproducers;
+	int npeers;
+
+	npeers = nproducers + throughput.nconsumers;
+
+	/* Producers split items evenly, and so do consumers. */
+	for (int i = 0; i < npeers; i++)
+	{
+		int n = (i < nproducers) ? nproducers : throughput.nconsumers;
+
+		peers[i].batch = throughput.batch;
+		peers[i].first = 1 + ((i < nproducers) ? i : 0)*(nops/n);
+		peers[i].nitems = nops/n;
+		peers[i].sum = 0;
+	}
+
+	for (int i = 0; i < npeers; i++)
+	{
+		uassert(uthread_create(&tids[i],
+			(i < nproducers) ? throughput.producer : throughput.consumer, &peers[i]) == 0
+		);
+	}
+	for (int i = 0; i < npeers; i++)
+		uassert(kthread_join(tids[i], NULL) == 0);
+
+	/* Every item was consumed exactly once. */
+	sum = 0;
+	for (int i = nproducers; i < npeers; i++)
+		sum += peers[i].sum;
+	uassert(sum == ((uint64_t) nops*(nops + 1))/2);
+}
+
+/**
+ * @brief Benchmarks the throughput of a queue.
+ *
+ * @param name       Benchmark name.
+ * @param producer   Producer routine.
+ * @param consumer   Consumer routine.
+ * @param nproducers Number of producers.
+ * @param nconsumers Number of consumers.
+ * @param batch      Use batch operations?
+ */
+static void benchmark_throughput(
+	const char *name,
+	void *(*producer)(void *),
+	void *(*consumer)(void *),
+	int nproducers,
+	int nconsumers,
+	int batch
+)
+{
+	char label[32];
+	struct bench bench = { label, bench_throughput, NITEMS };
+
+	throughput.producer = producer;
+	throughput.consumer = consumer;
+	throughput.nproducers = nproducers;
+	throughput.nconsumers = nconsumers;
+	throughput.batch = batch;
+
+	usnprintf(label, sizeof(label), "%s%s-%dp%dc",
+		name, batch ? "-batch" : "", nproducers, nconsumers
+	);
+	bench_run_n("queue", &bench, 1, BENCH_RUNS_THREADS);
+}
+
+/*============================================================================*
+ * Latency                                                                    *
+ *============================================================================*/
+
+/**
+ * @brief Echoes items back through the single-producer single-consumer
+ * queues.
+ *
+ * @param arg Number of round trips.
+ */
+static void *spsc_echo(void *arg)
+{
+	void *item;
+	unsigned spins;
+
+	for (intptr_t i = 0; i < (intptr_t) arg; i++)
+	{
+		for (spins = 0; uspsc_pop(&spsc, &item) != 0; /* noop */)
+			backoff(&spins);
+		for (spins = 0; uspsc_push(&spsc_back, item) != 0; /* noop */)
+			backoff(&spins);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Sends items through single-producer single-consumer queues
+ * and waits for them to come back.
+ *
+ * @param nops Number of round trips.
+ */
+static void bench_latency(int nops)
+{
+	kthread_t tid;
+	void *item;
+	unsigned spins;
+
+	uassert(uthread_create(&tid, spsc_echo, (void *) (intptr_t) nops) == 0);
+	for (int i = 0; i < nops; i++)
+	{
+		for (spins = 0; uspsc_push(&spsc, (void *) (uintptr_t) i) != 0; /* noop */)
+			backoff(&spins);
+		for (spins = 0; uspsc_pop(&spsc_back, &item) != 0; /* noop */)
+			backoff(&spins);
+		uassert(item == (void *) (uintptr_t) i);
+	}
+	uassert(kthread_join(tid, NULL) == 0);
+}
+
+/**
+ * @brief Benchmarks the round-trip latency of single-producer
+ * single-consumer queues.
+ */
+static void benchmark_latency(void)
+{
+	static const struct bench benchs[] = {
+		{ "uspsc-roundtrip", bench_latency, NROUNDS },
+	};
+
+	uassert(uspsc_init(&spsc_back, CAPACITY) == 0);
+
+	bench_run_n("queue", benchs, sizeof(benchs)/sizeof(benchs[0]), BENCH_RUNS_THREADS);
+
+	uspsc_destroy(&spsc_back);
+}
+
+/**
+ * @brief Benchmarks queues.
+ */
+void benchmark_queue(void)
+{
+	test_queue_api();
+
+	uassert(uspsc_init(&spsc, CAPACITY) == 0);
+	uassert(umpmc_init(&mpmc, CAPACITY) == 0);
+
+	if (NPEERS >= 1)
+	{
+		benchmark_throughput("uspsc", spsc_producer, spsc_consumer, 1, 1, 0);
+		benchmark_throughput("uspsc", spsc_producer, spsc_consumer, 1, 1, 1);
+		benchmark_latency();
+	}
+
+	for (int np = 1; np <= NPEERS; np++)
+	{
+		for (int nc = 1; nc <= NPEERS; nc++)
+		{
+			benchmark_throughput("umpmc", mpmc_producer, mpmc_consumer, np, nc, 0);
+			benchmark_throughput("umpmc", mpmc_producer, mpmc_consumer, np, nc, 1);
+		}
+	}
+
+	uspsc_destroy(&spsc);
+	umpmc_destroy(&mpmc);
+}
@@ -0,0 +1,217 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of keys.
+ */
+#define NKEYS 2048
+
+/**
+ * @name Keys and Values
+ */
+/**@{*/
+static uint32_t keys32[NKEYS];
+static uint32_t work32[NKEYS];
+static uint32_t vals32[NKEYS];
+static uint64_t keys64[NKEYS];
+static uint64_t work64[NKEYS];
+static uint64_t vals64[NKEYS];
+/**@}*/
+
+/**
+ * @brief Scratch buffer.
+ */
+static uint64_t scratch[URADIX_SCRATCH_SIZE(NKEYS, 8, 8)/sizeof(uint64_t)];
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile uint64_t sink;
+
+/**
+ * @brief Fills keys.
+ *
+ * @param n      Number of keys.
+ * @param sorted Ascending keys?
+ * @param mask   Bits that may be set in keys.
+ */
+static void fill(int n, int sorted, uint64_t mask)
+{
+	struct urand_state state;
+
+	urand_seed(&state, n);
+
+	for (int i = 0; i < n; i++)
+	{
+		keys64[i] = sorted ? (uint64_t) i << 20 : urand64(&state) & mask;
+		keys32[i] = (uint32_t) keys64[i] ^ (uint32_t) (keys64[i] >> 32);
+		if (sorted)
+			keys32[i] = i;
+	}
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks radix sorts against comparison sorts.
+ */
+static void test_radix(void)
+{
+	static const int sizes[] = { 0, 1, 2, 3, 100, 1000, NKEYS };
+	static const uint64_t masks[] = {
+		~((uint64_t) 0),        /* All digits differ.        */
+		0xff00000000000000ULL,  /* A single digit differs.   */
+		0x0000000000000f0fULL,  /* Few distinct keys.        */
+		0                       /* Equal keys.               */
+	};
+
+	uassert(uradix_sort_u32(NULL, 1, NULL) == -EINVAL);
+	uassert(uradix_sort_u64_kv(work64, NULL, 1, NULL) == -EINVAL);
+
+	for (int m = 0; m < (int) (sizeof(masks)/sizeof(masks[0])); m++)
+	{
+		for (int s = 0; s < (int) (sizeof(sizes)/sizeof(sizes[0])); s++)
+		{
+			int n = sizes[s];
+
+			fill(n, 0, masks[m]);
+
+			/* Keys only, with and without a scratch buffer. */
+			umemcpy(work32, keys32, n*sizeof(uint32_t));
+			uassert(uradix_sort_u32(work32, n, (n & 1) ? NULL : scratch) == 0);
+			usort_u32(keys32, n);
+			uassert(umemcmp(work32, keys32, n*sizeof(uint32_t)) == 0);
+
+			umemcpy(work64, keys64, n*sizeof(uint64_t));
+			uassert(uradix_sort_u64(work64, n, (n & 1) ? scratch : NULL) == 0);
+			usort_u64(keys64, n);
+			uassert(umemcmp(work64, keys64, n*sizeof(uint64_t)) == 0);
+
+			/* Values follow keys, and equal keys keep their order. */
+			fill(n, 0, masks[m]);
+			for (int i = 0; i < n; i++)
+			{
+				vals32[i] = i;
+				vals64[i] = keys64[i] ^ i;
+			}
+
+			uassert(uradix_sort_u32_kv(keys32, vals32, n, scratch) == 0);
+			uassert(uradix_sort_u64_kv(keys64, vals64, n, (n < NKEYS) ? NULL : scratch) == 0);
+			for (int i = 1; i < n; i++)
+			{
+				uassert(keys32[i - 1] <= keys32[i]);
+				uassert((keys32[i - 1] < keys32[i]) || (vals32[i - 1] < vals32[i]));
+				uassert(keys64[i - 1] <= keys64[i]);
+			}
+			for (int i = 0; i < n; i++)
+				uassert((vals64[i] ^ keys64[i]) < (uint64_t) n);
+		}
+	}
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Radix sorts 32-bit keys.
+ */
+static void bench_radix_u32(int nops)
+{
+	umemcpy(work32, keys32, nops*sizeof(uint32_t));
+	uradix_sort_u32(work32, nops, scratch);
+	sink = work32[0];
+}
+
+/**
+ * @brief Comparison sorts 32-bit keys.
+ */
+static void bench_usort_u32(int nops)
+{
+	umemcpy(work32, keys32, nops*sizeof(uint32_t));
+	usort_u32(work32, nops);
+	sink = work32[0];
+}
+
+/**
+ * @brief Radix sorts 64-bit keys.
+ */
+static void bench_radix_u64(int nops)
+{
+	umemcpy(work64, keys64, nops*sizeof(uint64_t));
+	uradix_sort_u64(work64, nops, scratch);
+	sink = work64[0];
+}
+
+/**
+ * @brief Comparison sorts 64-bit keys.
+ */
+static void bench_usort_u64(int nops)
+{
+	umemcpy(work64, keys64, nops*sizeof(uint64_t));
+	usort_u64(work64, nops);
+	sink = work64[0];
+}
+
+/**
+ * @brief Radix sorts 32-bit keys and values.
+ */
+static void bench_radix_u32_kv(int nops)
+{
+	umemcpy(work32, keys32, nops*sizeof(uint32_t));
+	uradix_sort_u32_kv(work32, vals32, nops, scratch);
+	sink = work32[0];
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "uradix_sort_u32",     bench_radix_u32,     NKEYS },
+	{ "usort_u32",           bench_usort_u32,     NKEYS },
+	{ "uradix_sort_u64",     bench_radix_u64,     NKEYS },
+	{ "usort_u64",           bench_usort_u64,     NKEYS },
+	{ "uradix_sort_u32_kv",  bench_radix_u32_kv,  NKEYS },
+};
+
+/**
+ * @brief Benchmarks radix sorts.
+ */
+void benchmark_radix(void)
+{
+	test_radix();
+
+	fill(NKEYS, 0, ~((uint64_t) 0));
+	bench_run("radix-random", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	fill(NKEYS, 1, 0);
+	bench_run("radix-sorted", benchs, sizeof(benchs)/sizeof(benchs[0]));
+}
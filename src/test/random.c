@@ -0,0 +1,442 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Size of buffers filled by benchmarks (in 64-bit words).
+ */
+#define NWORDS 256
+
+/**
+ * @brief Number of operations in a benchmark run.
+ */
+#define NOPS 1000
+
+/**
+ * @brief Number of default streams checked.
+ */
+#define NSTREAMS 6
+
+/**
+ * @brief Number of histogram bins for the normal distribution.
+ */
+#define NBINS_NORMAL 8
+
+/**
+ * @brief Number of histogram bins for the exponential distribution.
+ */
+#define NBINS_EXPONENTIAL 5
+
+/**
+ * @name Chi-Square Critical Values at 0.01% Significance
+ */
+/**@{*/
+#define CHI2_NORMAL      29.88 /**< Seven degrees of freedom. */
+#define CHI2_EXPONENTIAL 23.51 /**< Four degrees of freedom.  */
+/**@}*/
+
+/**
+ * @brief Shared stream and per-thread streams.
+ */
+static struct urand_state streams_self[NSTREAMS];
+
+/**
+ * @brief Draws of short-lived threads.
+ */
+static struct drawn
+{
+	struct urand_state *state; /**< Default stream of the thread. */
+	uint32_t x;                /**< First number drawn.           */
+} drawn[NSTREAMS - 2];
+
+/**
+ * @brief Sink that keeps the compiler from discarding random numbers.
+ */
+static volatile uint64_t sink;
+
+/**
+ * @brief Sink that keeps the compiler from discarding random variates.
+ */
+static volatile double dsink;
+
+/**
+ * @brief Probabilities of unit-wide bins of the standard normal
+ * distribution, from (-inf, -3) to [3, inf).
+ */
+static const double pnormal[NBINS_NORMAL] = {
+	0.0013499, 0.0214002, 0.1359051, 0.3413447,
+	0.3413447, 0.1359051, 0.0214002, 0.0013499
+};
+
+/**
+ * @brief Probabilities of unit-wide bins of the exponential
+ * distribution, from [0, 1) to [4, inf).
+ */
+static const double pexponential[NBINS_EXPONENTIAL] = {
+	0.6321206, 0.2325442, 0.0855482, 0.0314714, 0.0183156
+};
+
+/**
+ * @brief Buffer filled by benchmarks.
+ */
+static uint64_t words[NWORDS];
+
+/**
+ * @brief Checks the random number generator.
+ */
+static void test_random_api(void)
+{
+	uint64_t buf[3];
+	struct urand_state s1, s2;
+
+	/* Reference outputs of xoshiro256** seeded by splitmix64. */
+	urand_seed(&s1, 0);
+	uassert(urand64(&s1) == 0x99ec5f36cb75f2b4ULL);
+	uassert(urand64(&s1) == 0xbf6e1f784956452aULL);
+	uassert(urand32(&s1) == 0x1a5f849dU);
+
+	/* Bulk output matches single outputs. */
+	urand_seed(&s1, 42);
+	urand_seed(&s2, 42);
+	urand_fill(&s1, buf, sizeof(buf));
+	for (int i = 0; i < 3; i++)
+		uassert(buf[i] == urand64(&s2));
+	uassert(urand64(&s1) == urand64(&s2));
+}
+
+/**
+ * @brief Draws from the default stream of the calling thread.
+ *
+ * @param arg Where to store the stream and the number drawn.
+ */
+static void *draw(void *arg)
+{
+	struct drawn *d = arg;
+
+	d->state = urand_self();
+	d->x = urand32(d->state);
+
+	return (NULL);
+}
+
+/**
+ * @brief Checks random number streams.
+ */
+static void test_random_streams(void)
+{
+	int r;
+	struct urand_state s;
+	struct urand_state streams[4];
+
+	/* Reference output after a jump. */
+	urand_seed(&s, 0);
+	urand_jump(&s);
+	uassert(urand64(&s) == 0x376215edc846d62cULL);
+
+	/* Stream i is stream i - 1 jumped once. */
+	urand_streams(streams, 4, 0);
+	urand_seed(&s, 0);
+	for (int i = 0; i < 4; i++)
+	{
+		uassert(urand64(&streams[i]) == urand64(&s));
+		urand_seed(&s, 0);
+		for (int j = 0; j <= i; j++)
+			urand_jump(&s);
+	}
+
+	/* Default stream only depends on the seed. */
+	usrand(5);
+	r = urand();
+	uassert(r >= 0);
+	usrand(5);
+	uassert(urand() == r);
+	uassert(urand_self() == urand_self());
+
+	/* Default streams are handed out in claim order. */
+	usrand(7);
+	urand_streams(streams_self, NSTREAMS, 7);
+	uassert(umemcmp(urand_self(), &streams_self[1], sizeof(s)) == 0);
+	uassert(__urand_shared() == urand32(&streams_self[0]));
+
+	/* Threads that reuse a slot get a new stream. */
+	for (int i = 0; i < NSTREAMS - 2; i++)
+	{
+		kthread_t tid;
+
+		uassert(uthread_create(&tid, draw, &drawn[i]) == 0);
+		uassert(kthread_join(tid, NULL) == 0);
+		uassert(drawn[i].state == drawn[0].state);
+		uassert(drawn[i].x == urand32(&streams_self[i + 2]));
+		for (int j = 0; j < i; j++)
+			uassert(drawn[i].x != drawn[j].x);
+	}
+}
+
+/**
+ * @brief Computes the chi-square statistic of a histogram.
+ *
+ * @param counts Observed counts.
+ * @param p      Expected probabilities.
+ * @param nbins  Number of bins.
+ * @param n      Number of samples.
+ *
+ * @returns The chi-square statistic.
+ */
+static double chi2(const unsigned *counts, const double *p, int nbins, unsigned n)
+{
+	double e, d;
+	double stat;
+
+	stat = 0;
+	for (int i = 0; i < nbins; i++)
+	{
+		e = p[i]*n;
+		d = counts[i] - e;
+		stat += d*d/e;
+	}
+
+	return (stat);
+}
+
+/**
+ * @brief Checks non-uniform distributions with histograms.
+ */
+static void test_random_distributions(void)
+{
+	int b;
+	double x;
+	double sum, sum2;
+	unsigned counts[NBINS_NORMAL];
+	struct urand_state s;
+
+	urand_seed(&s, 11);
+
+	/* Uniform. */
+	for (int i = 0; i < 1000; i++)
+	{
+		x = urand_double(&s);
+		uassert((x >= 0) && (x < 1));
+		x = urand_float(&s);
+		uassert((x >= 0) && (x < 1));
+	}
+
+	/* Normal. */
+	sum = sum2 = 0;
+	umemset(counts, 0, sizeof(counts));
+	for (int i = 0; i < NOPERATIONS; i++)
+	{
+		x = urand_normal(&s);
+		sum += x;
+		sum2 += x*x;
+		b = (x < -3) ? 0 : (x >= 3) ? NBINS_NORMAL - 1 : (int) (x + 4);
+		counts[b]++;
+	}
+	uassert((sum/NOPERATIONS > -0.02) && (sum/NOPERATIONS < 0.02));
+	uassert((sum2/NOPERATIONS > 0.98) && (sum2/NOPERATIONS < 1.02));
+	uassert(chi2(counts, pnormal, NBINS_NORMAL, NOPERATIONS) < CHI2_NORMAL);
+
+	/* Exponential. */
+	sum = 0;
+	umemset(counts, 0, sizeof(counts));
+	for (int i = 0; i < NOPERATIONS; i++)
+	{
+		x = urand_exponential(&s);
+		uassert(x >= 0);
+		sum += x;
+		b = (x >= NBINS_EXPONENTIAL - 1) ? NBINS_EXPONENTIAL - 1 : (int) x;
+		counts[b]++;
+	}
+	uassert((sum/NOPERATIONS > 0.98) && (sum/NOPERATIONS < 1.02));
+	uassert(chi2(counts, pexponential, NBINS_EXPONENTIAL, NOPERATIONS) < CHI2_EXPONENTIAL);
+}
+
+/**
+ * @brief Checks bounded random numbers.
+ */
+static void test_random_range(void)
+{
+	int seen;
+	int32_t x;
+	unsigned counts[6];
+	unsigned perm[NWORDS];
+	unsigned sample[16];
+	struct urand_state s;
+
+	urand_seed(&s, 7);
+
+	/* Bounds. */
+	uassert(urand_range(&s, 0) == 0);
+	uassert(urand_range(&s, 1) == 0);
+	for (int i = 0; i < 1000; i++)
+	{
+		uassert(urand_range(&s, 3) < 3);
+		uassert(urand_range64(&s, 1ULL << 40) < (1ULL << 40));
+		x = urand_between(&s, -5, 5);
+		uassert((x >= -5) && (x <= 5));
+	}
+	uassert(urand_between(&s, 9, 9) == 9);
+
+	/* Every value is about equally likely. */
+	umemset(counts, 0, sizeof(counts));
+	for (int i = 0; i < 6000; i++)
+		counts[urand_range(&s, 6)]++;
+	for (int i = 0; i < 6; i++)
+		uassert((counts[i] > 850) && (counts[i] < 1150));
+
+	/* Shuffling yields a permutation. */
+	for (unsigned i = 0; i < NWORDS; i++)
+		perm[i] = i;
+	ushuffle(&s, perm, NWORDS, sizeof(unsigned));
+	for (unsigned i = 0; i < NWORDS; i++)
+	{
+		seen = 0;
+		for (unsigned j = 0; j < NWORDS; j++)
+			seen += (perm[j] == i);
+		uassert(seen == 1);
+	}
+
+	/* Samples are distinct elements of the source. */
+	uassert(usample(&s, sample, 16, perm, NWORDS, sizeof(unsigned)) == 16);
+	for (int i = 0; i < 16; i++)
+	{
+		uassert(sample[i] < NWORDS);
+		for (int j = 0; j < i; j++)
+			uassert(sample[i] != sample[j]);
+	}
+	uassert(usample(&s, sample, 16, perm, 4, sizeof(unsigned)) == 4);
+}
+
+/**
+ * @brief State of urand_r() in benchmarks.
+ */
+static unsigned bench_seed;
+
+/**
+ * @brief Generator in benchmarks.
+ */
+static struct urand_state bench_state;
+
+/**
+ * @brief Defines a benchmark of a random number generator.
+ *
+ * @param fn  Benchmark function.
+ * @param gen Generator call.
+ */
+#define BENCH_GENERATOR(fn, gen)               \
+static void fn(int nops)                       \
+{                                              \
+	uint64_t acc = 0;                          \
+                                               \
+	for (int i = 0; i < nops; i++)             \
+		acc += (uint64_t) (gen);               \
+                                               \
+	sink = acc;                                \
+}
+
+/**
+ * @brief Defines a benchmark of a random variate generator.
+ *
+ * @param fn  Benchmark function.
+ * @param gen Generator call.
+ */
+#define BENCH_VARIATE(fn, gen)                 \
+static void fn(int nops)                       \
+{                                              \
+	double acc = 0;                            \
+                                               \
+	for (int i = 0; i < nops; i++)             \
+		acc += (gen);                          \
+                                               \
+	dsink = acc;                               \
+}
+
+BENCH_GENERATOR(bench_urand, urand())
+BENCH_GENERATOR(bench_urand_r, urand_r(&bench_seed))
+BENCH_GENERATOR(bench_urand32, urand32(&bench_state))
+BENCH_GENERATOR(bench_urand64, urand64(&bench_state))
+BENCH_GENERATOR(bench_urand_mod, urand() % (unsigned) (i + 1))
+BENCH_GENERATOR(bench_urand_range, urand_range(&bench_state, (uint32_t) (i + 1)))
+BENCH_GENERATOR(bench_urand_between, urand_between(&bench_state, -1000, 1000))
+BENCH_VARIATE(bench_urand_double, urand_double(&bench_state))
+BENCH_VARIATE(bench_urand_float, urand_float(&bench_state))
+BENCH_VARIATE(bench_urand_normal, urand_normal(&bench_state))
+BENCH_VARIATE(bench_urand_exponential, urand_exponential(&bench_state))
+
+/**
+ * @brief Fills a buffer with random words.
+ */
+static void bench_urand_fill(int nops)
+{
+	urand_fill(&bench_state, words, (size_t) nops*sizeof(uint64_t));
+	sink = words[0];
+}
+
+/**
+ * @brief Shuffles a buffer of words.
+ */
+static void bench_ushuffle(int nops)
+{
+	ushuffle(&bench_state, words, (size_t) nops, sizeof(uint64_t));
+	sink = words[0];
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "urand",             bench_urand,             NOPS   },
+	{ "urand_r",           bench_urand_r,           NOPS   },
+	{ "urand32",           bench_urand32,           NOPS   },
+	{ "urand64",           bench_urand64,           NOPS   },
+	{ "urand_fill",        bench_urand_fill,        NWORDS },
+	{ "urand-mod",         bench_urand_mod,         NOPS   },
+	{ "urand_range",       bench_urand_range,       NOPS   },
+	{ "urand_between",     bench_urand_between,     NOPS   },
+	{ "ushuffle",          bench_ushuffle,          NWORDS },
+	{ "urand_double",      bench_urand_double,      NOPS   },
+	{ "urand_float",       bench_urand_float,       NOPS   },
+	{ "urand_normal",      bench_urand_normal,      NOPS   },
+	{ "urand_exponential", bench_urand_exponential, NOPS   },
+};
+
+/**
+ * @brief Benchmarks random number generation.
+ */
+void benchmark_random(void)
+{
+	test_random_api();
+	test_random_streams();
+	test_random_range();
+	test_random_distributions();
+
+	bench_seed = 1;
+	urand_seed(&bench_state, 1);
+
+	bench_run("random", benchs, sizeof(benchs)/sizeof(benchs[0]));
+}
@@ -0,0 +1,423 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of elements in test arrays.
+ */
+#define NELEMS 4096
+
+/**
+ * @brief Number of elements sorted by benchmarks.
+ */
+#define NBENCH 1024
+
+/**
+ * @name Arrays
+ */
+/**@{*/
+static int keys[NELEMS];
+static int work[NELEMS];
+static uint64_t keys64[NBENCH];
+static uint64_t work64[NBENCH];
+/**@}*/
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile uintptr_t sink;
+
+/**
+ * @brief Record that is not made of words.
+ */
+struct triple
+{
+	unsigned char key; /**< Key.                  */
+	unsigned char a;   /**< Copy of the key.      */
+	unsigned char b;   /**< Complement of the key. */
+};
+
+/**
+ * @brief Record with a payload.
+ */
+struct record
+{
+	uint32_t key;   /**< Key.                   */
+	uint32_t index; /**< Position before sort.  */
+	uint32_t check; /**< Function of the above. */
+};
+
+/**
+ * @brief Instance with helpers in reach of tests.
+ */
+USORT_DEFINE(static, test, int, USORT_LESS)
+
+/**
+ * @brief Compares integers.
+ */
+static int cmp_int(const void *a, const void *b)
+{
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+
+	return ((x > y) - (x < y));
+}
+
+/**
+ * @brief Compares 64-bit integers.
+ */
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a;
+	uint64_t y = *(const uint64_t *) b;
+
+	return ((x > y) - (x < y));
+}
+
+/**
+ * @brief Compares triples.
+ */
+static int cmp_triple(const void *a, const void *b)
+{
+	return (((const struct triple *) a)->key - ((const struct triple *) b)->key);
+}
+
+/**
+ * @brief Compares records.
+ */
+static int cmp_record(const void *a, const void *b)
+{
+	uint32_t x = ((const struct record *) a)->key;
+	uint32_t y = ((const struct record *) b)->key;
+
+	return ((x > y) - (x < y));
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Input patterns.
+ */
+enum pattern
+{
+	RANDOM,    /**< Random keys.             */
+	SORTED,    /**< Ascending keys.          */
+	REVERSED,  /**< Descending keys.         */
+	EQUAL,     /**< A single key.            */
+	ORGANPIPE, /**< Ascending then descending. */
+	FEW,       /**< Few distinct keys.       */
+	NPATTERNS  /**< Number of patterns.      */
+};
+
+/**
+ * @brief Fills an array with a pattern.
+ */
+static void fill(int *a, int n, enum pattern pattern)
+{
+	struct urand_state state;
+
+	urand_seed(&state, n);
+
+	for (int i = 0; i < n; i++)
+	{
+		switch (pattern)
+		{
+			case RANDOM:    a[i] = (int) urand32(&state); break;
+			case SORTED:    a[i] = i; break;
+			case REVERSED:  a[i] = n - i; break;
+			case EQUAL:     a[i] = 42; break;
+			case ORGANPIPE: a[i] = (i < n/2) ? i : n - i; break;
+			case FEW:       a[i] = (int) urand_range(&state, 4); break;
+			default:        a[i] = 0; break;
+		}
+	}
+}
+
+/**
+ * @brief Checks that an array is a sorted permutation of another one.
+ */
+static void check_sorted(const int *a, const int *orig, int n)
+{
+	uint32_t sum = 0, xor = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		if (i > 0)
+			uassert(a[i - 1] <= a[i]);
+		sum += (uint32_t) a[i] - (uint32_t) orig[i];
+		xor ^= (uint32_t) a[i] ^ (uint32_t) orig[i];
+	}
+
+	uassert((sum == 0) && (xor == 0));
+}
+
+/**
+ * @brief Checks sorting of integers.
+ */
+static void test_sort_int(void)
+{
+	static const int sizes[] = { 0, 1, 2, 3, 15, 16, 17, 100, 1000, NELEMS };
+
+	for (int p = 0; p < NPATTERNS; p++)
+	{
+		for (int s = 0; s < (int) (sizeof(sizes)/sizeof(sizes[0])); s++)
+		{
+			int n = sizes[s];
+
+			fill(keys, n, p);
+
+			umemcpy(work, keys, n*sizeof(int));
+			uqsort(work, n, sizeof(int), cmp_int);
+			check_sorted(work, keys, n);
+
+			umemcpy(work, keys, n*sizeof(int));
+			usort_int(work, n);
+			check_sorted(work, keys, n);
+
+			umemcpy(work, keys, n*sizeof(int));
+			usort_test_heap(work, n);
+			check_sorted(work, keys, n);
+		}
+	}
+}
+
+/**
+ * @brief Checks sorting of records.
+ */
+static void test_sort_records(void)
+{
+	static struct triple triples[257];
+	static struct record records[1000];
+	struct urand_state state;
+
+	urand_seed(&state, 1);
+
+	/* Byte swaps. */
+	for (int i = 0; i < 257; i++)
+	{
+		triples[i].key = triples[i].a = (unsigned char) urand32(&state);
+		triples[i].b = ~triples[i].key;
+	}
+	uqsort(triples, 257, sizeof(struct triple), cmp_triple);
+	for (int i = 0; i < 257; i++)
+	{
+		uassert((i == 0) || (triples[i - 1].key <= triples[i].key));
+		uassert(triples[i].a == triples[i].key);
+		uassert(triples[i].b == (unsigned char) ~triples[i].key);
+	}
+
+	/* Word swaps of multi-word records. */
+	for (int i = 0; i < 1000; i++)
+	{
+		records[i].key = urand_range(&state, 100);
+		records[i].index = i;
+		records[i].check = records[i].key*1000 + i;
+	}
+	uqsort(records, 1000, sizeof(struct record), cmp_record);
+	for (int i = 0; i < 1000; i++)
+	{
+		uassert((i == 0) || (records[i - 1].key <= records[i].key));
+		uassert(records[i].check == records[i].key*1000 + records[i].index);
+	}
+}
+
+/**
+ * @brief Checks searching.
+ */
+static void test_search(void)
+{
+	static void *ptrs[64];
+	int key;
+
+	/* Even keys. */
+	for (int i = 0; i < NELEMS; i++)
+		keys[i] = 2*i;
+
+	uassert(ubsearch(&key, keys, 0, sizeof(int), cmp_int) == NULL);
+	uassert(ubsearch_int(0, keys, 0) == NULL);
+
+	for (int n = 1; n <= 64; n++)
+	{
+		for (key = -1; key <= 2*n; key++)
+		{
+			int *p = ubsearch(&key, keys, n, sizeof(int), cmp_int);
+			int *q = ubsearch_int(key, keys, n);
+
+			if ((key & 1) || (key < 0) || (key >= 2*n))
+				uassert((p == NULL) && (q == NULL));
+			else
+				uassert((p == &keys[key/2]) && (q == &keys[key/2]));
+		}
+	}
+
+	for (key = 0; key < 2*NELEMS; key++)
+	{
+		int *q = ubsearch_int(key, keys, NELEMS);
+		uassert((key & 1) ? (q == NULL) : (q == &keys[key/2]));
+	}
+
+	/* Other variants. */
+	for (int i = 0; i < NBENCH; i++)
+		keys64[i] = (uint64_t) i << 33;
+	uassert(ubsearch_u64((uint64_t) 7 << 33, keys64, NBENCH) == &keys64[7]);
+	uassert(ubsearch_u64(1, keys64, NBENCH) == NULL);
+
+	for (int i = 0; i < 64; i++)
+		ptrs[i] = &keys[(i*37) % 64];
+	usort_ptr(ptrs, 64);
+	for (int i = 0; i < 64; i++)
+		uassert(ptrs[i] == &keys[i]);
+	uassert(ubsearch_ptr(&keys[5], ptrs, 64) == &ptrs[5]);
+	uassert(ubsearch_ptr(&keys[64], ptrs, 64) == NULL);
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Sorts integers with a callback.
+ */
+static void bench_uqsort_int(int nops)
+{
+	umemcpy(work, keys, nops*sizeof(int));
+	uqsort(work, nops, sizeof(int), cmp_int);
+	sink = work[0];
+}
+
+/**
+ * @brief Sorts integers with an inlined comparison.
+ */
+static void bench_usort_int(int nops)
+{
+	umemcpy(work, keys, nops*sizeof(int));
+	usort_int(work, nops);
+	sink = work[0];
+}
+
+/**
+ * @brief Sorts integers by insertion.
+ */
+static void bench_insertion_int(int nops)
+{
+	umemcpy(work, keys, nops*sizeof(int));
+	usort_test_insertion(work, nops);
+	sink = work[0];
+}
+
+/**
+ * @brief Sorts 64-bit integers with a callback.
+ */
+static void bench_uqsort_u64(int nops)
+{
+	umemcpy(work64, keys64, nops*sizeof(uint64_t));
+	uqsort(work64, nops, sizeof(uint64_t), cmp_u64);
+	sink = (uintptr_t) work64[0];
+}
+
+/**
+ * @brief Sorts 64-bit integers with an inlined comparison.
+ */
+static void bench_usort_u64(int nops)
+{
+	umemcpy(work64, keys64, nops*sizeof(uint64_t));
+	usort_u64(work64, nops);
+	sink = (uintptr_t) work64[0];
+}
+
+/**
+ * @brief Searches integers with a callback.
+ */
+static void bench_ubsearch_int(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int key = 0; key < nops; key++)
+		acc += (uintptr_t) ubsearch(&key, work, nops, sizeof(int), cmp_int);
+
+	sink = acc;
+}
+
+/**
+ * @brief Searches integers with an inlined comparison.
+ */
+static void bench_ubsearch_int_inline(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int key = 0; key < nops; key++)
+		acc += (uintptr_t) ubsearch_int(key, work, nops);
+
+	sink = acc;
+}
+
+/**
+ * @brief Registered sort benchmarks.
+ */
+static const struct bench sorts[] = {
+	{ "uqsort-int",          bench_uqsort_int,          NBENCH },
+	{ "usort_int",           bench_usort_int,           NBENCH },
+	{ "insertion-int",       bench_insertion_int,       NBENCH },
+	{ "uqsort-u64",          bench_uqsort_u64,          NBENCH },
+	{ "usort_u64",           bench_usort_u64,           NBENCH },
+};
+
+/**
+ * @brief Registered search benchmarks.
+ */
+static const struct bench searches[] = {
+	{ "ubsearch-int",        bench_ubsearch_int,        NBENCH },
+	{ "ubsearch_int",        bench_ubsearch_int_inline, NBENCH },
+};
+
+/**
+ * @brief Benchmarks sorting and searching.
+ */
+void benchmark_sort(void)
+{
+	struct urand_state state;
+
+	test_sort_int();
+	test_sort_records();
+	test_search();
+
+	urand_seed(&state, 0);
+	for (int i = 0; i < NBENCH; i++)
+	{
+		keys[i] = (int) urand32(&state);
+		keys64[i] = urand64(&state);
+	}
+
+	bench_run("sort", sorts, sizeof(sorts)/sizeof(sorts[0]));
+
+	for (int i = 0; i < NBENCH; i++)
+		work[i] = i;
+
+	bench_run("sort", searches, sizeof(searches)/sizeof(searches[0]));
+}
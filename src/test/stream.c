@@ -0,0 +1,557 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Capacity of the in-memory file (in bytes).
+ */
+#define FILE_SIZE (32*1024)
+
+/**
+ * @brief Number of records in benchmarks.
+ */
+#define NRECORDS 1000
+
+/**
+ * @brief File descriptor of the in-memory file.
+ */
+#define FD 3
+
+/**
+ * @brief In-memory file.
+ */
+static struct
+{
+	char data[FILE_SIZE]; /**< Contents.                      */
+	size_t len;           /**< Number of bytes written.       */
+	size_t pos;           /**< Next byte to read.             */
+	size_t chunk;         /**< Maximum bytes per call.        */
+	unsigned ncalls;      /**< Number of reads and writes.    */
+} file;
+
+/**
+ * @name Records
+ */
+/**@{*/
+static char text[FILE_SIZE];
+static size_t text_len;
+static size_t offsets[NRECORDS + 1];
+/**@}*/
+
+/**
+ * @brief Stream buffer.
+ */
+static char buffer[USTREAM_BUFSIZ_DEFAULT];
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile size_t sink;
+
+/**
+ * @brief Reads from the in-memory file.
+ */
+static ssize_t mem_read(int fd, void *buf, size_t n)
+{
+	size_t k = file.len - file.pos;
+
+	uassert(fd == FD);
+
+	if (k > n)
+		k = n;
+	if (k > file.chunk)
+		k = file.chunk;
+
+	umemcpy(buf, &file.data[file.pos], k);
+	file.pos += k;
+	file.ncalls++;
+
+	return (k);
+}
+
+/**
+ * @brief Writes to the in-memory file.
+ */
+static ssize_t mem_write(int fd, const void *buf, size_t n)
+{
+	size_t k = FILE_SIZE - file.len;
+
+	uassert(fd == FD);
+
+	if (k > n)
+		k = n;
+	if (k > file.chunk)
+		k = file.chunk;
+	if (k == 0)
+		return (-ENOSPC);
+
+	umemcpy(&file.data[file.len], buf, k);
+	file.len += k;
+	file.ncalls++;
+
+	return (k);
+}
+
+/**
+ * @brief Fails to read or write.
+ */
+static ssize_t bad_read(int fd, void *buf, size_t n)
+{
+	((void) fd);
+	((void) buf);
+	((void) n);
+
+	return (-EIO);
+}
+
+/**
+ * @brief Input and output routines of the in-memory file.
+ */
+static const struct ustream_io mem_io = { mem_read, mem_write };
+
+/**
+ * @brief Input routines that fail.
+ */
+static const struct ustream_io bad_io = { bad_read, mem_write };
+
+/**
+ * @brief Resets the in-memory file.
+ *
+ * @param chunk Maximum bytes per call.
+ */
+static void file_reset(size_t chunk)
+{
+	file.len = 0;
+	file.pos = 0;
+	file.chunk = chunk;
+	file.ncalls = 0;
+}
+
+/**
+ * @brief Generates records of varying lengths.
+ *
+ * @param nrecords Number of records.
+ * @param longest  Longest payload.
+ */
+static void gen_records(int nrecords, int longest)
+{
+	struct urand_state state;
+
+	urand_seed(&state, longest);
+
+	text_len = 0;
+	for (int i = 0; i < nrecords; i++)
+	{
+		int len = urand_range(&state, longest + 1);
+
+		offsets[i] = text_len;
+		text_len += usnprintf(&text[text_len], FILE_SIZE - text_len, "%d:", i);
+		for (int j = 0; j < len; j++)
+			text[text_len++] = 'a' + (i + j) % 26;
+		text[text_len++] = '\n';
+	}
+	offsets[nrecords] = text_len;
+}
+
+/**
+ * @brief Returns the number of bytes in use in the heap.
+ */
+static size_t heap_used(void)
+{
+	struct umalloc_stats stats;
+
+	uassert(umalloc_check(&stats) == 0);
+
+	return (stats.used_size);
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks writes and reads of records.
+ */
+static void test_stream_rw(void)
+{
+	static const size_t chunks[] = { 1, 7, FILE_SIZE };
+	static const size_t sizes[] = { 16, 64, USTREAM_BUFSIZ_DEFAULT };
+	static char in[FILE_SIZE];
+	struct ustream s;
+
+	gen_records(200, 100);
+
+	for (int c = 0; c < 3; c++)
+	{
+		for (int b = 0; b < 3; b++)
+		{
+			size_t total = 0;
+
+			/* Write records, and a long one every now and then. */
+			file_reset(chunks[c]);
+			uassert(ustream_open(&s, FD, USTREAM_WRITE, buffer, sizes[b]) == 0);
+			ustream_setio(&s, &mem_io);
+			for (int i = 0; i < 200; i += (i % 50 == 0) ? 10 : 1)
+			{
+				int j = (i % 50 == 0) ? i + 10 : i + 1;
+				size_t n = offsets[j] - offsets[i];
+				uassert(ustream_write(&s, &text[offsets[i]], n) == (ssize_t) n);
+			}
+			uassert(ustream_close(&s) == 0);
+			uassert((file.len == text_len) && (umemcmp(file.data, text, text_len) == 0));
+
+			/* Calls amortise over records. */
+			if (chunks[c] == FILE_SIZE)
+				uassert(file.ncalls <= 2*(text_len/sizes[b] + 1));
+
+			/* Read them back in varying amounts. */
+			file.pos = 0;
+			uassert(ustream_open(&s, FD, USTREAM_READ, buffer, sizes[b]) == 0);
+			ustream_setio(&s, &mem_io);
+			for (size_t n = 1; total < text_len; n = (n*3 + 1) % 97)
+			{
+				ssize_t ret = ustream_read(&s, &in[total], n);
+				uassert((ret == (ssize_t) n) || (total + ret == text_len));
+				total += ret;
+			}
+			uassert(ustream_read(&s, in, 10) == 0);
+			uassert(umemcmp(in, text, text_len) == 0);
+
+			/* Large reads. */
+			file.pos = 0;
+			s.eof = 0;
+			uassert(ustream_read(&s, in, 5) == 5);
+			uassert(ustream_read(&s, &in[5], text_len) == (ssize_t) text_len - 5);
+			uassert(umemcmp(in, text, text_len) == 0);
+			uassert(ustream_close(&s) == 0);
+		}
+	}
+}
+
+/**
+ * @brief Checks reads of lines.
+ */
+static void test_stream_lines(void)
+{
+	static const size_t chunks[] = { 1, 7, FILE_SIZE };
+	char line[48];
+	struct ustream s;
+
+	gen_records(300, 80);
+
+	for (int c = 0; c < 3; c++)
+	{
+		size_t pos = 0;
+		ssize_t ret;
+
+		file_reset(FILE_SIZE);
+		umemcpy(file.data, text, text_len);
+		file.len = text_len - 1; /* The last line has no newline. */
+		file.chunk = chunks[c];
+
+		uassert(ustream_open(&s, FD, USTREAM_READ, NULL, 64) == 0);
+		ustream_setio(&s, &mem_io);
+
+		/* Long lines come in pieces. */
+		while ((ret = ustream_getline(&s, line, sizeof(line))) > 0)
+		{
+			const char *nl = umemchr(&text[pos], '\n', text_len - 1 - pos);
+			size_t len = (nl != NULL) ? (size_t) (nl - &text[pos]) + 1 : text_len - 1 - pos;
+
+			if (len > sizeof(line) - 1)
+				len = sizeof(line) - 1;
+
+			uassert((size_t) ret == len);
+			uassert(umemcmp(line, &text[pos], len) == 0);
+			uassert(line[len] == '\0');
+			pos += len;
+		}
+		uassert((ret == 0) && (pos == text_len - 1));
+		uassert(ustream_close(&s) == 0);
+	}
+}
+
+/**
+ * @brief Checks zero-copy parsing.
+ */
+static void test_stream_peek(void)
+{
+	struct ustream s;
+	const char *data;
+	ssize_t avail;
+	int i = 0;
+
+	gen_records(300, 40);
+
+	file_reset(13);
+	umemcpy(file.data, text, text_len);
+	file.len = text_len;
+
+	uassert(ustream_open(&s, FD, USTREAM_READ, buffer, 64) == 0);
+	ustream_setio(&s, &mem_io);
+
+	/* Parse records in place. */
+	while ((avail = ustream_peek(&s, &data, 0)) > 0)
+	{
+		const char *nl;
+		size_t len;
+
+		/* Ask for more until the record is complete. */
+		while ((nl = umemchr(data, '\n', avail)) == NULL)
+		{
+			uassert((size_t) avail < s.size);
+			avail = ustream_peek(&s, &data, avail + 1);
+			uassert(avail > 0);
+		}
+
+		len = nl - data + 1;
+		uassert(len == offsets[i + 1] - offsets[i]);
+		uassert(umemcmp(data, &text[offsets[i]], len) == 0);
+		uassert(ustream_consume(&s, len) == 0);
+		i++;
+	}
+	uassert((avail == 0) && (i == 300));
+
+	/* Invalid requests. */
+	uassert(ustream_peek(&s, &data, s.size + 1) == -EINVAL);
+	uassert(ustream_consume(&s, 1) == -EINVAL);
+	uassert(ustream_write(&s, "x", 1) == -EBADF);
+	uassert(ustream_close(&s) == 0);
+}
+
+/**
+ * @brief Checks error handling.
+ */
+static void test_stream_errors(void)
+{
+	struct ustream s;
+	char c;
+	size_t used = heap_used();
+
+	uassert(ustream_open(NULL, FD, USTREAM_READ, NULL, 0) == -EINVAL);
+	uassert(ustream_open(&s, FD, 0, NULL, 0) == -EINVAL);
+	uassert(ustream_open(&s, FD, USTREAM_READ, buffer, 0) == -EINVAL);
+
+	/* Failed reads. */
+	uassert(ustream_open(&s, FD, USTREAM_READ, NULL, 0) == 0);
+	uassert(s.size == USTREAM_BUFSIZ_DEFAULT);
+	ustream_setio(&s, &bad_io);
+	uassert(ustream_read(&s, &c, 1) == -EIO);
+	uassert(ustream_getline(&s, &c, 1) == 0);
+	uassert(ustream_write(&s, &c, 1) == -EBADF);
+	uassert(ustream_flush(&s) == -EBADF);
+
+	/* The kernel has no input path. */
+	ustream_setio(&s, NULL);
+	uassert(ustream_read(&s, &c, 1) == -ENOTSUP);
+	uassert(ustream_close(&s) == 0);
+	uassert(heap_used() == used);
+
+	/* Failed writes keep pending bytes. */
+	file_reset(FILE_SIZE);
+	file.len = FILE_SIZE - 4;
+	uassert(ustream_open(&s, FD, USTREAM_WRITE, buffer, 16) == 0);
+	ustream_setio(&s, &mem_io);
+	uassert(ustream_write(&s, "0123456789", 10) == 10);
+	uassert(ustream_flush(&s) == -ENOSPC);
+	uassert((file.len == FILE_SIZE) && (s.len - s.pos == 6));
+	file.len = 0;
+	uassert(ustream_close(&s) == 0);
+	uassert((file.len == 6) && (umemcmp(file.data, "456789", 6) == 0));
+	uassert(ustream_read(&s, &c, 1) == -EBADF);
+
+	/* Failed writes report accepted bytes. */
+	gen_records(10, 20);
+	file_reset(FILE_SIZE);
+	file.len = FILE_SIZE - 4;
+	uassert(ustream_open(&s, FD, USTREAM_WRITE, buffer, 16) == 0);
+	ustream_setio(&s, &mem_io);
+	uassert(ustream_write(&s, text, 10) == 10);
+	uassert(ustream_write(&s, &text[10], 20) == 6);
+	uassert(ustream_write(&s, &text[16], 1) == -ENOSPC);
+	file.len = 0;
+	uassert(ustream_flush(&s) == 0);
+	uassert((file.len == 12) && (umemcmp(file.data, &text[4], 12) == 0));
+
+	/* Failed large writes report accepted bytes. */
+	file.len = FILE_SIZE - 20;
+	uassert(ustream_write(&s, text, 40) == 20);
+	uassert(umemcmp(&file.data[FILE_SIZE - 20], text, 20) == 0);
+	uassert(ustream_write(&s, text, 40) == 16);
+	uassert(ustream_write(&s, text, 40) == -ENOSPC);
+	file.len = 0;
+	uassert(ustream_close(&s) == 0);
+	uassert((file.len == 16) && (umemcmp(file.data, text, 16) == 0));
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Writes one record per call.
+ */
+static void bench_write_direct(int nrecords)
+{
+	file_reset(FILE_SIZE);
+
+	for (int i = 0; i < nrecords; i++)
+		mem_write(FD, &text[offsets[i]], offsets[i + 1] - offsets[i]);
+
+	sink = file.len;
+}
+
+/**
+ * @brief Writes records through a stream.
+ */
+static void bench_ustream_write(int nrecords)
+{
+	struct ustream s;
+
+	file_reset(FILE_SIZE);
+	ustream_open(&s, FD, USTREAM_WRITE, buffer, sizeof(buffer));
+	ustream_setio(&s, &mem_io);
+
+	for (int i = 0; i < nrecords; i++)
+		ustream_write(&s, &text[offsets[i]], offsets[i + 1] - offsets[i]);
+
+	ustream_close(&s);
+	sink = file.len;
+}
+
+/**
+ * @brief Reads records one byte per call.
+ */
+static void bench_read_bytewise(int nrecords)
+{
+	char line[128];
+	size_t acc = 0;
+
+	file.pos = 0;
+	file.ncalls = 0;
+
+	for (int i = 0; i < nrecords; i++)
+	{
+		size_t len = 0;
+
+		while ((mem_read(FD, &line[len], 1) == 1) && (line[len++] != '\n'))
+			/* noop */;
+
+		acc += len;
+	}
+
+	sink = acc;
+}
+
+/**
+ * @brief Reads records through a stream, one line at a time.
+ */
+static void bench_ustream_getline(int nrecords)
+{
+	struct ustream s;
+	char line[128];
+	size_t acc = 0;
+
+	file.pos = 0;
+	file.ncalls = 0;
+	ustream_open(&s, FD, USTREAM_READ, buffer, sizeof(buffer));
+	ustream_setio(&s, &mem_io);
+
+	for (int i = 0; i < nrecords; i++)
+		acc += ustream_getline(&s, line, sizeof(line));
+
+	ustream_close(&s);
+	sink = acc;
+}
+
+/**
+ * @brief Parses records in the buffer of a stream.
+ */
+static void bench_ustream_peek(int nrecords)
+{
+	struct ustream s;
+	const char *data;
+	size_t acc = 0;
+	ssize_t avail;
+
+	file.pos = 0;
+	file.ncalls = 0;
+	ustream_open(&s, FD, USTREAM_READ, buffer, sizeof(buffer));
+	ustream_setio(&s, &mem_io);
+
+	for (int i = 0; (i < nrecords) && ((avail = ustream_peek(&s, &data, 0)) > 0); i++)
+	{
+		const char *nl;
+
+		while ((nl = umemchr(data, '\n', avail)) == NULL)
+			avail = ustream_peek(&s, &data, avail + 1);
+
+		acc += nl - data + 1;
+		ustream_consume(&s, nl - data + 1);
+	}
+
+	ustream_close(&s);
+	sink = acc;
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "write-direct",    bench_write_direct,    NRECORDS },
+	{ "ustream_write",   bench_ustream_write,   NRECORDS },
+	{ "read-bytewise",   bench_read_bytewise,   NRECORDS },
+	{ "ustream_getline", bench_ustream_getline, NRECORDS },
+	{ "ustream_peek",    bench_ustream_peek,    NRECORDS },
+};
+
+/**
+ * @brief Benchmarks buffered streams.
+ */
+void benchmark_stream(void)
+{
+	test_stream_rw();
+	test_stream_lines();
+	test_stream_peek();
+	test_stream_errors();
+
+	/* Short records. */
+	gen_records(NRECORDS, 24);
+	file_reset(FILE_SIZE);
+	umemcpy(file.data, text, text_len);
+	file.len = text_len;
+
+	bench_run("stream", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	/* Calls to the file per run. */
+	for (int i = 0; i < (int) (sizeof(benchs)/sizeof(benchs[0])); i++)
+	{
+		benchs[i].fn(benchs[i].nops);
+		bench_metric("stream", benchs[i].name, "calls", file.ncalls);
+	}
+}
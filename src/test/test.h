@@ -0,0 +1,201 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+	#include <nanvix/ulib.h>
+	#include <posix/stdint.h>
+
+	/**
+	 * @brief Number of operations in a benchmark run.
+	 */
+	#define NOPERATIONS 100000
+
+	/**
+	 * @brief Reads the clock.
+	 *
+	 * @returns The current value of the clock, in cycles.
+	 */
+	static inline uint64_t bench_clock(void)
+	{
+		return (ucycles());
+	}
+
+	/**
+	 * @brief Number of untimed runs of a benchmark.
+	 */
+	#define BENCH_WARMUP 3
+
+	/**
+	 * @brief Number of timed runs of a benchmark.
+	 */
+	#define BENCH_RUNS 101
+
+	/**
+	 * @brief Number of timed runs of a benchmark that starts threads.
+	 */
+	#define BENCH_RUNS_THREADS 11
+
+	/**
+	 * @brief Registered benchmark.
+	 */
+	struct bench
+	{
+		const char *name;    /**< Benchmark name.               */
+		void (*fn)(int);     /**< Runs a number of operations.  */
+		int nops;            /**< Number of operations per run. */
+	};
+
+	/**
+	 * @brief Runs registered benchmarks a number of times.
+	 *
+	 * @param group   Benchmark group.
+	 * @param benchs  Benchmarks.
+	 * @param nbenchs Number of benchmarks.
+	 * @param nruns   Number of timed runs (at most BENCH_RUNS).
+	 *
+	 * @details Each benchmark is warmed up and then timed over @p
+	 * nruns runs. The minimum, median and 99th percentile of the
+	 * cycles per run are printed on a single line.
+	 */
+	extern void bench_run_n(const char *group, const struct bench *benchs, int nbenchs, int nruns);
+
+	/**
+	 * @brief Runs registered benchmarks.
+	 *
+	 * @param group   Benchmark group.
+	 * @param benchs  Benchmarks.
+	 * @param nbenchs Number of benchmarks.
+	 *
+	 * @see bench_run_n().
+	 */
+	extern void bench_run(const char *group, const struct bench *benchs, int nbenchs);
+
+	/**
+	 * @brief Prints a measurement of a benchmark other than time.
+	 *
+	 * @param group Benchmark group.
+	 * @param name  Benchmark name.
+	 * @param key   Name of the measurement.
+	 * @param value Value of the measurement.
+	 */
+	extern void bench_metric(const char *group, const char *name, const char *key, uint64_t value);
+
+	/**
+	 * @brief Benchmarks the memory allocator and string routines.
+	 */
+	extern void benchmark_libc(void);
+
+	/**
+	 * @brief Runs allocator workloads and checks the heap.
+	 */
+	extern void benchmark_malloc(void);
+
+	/**
+	 * @brief Benchmarks integer and floating-point formatting.
+	 */
+	extern void benchmark_format(void);
+
+	/**
+	 * @brief Benchmarks deferred logging.
+	 */
+	extern void benchmark_log(void);
+
+	/**
+	 * @brief Benchmarks scatter-gather output.
+	 */
+	extern void benchmark_writev(void);
+
+	/**
+	 * @brief Benchmarks number parsing.
+	 */
+	extern void benchmark_parse(void);
+
+	/**
+	 * @brief Benchmarks random number generation.
+	 */
+	extern void benchmark_random(void);
+
+	/**
+	 * @brief Benchmarks locking primitives.
+	 */
+	extern void benchmark_lock(void);
+
+	/**
+	 * @brief Benchmarks queues.
+	 */
+	extern void benchmark_queue(void);
+
+	/**
+	 * @brief Benchmarks the thread pool.
+	 */
+	extern void benchmark_pool(void);
+
+	/**
+	 * @brief Benchmarks fibers.
+	 */
+	extern void benchmark_fiber(void);
+
+	/**
+	 * @brief Benchmarks thread-local storage.
+	 */
+	extern void benchmark_tls(void);
+
+	/**
+	 * @brief Benchmarks the profiling interface.
+	 */
+	extern void benchmark_prof(void);
+
+	/**
+	 * @brief Benchmarks sorting and searching.
+	 */
+	extern void benchmark_sort(void);
+
+	/**
+	 * @brief Benchmarks radix sorts.
+	 */
+	extern void benchmark_radix(void);
+
+	/**
+	 * @brief Benchmarks hash maps.
+	 */
+	extern void benchmark_hmap(void);
+
+	/**
+	 * @brief Benchmarks hashing and checksums.
+	 */
+	extern void benchmark_hash(void);
+
+	/**
+	 * @brief Benchmarks bitsets.
+	 */
+	extern void benchmark_bitset(void);
+
+	/**
+	 * @brief Benchmarks buffered streams.
+	 */
+	extern void benchmark_stream(void);
+
+#endif /* _TEST_H_ */
@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Number of threads in the isolation test.
+ */
+#define NTHREADS (((THREAD_MAX - 1) < 4) ? (THREAD_MAX - 1) : 4)
+
+/**
+ * @brief Number of operations in a benchmark run.
+ */
+#define NOPS 1000
+
+/**
+ * @brief Key under test.
+ */
+static unsigned key;
+
+/**
+ * @brief Number of destroyed values.
+ */
+static unsigned destroyed;
+
+/**
+ * @brief IDs of threads in the isolation test.
+ */
+static kthread_t tids[NTHREADS];
+
+/**
+ * @brief Sink for benchmark results.
+ */
+static volatile uintptr_t sink;
+
+/**
+ * @brief Destroys a value.
+ */
+static void destroy(void *value)
+{
+	uassert(value != NULL);
+
+	__atomic_add_fetch(&destroyed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Checks that a thread sees its own value of a key.
+ */
+static void *isolated(void *arg)
+{
+	uassert(utls_get(key) == NULL);
+	uassert(utls_set(key, arg) == 0);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		uassert(utls_get(key) == arg);
+		kthread_yield();
+	}
+
+	/* Destructors run whether threads exit or return. */
+	if (((kthread_t *) arg - tids) & 1)
+		___nanvix_exit(0);
+
+	return (NULL);
+}
+
+/**
+ * @brief Uses the per-thread resources of the library and returns.
+ */
+static void *transient(void *arg)
+{
+	uassert(utls_set(key, arg) == 0);
+	uassert(urand_self() != NULL);
+	uassert(utls_get(UTLS_KEY_RAND) != NULL);
+
+	return (NULL);
+}
+
+/**
+ * @brief Checks thread-local storage.
+ */
+static void test_tls_api(void)
+{
+	unsigned keys[UTLS_KEYS_MAX];
+	int x, y, n;
+
+	uassert(utls_key_create(NULL, NULL) == -EINVAL);
+	uassert(utls_key_delete(UTLS_KEY_BUFFER) == -EINVAL);
+	uassert(utls_key_delete(UTLS_KEYS_MAX) == -EINVAL);
+	uassert(utls_get(UTLS_KEYS_MAX) == NULL);
+	uassert(utls_set(UTLS_KEYS_MAX, &x) == -EINVAL);
+
+	/* Keys start out NULL and are not shared. */
+	uassert(utls_key_create(&keys[0], NULL) == 0);
+	uassert(utls_key_create(&keys[1], NULL) == 0);
+	uassert(keys[0] != keys[1]);
+	uassert(utls_get(keys[0]) == NULL);
+	uassert(utls_set(keys[0], &x) == 0);
+	uassert(utls_set(keys[1], &y) == 0);
+	uassert(utls_get(keys[0]) == &x);
+	uassert(utls_get(keys[1]) == &y);
+
+	/* A deleted key is reused with no stale value. */
+	uassert(utls_key_delete(keys[0]) == 0);
+	uassert(utls_key_delete(keys[0]) == -EINVAL);
+	uassert(utls_key_create(&keys[0], NULL) == 0);
+	uassert(utls_get(keys[0]) == NULL);
+	uassert(utls_key_delete(keys[0]) == 0);
+	uassert(utls_key_delete(keys[1]) == 0);
+
+	/* Keys run out. */
+	for (n = 0; n < UTLS_KEYS_MAX; n++)
+	{
+		if (utls_key_create(&keys[n], NULL) < 0)
+			break;
+	}
+	uassert(n == (UTLS_KEYS_MAX - UTLS_KEYS_RESERVED));
+	while (n-- > 0)
+		uassert(utls_key_delete(keys[n]) == 0);
+
+	/* Each thread has its own values, destroyed when it exits. */
+	destroyed = 0;
+	uassert(utls_key_create(&key, destroy) == 0);
+	uassert(utls_set(key, &x) == 0);
+	for (int i = 0; i < NTHREADS; i++)
+		uassert(uthread_create(&tids[i], isolated, &tids[i]) == 0);
+	for (int i = 0; i < NTHREADS; i++)
+		uassert(kthread_join(tids[i], NULL) == 0);
+	uassert(destroyed == NTHREADS);
+	uassert(utls_get(key) == &x);
+
+	/* Threads that return give their storage back. */
+	for (int i = 0; i < 2*THREAD_MAX; i++)
+	{
+		uassert(uthread_create(&tids[0], transient, &y) == 0);
+		uassert(kthread_join(tids[0], NULL) == 0);
+	}
+	uassert(destroyed == NTHREADS + 2*THREAD_MAX);
+	uassert(utls_key_delete(key) == 0);
+}
+
+/**
+ * @brief Stores thread-local values.
+ */
+static void bench_utls_set(int nops)
+{
+	for (int i = 0; i < nops; i++)
+		uassert(utls_set(key, (void *) (uintptr_t) i) == 0);
+}
+
+/**
+ * @brief Loads thread-local values.
+ */
+static void bench_utls_get(int nops)
+{
+	uintptr_t acc = 0;
+
+	for (int i = 0; i < nops; i++)
+		acc += (uintptr_t) utls_get(key);
+
+	sink = acc;
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "utls_set", bench_utls_set, NOPS },
+	{ "utls_get", bench_utls_get, NOPS },
+};
+
+/**
+ * @brief Benchmarks thread-local storage.
+ */
+void benchmark_tls(void)
+{
+	test_tls_api();
+
+	uassert(utls_key_create(&key, NULL) == 0);
+
+	bench_run("tls", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	uassert(utls_key_delete(key) == 0);
+}
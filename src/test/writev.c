@@ -0,0 +1,341 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/dev.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "test.h"
+
+/**
+ * @brief Capacity of the capturing file (in bytes).
+ */
+#define FILE_SIZE (4*1024)
+
+/**
+ * @brief Size of the coalescing buffer of uwritev_to().
+ */
+#define COALESCE_SIZE ((KBUFFER_SIZE < 256) ? KBUFFER_SIZE : 256)
+
+/**
+ * @brief Number of fragments in benchmarks.
+ */
+#define NFRAGMENTS 64
+
+/**
+ * @brief File descriptor of the capturing file.
+ */
+#define FD 3
+
+/**
+ * @brief Capturing file.
+ */
+static struct
+{
+	char data[FILE_SIZE]; /**< Contents.                */
+	size_t len;           /**< Number of bytes written. */
+	size_t size;          /**< Capacity.                */
+	size_t chunk;         /**< Maximum bytes per call.  */
+	size_t longest;       /**< Longest call.            */
+	unsigned ncalls;      /**< Number of calls.         */
+	unsigned ninplace;    /**< Calls on source bytes.   */
+} file;
+
+/**
+ * @brief Source bytes.
+ */
+static char text[FILE_SIZE];
+
+/**
+ * @brief Fragments.
+ */
+static struct uiovec iov[NFRAGMENTS];
+
+/**
+ * @brief Sink that keeps the compiler from discarding results.
+ */
+static volatile ssize_t sink;
+
+/**
+ * @brief Writes to the capturing file.
+ */
+static ssize_t capture(int fd, const void *buf, size_t n)
+{
+	size_t k = file.size - file.len;
+
+	uassert(fd == FD);
+
+	if (n > file.longest)
+		file.longest = n;
+	if (k > n)
+		k = n;
+	if (k > file.chunk)
+		k = file.chunk;
+	if (k == 0)
+		return (-ENOSPC);
+
+	umemcpy(&file.data[file.len], buf, k);
+	file.len += k;
+	file.ncalls++;
+
+	/* Bytes were not copied. */
+	if (((const char *) buf >= text) && ((const char *) buf < &text[FILE_SIZE]))
+		file.ninplace++;
+
+	return (k);
+}
+
+/**
+ * @brief Writes nothing.
+ */
+static ssize_t stall(int fd, const void *buf, size_t n)
+{
+	((void) fd);
+	((void) buf);
+	((void) n);
+
+	return (0);
+}
+
+/**
+ * @brief Resets the capturing file.
+ *
+ * @param size  Capacity.
+ * @param chunk Maximum bytes per call.
+ */
+static void file_reset(size_t size, size_t chunk)
+{
+	file.len = 0;
+	file.size = size;
+	file.chunk = chunk;
+	file.longest = 0;
+	file.ncalls = 0;
+	file.ninplace = 0;
+}
+
+/**
+ * @brief Splits source bytes into fragments.
+ *
+ * @param lens Lengths of fragments.
+ * @param n    Number of fragments.
+ *
+ * @returns The total length of fragments.
+ */
+static size_t iov_build(const size_t *lens, int n)
+{
+	size_t off = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		iov[i].iov_base = &text[off];
+		iov[i].iov_len = lens[i];
+		off += lens[i];
+	}
+
+	return (off);
+}
+
+/**
+ * @brief Writes fragments and checks the contents of the file.
+ *
+ * @param n      Number of fragments.
+ * @param total  Total length of fragments.
+ * @param ncalls Expected number of calls (zero to skip the check).
+ */
+static void check_writev(int n, size_t total, unsigned ncalls)
+{
+	uassert(uwritev_to(capture, FD, iov, n) == (ssize_t) total);
+	uassert(file.len == total);
+	uassert(umemcmp(file.data, text, total) == 0);
+	uassert(file.longest <= KBUFFER_SIZE);
+
+	if (ncalls > 0)
+		uassert(file.ncalls == ncalls);
+}
+
+/*============================================================================*
+ * Tests                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Checks coalescing, writes in place and chunking.
+ */
+static void test_writev_api(void)
+{
+	size_t lens[NFRAGMENTS];
+	size_t total;
+	unsigned per;
+
+	for (int i = 0; i < FILE_SIZE; i++)
+		text[i] = 'a' + (i*7) % 26;
+
+	/* No fragments. */
+	file_reset(FILE_SIZE, FILE_SIZE);
+	uassert(uwritev_to(capture, FD, NULL, 0) == 0);
+	uassert(file.ncalls == 0);
+
+	/* Small fragments are coalesced. */
+	for (int i = 0; i < NFRAGMENTS; i++)
+		lens[i] = 10;
+	total = iov_build(lens, NFRAGMENTS);
+	per = COALESCE_SIZE/10;
+	file_reset(FILE_SIZE, FILE_SIZE);
+	check_writev(NFRAGMENTS, total, (NFRAGMENTS + per - 1)/per);
+
+	/* Empty fragments. */
+	lens[1] = 0;
+	lens[3] = 0;
+	total = iov_build(lens, 4);
+	file_reset(FILE_SIZE, FILE_SIZE);
+	check_writev(4, total, 1);
+
+	/* Large fragments are written in chunks. */
+	lens[0] = 1000;
+	total = iov_build(lens, 1);
+	file_reset(FILE_SIZE, FILE_SIZE);
+	check_writev(1, total, (1000 + KBUFFER_SIZE - 1)/KBUFFER_SIZE);
+
+	/* Large fragments are written in place after pending bytes. */
+	lens[0] = 10;
+	lens[1] = KBUFFER_SIZE - 1;
+	total = iov_build(lens, 2);
+	file_reset(FILE_SIZE, FILE_SIZE);
+	check_writev(2, total, 2);
+	uassert(file.ninplace == 1);
+
+	/* Short tails of large fragments join the fragments that follow. */
+	lens[0] = 10;
+	lens[1] = 2*KBUFFER_SIZE + 20;
+	lens[2] = 10;
+	total = iov_build(lens, 3);
+	file_reset(FILE_SIZE, FILE_SIZE);
+	check_writev(3, total, 4);
+	uassert(file.ninplace == 2);
+
+	/* Mixed fragments and short writes. */
+	for (int i = 0; i < NFRAGMENTS; i++)
+		lens[i] = ((i % 5) == 0) ? 100 + i : 1 + (i*13) % 40;
+	total = iov_build(lens, NFRAGMENTS);
+	for (size_t chunk = 1; chunk <= KBUFFER_SIZE; chunk *= 3)
+	{
+		file_reset(FILE_SIZE, chunk);
+		check_writev(NFRAGMENTS, total, 0);
+	}
+}
+
+/**
+ * @brief Checks error handling.
+ */
+static void test_writev_errors(void)
+{
+	size_t lens[NFRAGMENTS];
+
+	/* Invalid arguments. */
+	uassert(uwritev_to(NULL, FD, iov, 1) == -EINVAL);
+	uassert(uwritev_to(capture, FD, iov, -1) == -EINVAL);
+	uassert(uwritev_to(capture, FD, iov, UIOV_MAX + 1) == -EINVAL);
+	uassert(uwritev_to(capture, FD, NULL, 1) == -EINVAL);
+
+	/* Nothing written. */
+	lens[0] = 10;
+	iov_build(lens, 1);
+	file_reset(0, FILE_SIZE);
+	uassert(uwritev_to(capture, FD, iov, 1) == -ENOSPC);
+	uassert(uwritev_to(stall, FD, iov, 1) == -EIO);
+
+	/* Large fragment partially written. */
+	lens[0] = 1000;
+	iov_build(lens, 1);
+	file_reset(300, FILE_SIZE);
+	uassert(uwritev_to(capture, FD, iov, 1) == 300);
+	uassert(umemcmp(file.data, text, 300) == 0);
+
+	/* Coalesced fragments partially written. */
+	for (int i = 0; i < NFRAGMENTS; i++)
+		lens[i] = 10;
+	iov_build(lens, NFRAGMENTS);
+	file_reset(105, 50);
+	uassert(uwritev_to(capture, FD, iov, NFRAGMENTS) == 105);
+	uassert(umemcmp(file.data, text, 105) == 0);
+}
+
+/*============================================================================*
+ * Benchmarks                                                                 *
+ *============================================================================*/
+
+/**
+ * @brief Writes one fragment per call.
+ */
+static void bench_write_each(int n)
+{
+	file_reset(FILE_SIZE, FILE_SIZE);
+
+	for (int i = 0; i < n; i++)
+		capture(FD, iov[i].iov_base, iov[i].iov_len);
+
+	sink = file.len;
+}
+
+/**
+ * @brief Writes fragments with uwritev_to().
+ */
+static void bench_uwritev(int n)
+{
+	file_reset(FILE_SIZE, FILE_SIZE);
+
+	sink = uwritev_to(capture, FD, iov, n);
+}
+
+/**
+ * @brief Registered benchmarks.
+ */
+static const struct bench benchs[] = {
+	{ "write-each", bench_write_each, NFRAGMENTS },
+	{ "uwritev",    bench_uwritev,    NFRAGMENTS },
+};
+
+/**
+ * @brief Benchmarks scatter-gather output.
+ */
+void benchmark_writev(void)
+{
+	size_t lens[NFRAGMENTS];
+
+	test_writev_api();
+	test_writev_errors();
+
+	/* Headers and fields, with a payload every now and then. */
+	for (int i = 0; i < NFRAGMENTS; i++)
+		lens[i] = ((i % 16) == 15) ? 200 : 1 + (i*7) % 24;
+	iov_build(lens, NFRAGMENTS);
+
+	bench_run("writev", benchs, sizeof(benchs)/sizeof(benchs[0]));
+
+	/* Calls to the file per run. */
+	for (int i = 0; i < (int) (sizeof(benchs)/sizeof(benchs[0])); i++)
+	{
+		benchs[i].fn(benchs[i].nops);
+		bench_metric("writev", benchs[i].name, "calls", file.ncalls);
+	}
+}
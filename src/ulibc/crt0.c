@@ -46,6 +46,8 @@ void ___start(int argc, const char *argv[], char **envp)
 
 	environ = envp;
 
+	__utls_init();
+
 	knoc_init();
 
 	ret = __main2(argc, argv);
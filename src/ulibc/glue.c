@@ -26,6 +26,8 @@
 #include <nanvix/sys/thread.h>
 #include <posix/sys/types.h>
 #include <posix/stddef.h>
+#include <posix/errno.h>
+#include <nanvix/ulib.h>
 
 /**
  * @brief Heap size (in bytes).
@@ -70,14 +72,26 @@ void *__nanvix_sbrk(size_t size)
 }
 
 /**
- *  Terminates the calling process.
+ *  Terminates the calling process. Pending output is flushed before
+ *  terminating: the leader thread formats pending log entries, prints
+ *  the statistics of probes and flushes the output buffers of all
+ *  threads, whereas any other thread releases its resources with
+ *  __uthread_release().
  */
 NORETURN void ___nanvix_exit(int status)
 {
 	if (kthread_self() == KTHREAD_LEADER_TID)
+	{
+		ulog_flush();
+		__uprof_exit();
+		__ubuffer_flush_all();
 		_kexit(status);
+	}
 	else
+	{
+		__uthread_release();
 		kthread_exit(&status);
+	}
 
 	UNREACHABLE();
 }
@@ -90,6 +104,19 @@ ssize_t __nanvix_write(int fd, const void *buf, size_t n)
 	return (nanvix_write(fd, buf, n));
 }
 
+/**
+ * Reads from a file. The kernel has no input path for files yet, thus
+ * reads are not supported.
+ */
+ssize_t __nanvix_read(int fd, void *buf, size_t n)
+{
+	UNUSED(fd);
+	UNUSED(buf);
+	UNUSED(n);
+
+	return (-ENOTSUP);
+}
+
 #ifdef __mppa256__
 
 /**
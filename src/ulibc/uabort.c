@@ -25,7 +25,9 @@
 #include <nanvix/ulib.h>
 
 /**
- * The uabort() function causes abnormal termination to occur.
+ * The uabort() function causes abnormal termination to occur. Pending
+ * output is flushed by ___nanvix_exit(), so that diagnostic messages
+ * printed right before aborting are not lost.
  */
 void uabort(void)
 {
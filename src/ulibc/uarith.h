@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ULIBC_UARITH_H_
+#define ULIBC_UARITH_H_
+
+	#include <posix/stdint.h>
+
+	/**
+	 * @brief Computes the high 64 bits of a 64x64-bit multiplication.
+	 *
+	 * @param a First operand.
+	 * @param b Second operand.
+	 *
+	 * @returns The high 64 bits of @p a times @p b.
+	 *
+	 * @note Targets with 32-bit registers lack a native 64x64-bit
+	 * multiplication, thus the product is assembled from 32x32-bit
+	 * partial products.
+	 */
+	static inline uint64_t umulh64(uint64_t a, uint64_t b)
+	{
+	#if defined(__SIZEOF_INT128__)
+		return ((uint64_t)(((unsigned __int128) a * b) >> 64));
+	#else
+		uint64_t alo, ahi, blo, bhi;
+		uint64_t p0, p1, p2, p3, mid;
+
+		alo = (uint32_t) a;
+		ahi = a >> 32;
+		blo = (uint32_t) b;
+		bhi = b >> 32;
+
+		p0 = alo*blo;
+		p1 = alo*bhi;
+		p2 = ahi*blo;
+		p3 = ahi*bhi;
+
+		mid = (p0 >> 32) + (uint32_t) p1 + (uint32_t) p2;
+
+		return (p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32));
+	#endif
+	}
+
+	/**
+	 * @brief Divides a 64-bit integer by 10^8.
+	 *
+	 * @param n Dividend.
+	 *
+	 * @returns The quotient of @p n divided by 10^8.
+	 *
+	 * @note 10^8 = 2^8 * 390625, thus the quotient is computed with a
+	 * shift followed by a multiplication by the reciprocal of 390625,
+	 * which is exact for dividends up to 2^56. This avoids calls to the
+	 * software division routines of targets with 32-bit registers.
+	 */
+	static inline uint64_t udiv1e8(uint64_t n)
+	{
+		return (umulh64(n >> 8, 0xabcc77118461cefdULL) >> 18);
+	}
+
+	/**
+	 * @brief Parses exactly eight decimal digits.
+	 *
+	 * @param p Target digits.
+	 *
+	 * @returns The value of the eight digits starting at @p p.
+	 *
+	 * @details The digits are loaded as a single 64-bit word and
+	 * combined in pairs, quads and then octets with three
+	 * multiplications, instead of one multiply-add per digit.
+	 *
+	 * @note The caller must ensure that all eight bytes are digits.
+	 */
+	static inline uint32_t uparse8(const char *p)
+	{
+		uint64_t v;
+
+		__builtin_memcpy(&v, p, sizeof(uint64_t));
+
+	#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		v = __builtin_bswap64(v);
+	#endif
+
+		v -= 0x3030303030303030ULL;
+		v = (v*10) + (v >> 8);
+		v = (((v & 0x000000ff000000ffULL)*0x000f424000000064ULL) +
+			(((v >> 16) & 0x000000ff000000ffULL)*0x0000271000000001ULL)) >> 32;
+
+		return ((uint32_t) v);
+	}
+
+#endif /* ULIBC_UARITH_H_ */
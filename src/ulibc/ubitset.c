@@ -0,0 +1,170 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+
+/**
+ * @brief Mask of the bits at or above a position of a word.
+ */
+#define UBITSET_MASK_FROM(i) (~0ULL << ((i) % UBITSET_WORD_BIT))
+
+/**
+ * @brief Mask of the bits below a position of a word (all if zero).
+ */
+#define UBITSET_MASK_TO(i) \
+	(~0ULL >> ((UBITSET_WORD_BIT - (i) % UBITSET_WORD_BIT) % UBITSET_WORD_BIT))
+
+/**
+ * The ubitset_fill() function sets all @p nbits bits of the bitset
+ * pointed to by @p set if @p value is not zero, and clears them
+ * otherwise.
+ */
+void ubitset_fill(uint64_t *set, size_t nbits, int value)
+{
+	size_t nwords = UBITSET_WORDS(nbits);
+
+	umemset(set, value ? 0xff : 0, nwords*sizeof(uint64_t));
+
+	/* Clear bits past the end. */
+	if (value && (nwords > 0))
+		set[nwords - 1] &= UBITSET_MASK_TO(nbits);
+}
+
+/**
+ * The ubitset_ffs() function scans the bitset pointed to by @p set a
+ * word at a time, starting at bit @p from, and returns the index of the
+ * first set bit.
+ */
+size_t ubitset_ffs(const uint64_t *set, size_t nbits, size_t from)
+{
+	size_t w = from/UBITSET_WORD_BIT;
+	size_t nwords = UBITSET_WORDS(nbits);
+	uint64_t word;
+
+	if (from >= nbits)
+		return (nbits);
+
+	/* Skip bits before the starting one. */
+	word = set[w] & UBITSET_MASK_FROM(from);
+
+	while (word == 0)
+	{
+		if (++w >= nwords)
+			return (nbits);
+		word = set[w];
+	}
+
+	return (w*UBITSET_WORD_BIT + ubit_ctz64(word));
+}
+
+/**
+ * The ubitset_ffz() function works like ubitset_ffs() on clear bits.
+ */
+size_t ubitset_ffz(const uint64_t *set, size_t nbits, size_t from)
+{
+	size_t w = from/UBITSET_WORD_BIT;
+	size_t nwords = UBITSET_WORDS(nbits);
+	size_t i;
+	uint64_t word;
+
+	if (from >= nbits)
+		return (nbits);
+
+	/* Skip bits before the starting one. */
+	word = ~set[w] & UBITSET_MASK_FROM(from);
+
+	while (word == 0)
+	{
+		if (++w >= nwords)
+			return (nbits);
+		word = ~set[w];
+	}
+
+	/* Bits past the end are clear. */
+	i = w*UBITSET_WORD_BIT + ubit_ctz64(word);
+
+	return ((i < nbits) ? i : nbits);
+}
+
+/**
+ * The ubitset_count() function counts the bits set in the range
+ * [@p from, @p to) of the bitset pointed to by @p set, a word at a
+ * time.
+ */
+size_t ubitset_count(const uint64_t *set, size_t from, size_t to)
+{
+	size_t first, last;
+	size_t count;
+
+	if (from >= to)
+		return (0);
+
+	first = from/UBITSET_WORD_BIT;
+	last = (to - 1)/UBITSET_WORD_BIT;
+
+	/* Single word. */
+	if (first == last)
+	{
+		return (ubit_popcount64(set[first] &
+			UBITSET_MASK_FROM(from) & UBITSET_MASK_TO(to)));
+	}
+
+	count = ubit_popcount64(set[first] & UBITSET_MASK_FROM(from));
+	for (size_t w = first + 1; w < last; w++)
+		count += ubit_popcount64(set[w]);
+	count += ubit_popcount64(set[last] & UBITSET_MASK_TO(to));
+
+	return (count);
+}
+
+/**
+ * The ubitset_and() function stores in @p dst the bits that are set in
+ * both @p a and @p b.
+ */
+void ubitset_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits)
+{
+	for (size_t w = 0; w < UBITSET_WORDS(nbits); w++)
+		dst[w] = a[w] & b[w];
+}
+
+/**
+ * The ubitset_or() function stores in @p dst the bits that are set in
+ * @p a or @p b.
+ */
+void ubitset_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits)
+{
+	for (size_t w = 0; w < UBITSET_WORDS(nbits); w++)
+		dst[w] = a[w] | b[w];
+}
+
+/**
+ * The ubitset_xor() function stores in @p dst the bits that are set in
+ * either @p a or @p b, but not in both.
+ */
+void ubitset_xor(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nbits)
+{
+	for (size_t w = 0; w < UBITSET_WORDS(nbits); w++)
+		dst[w] = a[w] ^ b[w];
+}
@@ -0,0 +1,266 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "udecimal.h"
+
+/**
+ * The __udecimal_trim() function removes trailing zeros of the decimal
+ * pointed to by @p a. An empty decimal has its decimal point reset.
+ */
+void __udecimal_trim(struct udecimal *a)
+{
+	while ((a->nd > 0) && (a->d[a->nd - 1] == 0))
+		a->nd--;
+
+	if (a->nd == 0)
+		a->dp = 0;
+}
+
+/**
+ * The __udecimal_assign() function sets the decimal pointed to by @p a
+ * to the integer @p v.
+ */
+void __udecimal_assign(struct udecimal *a, uint64_t v)
+{
+	int n;
+	unsigned char buf[20];
+
+	for (n = 0; v > 0; v /= 10)
+		buf[n++] = v % 10;
+
+	for (a->nd = 0; n > 0; /* noop */)
+		a->d[a->nd++] = buf[--n];
+
+	a->dp = a->nd;
+	a->trunc = 0;
+	__udecimal_trim(a);
+}
+
+/**
+ * @brief Multiplies a decimal by 2^k.
+ *
+ * @param a Target decimal.
+ * @param k Shift amount (at most UDECIMAL_SHIFT_MAX).
+ *
+ * @details Digits are written from the end of the slack area
+ * backwards, then moved to the start of the decimal.
+ */
+static void udecimal_lshift(struct udecimal *a, unsigned k)
+{
+	int r, w;
+	int nd;
+	uint32_t n, q;
+
+	n = 0;
+	w = a->nd + UDECIMAL_SLACK;
+
+	for (r = a->nd - 1; r >= 0; r--)
+	{
+		n += (uint32_t) a->d[r] << k;
+		q = n/10;
+		a->d[--w] = n - 10*q;
+		n = q;
+	}
+
+	for (/* noop */; n > 0; n = q)
+	{
+		q = n/10;
+		a->d[--w] = n - 10*q;
+	}
+
+	nd = a->nd + UDECIMAL_SLACK - w;
+	a->dp += nd - a->nd;
+	umemmove(a->d, &a->d[w], nd);
+
+	/* Discard extra digits. */
+	if (nd > UDECIMAL_DIGITS)
+	{
+		for (int i = UDECIMAL_DIGITS; i < nd; i++)
+			a->trunc |= (a->d[i] != 0);
+		nd = UDECIMAL_DIGITS;
+	}
+
+	a->nd = nd;
+	__udecimal_trim(a);
+}
+
+/**
+ * @brief Divides a decimal by 2^k.
+ *
+ * @param a Target decimal.
+ * @param k Shift amount (at most UDECIMAL_SHIFT_MAX).
+ */
+static void udecimal_rshift(struct udecimal *a, unsigned k)
+{
+	int r, w;
+	uint32_t n, dig, mask;
+
+	r = w = 0;
+	n = 0;
+	mask = (1U << k) - 1;
+
+	/* Pick up enough leading digits to cover the first shift. */
+	for (/* noop */; (n >> k) == 0; r++)
+	{
+		if (r >= a->nd)
+		{
+			if (n == 0)
+			{
+				a->nd = 0;
+				return;
+			}
+
+			while ((n >> k) == 0)
+			{
+				n *= 10;
+				r++;
+			}
+			break;
+		}
+
+		n = n*10 + a->d[r];
+	}
+
+	a->dp -= r - 1;
+
+	/* Pick up a digit, put down a digit. */
+	for (/* noop */; r < a->nd; r++)
+	{
+		dig = n >> k;
+		n &= mask;
+		a->d[w++] = dig;
+		n = n*10 + a->d[r];
+	}
+
+	/* Put down extra digits. */
+	for (/* noop */; n > 0; n *= 10)
+	{
+		dig = n >> k;
+		n &= mask;
+
+		if (w < UDECIMAL_DIGITS)
+			a->d[w++] = dig;
+		else if (dig > 0)
+			a->trunc = 1;
+	}
+
+	a->nd = w;
+	__udecimal_trim(a);
+}
+
+/**
+ * The __udecimal_shift() function multiplies the decimal pointed to by
+ * @p a by 2^k. Negative values of @p k divide it instead. The operation
+ * is exact as long as digits fit in the decimal.
+ */
+void __udecimal_shift(struct udecimal *a, int k)
+{
+	if (a->nd == 0)
+		return;
+
+	for (/* noop */; k > UDECIMAL_SHIFT_MAX; k -= UDECIMAL_SHIFT_MAX)
+		udecimal_lshift(a, UDECIMAL_SHIFT_MAX);
+	for (/* noop */; k < -UDECIMAL_SHIFT_MAX; k += UDECIMAL_SHIFT_MAX)
+		udecimal_rshift(a, UDECIMAL_SHIFT_MAX);
+
+	if (k > 0)
+		udecimal_lshift(a, k);
+	else if (k < 0)
+		udecimal_rshift(a, -k);
+}
+
+/**
+ * The __udecimal_round_down() function truncates the decimal pointed
+ * to by @p a to its first @p nd digits.
+ */
+void __udecimal_round_down(struct udecimal *a, int nd)
+{
+	if (nd >= a->nd)
+		return;
+
+	a->nd = (nd > 0) ? nd : 0;
+	__udecimal_trim(a);
+}
+
+/**
+ * The __udecimal_round_up() function rounds the decimal pointed to by
+ * @p a up to its first @p nd digits. If all kept digits are nines, the
+ * decimal becomes a single one and its decimal point moves one position
+ * to the right.
+ */
+void __udecimal_round_up(struct udecimal *a, int nd)
+{
+	int i;
+
+	if ((nd < 0) || (nd >= a->nd))
+		return;
+
+	for (i = nd - 1; i >= 0; i--)
+	{
+		if (a->d[i] < 9)
+		{
+			a->d[i]++;
+			a->nd = i + 1;
+			return;
+		}
+	}
+
+	a->d[0] = 1;
+	a->nd = 1;
+	a->dp++;
+}
+
+/**
+ * The __udecimal_round() function rounds the decimal pointed to by @p
+ * a to its first @p nd digits, to nearest with ties to even. Rounding
+ * to zero digits keeps the carry, so that 0.6 becomes 1.
+ */
+void __udecimal_round(struct udecimal *a, int nd)
+{
+	int up;
+
+	if (nd >= a->nd)
+		return;
+
+	if (nd < 0)
+	{
+		a->nd = 0;
+		a->dp = 0;
+		return;
+	}
+
+	/* Exactly halfway, so round to even. */
+	if ((a->d[nd] == 5) && (nd + 1 == a->nd))
+		up = a->trunc || ((nd > 0) && (a->d[nd - 1] & 1));
+	else
+		up = (a->d[nd] >= 5);
+
+	if (up)
+		__udecimal_round_up(a, nd);
+	else
+		__udecimal_round_down(a, nd);
+}
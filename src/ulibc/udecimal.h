@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef ULIBC_UDECIMAL_H_
+#define ULIBC_UDECIMAL_H_
+
+	#include <posix/stdint.h>
+
+	/**
+	 * @name Double-Precision Format
+	 */
+	/**@{*/
+	#define UDBL_MANTBITS 52    /**< Mantissa bits.  */
+	#define UDBL_EXPBITS  11    /**< Exponent bits.  */
+	#define UDBL_BIAS     -1023 /**< Exponent bias.  */
+	/**@}*/
+
+	/**
+	 * @brief Number of digits in a decimal.
+	 *
+	 * @note The exact expansion of any double has at most 767
+	 * significant digits.
+	 */
+	#define UDECIMAL_DIGITS 800
+
+	/**
+	 * @brief Extra room for digits produced by a left shift.
+	 */
+	#define UDECIMAL_SLACK 16
+
+	/**
+	 * @brief Maximum shift applied to a decimal at once.
+	 */
+	#define UDECIMAL_SHIFT_MAX 28
+
+	/**
+	 * @brief Arbitrary-precision decimal.
+	 *
+	 * @details The value is 0.d[0]d[1]...d[nd-1] * 10^dp.
+	 */
+	struct udecimal
+	{
+		unsigned char d[UDECIMAL_DIGITS + UDECIMAL_SLACK]; /* Digits.              */
+		int nd;                                            /* Number of digits.    */
+		int dp;                                            /* Decimal point.       */
+		int trunc;                                         /* Discarded nonzeros?  */
+	};
+
+	/**
+	 * @brief Removes trailing zeros of a decimal.
+	 *
+	 * @param a Target decimal.
+	 */
+	extern void __udecimal_trim(struct udecimal *a);
+
+	/**
+	 * @brief Sets a decimal to an integer.
+	 *
+	 * @param a Target decimal.
+	 * @param v Value.
+	 */
+	extern void __udecimal_assign(struct udecimal *a, uint64_t v);
+
+	/**
+	 * @brief Multiplies a decimal by 2^k.
+	 *
+	 * @param a Target decimal.
+	 * @param k Shift amount (negative to divide).
+	 */
+	extern void __udecimal_shift(struct udecimal *a, int k);
+
+	/**
+	 * @brief Rounds a decimal to nearest, ties to even.
+	 *
+	 * @param a  Target decimal.
+	 * @param nd Number of digits to keep.
+	 */
+	extern void __udecimal_round(struct udecimal *a, int nd);
+
+	/**
+	 * @brief Rounds a decimal up.
+	 *
+	 * @param a  Target decimal.
+	 * @param nd Number of digits to keep.
+	 */
+	extern void __udecimal_round_up(struct udecimal *a, int nd);
+
+	/**
+	 * @brief Rounds a decimal down.
+	 *
+	 * @param a  Target decimal.
+	 * @param nd Number of digits to keep.
+	 */
+	extern void __udecimal_round_down(struct udecimal *a, int nd);
+
+	/**
+	 * @name Conversion Modes of __udtoa()
+	 */
+	/**@{*/
+	#define UDTOA_SHORTEST 0 /**< Shortest round-trip digits.      */
+	#define UDTOA_DIGITS   1 /**< Significant digits.              */
+	#define UDTOA_FIXED    2 /**< Digits after the decimal point.  */
+	/**@}*/
+
+	/**
+	 * @brief Converts a double to a decimal.
+	 *
+	 * @param v    Target number (finite and non-negative).
+	 * @param mode Conversion mode.
+	 * @param n    Number of digits, as defined by @p mode.
+	 * @param a    Converted number.
+	 */
+	extern void __udtoa(double v, int mode, int n, struct udecimal *a);
+
+#endif /* ULIBC_UDECIMAL_H_ */
@@ -0,0 +1,641 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+
+/**
+ * @brief Number of layers in ziggurat tables.
+ */
+#define UZIG_LAYERS 256
+
+/**
+ * @brief Start of the tail of the normal distribution.
+ */
+#define UZIG_NORM_R 3.654152885361008796
+
+/**
+ * @brief Start of the tail of the exponential distribution.
+ */
+#define UZIG_EXP_R 7.697117470131050077
+
+/**
+ * @name Scaling Factors
+ */
+/**@{*/
+#define U2P_24 5.9604644775390625e-08  /**< 2^-24 */
+#define U2P_52 2.220446049250313e-16   /**< 2^-52 */
+#define U2P_53 1.1102230246251565e-16  /**< 2^-53 */
+/**@}*/
+
+/**
+ * @name Natural Logarithm of Two
+ */
+/**@{*/
+#define ULN2_HI 6.93147180369123816490e-01 /**< High bits. */
+#define ULN2_LO 1.90821492927058770002e-10 /**< Low bits.  */
+/**@}*/
+
+/**
+ * @name Ziggurat for the Normal Distribution
+ *
+ * @details Layer i spans [0, x[i]) and has height f[i] = exp(-x[i]^2/2).
+ * All layers have the same area, and the bottom one includes the tail.
+ * From "An Improved Ziggurat Method to Generate Normal Random Samples",
+ * Doornik, 2005.
+ */
+/**@{*/
+static const double uzig_norm_x[UZIG_LAYERS + 1] = {
+	3.91075795953709004e+00, 3.65415288536100880e+00, 3.44927829856096446e+00,
+	3.32024473383916607e+00, 3.22457505204702910e+00, 3.14788928951714997e+00,
+	3.08352613200123304e+00, 3.02783779176863543e+00, 2.97860327988084483e+00,
+	2.93436686720785422e+00, 2.89412105361234806e+00, 2.85713873087213255e+00,
+	2.82287739682532512e+00, 2.79092117400078576e+00, 2.76094400527882256e+00,
+	2.73268535904282706e+00, 2.70593365612185810e+00, 2.68051464328452216e+00,
+	2.65628303757550244e+00, 2.63311639363032457e+00, 2.61091051848754852e+00,
+	2.58957598670699518e+00, 2.56903545268053657e+00, 2.54922155032346076e+00,
+	2.53007523215851693e+00, 2.51154444162534229e+00, 2.49358304126968067e+00,
+	2.47614993966914332e+00, 2.45920837433331130e+00, 2.44272531819895677e+00,
+	2.42667098493572597e+00, 2.41101841389968552e+00, 2.39574311978048060e+00,
+	2.38082279517062601e+00, 2.36623705671581863e+00, 2.35196722737765995e+00,
+	2.33799614879503137e+00, 2.32430801886962302e+00, 2.31088825059985004e+00,
+	2.29772334890132957e+00, 2.28480080272294606e+00, 2.27210899022682389e+00,
+	2.25963709517221778e+00, 2.24737503294580776e+00, 2.23531338492832798e+00,
+	2.22344334009090572e+00, 2.21175664288254437e+00, 2.20024554660964800e+00,
+	2.18890277162472069e+00, 2.17772146773864161e+00, 2.16669518035264597e+00,
+	2.15581781987506327e+00, 2.14508363404620361e+00, 2.13448718284432015e+00,
+	2.12402331568781566e+00, 2.11368715068493396e+00, 2.10347405571314683e+00,
+	2.09337963113705028e+00, 2.08339969399655178e+00, 2.07353026351697878e+00,
+	2.06376754780995642e+00, 2.05410793164886485e+00, 2.04454796521573279e+00,
+	2.03508435372780871e+00, 2.02571394786203296e+00, 2.01643373490437172e+00,
+	2.00724083055868485e+00, 1.99813247135656424e+00, 1.98910600761557133e+00,
+	1.98015889689859836e+00, 1.97128869793176964e+00, 1.96249306494246190e+00,
+	1.95376974238273404e+00, 1.94511656000675393e+00, 1.93653142827375890e+00,
+	1.92801233405071826e+00, 1.91955733659122885e+00, 1.91116456376928223e+00,
+	1.90283220854844637e+00, 1.89455852566871008e+00, 1.88634182853477639e+00,
+	1.87818048629097767e+00, 1.87007292106923684e+00, 1.86201760539763228e+00,
+	1.85401305975814812e+00, 1.84605785028311975e+00, 1.83815058658072861e+00,
+	1.83028991968066657e+00, 1.82247454009178322e+00, 1.81470317596416764e+00,
+	1.80697459134869343e+00, 1.79928758454758020e+00, 1.79164098655001003e+00,
+	1.78403365954727633e+00, 1.77646449552234498e+00, 1.76893241490907793e+00,
+	1.76143636531670666e+00, 1.75397532031545511e+00, 1.74654827827949299e+00,
+	1.73915426128366901e+00, 1.73179231405070722e+00, 1.72446150294577571e+00,
+	1.71716091501554069e+00, 1.70988965706900609e+00, 1.70264685479761391e+00,
+	1.69543165193223855e+00, 1.68824320943485873e+00, 1.68108070472282334e+00,
+	1.67394333092376035e+00, 1.66683029615928668e+00, 1.65974082285578950e+00,
+	1.65267414708064853e+00, 1.64562951790236034e+00, 1.63860619677311115e+00,
+	1.63160345693242204e+00, 1.62462058283056843e+00, 1.61765686957053423e+00,
+	1.61071162236733367e+00, 1.60378415602358304e+00, 1.59687379442026134e+00,
+	1.58997987002164853e+00, 1.58310172339347144e+00, 1.57623870273333289e+00,
+	1.56939016341253446e+00, 1.56255546752843966e+00, 1.55573398346655489e+00,
+	1.54892508547153551e+00, 1.54212815322634755e+00, 1.53534257143884312e+00,
+	1.52856772943502461e+00, 1.52180302075829310e+00, 1.51504784277399240e+00,
+	1.50830159627857197e+00, 1.50156368511270655e+00, 1.49483351577771839e+00,
+	1.48811049705465437e+00, 1.48139403962537575e+00, 1.47468355569502552e+00,
+	1.46797845861523091e+00, 1.46127816250740783e+00, 1.45458208188552329e+00,
+	1.44788963127766968e+00, 1.44120022484579802e+00, 1.43451327600294642e+00,
+	1.42782819702729036e+00, 1.42114439867232312e+00, 1.41446128977246466e+00,
+	1.40777827684337153e+00, 1.40109476367620256e+00, 1.39441015092507126e+00,
+	1.38772383568688462e+00, 1.38103521107274196e+00, 1.37434366577003053e+00,
+	1.36764858359431796e+00, 1.36094934303010184e+00, 1.35424531675943061e+00,
+	1.34753587117735929e+00, 1.34082036589315212e+00, 1.33409815321608360e+00,
+	1.32736857762462468e+00, 1.32063097521773010e+00, 1.31388467314686896e+00,
+	1.30712898902735386e+00, 1.30036323032743373e+00, 1.29358669373351765e+00,
+	1.28679866448978641e+00, 1.27999841571033324e+00, 1.27318520766184373e+00,
+	1.26635828701468833e+00, 1.25951688606014423e+00, 1.25266022189129789e+00,
+	1.24578749554499790e+00, 1.23889789110202742e+00, 1.23199057474244511e+00,
+	1.22506469375280802e+00, 1.21811937548172655e+00, 1.21115372623991124e+00,
+	1.20416683014056014e+00, 1.19715774787558593e+00, 1.19012551542280165e+00,
+	1.18306914267876073e+00, 1.17598761201148982e+00, 1.16887987672683380e+00,
+	1.16174485944157424e+00, 1.15458145035585180e+00, 1.14738850541673387e+00,
+	1.14016484436399579e+00, 1.13290924864833698e+00, 1.12562045921129439e+00,
+	1.11829717411506291e+00, 1.11093804600924950e+00, 1.10354167942026815e+00,
+	1.09610662784760349e+00, 1.08863139064951420e+00, 1.08111440969888939e+00,
+	1.07355406578787171e+00, 1.06594867475750665e+00, 1.05829648332600645e+00,
+	1.05059566458620712e+00, 1.04284431313937054e+00, 1.03504043982860527e+00,
+	1.02718196603075129e+00, 1.01926671746052921e+00, 1.01129241743497844e+00,
+	1.00325667953959141e+00, 9.95156999629943084e-01, 9.86990747093846266e-01,
+	9.78755155288937750e-01, 9.70447311058864615e-01, 9.62064143217605250e-01,
+	9.53602409875572654e-01, 9.45058684462571130e-01, 9.36429340280896860e-01,
+	9.27710533396234771e-01, 9.18898183643734989e-01, 9.09987953490768997e-01,
+	9.00975224455174528e-01, 8.91855070726792376e-01, 8.82622229578910122e-01,
+	8.73271068082494550e-01, 8.63795545546826915e-01, 8.54189171001560554e-01,
+	8.44444954902423661e-01, 8.34555354079518752e-01, 8.24512208745288633e-01,
+	8.14306670128064347e-01, 8.03929116982664893e-01, 7.93369058833152785e-01,
+	7.82615023299588763e-01, 7.71654424216739354e-01, 7.60473406422083165e-01,
+	7.49056662009581653e-01, 7.37387211425838629e-01, 7.25446140901303549e-01,
+	7.13212285182022732e-01, 7.00661841097584448e-01, 6.87767892786257717e-01,
+	6.74499822827436479e-01, 6.60822574234205984e-01, 6.46695714884388928e-01,
+	6.32072236375024632e-01, 6.16896989996235545e-01, 6.01104617743940417e-01,
+	5.84616766093722262e-01, 5.67338257040473026e-01, 5.49151702313026790e-01,
+	5.29909720646495108e-01, 5.09423329585933393e-01, 4.87443966121754335e-01,
+	4.63634336771763245e-01, 4.37518402186662658e-01, 4.08389134588000746e-01,
+	3.75121332850465727e-01, 3.35737519180459465e-01, 2.86174591747260509e-01,
+	2.15241895913273806e-01, 0.00000000000000000e+00
+};
+static const double uzig_norm_f[UZIG_LAYERS + 1] = {
+	4.77467764586655301e-04, 1.26028593049859797e-03, 2.60907274610636293e-03,
+	4.03797259337187152e-03, 5.52240329926475398e-03, 7.05087547139211009e-03,
+	8.61658276942291711e-03, 1.02149714397311003e-02, 1.18427578579431043e-02,
+	1.34974506017808069e-02, 1.51770883079820722e-02, 1.68800831525958393e-02,
+	1.86051212757833498e-02, 2.03510962301093543e-02, 2.21170627073799218e-02,
+	2.39022033058732368e-02, 2.57058040086326559e-02, 2.75272356696933153e-02,
+	2.93659397582301113e-02, 3.12214171920236899e-02, 3.30932194586886982e-02,
+	3.49809414618330733e-02, 3.68842156886911507e-02, 3.88027074046569179e-02,
+	4.07361106560787528e-02, 4.26841449166193779e-02, 4.46465522514465363e-02,
+	4.66230949020896637e-02, 4.86135532160351450e-02, 5.06177238611217883e-02,
+	5.26354182769736487e-02, 5.46664613250779155e-02, 5.67106901063994667e-02,
+	5.87679529211379836e-02, 6.08381083497518058e-02, 6.29210244379778544e-02,
+	6.50165779714704378e-02, 6.71246538280239891e-02, 6.92451443972502689e-02,
+	7.13779490591419652e-02, 7.35229737142409911e-02, 7.56801303591949637e-02,
+	7.78493367023722072e-02, 8.00305158149475088e-02, 8.22235958134956840e-02,
+	8.44285095706546612e-02, 8.66451944508677824e-02, 8.88735920685942288e-02,
+	9.11136480667007337e-02, 9.33653119130266190e-02, 9.56285367133533348e-02,
+	9.79032790392156266e-02, 1.00189498769172020e-01, 1.02487158942306270e-01,
+	1.04796225622867056e-01, 1.07116667775072880e-01, 1.09448457147210021e-01,
+	1.11791568164245583e-01, 1.14145977828255210e-01, 1.16511665626037014e-01,
+	1.18888613443345698e-01, 1.21276805485235437e-01, 1.23676228202051403e-01,
+	1.26086870220650349e-01, 1.28508722280473636e-01, 1.30941777174128166e-01,
+	1.33386029692162844e-01, 1.35841476571757352e-01, 1.38308116449064322e-01,
+	1.40785949814968309e-01, 1.43274978974047118e-01, 1.45775208006537926e-01,
+	1.48286642733128721e-01, 1.50809290682410169e-01, 1.53343161060837674e-01,
+	1.55888264725064563e-01, 1.58444614156520225e-01, 1.61012223438117663e-01,
+	1.63591108232982951e-01, 1.66181285765110071e-01, 1.68782774801850333e-01,
+	1.71395595638155623e-01, 1.74019770082499359e-01, 1.76655321444406654e-01,
+	1.79302274523530397e-01, 1.81960655600216487e-01, 1.84630492427504539e-01,
+	1.87311814224516926e-01, 1.90004651671193070e-01, 1.92709036904328807e-01,
+	1.95425003514885592e-01, 1.98152586546538112e-01, 2.00891822495431333e-01,
+	2.03642749311121501e-01, 2.06405406398679325e-01, 2.09179834621935651e-01,
+	2.11966076307852941e-01, 2.14764175252008499e-01, 2.17574176725178370e-01,
+	2.20396127481011589e-01, 2.23230075764789593e-01, 2.26076071323264877e-01,
+	2.28934165415577484e-01, 2.31804410825248525e-01, 2.34686861873252689e-01,
+	2.37581574432173676e-01, 2.40488605941449107e-01, 2.43408015423711988e-01,
+	2.46339863502238771e-01, 2.49284212419516704e-01, 2.52241126056943765e-01,
+	2.55210669955677150e-01, 2.58192911338648023e-01, 2.61187919133763713e-01,
+	2.64195763998317568e-01, 2.67216518344631837e-01, 2.70250256366959984e-01,
+	2.73297054069675804e-01, 2.76356989296781264e-01, 2.79430141762765316e-01,
+	2.82516593084849388e-01, 2.85616426816658109e-01, 2.88729728483353931e-01,
+	2.91856585618280984e-01, 2.94997087801162572e-01, 2.98151326697901342e-01,
+	3.01319396102034120e-01, 3.04501391977896274e-01, 3.07697412505553769e-01,
+	3.10907558127563710e-01, 3.14131931597630143e-01, 3.17370638031222396e-01,
+	3.20623784958230129e-01, 3.23891482377732021e-01, 3.27173842814958593e-01,
+	3.30470981380537099e-01, 3.33783015832108509e-01, 3.37110066638412809e-01,
+	3.40452257045945450e-01, 3.43809713148291340e-01, 3.47182563958251478e-01,
+	3.50570941482881204e-01, 3.53974980801569250e-01, 3.57394820147290515e-01,
+	3.60830600991175754e-01, 3.64282468130549597e-01, 3.67750569780596226e-01,
+	3.71235057669821344e-01, 3.74736087139491414e-01, 3.78253817247238111e-01,
+	3.81788410875031348e-01, 3.85340034841733958e-01, 3.88908860020464597e-01,
+	3.92495061461010764e-01, 3.96098818517547080e-01, 3.99720314981931668e-01,
+	4.03359739222868885e-01, 4.07017284331247953e-01, 4.10693148271983222e-01,
+	4.14387534042706784e-01, 4.18100649839684591e-01, 4.21832709231353298e-01,
+	4.25583931339900579e-01, 4.29354541031341519e-01, 4.33144769114574058e-01,
+	4.36954852549929273e-01, 4.40785034667769915e-01, 4.44635565397727750e-01,
+	4.48506701509214067e-01, 4.52398706863882505e-01, 4.56311852680773566e-01,
+	4.60246417814923481e-01, 4.64202689050278838e-01, 4.68180961407822172e-01,
+	4.72181538469883255e-01, 4.76204732721683788e-01, 4.80250865911249714e-01,
+	4.84320269428911598e-01, 4.88413284707712059e-01, 4.92530263646148658e-01,
+	4.96671569054796314e-01, 5.00837575128482149e-01, 5.05028667945828791e-01,
+	5.09245245998136142e-01, 5.13487720749743026e-01, 5.17756517232200619e-01,
+	5.22052074674794864e-01, 5.26374847174186700e-01, 5.30725304406193921e-01,
+	5.35103932383019565e-01, 5.39511234259544614e-01, 5.43947731192649941e-01,
+	5.48413963257921133e-01, 5.52910490428519918e-01, 5.57437893621486324e-01,
+	5.61996775817277916e-01, 5.66587763258951771e-01, 5.71211506738074970e-01,
+	5.75868682975210544e-01, 5.80559996103683473e-01, 5.85286179266300333e-01,
+	5.90047996335791969e-01, 5.94846243770991268e-01, 5.99681752622167719e-01,
+	6.04555390700549533e-01, 6.09468064928895381e-01, 6.14420723892076803e-01,
+	6.19414360609039205e-01, 6.24450015550274240e-01, 6.29528779928128279e-01,
+	6.34651799290960050e-01, 6.39820277456438991e-01, 6.45035480824251883e-01,
+	6.50298743114294586e-01, 6.55611470583224665e-01, 6.60975147780241357e-01,
+	6.66391343912380640e-01, 6.71861719900766374e-01, 6.77388036222513090e-01,
+	6.82972161648791376e-01, 6.88616083008527058e-01, 6.94321916130032579e-01,
+	7.00091918140490099e-01, 7.05928501336797409e-01, 7.11834248882358467e-01,
+	7.17811932634901395e-01, 7.23864533472881599e-01, 7.29995264565802437e-01,
+	7.36207598131266683e-01, 7.42505296344636245e-01, 7.48892447223726720e-01,
+	7.55373506511754500e-01, 7.61953346841546475e-01, 7.68637315803334831e-01,
+	7.75431304986138326e-01, 7.82341832659861902e-01, 7.89376143571198563e-01,
+	7.96542330428254619e-01, 8.03849483176389490e-01, 8.11307874318219935e-01,
+	8.18929191609414797e-01, 8.26726833952094231e-01, 8.34716292992930375e-01,
+	8.42915653118441077e-01, 8.51346258465123684e-01, 8.60033621203008636e-01,
+	8.69008688043793165e-01, 8.78309655816146839e-01, 8.87984660763399880e-01,
+	8.98095921906304051e-01, 9.08726440060562912e-01, 9.19991505048360247e-01,
+	9.32060075968990209e-01, 9.45198953453078028e-01, 9.59879091812415930e-01,
+	9.77101701282731328e-01, 1.00000000000000000e+00
+};
+/**@}*/
+
+/**
+ * @name Ziggurat for the Exponential Distribution
+ *
+ * @details Layer i spans [0, x[i]) and has height f[i] = exp(-x[i]).
+ */
+/**@{*/
+static const double uzig_exp_x[UZIG_LAYERS + 1] = {
+	8.69711747013105274e+00, 7.69711747013105008e+00, 6.94103362937721258e+00,
+	6.47837849383256970e+00, 6.14416466577247267e+00, 5.88214431579539987e+00,
+	5.66641016745403370e+00, 5.48289062752606249e+00, 5.32309050575439802e+00,
+	5.18148728130150005e+00, 5.05428848998130409e+00, 4.93877708590125053e+00,
+	4.83293974102511203e+00, 4.73524299660174108e+00, 4.64449188542008518e+00,
+	4.55973706170735138e+00, 4.48021174652842191e+00, 4.40528769347357319e+00,
+	4.33444368031727301e+00, 4.26724248027736586e+00, 4.20331371373518436e+00,
+	4.14234086566405146e+00, 4.08405131040829783e+00, 4.02820854464793676e+00,
+	3.97460606667378880e+00, 3.92306250013548974e+00, 3.87341767039950913e+00,
+	3.82552941852233674e+00, 3.77927099241166786e+00, 3.73452889403979738e+00,
+	3.69120109023741882e+00, 3.64919551576085377e+00, 3.60842881312890951e+00,
+	3.56882526564833702e+00, 3.53031588912934335e+00, 3.49283765477405961e+00,
+	3.45633282113276019e+00, 3.42074835725111992e+00, 3.38603544246030097e+00,
+	3.35214903090010941e+00, 3.31904747097074804e+00, 3.28669217159906868e+00,
+	3.25504730857044988e+00, 3.22407956528626416e+00, 3.19375790321224029e+00,
+	3.16405335802597287e+00, 3.13493885808444039e+00, 3.10638906233982448e+00,
+	3.07838021525409022e+00, 3.05089001661545511e+00, 3.02389750445567662e+00,
+	2.99738294951613060e+00, 2.97132775992108966e+00, 2.94571439489504572e+00,
+	2.92052628651274082e+00, 2.89574776860014182e+00, 2.87136401201553637e+00,
+	2.84736096563518881e+00, 2.82372530245003528e+00, 2.80044437025073778e+00,
+	2.77750614643975657e+00, 2.75489919656234461e+00, 2.73261263619470007e+00,
+	2.71063609586792875e+00, 2.68895968874180369e+00, 2.66757398077326657e+00,
+	2.64646996315180916e+00, 2.62563902679778849e+00, 2.60507293874083556e+00,
+	2.58476382021414075e+00, 2.56470412631690525e+00, 2.54488662711186997e+00,
+	2.52530439003782803e+00, 2.50595076352859403e+00, 2.48681936174020946e+00,
+	2.46790405029736482e+00, 2.44919893297824975e+00, 2.43069833926441969e+00,
+	2.41239681268887063e+00, 2.39428909992145789e+00, 2.37637014053614060e+00,
+	2.35863505740933732e+00, 2.34107914770303438e+00, 2.32369787439019637e+00,
+	2.30648685828357980e+00, 2.28944187053226944e+00, 2.27255882555315480e+00,
+	2.25583377436721921e+00, 2.23926289831290903e+00, 2.22284250311103682e+00,
+	2.20656901325766386e+00, 2.19043896672322003e+00, 2.17444900993777468e+00,
+	2.15859589304388599e+00, 2.14287646539984200e+00, 2.12728767131736829e+00,
+	2.11182654601904218e+00, 2.09649021180171502e+00, 2.08127587439322514e+00,
+	2.06618081949057553e+00, 2.05120240946858479e+00, 2.03633808024876961e+00,
+	2.02158533831892617e+00, 2.00694175789451856e+00, 1.99240497821357665e+00,
+	1.97797270095736044e+00, 1.96364268778954831e+00, 1.94941275800718494e+00,
+	1.93528078629705136e+00, 1.92124470059152808e+00, 1.90730248001838754e+00,
+	1.89345215293930824e+00, 1.87969179507221118e+00, 1.86601952769282797e+00,
+	1.85243351591117555e+00, 1.83893196701887995e+00, 1.82551312890351980e+00,
+	1.81217528852639065e+00, 1.79891677046029086e+00, 1.78573593548412601e+00,
+	1.77263117923130564e+00, 1.75960093088907477e+00, 1.74664365194607440e+00,
+	1.73375783498557157e+00, 1.72094200252193530e+00, 1.70819470587805777e+00,
+	1.69551452410153791e+00, 1.68290006291755390e+00, 1.67034995371645212e+00,
+	1.65786285257417276e+00, 1.64543743930372366e+00, 1.63307241653599133e+00,
+	1.62076650882825790e+00, 1.60851846179885838e+00, 1.59632704128648339e+00,
+	1.58419103253268889e+00, 1.57210923938622971e+00, 1.56008048352788808e+00,
+	1.54810360371451350e+00, 1.53617745504103209e+00, 1.52430090821922626e+00,
+	1.51247284887211708e+00, 1.50069217684281675e+00, 1.48895780551674606e+00,
+	1.47726866115613387e+00, 1.46562368224574535e+00, 1.45402181884879345e+00,
+	1.44246203197201250e+00, 1.43094329293887967e+00, 1.41946458276998322e+00,
+	1.40802489156953570e+00, 1.39662321791704214e+00, 1.38525856826312199e+00,
+	1.37392995632849058e+00, 1.36263640250508677e+00, 1.35137693325833519e+00,
+	1.34015058052950464e+00, 1.32895638113711656e+00, 1.31779337617632475e+00,
+	1.30666061041517412e+00, 1.29555713168660103e+00, 1.28448199027501264e+00,
+	1.27343423829624114e+00, 1.26241292906961533e+00, 1.25141711648085252e+00,
+	1.24044585433440657e+00, 1.22949819569384911e+00, 1.21857319220879012e+00,
+	1.20766989342676112e+00, 1.19678734608840309e+00, 1.18592459340420220e+00,
+	1.17508067431091168e+00, 1.16425462270567892e+00, 1.15344546665577474e+00,
+	1.14265222758167284e+00, 1.13187391941107851e+00, 1.12110954770133020e+00,
+	1.11035810872741103e+00, 1.09961858853259731e+00, 1.08888996193854681e+00,
+	1.07817119151137231e+00, 1.06746122647996766e+00, 1.05675900160255143e+00,
+	1.04606343597704421e+00, 1.03537343179052854e+00, 1.02468787300261721e+00,
+	1.01400562395709648e+00, 1.00332552791569674e+00, 9.92646405507275897e-01,
+	9.81967053085062602e-01, 9.71286240983903260e-01, 9.60602711668666509e-01,
+	9.49915177764075969e-01, 9.39222319955262286e-01, 9.28522784747210395e-01,
+	9.17815182070044311e-01, 9.07098082715690257e-01, 8.96370015589889935e-01,
+	8.85629464761751528e-01, 8.74874866291025066e-01, 8.64104604811004484e-01,
+	8.53317009842373353e-01, 8.42510351810368485e-01, 8.31682837734273206e-01,
+	8.20832606554411814e-01, 8.09957724057418282e-01, 7.99056177355487174e-01,
+	7.88125868869492430e-01, 7.77164609759129710e-01, 7.66170112735434672e-01,
+	7.55139984181982249e-01, 7.44071715500508102e-01, 7.32962673584365398e-01,
+	7.21810090308756203e-01, 7.10611050909655040e-01, 6.99362481103231959e-01,
+	6.88061132773747808e-01, 6.76703568029522584e-01, 6.65286141392677943e-01,
+	6.53804979847664947e-01, 6.42255960424536365e-01, 6.30634684933490286e-01,
+	6.18936451394876075e-01, 6.07156221620300030e-01, 5.95288584291502887e-01,
+	5.83327712748769489e-01, 5.71267316532588332e-01, 5.59100585511540626e-01,
+	5.46820125163310577e-01, 5.34417881237165604e-01, 5.21885051592135052e-01,
+	5.09211982443654398e-01, 4.96388045518671162e-01, 4.83401491653461857e-01,
+	4.70239275082169006e-01, 4.56886840931420235e-01, 4.43327866073552401e-01,
+	4.29543940225410703e-01, 4.15514169600356364e-01, 4.01214678896277765e-01,
+	3.86617977941119573e-01, 3.71692145329917234e-01, 3.56399760258393816e-01,
+	3.40696481064849122e-01, 3.24529117016909452e-01, 3.07832954674932158e-01,
+	2.90527955491230394e-01, 2.72513185478464703e-01, 2.53658363385912022e-01,
+	2.33790483059674731e-01, 2.12671510630966620e-01, 1.89958689622431842e-01,
+	1.65127622564187282e-01, 1.37304980940012589e-01, 1.04838507565818778e-01,
+	6.38521638150015697e-02, 0.00000000000000000e+00
+};
+static const double uzig_exp_f[UZIG_LAYERS + 1] = {
+	1.67066692307963374e-04, 4.54134353841496603e-04, 9.67269282327174319e-04,
+	1.53629978030157257e-03, 2.14596774371890713e-03, 2.78879879357407569e-03,
+	3.46026477783690405e-03, 4.15729512083379705e-03, 4.87765598354239580e-03,
+	5.61964220720548909e-03, 6.38190593731918342e-03, 7.16335318363499080e-03,
+	7.96307743801704347e-03, 8.78031498580897699e-03, 9.61441364250221163e-03,
+	1.04648101810299807e-02, 1.13310135978346004e-02, 1.22125924262553778e-02,
+	1.31091649312549911e-02, 1.40203914031819428e-02, 1.49459680116911485e-02,
+	1.58856218399731561e-02, 1.68391068260399408e-02, 1.78062004109113547e-02,
+	1.87867007446960235e-02, 1.97804243380097396e-02, 2.07872040725781138e-02,
+	2.18068875042835807e-02, 2.28393354063852402e-02, 2.38844205115581742e-02,
+	2.49420264197317866e-02, 2.60120466451342208e-02, 2.70943837809558032e-02,
+	2.81889487639786461e-02, 2.92956602246374105e-02, 3.04144439104666216e-02,
+	3.15452321728936225e-02, 3.26879635089595555e-02, 3.38425821508743577e-02,
+	3.50090376973974313e-02, 3.61872847819314433e-02, 3.73772827729593818e-02,
+	3.85789955030748713e-02, 3.97923910233741393e-02, 4.10174413804148402e-02,
+	4.22541224133162543e-02, 4.35024135688881972e-02, 4.47622977329432889e-02,
+	4.60337610761751836e-02, 4.73167929131815615e-02, 4.86113855733795036e-02,
+	4.99175342827063787e-02, 5.12352370551262815e-02, 5.25644945930716853e-02,
+	5.39053101960460801e-02, 5.52576896766970305e-02, 5.66216412837428698e-02,
+	5.79971756312006592e-02, 5.93843056334202798e-02, 6.07830464454796604e-02,
+	6.21934154085410362e-02, 6.36154319998073758e-02, 6.50491177867538045e-02,
+	6.64944963853398158e-02, 6.79515934219366430e-02, 6.94204364987287825e-02,
+	7.09010551623718427e-02, 7.23934808757087517e-02, 7.38977469923647462e-02,
+	7.54138887340584096e-02, 7.69419431704805173e-02, 7.84819492016064352e-02,
+	8.00339475423199054e-02, 8.15979807092374193e-02, 8.31740930096323966e-02,
+	8.47623305323681464e-02, 8.63627411407569268e-02, 8.79753744672702315e-02,
+	8.96002819100328862e-02, 9.12375166310401969e-02, 9.28871335560435690e-02,
+	9.45491893760558727e-02, 9.62237425504328253e-02, 9.79108533114922130e-02,
+	9.96105836706371317e-02, 1.01322997425953631e-01, 1.03048160171257702e-01,
+	1.04786139306570159e-01, 1.06537004050001632e-01, 1.08300825451033755e-01,
+	1.10077676405185357e-01, 1.11867631670056283e-01, 1.13670767882744286e-01,
+	1.15487163578633506e-01, 1.17316899211555525e-01, 1.19160057175327641e-01,
+	1.21016721826674792e-01, 1.22886979509545108e-01, 1.24770918580830933e-01,
+	1.26668629437510671e-01, 1.28580204545228199e-01, 1.30505738468330773e-01,
+	1.32445327901387494e-01, 1.34399071702213602e-01, 1.36367070926428829e-01,
+	1.38349428863580176e-01, 1.40346251074862399e-01, 1.42357645432472146e-01,
+	1.44383722160634720e-01, 1.46424593878344889e-01, 1.48480375643866735e-01,
+	1.50551185001039839e-01, 1.52637142027442801e-01, 1.54738369384468027e-01,
+	1.56854992369365148e-01, 1.58987138969314129e-01, 1.61134939917591952e-01,
+	1.63298528751901734e-01, 1.65478041874935922e-01, 1.67673618617250081e-01,
+	1.69885401302527550e-01, 1.72113535315319977e-01, 1.74358169171353411e-01,
+	1.76619454590494829e-01, 1.78897546572478278e-01, 1.81192603475496261e-01,
+	1.83504787097767436e-01, 1.85834262762197083e-01, 1.88181199404254262e-01,
+	1.90545769663195363e-01, 1.92928149976771296e-01, 1.95328520679563189e-01,
+	1.97747066105098818e-01, 2.00183974691911210e-01, 2.02639439093708962e-01,
+	2.05113656293837654e-01, 2.07606827724221982e-01, 2.10119159388988230e-01,
+	2.12650861992978224e-01, 2.15202151075378628e-01, 2.17773247148700472e-01,
+	2.20364375843359439e-01, 2.22975768058120111e-01, 2.25607660116683956e-01,
+	2.28260293930716618e-01, 2.30933917169627356e-01, 2.33628783437433291e-01,
+	2.36345152457059560e-01, 2.39083290262449094e-01, 2.41843469398877131e-01,
+	2.44625969131892024e-01, 2.47431075665327543e-01, 2.50259082368862240e-01,
+	2.53110290015629402e-01, 2.55985007030415324e-01, 2.58883549749016173e-01,
+	2.61806242689362922e-01, 2.64753418835062149e-01, 2.67725419932044739e-01,
+	2.70722596799059967e-01, 2.73745309652802915e-01, 2.76793928448517301e-01,
+	2.79868833236972869e-01, 2.82970414538780746e-01, 2.86099073737076826e-01,
+	2.89255223489677693e-01, 2.92439288161892630e-01, 2.95651704281261252e-01,
+	2.98892921015581847e-01, 3.02163400675693528e-01, 3.05463619244590256e-01,
+	3.08794066934560185e-01, 3.12155248774179606e-01, 3.15547685227128949e-01,
+	3.18971912844957239e-01, 3.22428484956089223e-01, 3.25917972393556354e-01,
+	3.29440964264136438e-01, 3.32998068761809096e-01, 3.36589914028677717e-01,
+	3.40217149066780189e-01, 3.43880444704502575e-01, 3.47580494621637148e-01,
+	3.51318016437483449e-01, 3.55093752866787626e-01, 3.58908472948750001e-01,
+	3.62762973354817997e-01, 3.66658079781514379e-01, 3.70594648435146223e-01,
+	3.74573567615902381e-01, 3.78595759409581067e-01, 3.82662181496010056e-01,
+	3.86773829084137932e-01, 3.90931736984797384e-01, 3.95136981833290435e-01,
+	3.99390684475231350e-01, 4.03694012530530555e-01, 4.08048183152032673e-01,
+	4.12454465997161457e-01, 4.16914186433003209e-01, 4.21428728997616908e-01,
+	4.25999541143034677e-01, 4.30628137288459167e-01, 4.35316103215636907e-01,
+	4.40065100842354173e-01, 4.44876873414548846e-01, 4.49753251162755330e-01,
+	4.54696157474615836e-01, 4.59707615642138023e-01, 4.64789756250426511e-01,
+	4.69944825283960310e-01, 4.75175193037377708e-01, 4.80483363930454543e-01,
+	4.85871987341885248e-01, 4.91343869594032867e-01, 4.96901987241549881e-01,
+	5.02549501841348056e-01, 5.08289776410643213e-01, 5.14126393814748894e-01,
+	5.20063177368233931e-01, 5.26104213983620062e-01, 5.32253880263043655e-01,
+	5.38516872002862246e-01, 5.44898237672440056e-01, 5.51403416540641733e-01,
+	5.58038282262587892e-01, 5.64809192912400615e-01, 5.71723048664826150e-01,
+	5.78787358602845359e-01, 5.86010318477268366e-01, 5.93400901691733762e-01,
+	6.00968966365232560e-01, 6.08725382079622346e-01, 6.16682180915207878e-01,
+	6.24852738703666200e-01, 6.33251994214366398e-01, 6.41896716427266423e-01,
+	6.50805833414571433e-01, 6.60000841079000145e-01, 6.69506316731925177e-01,
+	6.79350572264765806e-01, 6.89566496117078431e-01, 7.00192655082788606e-01,
+	7.11274760805076456e-01, 7.22867659593572465e-01, 7.35038092431424039e-01,
+	7.47868621985195658e-01, 7.61463388849896838e-01, 7.75956852040116218e-01,
+	7.91527636972496285e-01, 8.08421651523009044e-01, 8.26993296643051101e-01,
+	8.47785500623990496e-01, 8.71704332381204705e-01, 9.00469929925747703e-01,
+	9.38143680862176477e-01, 1.00000000000000000e+00
+};
+/**@}*/
+
+/**
+ * @brief Converts bits to a double.
+ *
+ * @param bits Target bits.
+ *
+ * @returns The double whose bits are @p bits.
+ */
+static inline double ubits_to_double(uint64_t bits)
+{
+	double d;
+
+	__builtin_memcpy(&d, &bits, sizeof(double));
+
+	return (d);
+}
+
+/**
+ * @brief Computes the exponential function.
+ *
+ * @param x Target number (in [-700, 700]).
+ *
+ * @returns e raised to @p x.
+ *
+ * @details The argument is reduced to r = x - k*ln(2), with |r| at
+ * most ln(2)/2, so that a degree-12 Taylor polynomial of e^r is
+ * accurate to an ulp. The result is then scaled by 2^k.
+ */
+static double uexp(double x)
+{
+	int k;
+	double r, p;
+
+	k = (int) ((x < 0) ? x*1.4426950408889634 - 0.5 : x*1.4426950408889634 + 0.5);
+	r = (x - k*ULN2_HI) - k*ULN2_LO;
+
+	p = 1.0/479001600;
+	p = p*r + 1.0/39916800;
+	p = p*r + 1.0/3628800;
+	p = p*r + 1.0/362880;
+	p = p*r + 1.0/40320;
+	p = p*r + 1.0/5040;
+	p = p*r + 1.0/720;
+	p = p*r + 1.0/120;
+	p = p*r + 1.0/24;
+	p = p*r + 1.0/6;
+	p = p*r + 0.5;
+	p = p*r + 1.0;
+	p = p*r + 1.0;
+
+	return (p*ubits_to_double((uint64_t) (k + 1023) << 52));
+}
+
+/**
+ * @brief Computes the natural logarithm.
+ *
+ * @param x Target number (positive and normal).
+ *
+ * @returns The natural logarithm of @p x.
+ *
+ * @details With x = m*2^e and m in [sqrt(2)/2, sqrt(2)), ln(m) is
+ * computed from the series of atanh((m - 1)/(m + 1)), which converges
+ * fast in that interval.
+ */
+static double uln(double x)
+{
+	int e;
+	uint64_t bits;
+	double m, s, z, p;
+
+	__builtin_memcpy(&bits, &x, sizeof(double));
+
+	e = (int) (bits >> 52) - 1023;
+	m = ubits_to_double((bits & ((1ULL << 52) - 1)) | (1023ULL << 52));
+	if (m > 1.4142135623730951)
+	{
+		m *= 0.5;
+		e++;
+	}
+
+	s = (m - 1)/(m + 1);
+	z = s*s;
+
+	p = 1.0/21;
+	p = p*z + 1.0/19;
+	p = p*z + 1.0/17;
+	p = p*z + 1.0/15;
+	p = p*z + 1.0/13;
+	p = p*z + 1.0/11;
+	p = p*z + 1.0/9;
+	p = p*z + 1.0/7;
+	p = p*z + 1.0/5;
+	p = p*z + 1.0/3;
+	p = p*z + 1.0;
+
+	return ((e*ULN2_HI + 2*s*p) + e*ULN2_LO);
+}
+
+/**
+ * @brief Generates a random number in (0, 1).
+ *
+ * @param state Target generator.
+ */
+static inline double urand_open(struct urand_state *state)
+{
+	return (((urand64(state) >> 12) + 0.5)*U2P_52);
+}
+
+/**
+ * The urand_double() function returns a uniformly distributed random
+ * number in [0, 1), drawn from the generator pointed to by @p state.
+ * All 53 bits of the mantissa are random.
+ */
+double urand_double(struct urand_state *state)
+{
+	return ((urand64(state) >> 11)*U2P_53);
+}
+
+/**
+ * The urand_float() function returns a uniformly distributed random
+ * number in [0, 1), drawn from the generator pointed to by @p state.
+ * All 24 bits of the mantissa are random.
+ */
+float urand_float(struct urand_state *state)
+{
+	return ((float) ((urand32(state) >> 8)*U2P_24));
+}
+
+/**
+ * The urand_normal() function returns a random number drawn from the
+ * standard normal distribution, using the generator pointed to by @p
+ * state. A sample with mean m and standard deviation s is obtained as
+ * m + s*urand_normal().
+ *
+ * Sampling uses a 256-layer ziggurat. The low byte of a 64-bit random
+ * number selects a layer and the upper bits a signed position within
+ * it. The position is returned if it lies inside the next layer up,
+ * which takes a table lookup and a multiplication and happens in about 99%
+ * of draws. Otherwise, the wedge is tested against the density or, in
+ * the bottom layer, the tail is sampled (Marsaglia).
+ */
+double urand_normal(struct urand_state *state)
+{
+	int i;
+	uint64_t bits;
+	double u, x, y, ax;
+
+	for (;;)
+	{
+		bits = urand64(state);
+		i = bits & (UZIG_LAYERS - 1);
+		u = 2*(((bits >> 12) + 0.5)*U2P_52) - 1;
+		x = u*uzig_norm_x[i];
+
+		/* Inside the layer. */
+		ax = (x < 0) ? -x : x;
+		if (ax < uzig_norm_x[i + 1])
+			return (x);
+
+		/* Tail. */
+		if (i == 0)
+		{
+			do
+			{
+				x = -uln(urand_open(state))/UZIG_NORM_R;
+				y = -uln(urand_open(state));
+			} while (2*y < x*x);
+
+			return ((u < 0) ? -(UZIG_NORM_R + x) : UZIG_NORM_R + x);
+		}
+
+		/* Wedge. */
+		y = uzig_norm_f[i + 1] + (uzig_norm_f[i] - uzig_norm_f[i + 1])*urand_double(state);
+		if (y < uexp(-0.5*x*x))
+			return (x);
+	}
+}
+
+/**
+ * The urand_exponential() function returns a random number drawn from
+ * the exponential distribution with rate one, using the generator
+ * pointed to by @p state. A sample with rate r is obtained as
+ * urand_exponential()/r. Sampling uses a 256-layer ziggurat, like
+ * urand_normal() does.
+ */
+double urand_exponential(struct urand_state *state)
+{
+	int i;
+	uint64_t bits;
+	double x, y;
+
+	for (;;)
+	{
+		bits = urand64(state);
+		i = bits & (UZIG_LAYERS - 1);
+		x = (((bits >> 12) + 0.5)*U2P_52)*uzig_exp_x[i];
+
+		/* Inside the layer. */
+		if (x < uzig_exp_x[i + 1])
+			return (x);
+
+		/* Tail, which is memoryless. */
+		if (i == 0)
+			return (UZIG_EXP_R - uln(urand_open(state)));
+
+		/* Wedge. */
+		y = uzig_exp_f[i + 1] + (uzig_exp_f[i] - uzig_exp_f[i + 1])*urand_double(state);
+		if (y < uexp(-x))
+			return (x);
+	}
+}
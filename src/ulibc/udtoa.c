@@ -0,0 +1,756 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "udecimal.h"
+
+/**
+ * @name Target Exponent Range of Grisu
+ */
+/**@{*/
+#define UGRISU_ALPHA -60 /**< Minimum binary exponent of scaled numbers. */
+#define UGRISU_GAMMA -32 /**< Maximum binary exponent of scaled numbers. */
+/**@}*/
+
+/**
+ * @brief Significant digits that the shortest representation can be
+ * padded to without rounding differently.
+ *
+ * @details Decimals with up to 15 significant digits are spaced wider
+ * than the rounding interval of any normal double, so that only one of
+ * them lies within half an ulp.
+ */
+#define UDTOA_DIGITS_PAD 15
+
+/**
+ * @brief Smallest decimal exponent written in scientific notation by
+ * udtoa().
+ */
+#define UDTOA_NOTATION_MAX 17
+
+/**
+ * @brief Floating-point number with a 64-bit significand.
+ *
+ * @details The value is f * 2^e.
+ */
+struct udiyfp
+{
+	uint64_t f; /* Significand. */
+	int e;      /* Exponent.    */
+};
+
+/**
+ * @brief Cached power of ten.
+ *
+ * @details The value is f * 2^e, rounded to nearest, and equals 10^k.
+ */
+struct upow10
+{
+	uint64_t f; /* Significand.      */
+	int16_t e;  /* Binary exponent.  */
+	int16_t k;  /* Decimal exponent. */
+};
+
+/**
+ * @brief Powers of ten from 10^-348 to 10^340, in steps of 10^8.
+ */
+static const struct upow10 upow10_cache[] = {
+	{ 0xfa8fd5a0081c0288ULL, -1220, -348 },
+	{ 0xbaaee17fa23ebf76ULL, -1193, -340 },
+	{ 0x8b16fb203055ac76ULL, -1166, -332 },
+	{ 0xcf42894a5dce35eaULL, -1140, -324 },
+	{ 0x9a6bb0aa55653b2dULL, -1113, -316 },
+	{ 0xe61acf033d1a45dfULL, -1087, -308 },
+	{ 0xab70fe17c79ac6caULL, -1060, -300 },
+	{ 0xff77b1fcbebcdc4fULL, -1034, -292 },
+	{ 0xbe5691ef416bd60cULL, -1007, -284 },
+	{ 0x8dd01fad907ffc3cULL,  -980, -276 },
+	{ 0xd3515c2831559a83ULL,  -954, -268 },
+	{ 0x9d71ac8fada6c9b5ULL,  -927, -260 },
+	{ 0xea9c227723ee8bcbULL,  -901, -252 },
+	{ 0xaecc49914078536dULL,  -874, -244 },
+	{ 0x823c12795db6ce57ULL,  -847, -236 },
+	{ 0xc21094364dfb5637ULL,  -821, -228 },
+	{ 0x9096ea6f3848984fULL,  -794, -220 },
+	{ 0xd77485cb25823ac7ULL,  -768, -212 },
+	{ 0xa086cfcd97bf97f4ULL,  -741, -204 },
+	{ 0xef340a98172aace5ULL,  -715, -196 },
+	{ 0xb23867fb2a35b28eULL,  -688, -188 },
+	{ 0x84c8d4dfd2c63f3bULL,  -661, -180 },
+	{ 0xc5dd44271ad3cdbaULL,  -635, -172 },
+	{ 0x936b9fcebb25c996ULL,  -608, -164 },
+	{ 0xdbac6c247d62a584ULL,  -582, -156 },
+	{ 0xa3ab66580d5fdaf6ULL,  -555, -148 },
+	{ 0xf3e2f893dec3f126ULL,  -529, -140 },
+	{ 0xb5b5ada8aaff80b8ULL,  -502, -132 },
+	{ 0x87625f056c7c4a8bULL,  -475, -124 },
+	{ 0xc9bcff6034c13053ULL,  -449, -116 },
+	{ 0x964e858c91ba2655ULL,  -422, -108 },
+	{ 0xdff9772470297ebdULL,  -396, -100 },
+	{ 0xa6dfbd9fb8e5b88fULL,  -369,  -92 },
+	{ 0xf8a95fcf88747d94ULL,  -343,  -84 },
+	{ 0xb94470938fa89bcfULL,  -316,  -76 },
+	{ 0x8a08f0f8bf0f156bULL,  -289,  -68 },
+	{ 0xcdb02555653131b6ULL,  -263,  -60 },
+	{ 0x993fe2c6d07b7facULL,  -236,  -52 },
+	{ 0xe45c10c42a2b3b06ULL,  -210,  -44 },
+	{ 0xaa242499697392d3ULL,  -183,  -36 },
+	{ 0xfd87b5f28300ca0eULL,  -157,  -28 },
+	{ 0xbce5086492111aebULL,  -130,  -20 },
+	{ 0x8cbccc096f5088ccULL,  -103,  -12 },
+	{ 0xd1b71758e219652cULL,   -77,   -4 },
+	{ 0x9c40000000000000ULL,   -50,    4 },
+	{ 0xe8d4a51000000000ULL,   -24,   12 },
+	{ 0xad78ebc5ac620000ULL,     3,   20 },
+	{ 0x813f3978f8940984ULL,    30,   28 },
+	{ 0xc097ce7bc90715b3ULL,    56,   36 },
+	{ 0x8f7e32ce7bea5c70ULL,    83,   44 },
+	{ 0xd5d238a4abe98068ULL,   109,   52 },
+	{ 0x9f4f2726179a2245ULL,   136,   60 },
+	{ 0xed63a231d4c4fb27ULL,   162,   68 },
+	{ 0xb0de65388cc8ada8ULL,   189,   76 },
+	{ 0x83c7088e1aab65dbULL,   216,   84 },
+	{ 0xc45d1df942711d9aULL,   242,   92 },
+	{ 0x924d692ca61be758ULL,   269,  100 },
+	{ 0xda01ee641a708deaULL,   295,  108 },
+	{ 0xa26da3999aef774aULL,   322,  116 },
+	{ 0xf209787bb47d6b85ULL,   348,  124 },
+	{ 0xb454e4a179dd1877ULL,   375,  132 },
+	{ 0x865b86925b9bc5c2ULL,   402,  140 },
+	{ 0xc83553c5c8965d3dULL,   428,  148 },
+	{ 0x952ab45cfa97a0b3ULL,   455,  156 },
+	{ 0xde469fbd99a05fe3ULL,   481,  164 },
+	{ 0xa59bc234db398c25ULL,   508,  172 },
+	{ 0xf6c69a72a3989f5cULL,   534,  180 },
+	{ 0xb7dcbf5354e9beceULL,   561,  188 },
+	{ 0x88fcf317f22241e2ULL,   588,  196 },
+	{ 0xcc20ce9bd35c78a5ULL,   614,  204 },
+	{ 0x98165af37b2153dfULL,   641,  212 },
+	{ 0xe2a0b5dc971f303aULL,   667,  220 },
+	{ 0xa8d9d1535ce3b396ULL,   694,  228 },
+	{ 0xfb9b7cd9a4a7443cULL,   720,  236 },
+	{ 0xbb764c4ca7a44410ULL,   747,  244 },
+	{ 0x8bab8eefb6409c1aULL,   774,  252 },
+	{ 0xd01fef10a657842cULL,   800,  260 },
+	{ 0x9b10a4e5e9913129ULL,   827,  268 },
+	{ 0xe7109bfba19c0c9dULL,   853,  276 },
+	{ 0xac2820d9623bf429ULL,   880,  284 },
+	{ 0x80444b5e7aa7cf85ULL,   907,  292 },
+	{ 0xbf21e44003acdd2dULL,   933,  300 },
+	{ 0x8e679c2f5e44ff8fULL,   960,  308 },
+	{ 0xd433179d9c8cb841ULL,   986,  316 },
+	{ 0x9e19db92b4e31ba9ULL,  1013,  324 },
+	{ 0xeb96bf6ebadf77d9ULL,  1039,  332 },
+	{ 0xaf87023b9bf0ee6bULL,  1066,  340 },
+};
+
+/**
+ * @brief Number of cached powers of ten.
+ */
+#define UPOW10_CACHE_SIZE ((int) (sizeof(upow10_cache)/sizeof(upow10_cache[0])))
+
+/**
+ * @brief Normalizes a floating-point number.
+ *
+ * @param x Target number (nonzero).
+ *
+ * @returns @p x with the most significant bit of its significand set.
+ */
+static inline struct udiyfp udiyfp_normalize(struct udiyfp x)
+{
+	int shift;
+
+	shift = __builtin_clzll(x.f);
+	x.f <<= shift;
+	x.e -= shift;
+
+	return (x);
+}
+
+/**
+ * @brief Multiplies two floating-point numbers.
+ *
+ * @param x First operand.
+ * @param y Second operand.
+ *
+ * @returns The product of @p x and @p y, rounded to 64 bits.
+ *
+ * @note The product is assembled from 32x32-bit partial products, so
+ * that targets with 32-bit registers do not need software routines.
+ */
+static inline struct udiyfp udiyfp_mul(struct udiyfp x, struct udiyfp y)
+{
+	uint64_t a, b, c, d;
+	uint64_t ac, bc, ad, bd, tmp;
+	struct udiyfp r;
+
+	a = x.f >> 32;
+	b = (uint32_t) x.f;
+	c = y.f >> 32;
+	d = (uint32_t) y.f;
+
+	ac = a*c;
+	bc = b*c;
+	ad = a*d;
+	bd = b*d;
+
+	/* Round. */
+	tmp = (bd >> 32) + (uint32_t) ad + (uint32_t) bc + (1U << 31);
+
+	r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+	r.e = x.e + y.e + 64;
+
+	return (r);
+}
+
+/**
+ * @brief Looks up a cached power of ten.
+ *
+ * @param e Binary exponent of the number to scale.
+ * @param k Decimal exponent of the cached power.
+ *
+ * @returns A power of ten c such that the binary exponent of the
+ * product of a number with exponent @p e and c lies within
+ * [UGRISU_ALPHA, UGRISU_GAMMA].
+ */
+static struct udiyfp upow10_lookup(int e, int *k)
+{
+	int i;
+	int min;
+	struct udiyfp c;
+
+	min = UGRISU_ALPHA - (e + 64);
+
+	/* Cached powers are roughly 26.6 binary orders of magnitude apart. */
+	i = ((min - upow10_cache[0].e)*77) >> 11;
+	if (i < 0)
+		i = 0;
+	while ((i < UPOW10_CACHE_SIZE - 1) && (upow10_cache[i].e < min))
+		i++;
+	while ((i > 0) && (upow10_cache[i].e > min + (UGRISU_GAMMA - UGRISU_ALPHA)))
+		i--;
+
+	c.f = upow10_cache[i].f;
+	c.e = upow10_cache[i].e;
+	*k = upow10_cache[i].k;
+
+	return (c);
+}
+
+/**
+ * @brief Powers of ten that fit in 32 bits.
+ */
+static const uint32_t upow10_32[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+	1000000000
+};
+
+/**
+ * @brief Weeds out the last generated digit.
+ *
+ * @param digits     Generated digits.
+ * @param nd         Number of generated digits.
+ * @param too_high_w Distance from the upper boundary to the number.
+ * @param unsafe     Width of the unsafe interval.
+ * @param rest       Distance from the upper boundary to the digits.
+ * @param ten_kappa  Weight of the last digit.
+ * @param unit       Accumulated error.
+ *
+ * @returns Non-zero if the digits are provably the closest to the
+ * number among the shortest ones, zero otherwise.
+ *
+ * @details The last digit is decremented while that brings the digits
+ * closer to the number. Since the scaled number and its boundaries are
+ * off by up to @p unit, the result is only accepted when no other
+ * candidate may be closer.
+ */
+static int ugrisu_weed(
+	unsigned char *digits,
+	int nd,
+	uint64_t too_high_w,
+	uint64_t unsafe,
+	uint64_t rest,
+	uint64_t ten_kappa,
+	uint64_t unit
+)
+{
+	uint64_t small;
+	uint64_t big;
+
+	small = too_high_w - unit;
+	big = too_high_w + unit;
+
+	while ((rest < small) && (unsafe - rest >= ten_kappa) &&
+		((rest + ten_kappa < small) || (small - rest >= rest + ten_kappa - small)))
+	{
+		digits[nd - 1]--;
+		rest += ten_kappa;
+	}
+
+	/* Another candidate may be closer. */
+	if ((rest < big) && (unsafe - rest >= ten_kappa) &&
+		((rest + ten_kappa < big) || (big - rest > rest + ten_kappa - big)))
+		return (0);
+
+	/* Digits must lie safely within the rounding interval. */
+	return ((2*unit <= rest) && (rest <= unsafe - 4*unit));
+}
+
+/**
+ * @brief Generates the shortest digits of a number (Grisu3).
+ *
+ * @param low    Scaled lower boundary.
+ * @param w      Scaled number.
+ * @param high   Scaled upper boundary.
+ * @param digits Generated digits.
+ * @param nd     Number of generated digits.
+ * @param kappa  Decimal exponent of the generated digits.
+ *
+ * @returns Non-zero if the digits are provably the shortest and
+ * closest, zero otherwise.
+ *
+ * @details Digits of the upper boundary are generated until they fall
+ * within the unsafe interval, which is the rounding interval widened
+ * by the error of the scaling. The integral part is handled with
+ * 32-bit arithmetic and the fractional part with 64-bit fixed point.
+ */
+static int ugrisu_digits(
+	struct udiyfp low,
+	struct udiyfp w,
+	struct udiyfp high,
+	unsigned char *digits,
+	int *nd,
+	int *kappa
+)
+{
+	int shift;
+	uint64_t unit;
+	uint64_t one;
+	uint64_t unsafe;
+	uint64_t too_low, too_high;
+	uint64_t fractionals, rest;
+	uint32_t integrals, divisor, digit;
+
+	unit = 1;
+	too_low = low.f - unit;
+	too_high = high.f + unit;
+	unsafe = too_high - too_low;
+
+	shift = -w.e;
+	one = 1ULL << shift;
+	integrals = (uint32_t) (too_high >> shift);
+	fractionals = too_high & (one - 1);
+
+	/* Integral digits. */
+	for (*kappa = 0; (*kappa < 10) && (integrals >= upow10_32[*kappa]); (*kappa)++)
+		/* noop */ ;
+
+	*nd = 0;
+	while (*kappa > 0)
+	{
+		divisor = upow10_32[*kappa - 1];
+		digit = integrals/divisor;
+		digits[(*nd)++] = digit;
+		integrals -= digit*divisor;
+		(*kappa)--;
+
+		rest = ((uint64_t) integrals << shift) + fractionals;
+		if (rest < unsafe)
+		{
+			return (ugrisu_weed(digits, *nd, too_high - w.f, unsafe, rest,
+				(uint64_t) divisor << shift, unit));
+		}
+	}
+
+	/* Fractional digits. */
+	for (;;)
+	{
+		fractionals *= 10;
+		unit *= 10;
+		unsafe *= 10;
+
+		digits[(*nd)++] = fractionals >> shift;
+		fractionals &= one - 1;
+		(*kappa)--;
+
+		if (fractionals < unsafe)
+		{
+			return (ugrisu_weed(digits, *nd, (too_high - w.f)*unit, unsafe,
+				fractionals, one, unit));
+		}
+	}
+}
+
+/**
+ * @brief Computes the shortest digits of a double with Grisu3.
+ *
+ * @param a     Target decimal.
+ * @param f     Significand.
+ * @param e     Binary exponent.
+ * @param lower Is the lower boundary closer?
+ *
+ * @returns Non-zero if the digits in @p a are the shortest and
+ * closest, zero otherwise.
+ */
+static int ugrisu(struct udecimal *a, uint64_t f, int e, int lower)
+{
+	int k, kappa;
+	struct udiyfp w, c;
+	struct udiyfp plus, minus;
+
+	w.f = f;
+	w.e = e;
+	w = udiyfp_normalize(w);
+
+	/* Boundaries are halfway to the neighbouring doubles. */
+	plus.f = (f << 1) + 1;
+	plus.e = e - 1;
+	plus = udiyfp_normalize(plus);
+	if (lower)
+	{
+		minus.f = (f << 2) - 1;
+		minus.e = e - 2;
+	}
+	else
+	{
+		minus.f = (f << 1) - 1;
+		minus.e = e - 1;
+	}
+	minus.f <<= minus.e - plus.e;
+	minus.e = plus.e;
+
+	/* Scale. */
+	c = upow10_lookup(w.e, &k);
+	w = udiyfp_mul(w, c);
+	plus = udiyfp_mul(plus, c);
+	minus = udiyfp_mul(minus, c);
+
+	if (!ugrisu_digits(minus, w, plus, a->d, &a->nd, &kappa))
+		return (0);
+
+	a->dp = a->nd + kappa - k;
+	a->trunc = 0;
+	__udecimal_trim(a);
+
+	return (1);
+}
+
+/**
+ * @brief Rounds an exact decimal to its shortest representation.
+ *
+ * @param a    Target decimal.
+ * @param mant Mantissa.
+ * @param exp  Exponent.
+ *
+ * @details The exact value of the double is mant * 2^(exp - 52). The
+ * boundaries of its rounding interval are computed exactly as well,
+ * and the decimal is rounded at the first digit where it may move
+ * within the interval.
+ */
+static void udtoa_shortest(struct udecimal *a, uint64_t mant, int exp)
+{
+	int ui, mi, li;
+	int inclusive;
+	int okdown, okup;
+	int upperdelta;
+	int explo;
+	unsigned l, m, u;
+	uint64_t mantlo;
+	struct udecimal upper;
+	struct udecimal lower;
+
+	/* Integers with enough digits are already the shortest. */
+	if ((exp > UDBL_BIAS + 1) &&
+		(332*(a->dp - a->nd) >= 100*(exp - UDBL_MANTBITS)))
+		return;
+
+	/* Upper boundary. */
+	__udecimal_assign(&upper, 2*mant + 1);
+	__udecimal_shift(&upper, exp - UDBL_MANTBITS - 1);
+
+	/* Lower boundary, which is closer at powers of two. */
+	if ((mant > (1ULL << UDBL_MANTBITS)) || (exp == UDBL_BIAS + 1))
+	{
+		mantlo = mant - 1;
+		explo = exp;
+	}
+	else
+	{
+		mantlo = 2*mant - 1;
+		explo = exp - 1;
+	}
+	__udecimal_assign(&lower, 2*mantlo + 1);
+	__udecimal_shift(&lower, explo - UDBL_MANTBITS - 1);
+
+	/* Boundaries round to the number if the mantissa is even. */
+	inclusive = !(mant & 1);
+
+	upperdelta = 0;
+	for (ui = 0; /* noop */; ui++)
+	{
+		mi = ui - upper.dp + a->dp;
+		if (mi >= a->nd)
+			break;
+		li = ui - upper.dp + lower.dp;
+
+		l = ((li >= 0) && (li < lower.nd)) ? lower.d[li] : 0;
+		m = (mi >= 0) ? a->d[mi] : 0;
+		u = (ui < upper.nd) ? upper.d[ui] : 0;
+
+		/* Rounding down stays above the lower boundary? */
+		okdown = (l != m) || (inclusive && (li + 1 == lower.nd));
+
+		/* Rounding up stays below the upper boundary? */
+		if ((upperdelta == 0) && (m + 1 < u))
+			upperdelta = 2;
+		else if ((upperdelta == 0) && (m != u))
+			upperdelta = 1;
+		else if ((upperdelta == 1) && ((m != 9) || (u != 0)))
+			upperdelta = 2;
+		okup = (upperdelta > 0) &&
+			(inclusive || (upperdelta > 1) || (ui + 1 < upper.nd));
+
+		if (okdown && okup)
+		{
+			__udecimal_round(a, mi + 1);
+			return;
+		}
+		else if (okdown)
+		{
+			__udecimal_round_down(a, mi + 1);
+			return;
+		}
+		else if (okup)
+		{
+			__udecimal_round_up(a, mi + 1);
+			return;
+		}
+	}
+}
+
+/**
+ * The __udtoa() function converts the finite and non-negative double
+ * @p v to the decimal pointed to by @p a. If @p mode is UDTOA_SHORTEST,
+ * the shortest digits that convert back to @p v are produced. If @p
+ * mode is UDTOA_DIGITS, @p v is rounded to @p n significant digits. If
+ * @p mode is UDTOA_FIXED, @p v is rounded to @p n digits after the
+ * decimal point.
+ *
+ * The shortest digits are computed with Grisu3, which relies on 64-bit
+ * integer arithmetic only and succeeds for about 99.5% of doubles.
+ * Rounded digits are derived from the shortest ones whenever that is
+ * provably correct. Remaining cases fall back to the exact decimal
+ * expansion of @p v.
+ */
+void __udtoa(double v, int mode, int n, struct udecimal *a)
+{
+	int nd;
+	int exp;
+	int e;
+	uint64_t bits;
+	uint64_t mant;
+	uint64_t f;
+
+	__builtin_memcpy(&bits, &v, sizeof(uint64_t));
+
+	mant = bits & ((1ULL << UDBL_MANTBITS) - 1);
+	exp = (bits >> UDBL_MANTBITS) & ((1 << UDBL_EXPBITS) - 1);
+
+	/* Zero. */
+	if ((mant == 0) && (exp == 0))
+	{
+		a->nd = 0;
+		a->dp = 0;
+		a->trunc = 0;
+		return;
+	}
+
+	/* Denormal. */
+	if (exp == 0)
+		exp++;
+	else
+		mant |= 1ULL << UDBL_MANTBITS;
+	exp += UDBL_BIAS;
+
+	/* Fast path. */
+	f = mant;
+	e = exp - UDBL_MANTBITS;
+	if (ugrisu(a, f, e, (f == (1ULL << UDBL_MANTBITS)) && (exp > UDBL_BIAS + 1)))
+	{
+		if (mode == UDTOA_SHORTEST)
+			return;
+
+		nd = (mode == UDTOA_FIXED) ? a->dp + n : n;
+
+		/* Rounds to zero. */
+		if (nd < 0)
+		{
+			a->nd = 0;
+			a->dp = 0;
+			return;
+		}
+
+		/*
+		 * Rounding the shortest digits is exact, unless
+		 * they end exactly halfway between the candidates.
+		 */
+		if (nd < a->nd)
+		{
+			if ((a->d[nd] != 5) || (nd + 1 != a->nd))
+			{
+				if (a->d[nd] >= 5)
+					__udecimal_round_up(a, nd);
+				else
+					__udecimal_round_down(a, nd);
+				return;
+			}
+		}
+
+		/*
+		 * The shortest digits are the closest ones of their
+		 * length, as long as the rounding interval is symmetric.
+		 */
+		else if ((nd == a->nd) && (f != (1ULL << UDBL_MANTBITS)))
+			return;
+
+		/* Padding the shortest digits is exact. */
+		else if ((nd <= UDTOA_DIGITS_PAD) && (f >= (1ULL << UDBL_MANTBITS)))
+			return;
+
+		/* Integers below 2^53 are their own shortest digits. */
+		else if ((e <= 0) && (e >= -UDBL_MANTBITS) && !(f & ((1ULL << -e) - 1)))
+			return;
+	}
+
+	/* Slow path. */
+	__udecimal_assign(a, mant);
+	__udecimal_shift(a, exp - UDBL_MANTBITS);
+
+	switch (mode)
+	{
+		case UDTOA_DIGITS:
+			__udecimal_round(a, n);
+			break;
+
+		case UDTOA_FIXED:
+			__udecimal_round(a, a->dp + n);
+			break;
+
+		default:
+			udtoa_shortest(a, mant, exp);
+			break;
+	}
+}
+
+/**
+ * The udtoa() function converts the double @p v to the shortest string
+ * that converts back to @p v. Numbers with decimal exponents in [-4,
+ * 17) are written in decimal notation, and all others in scientific
+ * notation, like %g does.
+ */
+size_t udtoa(double v, char *buf)
+{
+	int i;
+	int exp10;
+	uint64_t bits;
+	char *p;
+	struct udecimal a;
+
+	p = buf;
+
+	__builtin_memcpy(&bits, &v, sizeof(uint64_t));
+
+	/* Sign. */
+	if (bits >> 63)
+	{
+		*p++ = '-';
+		bits &= ~(1ULL << 63);
+		__builtin_memcpy(&v, &bits, sizeof(double));
+	}
+
+	/* Infinity and not a number. */
+	if ((bits >> UDBL_MANTBITS) == ((1 << UDBL_EXPBITS) - 1))
+	{
+		umemcpy(p, (bits << (64 - UDBL_MANTBITS)) ? "nan" : "inf", 3);
+		p += 3;
+		*p = '\0';
+		return (p - buf);
+	}
+
+	__udtoa(v, UDTOA_SHORTEST, 0, &a);
+
+	/* Zero. */
+	if (a.nd == 0)
+	{
+		*p++ = '0';
+		*p = '\0';
+		return (p - buf);
+	}
+
+	exp10 = a.dp - 1;
+
+	/* Scientific notation. */
+	if ((exp10 < -4) || (exp10 >= UDTOA_NOTATION_MAX))
+	{
+		*p++ = '0' + a.d[0];
+		if (a.nd > 1)
+		{
+			*p++ = '.';
+			for (i = 1; i < a.nd; i++)
+				*p++ = '0' + a.d[i];
+		}
+
+		*p++ = 'e';
+		*p++ = (exp10 < 0) ? '-' : '+';
+		if (exp10 < 0)
+			exp10 = -exp10;
+		if (exp10 < 10)
+			*p++ = '0';
+		p += uutoa(exp10, p);
+
+		return (p - buf);
+	}
+
+	/* Integral part. */
+	if (a.dp <= 0)
+		*p++ = '0';
+	for (i = 0; i < a.dp; i++)
+		*p++ = '0' + ((i < a.nd) ? a.d[i] : 0);
+
+	/* Fractional part. */
+	if (a.nd > a.dp)
+	{
+		*p++ = '.';
+		for (i = a.dp; i < 0; i++)
+			*p++ = '0';
+		for (i = (a.dp > 0) ? a.dp : 0; i < a.nd; i++)
+			*p++ = '0' + a.d[i];
+	}
+
+	*p = '\0';
+
+	return (p - buf);
+}
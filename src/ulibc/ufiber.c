@@ -0,0 +1,788 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Number of fiber schedulers.
+ */
+#define UFIBER_SCHEDS_MAX (THREAD_MAX + 1)
+
+/**
+ * @name States of a Fiber
+ */
+/**@{*/
+#define UFIBER_READY   0 /**< Waiting in the run queue.  */
+#define UFIBER_RUNNING 1 /**< Running.                   */
+#define UFIBER_BLOCKED 2 /**< Waiting for another fiber. */
+#define UFIBER_DONE    3 /**< Terminated.                */
+/**@}*/
+
+/*============================================================================*
+ * Context Switch                                                             *
+ *============================================================================*/
+
+/*
+ * A context holds the callee-saved registers of a fiber, its stack
+ * pointer and the address where it resumes. The switch routine saves
+ * the context of the caller and loads the other one, so that it returns
+ * into the other fiber. A new fiber resumes into a trampoline, which
+ * passes the fiber, held in a callee-saved register, to
+ * __ufiber_main(). Thread pointers are not switched, since all fibers
+ * of a thread share them.
+ */
+
+#if defined(__x86_64__)
+
+	/**
+	 * @name Context Layout
+	 */
+	/**@{*/
+	#define UFIBER_CONTEXT_REGS 8 /**< Number of registers.            */
+	#define UFIBER_CONTEXT_SP   0 /**< Stack pointer (rsp).            */
+	#define UFIBER_CONTEXT_PC   1 /**< Resume address.                 */
+	#define UFIBER_CONTEXT_ARG  2 /**< Trampoline argument (rbx).      */
+	#define UFIBER_STACK_BIAS   0 /**< Stack pointer offset from top.  */
+	/**@}*/
+
+	__asm__(
+		".text\n"
+		".globl __ufiber_switch\n"
+		".type __ufiber_switch, @function\n"
+		"__ufiber_switch:\n"
+		"	movq (%rsp), %rax\n"
+		"	leaq 8(%rsp), %rcx\n"
+		"	movq %rcx, 0(%rdi)\n"
+		"	movq %rax, 8(%rdi)\n"
+		"	movq %rbx, 16(%rdi)\n"
+		"	movq %rbp, 24(%rdi)\n"
+		"	movq %r12, 32(%rdi)\n"
+		"	movq %r13, 40(%rdi)\n"
+		"	movq %r14, 48(%rdi)\n"
+		"	movq %r15, 56(%rdi)\n"
+		"	movq 16(%rsi), %rbx\n"
+		"	movq 24(%rsi), %rbp\n"
+		"	movq 32(%rsi), %r12\n"
+		"	movq 40(%rsi), %r13\n"
+		"	movq 48(%rsi), %r14\n"
+		"	movq 56(%rsi), %r15\n"
+		"	movq 0(%rsi), %rsp\n"
+		"	jmp *8(%rsi)\n"
+		".size __ufiber_switch, .-__ufiber_switch\n"
+		".globl __ufiber_start\n"
+		".type __ufiber_start, @function\n"
+		"__ufiber_start:\n"
+		"	movq %rbx, %rdi\n"
+		"	call __ufiber_main\n"
+		"	ud2\n"
+		".size __ufiber_start, .-__ufiber_start\n"
+	);
+
+#elif defined(__i386__)
+
+	/**
+	 * @name Context Layout
+	 */
+	/**@{*/
+	#define UFIBER_CONTEXT_REGS 6  /**< Number of registers.           */
+	#define UFIBER_CONTEXT_SP   0  /**< Stack pointer (esp).           */
+	#define UFIBER_CONTEXT_PC   1  /**< Resume address.                */
+	#define UFIBER_CONTEXT_ARG  2  /**< Trampoline argument (ebx).     */
+	#define UFIBER_STACK_BIAS   12 /**< Stack pointer offset from top. */
+	/**@}*/
+
+	__asm__(
+		".text\n"
+		".globl __ufiber_switch\n"
+		".type __ufiber_switch, @function\n"
+		"__ufiber_switch:\n"
+		"	movl 4(%esp), %eax\n"
+		"	movl 8(%esp), %edx\n"
+		"	movl (%esp), %ecx\n"
+		"	movl %ecx, 4(%eax)\n"
+		"	leal 4(%esp), %ecx\n"
+		"	movl %ecx, 0(%eax)\n"
+		"	movl %ebx, 8(%eax)\n"
+		"	movl %ebp, 12(%eax)\n"
+		"	movl %esi, 16(%eax)\n"
+		"	movl %edi, 20(%eax)\n"
+		"	movl 8(%edx), %ebx\n"
+		"	movl 12(%edx), %ebp\n"
+		"	movl 16(%edx), %esi\n"
+		"	movl 20(%edx), %edi\n"
+		"	movl 0(%edx), %esp\n"
+		"	jmp *4(%edx)\n"
+		".size __ufiber_switch, .-__ufiber_switch\n"
+		".globl __ufiber_start\n"
+		".type __ufiber_start, @function\n"
+		"__ufiber_start:\n"
+		"	pushl %ebx\n"
+		"	call __ufiber_main\n"
+		"	ud2\n"
+		".size __ufiber_start, .-__ufiber_start\n"
+	);
+
+#elif defined(__riscv) && (__riscv_xlen == 32)
+
+	/**
+	 * @name Context Layout
+	 */
+	/**@{*/
+	#if defined(__riscv_flen)
+		#define UFIBER_CONTEXT_REGS 38 /**< Number of registers.      */
+	#else
+		#define UFIBER_CONTEXT_REGS 14 /**< Number of registers.      */
+	#endif
+	#define UFIBER_CONTEXT_PC   0  /**< Resume address (ra).           */
+	#define UFIBER_CONTEXT_SP   1  /**< Stack pointer (sp).            */
+	#define UFIBER_CONTEXT_ARG  2  /**< Trampoline argument (s0).      */
+	#define UFIBER_STACK_BIAS   0  /**< Stack pointer offset from top. */
+	/**@}*/
+
+	/**
+	 * @brief Saves and restores floating-point callee-saved registers.
+	 */
+	#if defined(__riscv_flen) && (__riscv_flen == 64)
+		#define UFIBER_RISCV_FP(op)                          \
+			"	f" op "d fs0, 56(a0)\n"  "	f" op "d fs1, 64(a0)\n"   \
+			"	f" op "d fs2, 72(a0)\n"  "	f" op "d fs3, 80(a0)\n"   \
+			"	f" op "d fs4, 88(a0)\n"  "	f" op "d fs5, 96(a0)\n"   \
+			"	f" op "d fs6, 104(a0)\n" "	f" op "d fs7, 112(a0)\n"  \
+			"	f" op "d fs8, 120(a0)\n" "	f" op "d fs9, 128(a0)\n"  \
+			"	f" op "d fs10, 136(a0)\n" "	f" op "d fs11, 144(a0)\n"
+	#elif defined(__riscv_flen)
+		#define UFIBER_RISCV_FP(op)                          \
+			"	f" op "w fs0, 56(a0)\n"  "	f" op "w fs1, 64(a0)\n"   \
+			"	f" op "w fs2, 72(a0)\n"  "	f" op "w fs3, 80(a0)\n"   \
+			"	f" op "w fs4, 88(a0)\n"  "	f" op "w fs5, 96(a0)\n"   \
+			"	f" op "w fs6, 104(a0)\n" "	f" op "w fs7, 112(a0)\n"  \
+			"	f" op "w fs8, 120(a0)\n" "	f" op "w fs9, 128(a0)\n"  \
+			"	f" op "w fs10, 136(a0)\n" "	f" op "w fs11, 144(a0)\n"
+	#else
+		#define UFIBER_RISCV_FP(op) ""
+	#endif
+
+	__asm__(
+		".text\n"
+		".globl __ufiber_switch\n"
+		".type __ufiber_switch, @function\n"
+		"__ufiber_switch:\n"
+		"	sw ra, 0(a0)\n"
+		"	sw sp, 4(a0)\n"
+		"	sw s0, 8(a0)\n"
+		"	sw s1, 12(a0)\n"
+		"	sw s2, 16(a0)\n"
+		"	sw s3, 20(a0)\n"
+		"	sw s4, 24(a0)\n"
+		"	sw s5, 28(a0)\n"
+		"	sw s6, 32(a0)\n"
+		"	sw s7, 36(a0)\n"
+		"	sw s8, 40(a0)\n"
+		"	sw s9, 44(a0)\n"
+		"	sw s10, 48(a0)\n"
+		"	sw s11, 52(a0)\n"
+		UFIBER_RISCV_FP("s")
+		"	mv a0, a1\n"
+		"	lw ra, 0(a0)\n"
+		"	lw sp, 4(a0)\n"
+		"	lw s0, 8(a0)\n"
+		"	lw s1, 12(a0)\n"
+		"	lw s2, 16(a0)\n"
+		"	lw s3, 20(a0)\n"
+		"	lw s4, 24(a0)\n"
+		"	lw s5, 28(a0)\n"
+		"	lw s6, 32(a0)\n"
+		"	lw s7, 36(a0)\n"
+		"	lw s8, 40(a0)\n"
+		"	lw s9, 44(a0)\n"
+		"	lw s10, 48(a0)\n"
+		"	lw s11, 52(a0)\n"
+		UFIBER_RISCV_FP("l")
+		"	ret\n"
+		".size __ufiber_switch, .-__ufiber_switch\n"
+		".globl __ufiber_start\n"
+		".type __ufiber_start, @function\n"
+		"__ufiber_start:\n"
+		"	mv a0, s0\n"
+		"	call __ufiber_main\n"
+		"	unimp\n"
+		".size __ufiber_start, .-__ufiber_start\n"
+	);
+
+#elif defined(__or1k__)
+
+	/**
+	 * @name Context Layout
+	 */
+	/**@{*/
+	#define UFIBER_CONTEXT_REGS 12 /**< Number of registers.           */
+	#define UFIBER_CONTEXT_SP   0  /**< Stack pointer (r1).            */
+	#define UFIBER_CONTEXT_PC   2  /**< Resume address (r9).           */
+	#define UFIBER_CONTEXT_ARG  3  /**< Trampoline argument (r14).     */
+	#define UFIBER_STACK_BIAS   0  /**< Stack pointer offset from top. */
+	/**@}*/
+
+	__asm__(
+		".text\n"
+		".globl __ufiber_switch\n"
+		".type __ufiber_switch, @function\n"
+		"__ufiber_switch:\n"
+		"	l.sw 0(r3), r1\n"
+		"	l.sw 4(r3), r2\n"
+		"	l.sw 8(r3), r9\n"
+		"	l.sw 12(r3), r14\n"
+		"	l.sw 16(r3), r16\n"
+		"	l.sw 20(r3), r18\n"
+		"	l.sw 24(r3), r20\n"
+		"	l.sw 28(r3), r22\n"
+		"	l.sw 32(r3), r24\n"
+		"	l.sw 36(r3), r26\n"
+		"	l.sw 40(r3), r28\n"
+		"	l.sw 44(r3), r30\n"
+		"	l.lwz r1, 0(r4)\n"
+		"	l.lwz r2, 4(r4)\n"
+		"	l.lwz r9, 8(r4)\n"
+		"	l.lwz r14, 12(r4)\n"
+		"	l.lwz r16, 16(r4)\n"
+		"	l.lwz r18, 20(r4)\n"
+		"	l.lwz r20, 24(r4)\n"
+		"	l.lwz r22, 28(r4)\n"
+		"	l.lwz r24, 32(r4)\n"
+		"	l.lwz r26, 36(r4)\n"
+		"	l.lwz r28, 40(r4)\n"
+		"	l.lwz r30, 44(r4)\n"
+		"	l.jr r9\n"
+		"	l.nop\n"
+		".size __ufiber_switch, .-__ufiber_switch\n"
+		".globl __ufiber_start\n"
+		".type __ufiber_start, @function\n"
+		"__ufiber_start:\n"
+		"	l.or r3, r14, r0\n"
+		"	l.jal __ufiber_main\n"
+		"	l.nop\n"
+		".size __ufiber_start, .-__ufiber_start\n"
+	);
+
+#else
+
+	/**
+	 * @brief Context switching is not supported on this target.
+	 */
+	#define UFIBER_UNSUPPORTED
+
+	#define UFIBER_CONTEXT_REGS 1
+
+#endif
+
+/**
+ * @brief Execution context of a fiber.
+ *
+ * @details Contexts are 8-byte aligned, because RV32 targets with the
+ * D extension save 64-bit floating-point registers in them, and
+ * misaligned fsd/fld trap or are emulated on common cores.
+ */
+struct ufiber_context
+{
+	uintptr_t regs[UFIBER_CONTEXT_REGS]; /**< Saved registers. */
+} __attribute__((aligned(8)));
+
+/**
+ * @brief Switches execution contexts.
+ *
+ * @param from Store location for the context of the caller.
+ * @param to   Context to resume.
+ */
+extern void __ufiber_switch(struct ufiber_context *from, const struct ufiber_context *to);
+
+/**
+ * @brief Entry point of fibers.
+ */
+extern void __ufiber_start(void);
+
+#if defined(__SANITIZE_ADDRESS__)
+
+	/**
+	 * @name AddressSanitizer Fiber Annotations
+	 *
+	 * @details AddressSanitizer tracks the bounds of the running
+	 * stack, thus it must be told when execution moves onto another
+	 * one. Otherwise, it reports accesses to fiber stacks as
+	 * underflows of the thread stack.
+	 */
+	/**@{*/
+	extern void __sanitizer_start_switch_fiber(void **fake_stack_save, const void *bottom, size_t size);
+	extern void __sanitizer_finish_switch_fiber(void *fake_stack_save, const void **bottom_old, size_t *size_old);
+	/**@}*/
+
+#endif
+
+/*============================================================================*
+ * Fibers                                                                     *
+ *============================================================================*/
+
+/**
+ * @brief Fiber.
+ */
+struct ufiber
+{
+	struct ufiber_context ctx;   /**< Execution context.          */
+	struct ufiber *next;         /**< Next fiber in a list.       */
+	struct ufiber *joiner;       /**< Fiber waiting for this one. */
+	struct ufiber_sched *sched;  /**< Scheduler.                  */
+	void *(*start)(void *);      /**< Start routine.              */
+	void *arg;                   /**< Argument of start routine.  */
+	void *retval;                /**< Return value.               */
+	int state;                   /**< State.                      */
+	unsigned char *stack;        /**< Stack.                      */
+#if defined(__SANITIZE_ADDRESS__)
+	const void *asan_bottom;     /**< Bottom of the stack.        */
+	size_t asan_size;            /**< Size of the stack.          */
+#endif
+};
+
+/**
+ * @brief Fiber scheduler of a thread.
+ */
+struct ufiber_sched
+{
+	int owner;               /**< Thread ID plus one.          */
+	int nfibers;             /**< Number of unjoined fibers.   */
+	struct ufiber main;      /**< Context of the thread.       */
+	struct ufiber *current;  /**< Running fiber.               */
+	struct ufiber *head;     /**< First fiber in run queue.    */
+	struct ufiber *tail;     /**< Last fiber in run queue.     */
+#if defined(__SANITIZE_ADDRESS__)
+	struct ufiber *from;     /**< Fiber that switched last.    */
+#endif
+};
+
+/**
+ * @brief Fiber schedulers.
+ */
+static struct ufiber_sched ufiber_scheds[UFIBER_SCHEDS_MAX];
+
+/**
+ * @brief Fibers.
+ */
+static struct ufiber ufiber_pool[UFIBER_MAX];
+
+/**
+ * @brief Stacks of fibers.
+ */
+static unsigned char ufiber_stacks[UFIBER_MAX][UFIBER_STACK_SIZE];
+
+/**
+ * @brief Free fibers.
+ */
+static struct ufiber *ufiber_free;
+
+/**
+ * @brief Has the pool of fibers been initialized?
+ */
+static int ufiber_initialized;
+
+/**
+ * @brief Lock of the pool of fibers.
+ */
+static struct uspinlock ufiber_lock = USPINLOCK_INITIALIZER;
+
+/**
+ * @brief Allocates a fiber and its stack.
+ *
+ * @returns A fiber, or NULL if there is none left.
+ */
+static struct ufiber *ufiber_alloc(void)
+{
+	struct ufiber *f;
+
+	uspinlock_lock(&ufiber_lock);
+
+	if (!ufiber_initialized)
+	{
+		for (int i = UFIBER_MAX - 1; i >= 0; i--)
+		{
+			ufiber_pool[i].stack = ufiber_stacks[i];
+			ufiber_pool[i].next = ufiber_free;
+			ufiber_free = &ufiber_pool[i];
+		}
+
+		ufiber_initialized = 1;
+	}
+
+	if ((f = ufiber_free) != NULL)
+		ufiber_free = f->next;
+
+	uspinlock_unlock(&ufiber_lock);
+
+	return (f);
+}
+
+/**
+ * @brief Releases a fiber and its stack.
+ *
+ * @param f Target fiber.
+ */
+static void ufiber_release(struct ufiber *f)
+{
+	uspinlock_lock(&ufiber_lock);
+	f->next = ufiber_free;
+	ufiber_free = f;
+	uspinlock_unlock(&ufiber_lock);
+}
+
+/**
+ * @brief Returns the fiber scheduler of the calling thread.
+ *
+ * @param claim Claim a scheduler if the thread has none?
+ *
+ * @returns The fiber scheduler of the calling thread, or NULL if it
+ * has none (or there is none left).
+ *
+ * @details The thread itself becomes the running fiber of a new
+ * scheduler. The scheduler is given back once the thread has joined
+ * all of its fibers.
+ */
+static struct ufiber_sched *ufiber_sched_self(int claim)
+{
+	struct ufiber_sched *s;
+	int owner;
+
+	/* Fast path: scheduler in thread-local storage. */
+	if ((s = utls_get(UTLS_KEY_FIBER)) != NULL)
+		return (s);
+
+	owner = kthread_self() + 1;
+
+	/* Scheduler already owned. */
+	for (int i = 0; i < UFIBER_SCHEDS_MAX; i++)
+	{
+		if (ufiber_scheds[i].owner == owner)
+			return (&ufiber_scheds[i]);
+	}
+
+	if (!claim)
+		return (NULL);
+
+	/* Slow path: claim a free scheduler. */
+	for (int i = 0; i < UFIBER_SCHEDS_MAX; i++)
+	{
+		s = &ufiber_scheds[i];
+
+		if (s->owner != 0)
+			continue;
+
+		if (__sync_bool_compare_and_swap(&s->owner, 0, owner))
+		{
+			s->nfibers = 0;
+			s->main.sched = s;
+			s->main.state = UFIBER_RUNNING;
+			s->main.joiner = NULL;
+			s->current = &s->main;
+			s->head = NULL;
+			s->tail = NULL;
+			utls_set(UTLS_KEY_FIBER, s);
+			return (s);
+		}
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Gives a fiber scheduler back.
+ *
+ * @param s Scheduler of the calling thread.
+ */
+static void ufiber_sched_release(struct ufiber_sched *s)
+{
+	utls_set(UTLS_KEY_FIBER, NULL);
+	__sync_lock_release(&s->owner);
+}
+
+/**
+ * @brief Appends a fiber to the run queue.
+ *
+ * @param s Target scheduler.
+ * @param f Target fiber.
+ */
+static void ufiber_enqueue(struct ufiber_sched *s, struct ufiber *f)
+{
+	f->state = UFIBER_READY;
+	f->next = NULL;
+
+	if (s->tail == NULL)
+		s->head = f;
+	else
+		s->tail->next = f;
+
+	s->tail = f;
+}
+
+/**
+ * @brief Removes the first fiber of the run queue.
+ *
+ * @param s Target scheduler.
+ *
+ * @returns The first fiber of the run queue, or NULL if it is empty.
+ */
+static struct ufiber *ufiber_dequeue(struct ufiber_sched *s)
+{
+	struct ufiber *f;
+
+	if ((f = s->head) != NULL)
+	{
+		if ((s->head = f->next) == NULL)
+			s->tail = NULL;
+	}
+
+	return (f);
+}
+
+/**
+ * @brief Switches to another fiber.
+ *
+ * @param s    Target scheduler.
+ * @param next Fiber to run.
+ */
+static void ufiber_switch(struct ufiber_sched *s, struct ufiber *next)
+{
+	struct ufiber *prev;
+#if defined(__SANITIZE_ADDRESS__)
+	void *fake_stack = NULL;
+#endif
+
+	prev = s->current;
+	s->current = next;
+	next->state = UFIBER_RUNNING;
+
+#if defined(__SANITIZE_ADDRESS__)
+	/* The stack of a terminated fiber is not coming back. */
+	s->from = prev;
+	__sanitizer_start_switch_fiber(
+		(prev->state == UFIBER_DONE) ? NULL : &fake_stack,
+		next->asan_bottom, next->asan_size
+	);
+#endif
+
+	__ufiber_switch(&prev->ctx, &next->ctx);
+
+#if defined(__SANITIZE_ADDRESS__)
+	__sanitizer_finish_switch_fiber(fake_stack,
+		&s->from->asan_bottom, &s->from->asan_size
+	);
+#endif
+}
+
+/**
+ * @brief Runs a fiber.
+ *
+ * @param f Target fiber.
+ */
+void __ufiber_main(struct ufiber *f)
+{
+#if defined(__SANITIZE_ADDRESS__)
+	struct ufiber_sched *s = f->sched;
+
+	/* Learns the bounds of the stack of the thread, too. */
+	__sanitizer_finish_switch_fiber(NULL,
+		&s->from->asan_bottom, &s->from->asan_size
+	);
+#endif
+
+	ufiber_exit(f->start(f->arg));
+}
+
+/**
+ * The ufiber_create() function creates a fiber that runs @p start with
+ * @p arg as argument, and stores it in @p fiber. The fiber is appended
+ * to the run queue of the calling thread, and its stack comes from a
+ * static pool.
+ */
+int ufiber_create(struct ufiber **fiber, void *(*start)(void *), void *arg)
+{
+#if defined(UFIBER_UNSUPPORTED)
+	UNUSED(fiber);
+	UNUSED(start);
+	UNUSED(arg);
+
+	return (-ENOSYS);
+#else
+	struct ufiber_sched *s;
+	struct ufiber *f;
+	uintptr_t top;
+
+	if ((fiber == NULL) || (start == NULL))
+		return (-EINVAL);
+
+	if ((s = ufiber_sched_self(1)) == NULL)
+		return (-EAGAIN);
+
+	if ((f = ufiber_alloc()) == NULL)
+	{
+		if (s->nfibers == 0)
+			ufiber_sched_release(s);
+		return (-EAGAIN);
+	}
+
+	top = (uintptr_t) (f->stack + UFIBER_STACK_SIZE) & ~((uintptr_t) 15);
+
+	umemset(&f->ctx, 0, sizeof(f->ctx));
+	f->ctx.regs[UFIBER_CONTEXT_SP] = top - UFIBER_STACK_BIAS;
+	f->ctx.regs[UFIBER_CONTEXT_PC] = (uintptr_t) __ufiber_start;
+	f->ctx.regs[UFIBER_CONTEXT_ARG] = (uintptr_t) f;
+	f->joiner = NULL;
+	f->sched = s;
+	f->start = start;
+	f->arg = arg;
+	f->retval = NULL;
+#if defined(__SANITIZE_ADDRESS__)
+	f->asan_bottom = f->stack;
+	f->asan_size = UFIBER_STACK_SIZE;
+#endif
+
+	s->nfibers++;
+	ufiber_enqueue(s, f);
+
+	*fiber = f;
+
+	return (0);
+#endif
+}
+
+/**
+ * The ufiber_yield() function moves the calling fiber to the end of
+ * the run queue of its thread, and runs the first fiber in the queue.
+ * If no other fiber is ready, the function returns at once.
+ */
+void ufiber_yield(void)
+{
+	struct ufiber_sched *s;
+	struct ufiber *next;
+
+	if ((s = ufiber_sched_self(0)) == NULL)
+		return;
+
+	if ((next = ufiber_dequeue(s)) == NULL)
+		return;
+
+	ufiber_enqueue(s, s->current);
+	ufiber_switch(s, next);
+}
+
+/**
+ * The ufiber_join() function waits for the fiber pointed to by @p
+ * fiber to terminate, and stores its return value in @p retval, if it
+ * is not NULL. Meanwhile, other fibers run. Once joined, the fiber and
+ * its stack are released. A fiber may only be joined once, and by a
+ * fiber of the same thread. Fibers must be joined, or else their
+ * stacks are lost.
+ */
+int ufiber_join(struct ufiber *fiber, void **retval)
+{
+	struct ufiber_sched *s;
+	struct ufiber *next;
+
+	if ((s = ufiber_sched_self(0)) == NULL)
+		return (-EINVAL);
+
+	if ((fiber == NULL) || (fiber->sched != s) || (fiber == s->current))
+		return (-EINVAL);
+
+	if ((fiber == &s->main) || (fiber->joiner != NULL))
+		return (-EINVAL);
+
+	while (fiber->state != UFIBER_DONE)
+	{
+		/* No fiber can wake up the caller. */
+		if ((next = ufiber_dequeue(s)) == NULL)
+			return (-EDEADLK);
+
+		fiber->joiner = s->current;
+		s->current->state = UFIBER_BLOCKED;
+		ufiber_switch(s, next);
+	}
+
+	if (retval != NULL)
+		*retval = fiber->retval;
+
+	ufiber_release(fiber);
+
+	/* No fibers left, give the scheduler back. */
+	if ((--s->nfibers == 0) && (s->current == &s->main))
+		ufiber_sched_release(s);
+
+	return (0);
+}
+
+/**
+ * The ufiber_exit() function terminates the calling fiber with @p
+ * retval as return value, and wakes up the fiber that joins it. The
+ * stack of the fiber is released when it is joined. Returning from the
+ * start routine of a fiber is equivalent to calling this function.
+ */
+NORETURN void ufiber_exit(void *retval)
+{
+	struct ufiber_sched *s;
+	struct ufiber *f;
+	struct ufiber *next;
+
+	s = ufiber_sched_self(0);
+
+	/* Not a fiber. */
+	if ((s == NULL) || (s->current == &s->main))
+		upanic("ufiber_exit() called outside a fiber\n");
+
+	f = s->current;
+	f->retval = retval;
+	f->state = UFIBER_DONE;
+
+	if (f->joiner != NULL)
+		ufiber_enqueue(s, f->joiner);
+
+	/* The thread itself is always runnable or joining. */
+	if ((next = ufiber_dequeue(s)) == NULL)
+		upanic("ufiber_exit() left no fiber to run\n");
+
+	ufiber_switch(s, next);
+
+	UNREACHABLE();
+}
+
+/**
+ * The ufiber_self() function returns the fiber that is running in the
+ * calling thread. While the thread runs fibers, the thread itself is a
+ * fiber, too.
+ */
+struct ufiber *ufiber_self(void)
+{
+	struct ufiber_sched *s;
+
+	if ((s = ufiber_sched_self(0)) == NULL)
+		return (NULL);
+
+	return (s->current);
+}
@@ -0,0 +1,284 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+
+/**
+ * @name Primes
+ */
+/**@{*/
+#define UHASH_P1 0x9e3779b185ebca87ULL /**< Prime 1. */
+#define UHASH_P2 0xc2b2ae3d27d4eb4fULL /**< Prime 2. */
+#define UHASH_P3 0x165667b19e3779f9ULL /**< Prime 3. */
+#define UHASH_P4 0x85ebca77c2b2ae63ULL /**< Prime 4. */
+#define UHASH_P5 0x27d4eb2f165667c5ULL /**< Prime 5. */
+/**@}*/
+
+/**
+ * @brief Rotates a 64-bit integer left.
+ */
+static inline uint64_t uhash_rotl(uint64_t x, int r)
+{
+	return ((x << r) | (x >> (64 - r)));
+}
+
+/**
+ * @brief Loads a 64-bit little-endian word.
+ */
+static inline uint64_t uhash_load64(const unsigned char *p)
+{
+	uint64_t v;
+
+	__builtin_memcpy(&v, p, sizeof(uint64_t));
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	v = __builtin_bswap64(v);
+#endif
+
+	return (v);
+}
+
+/**
+ * @brief Loads a 32-bit little-endian word.
+ */
+static inline uint32_t uhash_load32(const unsigned char *p)
+{
+	uint32_t v;
+
+	__builtin_memcpy(&v, p, sizeof(uint32_t));
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	v = __builtin_bswap32(v);
+#endif
+
+	return (v);
+}
+
+/**
+ * @brief Mixes a word into an accumulator.
+ */
+static inline uint64_t uhash_round(uint64_t acc, uint64_t v)
+{
+	acc += v*UHASH_P2;
+	acc = uhash_rotl(acc, 31);
+
+	return (acc*UHASH_P1);
+}
+
+/**
+ * @brief Initializes accumulators.
+ */
+static inline void uhash_seed(uint64_t acc[4], uint64_t seed)
+{
+	acc[0] = seed + UHASH_P1 + UHASH_P2;
+	acc[1] = seed + UHASH_P2;
+	acc[2] = seed;
+	acc[3] = seed - UHASH_P1;
+}
+
+/**
+ * @brief Mixes stripes into accumulators.
+ *
+ * @param acc Accumulators.
+ * @param p   Target stripes.
+ * @param n   Number of stripes.
+ */
+static inline void uhash_stripes(uint64_t acc[4], const unsigned char *p, size_t n)
+{
+	uint64_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+
+	/* Four independent lanes. */
+	for (/* noop */; n > 0; n--, p += UHASH64_STRIPE)
+	{
+		a0 = uhash_round(a0, uhash_load64(p));
+		a1 = uhash_round(a1, uhash_load64(p + 8));
+		a2 = uhash_round(a2, uhash_load64(p + 16));
+		a3 = uhash_round(a3, uhash_load64(p + 24));
+	}
+
+	acc[0] = a0;
+	acc[1] = a1;
+	acc[2] = a2;
+	acc[3] = a3;
+}
+
+/**
+ * @brief Folds accumulators.
+ */
+static inline uint64_t uhash_fold(const uint64_t acc[4])
+{
+	uint64_t h;
+
+	h = uhash_rotl(acc[0], 1) + uhash_rotl(acc[1], 7) +
+		uhash_rotl(acc[2], 12) + uhash_rotl(acc[3], 18);
+
+	for (int i = 0; i < 4; i++)
+	{
+		h ^= uhash_round(0, acc[i]);
+		h = h*UHASH_P1 + UHASH_P4;
+	}
+
+	return (h);
+}
+
+/**
+ * @brief Mixes the tail of the input and finalizes a hash value.
+ *
+ * @param h   Hash value of the stripes.
+ * @param p   Tail of the input.
+ * @param len Number of bytes in @p p, less than a stripe.
+ */
+static inline uint64_t uhash_finish(uint64_t h, const unsigned char *p, size_t len)
+{
+	/* Words. */
+	for (/* noop */; len >= 8; len -= 8, p += 8)
+	{
+		h ^= uhash_round(0, uhash_load64(p));
+		h = uhash_rotl(h, 27)*UHASH_P1 + UHASH_P4;
+	}
+
+	/* Half word. */
+	if (len >= 4)
+	{
+		h ^= uhash_load32(p)*UHASH_P1;
+		h = uhash_rotl(h, 23)*UHASH_P2 + UHASH_P3;
+		len -= 4;
+		p += 4;
+	}
+
+	/* Bytes. */
+	for (/* noop */; len > 0; len--)
+	{
+		h ^= (*p++)*UHASH_P5;
+		h = uhash_rotl(h, 11)*UHASH_P1;
+	}
+
+	/* Avalanche. */
+	h ^= h >> 33;
+	h *= UHASH_P2;
+	h ^= h >> 29;
+	h *= UHASH_P3;
+	h ^= h >> 32;
+
+	return (h);
+}
+
+/**
+ * The uhash64() function hashes the @p len bytes pointed to by @p data
+ * with XXH64, which reads four independent 64-bit lanes at a time. Hash
+ * values are the same on all targets.
+ */
+uint64_t uhash64(const void *data, size_t len, uint64_t seed)
+{
+	const unsigned char *p = data;
+	uint64_t h;
+
+	if (len >= UHASH64_STRIPE)
+	{
+		uint64_t acc[4];
+
+		uhash_seed(acc, seed);
+		uhash_stripes(acc, p, len/UHASH64_STRIPE);
+		h = uhash_fold(acc);
+		p += len & ~(size_t) (UHASH64_STRIPE - 1);
+	}
+	else
+		h = seed + UHASH_P5;
+
+	h += (uint64_t) len;
+
+	return (uhash_finish(h, p, len & (UHASH64_STRIPE - 1)));
+}
+
+/**
+ * The uhash64_init() function initializes the incremental hash pointed
+ * to by @p state with the seed @p seed.
+ */
+void uhash64_init(struct uhash64_state *state, uint64_t seed)
+{
+	uhash_seed(state->acc, seed);
+	state->total = 0;
+	state->buflen = 0;
+}
+
+/**
+ * The uhash64_update() function mixes the @p len bytes pointed to by
+ * @p data into the incremental hash pointed to by @p state. Bytes that
+ * do not fill a stripe are buffered until the next call.
+ */
+void uhash64_update(struct uhash64_state *state, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	state->total += len;
+
+	/* Fill the buffered stripe. */
+	if (state->buflen > 0)
+	{
+		size_t n = UHASH64_STRIPE - state->buflen;
+
+		if (len < n)
+		{
+			umemcpy(&state->buf[state->buflen], p, len);
+			state->buflen += len;
+			return;
+		}
+
+		umemcpy(&state->buf[state->buflen], p, n);
+		uhash_stripes(state->acc, state->buf, 1);
+		state->buflen = 0;
+		p += n;
+		len -= n;
+	}
+
+	/* Whole stripes. */
+	uhash_stripes(state->acc, p, len/UHASH64_STRIPE);
+	p += len & ~(size_t) (UHASH64_STRIPE - 1);
+	len &= UHASH64_STRIPE - 1;
+
+	/* Buffer the rest. */
+	umemcpy(state->buf, p, len);
+	state->buflen = len;
+}
+
+/**
+ * The uhash64_final() function returns the hash value of all bytes
+ * mixed into the incremental hash pointed to by @p state. The state is
+ * not modified, so more bytes may be mixed in afterwards.
+ */
+uint64_t uhash64_final(const struct uhash64_state *state)
+{
+	uint64_t h;
+
+	/* The third accumulator holds the seed until a stripe is mixed in. */
+	if (state->total >= UHASH64_STRIPE)
+		h = uhash_fold(state->acc);
+	else
+		h = state->acc[2] + UHASH_P5;
+
+	h += state->total;
+
+	return (uhash_finish(h, state->buf, state->buflen));
+}
@@ -0,0 +1,46 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+
+/**
+ * The uhmap_hash_str() function hashes the string pointed to by @p str
+ * with uhash64(). Since hash maps index their tables with the high bits
+ * of hash values, the high half of the 64-bit value is returned.
+ */
+uint32_t uhmap_hash_str(const char *str)
+{
+	return ((uint32_t) (uhash64(str, ustrlen(str), 0) >> 32));
+}
+
+/*============================================================================*
+ * Type-Specialised Hash Maps                                                 *
+ *============================================================================*/
+
+UHMAP_DEFINE(, u32, uint32_t, uint32_t, UHMAP_HASH_U32, UHMAP_EQ)
+UHMAP_DEFINE(, u64, uint64_t, uint64_t, UHMAP_HASH_U64, UHMAP_EQ)
+UHMAP_DEFINE(, ptr, void *, void *, UHMAP_HASH_PTR, UHMAP_EQ)
+UHMAP_DEFINE(, str, const char *, void *, uhmap_hash_str, UHMAP_EQ_STR)
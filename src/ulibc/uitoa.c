@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "uarith.h"
+
+/**
+ * @brief Decimal digits of all numbers from 00 to 99.
+ */
+static const char udigits2[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+/**
+ * @brief Hexadecimal digits.
+ */
+static const char uxdigits[2][16] = {
+	{ '0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f' },
+	{ '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F' }
+};
+
+/**
+ * @brief Copies the two decimal digits of a number below 100.
+ *
+ * @param p Target buffer.
+ * @param v Target number.
+ */
+static inline void ucopy2(char *p, uint32_t v)
+{
+	p[0] = udigits2[2*v];
+	p[1] = udigits2[2*v + 1];
+}
+
+/**
+ * @brief Counts the decimal digits of a 32-bit number.
+ *
+ * @param v Target number.
+ *
+ * @returns The number of decimal digits in @p v.
+ */
+static inline size_t ucount32(uint32_t v)
+{
+	if (v < 10)
+		return (1);
+	if (v < 100)
+		return (2);
+	if (v < 1000)
+		return (3);
+	if (v < 10000)
+		return (4);
+	if (v < 100000)
+		return (5);
+	if (v < 1000000)
+		return (6);
+	if (v < 10000000)
+		return (7);
+	if (v < 100000000)
+		return (8);
+	if (v < 1000000000)
+		return (9);
+
+	return (10);
+}
+
+/**
+ * @brief Converts a 32-bit number to decimal, two digits at a time.
+ *
+ * @param v   Target number.
+ * @param buf Target buffer.
+ * @param n   Number of digits in @p v.
+ *
+ * @note The division by 100 is by a constant, thus compilers emit a
+ * multiplication by its reciprocal instead.
+ */
+static inline void uwrite32(uint32_t v, char *buf, size_t n)
+{
+	char *p;
+	uint32_t q;
+
+	p = buf + n;
+
+	while (v >= 100)
+	{
+		q = v/100;
+		p -= 2;
+		ucopy2(p, v - q*100);
+		v = q;
+	}
+
+	if (v >= 10)
+		ucopy2(p - 2, v);
+	else
+		*(p - 1) = '0' + v;
+}
+
+/**
+ * @brief Converts a number below 10^8 to exactly eight decimal digits.
+ *
+ * @param v   Target number.
+ * @param buf Target buffer.
+ */
+static inline void uwrite8(uint32_t v, char *buf)
+{
+	uint32_t hi, lo;
+
+	hi = v/10000;
+	lo = v - hi*10000;
+
+	ucopy2(&buf[0], hi/100);
+	ucopy2(&buf[2], hi%100);
+	ucopy2(&buf[4], lo/100);
+	ucopy2(&buf[6], lo%100);
+}
+
+/**
+ * The uutoa() function converts the unsigned number @p val to its
+ * decimal representation and stores it, null-terminated, in @p buf.
+ * Numbers that fit in 32 bits are converted with 32-bit arithmetic
+ * only. Larger numbers are split into chunks of eight digits with
+ * udiv1e8(), which needs no division instruction.
+ */
+size_t uutoa(uint64_t val, char *buf)
+{
+	size_t n;
+	uint64_t hi;
+	uint32_t lo, mid;
+
+	/* 32-bit fast path. */
+	if (val <= 0xffffffffULL)
+	{
+		n = ucount32((uint32_t) val);
+		uwrite32((uint32_t) val, buf, n);
+		buf[n] = '\0';
+		return (n);
+	}
+
+	hi = udiv1e8(val);
+	lo = (uint32_t)(val - hi*100000000);
+
+	/* Up to 16 digits. */
+	if (hi < 100000000)
+	{
+		n = ucount32((uint32_t) hi);
+		uwrite32((uint32_t) hi, buf, n);
+	}
+
+	/* Up to 20 digits. */
+	else
+	{
+		mid = (uint32_t)(hi - udiv1e8(hi)*100000000);
+		hi = udiv1e8(hi);
+		n = ucount32((uint32_t) hi);
+		uwrite32((uint32_t) hi, buf, n);
+		uwrite8(mid, &buf[n]);
+		n += 8;
+	}
+
+	uwrite8(lo, &buf[n]);
+	n += 8;
+	buf[n] = '\0';
+
+	return (n);
+}
+
+/**
+ * The uitoa() function converts the signed number @p val to its
+ * decimal representation and stores it, null-terminated, in @p buf.
+ */
+size_t uitoa(int64_t val, char *buf)
+{
+	/* Positive number. */
+	if (val >= 0)
+		return (uutoa((uint64_t) val, buf));
+
+	buf[0] = '-';
+
+	return (uutoa(-((uint64_t) val), &buf[1]) + 1);
+}
+
+/**
+ * The uxtoa() function converts the unsigned number @p val to its
+ * hexadecimal representation and stores it, null-terminated, in @p
+ * buf. Digits above nine are written in uppercase if @p upper is
+ * non-zero, and in lowercase otherwise.
+ */
+size_t uxtoa(uint64_t val, char *buf, int upper)
+{
+	size_t n;
+	uint32_t hi, lo;
+	const char *digits;
+
+	digits = uxdigits[(upper) ? 1 : 0];
+	hi = (uint32_t)(val >> 32);
+	lo = (uint32_t) val;
+
+	/*
+	 * Count digits, a nibble at a time. Targets with no count leading
+	 * zeros instruction would otherwise call the compiler runtime.
+	 */
+	n = (hi != 0) ? 9 : 1;
+	for (uint32_t x = ((hi != 0) ? hi : lo) >> 4; x != 0; x >>= 4)
+		n++;
+
+	buf[n] = '\0';
+
+	/* Convert a nibble at a time. */
+	for (size_t i = n; i > 0; i--)
+	{
+		buf[i - 1] = digits[lo & 0xf];
+		lo = (lo >> 4) | (hi << 28);
+		hi >>= 4;
+	}
+
+	return (n);
+}
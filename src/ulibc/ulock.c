@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Spins for a while, doubling the delay of the next call.
+ *
+ * @param delay Current delay (in spins).
+ *
+ * @details Exponential backoff spreads retries of contending threads
+ * over time, so that fewer of them hammer the lock at once.
+ */
+static inline void ubackoff(unsigned *delay)
+{
+	for (unsigned i = 0; i < *delay; i++)
+		ucpu_relax();
+
+	if (*delay < ULOCK_BACKOFF_MAX)
+		*delay <<= 1;
+}
+
+/*============================================================================*
+ * Spinlock                                                                   *
+ *============================================================================*/
+
+/**
+ * The uspinlock_init() function initializes the spinlock pointed to by
+ * @p lock in the released state.
+ */
+void uspinlock_init(struct uspinlock *lock)
+{
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * The uspinlock_lock() function acquires the spinlock pointed to by @p
+ * lock. While the lock is taken, the caller only reads it, so that the
+ * cache line stays shared, and backs off exponentially between
+ * attempts.
+ */
+void uspinlock_lock(struct uspinlock *lock)
+{
+	unsigned delay;
+
+	delay = 1;
+
+	while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+	{
+		while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED))
+			ubackoff(&delay);
+	}
+}
+
+/**
+ * The uspinlock_trylock() function attempts to acquire the spinlock
+ * pointed to by @p lock without waiting.
+ */
+int uspinlock_trylock(struct uspinlock *lock)
+{
+	if (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED))
+		return (-EBUSY);
+
+	if (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+		return (-EBUSY);
+
+	return (0);
+}
+
+/**
+ * The uspinlock_unlock() function releases the spinlock pointed to by
+ * @p lock.
+ */
+void uspinlock_unlock(struct uspinlock *lock)
+{
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+/*============================================================================*
+ * Ticket Lock                                                                *
+ *============================================================================*/
+
+/**
+ * The uticketlock_init() function initializes the ticket lock pointed
+ * to by @p lock in the released state.
+ */
+void uticketlock_init(struct uticketlock *lock)
+{
+	lock->next = 0;
+	__atomic_store_n(&lock->owner, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * The uticketlock_lock() function acquires the ticket lock pointed to
+ * by @p lock. The caller draws a ticket and waits until it is served.
+ * The wait between checks is proportional to the number of threads
+ * ahead of the caller.
+ */
+void uticketlock_lock(struct uticketlock *lock)
+{
+	unsigned ticket;
+	unsigned owner;
+
+	ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+
+	while ((owner = __atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE)) != ticket)
+	{
+		for (unsigned i = (ticket - owner)*16; i > 0; i--)
+			ucpu_relax();
+	}
+}
+
+/**
+ * The uticketlock_trylock() function attempts to acquire the ticket
+ * lock pointed to by @p lock without waiting. A ticket is only drawn if
+ * it would be served at once.
+ */
+int uticketlock_trylock(struct uticketlock *lock)
+{
+	unsigned owner;
+
+	owner = __atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE);
+
+	if (!__atomic_compare_exchange_n(&lock->next, &owner, owner + 1, 0,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return (-EBUSY);
+
+	return (0);
+}
+
+/**
+ * The uticketlock_unlock() function releases the ticket lock pointed to
+ * by @p lock, serving the next ticket.
+ */
+void uticketlock_unlock(struct uticketlock *lock)
+{
+	__atomic_store_n(&lock->owner, lock->owner + 1, __ATOMIC_RELEASE);
+}
+
+/*============================================================================*
+ * MCS Lock                                                                   *
+ *============================================================================*/
+
+/**
+ * The umcslock_init() function initializes the MCS lock pointed to by
+ * @p lock in the released state.
+ */
+void umcslock_init(struct umcslock *lock)
+{
+	__atomic_store_n(&lock->tail, NULL, __ATOMIC_RELEASE);
+}
+
+/**
+ * The umcslock_lock() function acquires the MCS lock pointed to by @p
+ * lock. The caller appends @p node to the queue of waiting threads and
+ * spins on its own node until its predecessor hands the lock over.
+ * Thus, each waiting thread spins on a different cache line, and the
+ * lock is granted in arrival order (Mellor-Crummey and Scott).
+ */
+void umcslock_lock(struct umcslock *lock, struct umcs_node *node)
+{
+	struct umcs_node *prev;
+
+	node->next = NULL;
+	node->locked = 1;
+
+	prev = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+
+	/* Lock was free. */
+	if (prev == NULL)
+		return;
+
+	__atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+
+	while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE))
+		ucpu_relax();
+}
+
+/**
+ * The umcslock_trylock() function attempts to acquire the MCS lock
+ * pointed to by @p lock without waiting. The lock is only acquired if
+ * no thread holds or waits for it.
+ */
+int umcslock_trylock(struct umcslock *lock, struct umcs_node *node)
+{
+	struct umcs_node *expected;
+
+	node->next = NULL;
+	node->locked = 0;
+	expected = NULL;
+
+	if (!__atomic_compare_exchange_n(&lock->tail, &expected, node, 0,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return (-EBUSY);
+
+	return (0);
+}
+
+/**
+ * The umcslock_unlock() function releases the MCS lock pointed to by @p
+ * lock and hands it over to the next waiting thread, if any. If a
+ * thread is appending itself to the queue, the caller waits until it
+ * is linked.
+ */
+void umcslock_unlock(struct umcslock *lock, struct umcs_node *node)
+{
+	struct umcs_node *next;
+	struct umcs_node *expected;
+
+	if ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL)
+	{
+		expected = node;
+
+		/* No thread waiting. */
+		if (__atomic_compare_exchange_n(&lock->tail, &expected, NULL, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			return;
+
+		while ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL)
+			ucpu_relax();
+	}
+
+	__atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+}
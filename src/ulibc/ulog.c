@@ -0,0 +1,581 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/thread.h>
+#include <posix/stdarg.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include <nanvix/ulib.h>
+
+/**
+ * @brief Output file descriptor of post-mortem dumps.
+ */
+#define ULOG_FD 0
+
+/**
+ * @brief Number of log rings.
+ */
+#define ULOG_RINGS_MAX (THREAD_MAX + 1)
+
+/**
+ * @brief Maximum length of a conversion specification.
+ */
+#define ULOG_SPEC_MAX 48
+
+/**
+ * @name Argument Types
+ */
+/**@{*/
+#define ULOG_INT     0 /**< int.                */
+#define ULOG_UINT    1 /**< unsigned int.       */
+#define ULOG_LONG    2 /**< long.               */
+#define ULOG_ULONG   3 /**< unsigned long.      */
+#define ULOG_LLONG   4 /**< long long.          */
+#define ULOG_ULLONG  5 /**< unsigned long long. */
+#define ULOG_PTR     6 /**< Pointer.            */
+#define ULOG_DOUBLE  7 /**< double.             */
+/**@}*/
+
+/**
+ * @brief Log entry.
+ */
+struct ulog_entry
+{
+	const struct ulog_site *site; /* Call site.  */
+	uint64_t args[ULOG_ARGS_MAX]; /* Arguments.  */
+};
+
+/**
+ * @brief Log ring.
+ *
+ * @details The ring has a single producer, its owner thread, and a
+ * single consumer, the flushing thread. The producer advances @p tail
+ * and the consumer advances @p head, so no lock is needed.
+ */
+static struct ulog_ring
+{
+	int owner;                                /* Owner thread ID plus one. */
+	unsigned head;                            /* Next entry to format.     */
+	unsigned tail;                            /* Next entry to record.     */
+	unsigned dropped;                         /* Dropped entries.          */
+	unsigned reported;                        /* Reported dropped entries. */
+	struct ulog_entry entries[ULOG_ENTRIES];  /* Entries.                  */
+} ulog_rings[ULOG_RINGS_MAX];
+
+/**
+ * @brief Entries dropped because no ring was available.
+ */
+static unsigned ulog_unringed = 0;
+
+/**
+ * @brief Serializes flushes.
+ */
+static int ulog_flushing = 0;
+
+/**
+ * @brief Gets the log ring of the calling thread.
+ *
+ * @returns The log ring of the calling thread. If no ring is
+ * available, a NULL pointer is returned instead.
+ */
+static struct ulog_ring *ulog_ring_get(void)
+{
+	struct ulog_ring *r;
+	int owner;
+
+	/* Fast path: ring in thread-local storage. */
+	if ((r = utls_get(UTLS_KEY_LOG)) != NULL)
+		return (r);
+
+	owner = kthread_self() + 1;
+
+	/* Ring already owned. */
+	for (int i = 0; i < ULOG_RINGS_MAX; i++)
+	{
+		if (__atomic_load_n(&ulog_rings[i].owner, __ATOMIC_RELAXED) == owner)
+			return (&ulog_rings[i]);
+	}
+
+	/* Slow path: claim a free ring. */
+	for (int i = 0; i < ULOG_RINGS_MAX; i++)
+	{
+		if (__atomic_load_n(&ulog_rings[i].owner, __ATOMIC_RELAXED) != 0)
+			continue;
+
+		if (__sync_bool_compare_and_swap(&ulog_rings[i].owner, 0, owner))
+		{
+			utls_set(UTLS_KEY_LOG, &ulog_rings[i]);
+			return (&ulog_rings[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Conversion specifiers that take an argument.
+ */
+static const char ulog_convs[] = "diucxXopsfFeEgG";
+
+/**
+ * @brief Characters between '%' and a conversion specifier.
+ */
+static const char ulog_modifiers[] = "-+ #0123456789.*hljzt";
+
+/**
+ * @brief Marks a call site that is being parsed.
+ */
+static const char ulog_parsing[] = "";
+
+/**
+ * @brief Parses the argument types of a call site.
+ *
+ * @param site Target call site.
+ * @param fmt  Formatted string.
+ *
+ * @details The first thread to reach the site claims it and parses it,
+ * while others wait until the parsed site is published.
+ */
+static void ulog_site_parse(struct ulog_site *site, const char *fmt)
+{
+	int nargs;
+	int length;
+	const char *p;
+
+	if (!__sync_bool_compare_and_swap(&site->fmt, (const char *) NULL, ulog_parsing))
+	{
+		while (__atomic_load_n(&site->fmt, __ATOMIC_ACQUIRE) == ulog_parsing)
+			ucpu_relax();
+		return;
+	}
+
+	nargs = 0;
+
+	for (p = ustrchr(fmt, '%'); p != NULL; p = ustrchr(p, '%'))
+	{
+		p++;
+
+		/* Flags, width and precision. */
+		for (/* noop */; (*p != '\0') && (ustrchr("-+ #0123456789.*", *p) != NULL); p++)
+		{
+			if ((*p == '*') && (nargs < ULOG_ARGS_MAX))
+				site->types[nargs++] = ULOG_INT;
+		}
+
+		/* Length modifier. */
+		length = 0;
+		if (*p == 'h')
+		{
+			while (*p == 'h')
+				p++;
+		}
+		else if (*p == 'l')
+		{
+			length = (*++p == 'l') ? 2 : 1;
+			if (length == 2)
+				p++;
+		}
+		else if (*p == 'j')
+		{
+			length = 2;
+			p++;
+		}
+		else if ((*p == 'z') || (*p == 't'))
+		{
+			length = 1;
+			p++;
+		}
+
+		if ((*p == '\0') || (nargs == ULOG_ARGS_MAX))
+			break;
+
+		/* Conversion specifier. */
+		switch (*p++)
+		{
+			case 'd':
+			case 'i':
+			case 'c':
+				site->types[nargs++] = ULOG_INT + 2*length;
+				break;
+
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+				site->types[nargs++] = ULOG_UINT + 2*length;
+				break;
+
+			case 'p':
+			case 's':
+				site->types[nargs++] = ULOG_PTR;
+				break;
+
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+				site->types[nargs++] = ULOG_DOUBLE;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	site->nargs = nargs;
+
+	/* Publish parsed site. */
+	__atomic_store_n(&site->fmt, fmt, __ATOMIC_RELEASE);
+}
+
+/**
+ * The __ulog() function records the call site @p site and the
+ * arguments of the formatted string @p fmt in the log ring of the
+ * calling thread. Arguments are stored raw, and formatted only when
+ * the ring is drained.
+ */
+void __ulog(struct ulog_site *site, const char *fmt, ...)
+{
+	unsigned tail;
+	va_list args;
+	double d;
+	const char *p;
+	struct ulog_ring *r;
+	struct ulog_entry *e;
+
+	/* No ring available. */
+	if ((r = ulog_ring_get()) == NULL)
+	{
+		__atomic_add_fetch(&ulog_unringed, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	/* Parse argument types once. */
+	p = __atomic_load_n(&site->fmt, __ATOMIC_ACQUIRE);
+	if ((p == NULL) || (p == ulog_parsing))
+		ulog_site_parse(site, fmt);
+
+	tail = r->tail;
+
+	/* Ring is full. */
+	if ((tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) >= ULOG_ENTRIES)
+	{
+		r->dropped++;
+		return;
+	}
+
+	e = &r->entries[tail & (ULOG_ENTRIES - 1)];
+	e->site = site;
+
+	va_start(args, fmt);
+	for (int i = 0; i < site->nargs; i++)
+	{
+		switch (site->types[i])
+		{
+			case ULOG_INT:
+				e->args[i] = (uint64_t) va_arg(args, int);
+				break;
+			case ULOG_UINT:
+				e->args[i] = va_arg(args, unsigned);
+				break;
+			case ULOG_LONG:
+				e->args[i] = (uint64_t) va_arg(args, long);
+				break;
+			case ULOG_ULONG:
+				e->args[i] = va_arg(args, unsigned long);
+				break;
+			case ULOG_LLONG:
+				e->args[i] = (uint64_t) va_arg(args, long long);
+				break;
+			case ULOG_PTR:
+				e->args[i] = (unsigned long) va_arg(args, void *);
+				break;
+			case ULOG_DOUBLE:
+				d = va_arg(args, double);
+				umemcpy(&e->args[i], &d, sizeof(double));
+				break;
+			default:
+				e->args[i] = va_arg(args, unsigned long long);
+				break;
+		}
+	}
+	va_end(args);
+
+	/* Publish entry. */
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Formats a log entry.
+ *
+ * @param e   Target entry.
+ * @param buf Target buffer.
+ *
+ * @returns The length of the formatted entry.
+ *
+ * @details Each conversion specification is formatted on its own,
+ * with its argument cast back to its original type. Asterisks in a
+ * specification are replaced by the value of their argument.
+ */
+static size_t ulog_format(const struct ulog_entry *e, char *buf)
+{
+	int i;
+	size_t len;
+	size_t n;
+	double d;
+	const char *fmt;
+	char spec[ULOG_SPEC_MAX];
+	char *q;
+
+	fmt = e->site->fmt;
+	len = 0;
+	i = 0;
+
+	while ((*fmt != '\0') && (len < ULOG_LINE_MAX - 1))
+	{
+		/* Copy plain characters. */
+		if ((*fmt != '%') || (i >= e->site->nargs))
+		{
+			if ((fmt[0] == '%') && (fmt[1] == '%'))
+				fmt++;
+			buf[len++] = *fmt++;
+			continue;
+		}
+
+		/* Extract specification. */
+		q = spec;
+		*q++ = *fmt++;
+		for (/* noop */; (*fmt != '\0') && (ustrchr(ulog_modifiers, *fmt) != NULL); fmt++)
+		{
+			if (q >= &spec[ULOG_SPEC_MAX - UITOA_BUFSIZ])
+				continue;
+
+			if ((*fmt == '*') && (i < e->site->nargs))
+				q += uitoa((int) e->args[i++], q);
+			else
+				*q++ = *fmt;
+		}
+		if (*fmt != '\0')
+			*q++ = *fmt++;
+		*q = '\0';
+
+		n = ULOG_LINE_MAX - len;
+
+		/* No argument for this specification. */
+		if ((i >= e->site->nargs) || (ustrchr(ulog_convs, q[-1]) == NULL))
+		{
+			len += usnprintf(&buf[len], n, (q[-1] == '%') ? "%%" : "%s", spec);
+			continue;
+		}
+
+		switch (e->site->types[i])
+		{
+			case ULOG_INT:
+				len += usnprintf(&buf[len], n, spec, (int) e->args[i]);
+				break;
+			case ULOG_UINT:
+				len += usnprintf(&buf[len], n, spec, (unsigned) e->args[i]);
+				break;
+			case ULOG_LONG:
+				len += usnprintf(&buf[len], n, spec, (long) e->args[i]);
+				break;
+			case ULOG_ULONG:
+				len += usnprintf(&buf[len], n, spec, (unsigned long) e->args[i]);
+				break;
+			case ULOG_LLONG:
+				len += usnprintf(&buf[len], n, spec, (long long) e->args[i]);
+				break;
+			case ULOG_PTR:
+				len += usnprintf(&buf[len], n, spec, (void *) (unsigned long) e->args[i]);
+				break;
+			case ULOG_DOUBLE:
+				umemcpy(&d, &e->args[i], sizeof(double));
+				len += usnprintf(&buf[len], n, spec, d);
+				break;
+			default:
+				len += usnprintf(&buf[len], n, spec, (unsigned long long) e->args[i]);
+				break;
+		}
+
+		i++;
+	}
+
+	/* Truncated. */
+	if (len > ULOG_LINE_MAX - 1)
+		len = ULOG_LINE_MAX - 1;
+	buf[len] = '\0';
+
+	return (len);
+}
+
+/**
+ * @brief Emits a formatted log entry to the output buffer.
+ *
+ * @param buf Formatted entry.
+ * @param n   Length of @p buf.
+ */
+static void ulog_emit_buffered(const char *buf, size_t n)
+{
+	UNUSED(n);
+
+	uprintf("%s", buf);
+}
+
+/**
+ * @brief Emits a formatted log entry to the output device.
+ *
+ * @param buf Formatted entry.
+ * @param n   Length of @p buf.
+ */
+static void ulog_emit_direct(const char *buf, size_t n)
+{
+	__nanvix_write(ULOG_FD, buf, n);
+}
+
+/**
+ * @brief Formats pending log entries.
+ *
+ * @param emit Output routine.
+ *
+ * @returns The number of entries that were formatted.
+ */
+static int ulog_drain(void (*emit)(const char *, size_t))
+{
+	int n;
+	size_t len;
+	unsigned head;
+	unsigned tail;
+	unsigned dropped;
+	struct ulog_ring *r;
+	char buf[ULOG_LINE_MAX];
+
+	n = 0;
+
+	for (int i = 0; i < ULOG_RINGS_MAX; i++)
+	{
+		r = &ulog_rings[i];
+
+		head = r->head;
+		tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+		for (/* noop */; head != tail; head++, n++)
+		{
+			len = ulog_format(&r->entries[head & (ULOG_ENTRIES - 1)], buf);
+			emit(buf, len);
+		}
+
+		/* Release entries. */
+		__atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+
+		/* Report dropped entries. */
+		if ((dropped = r->dropped) != r->reported)
+		{
+			len = usnprintf(buf, ULOG_LINE_MAX,
+				"[ulog] %u entries dropped\n", dropped - r->reported
+			);
+			emit(buf, len);
+			r->reported = dropped;
+		}
+	}
+
+	return (n);
+}
+
+/**
+ * The ulog_flush() function formats the pending entries of all log
+ * rings to the output buffer of the calling thread.
+ */
+int ulog_flush(void)
+{
+	return (ulog_flush_to(ulog_emit_buffered));
+}
+
+/**
+ * The ulog_flush_to() function formats the pending entries of all log
+ * rings and passes each of them to @p emit.
+ */
+int ulog_flush_to(void (*emit)(const char *buf, size_t n))
+{
+	int n;
+
+	if (emit == NULL)
+		return (-EINVAL);
+
+	while (__sync_lock_test_and_set(&ulog_flushing, 1))
+		ucpu_relax();
+
+	n = ulog_drain(emit);
+
+	__sync_lock_release(&ulog_flushing);
+
+	return (n);
+}
+
+/**
+ * The ulog_dump() function formats the pending entries of all log
+ * rings straight to the output device.
+ */
+int ulog_dump(void)
+{
+	return (ulog_drain(ulog_emit_direct));
+}
+
+/**
+ * The ulog_dropped() function returns the total number of dropped log
+ * entries.
+ */
+unsigned ulog_dropped(void)
+{
+	unsigned n;
+
+	n = __atomic_load_n(&ulog_unringed, __ATOMIC_RELAXED);
+
+	for (int i = 0; i < ULOG_RINGS_MAX; i++)
+		n += ulog_rings[i].dropped;
+
+	return (n);
+}
+
+/**
+ * The __ulog_release() function makes the log ring of the calling
+ * thread available to other threads.
+ */
+void __ulog_release(void)
+{
+	int owner;
+
+	owner = kthread_self() + 1;
+
+	for (int i = 0; i < ULOG_RINGS_MAX; i++)
+	{
+		if (__atomic_load_n(&ulog_rings[i].owner, __ATOMIC_RELAXED) == owner)
+		{
+			utls_set(UTLS_KEY_LOG, NULL);
+			__sync_lock_release(&ulog_rings[i].owner);
+			break;
+		}
+	}
+}
@@ -63,12 +63,35 @@ struct block
 static struct block head;
 static struct block *freep = NULL;
 
+/**
+ * @brief Lock of the free list.
+ */
+static struct uticketlock umalloc_lock = UTICKETLOCK_INITIALIZER;
+
+/**
+ * @brief Heap bounds.
+ */
+/**@{*/
+static char *heap_base = NULL; /* First byte obtained from the kernel. */
+static char *heap_brk = NULL;  /* One past the last byte.              */
+/**@}*/
+
+/**
+ * @brief Bytes in allocated blocks.
+ */
+/**@{*/
+static size_t used_size = 0; /* Current.                     */
+static size_t used_peak = 0; /* Highest since the last check. */
+/**@}*/
+
 /**
  * @brief Frees allocated memory.
  *
  * @param ptr Memory area to free.
+ *
+ * @note The caller must hold the lock of the free list.
  */
-void ufree(void *ptr)
+static void do_free(void *ptr)
 {
 	struct block *p;  /* Working block.     */
 	struct block *bp; /* Block being freed. */
@@ -79,6 +102,8 @@ void ufree(void *ptr)
 
 	bp = (struct block *)ptr - 1;
 
+	used_size -= bp->size;
+
 	/* Look for insertion point. */
 	for (p = freep; !(p <= bp && bp <= p->nextp); p = p->nextp)
 	{
@@ -88,7 +113,7 @@ void ufree(void *ptr)
 	}
 
 	/* Merge with upper block. */
-	if (bp + bp->size == p->nextp)
+	if ((struct block *)((char *) bp + bp->size) == p->nextp)
 	{
 		bp->size += p->nextp->size;
 		bp->nextp = p->nextp->nextp;
@@ -97,7 +122,7 @@ void ufree(void *ptr)
 		bp->nextp = p->nextp;
 
 	/* Merge with lower block. */
-	if (p + p->size == bp)
+	if ((struct block *)((char *) p + p->size) == bp)
 	{
 		p->size += bp->size;
 		p->nextp = bp->nextp;
@@ -131,8 +156,15 @@ static void *expand(size_t size)
 	if ((p = __nanvix_sbrk(n)) == NULL)
 		return (NULL);
 
+	/* Track heap bounds. */
+	if (heap_base == NULL)
+		heap_base = (char *) p;
+	heap_brk = (char *) p + n;
+
+	/* do_free() discounts the block from used bytes. */
 	p->size = n;
-	ufree(p + 1);
+	used_size += n;
+	do_free(p + 1);
 
 	return (freep);
 }
@@ -142,13 +174,11 @@ static void *expand(size_t size)
  *
  * @param size Number of bytes to allocate.
  *
- * @returns Upon successful completion with size not equal to 0, nanvix_malloc()
- *          returns a pointer to the allocated space. If size is 0, either a
- *          null pointer or a unique pointer that can be successfully passed to
- *          nanvix_free() is returned. Otherwise, it returns a null pointer and set
- *          errno to indicate the error.
+ * @returns See umalloc().
+ *
+ * @note The caller must hold the lock of the free list.
  */
-void *umalloc(size_t size)
+static void *do_malloc(size_t size)
 {
 	size_t bsize;        /* Requested block size.     */
 	struct block *p;     /* Working block.            */
@@ -166,7 +196,8 @@ void *umalloc(size_t size)
 		head.size = 0;
 	}
 
-	bsize = BLOCK_META_SIZE(size);
+	/* Keep the meta-information of all blocks aligned. */
+	bsize = TRUNCATE(BLOCK_META_SIZE(size), BLOCK_STRUCT_SIZE);
 
 	/* Look for a free block that is big enough. */
 	for (p = prevp->nextp; /* void */ ; prevp = p, p = p->nextp)
@@ -197,6 +228,10 @@ void *umalloc(size_t size)
 
 			freep = prevp;
 
+			used_size += p->size;
+			if (used_size > used_peak)
+				used_peak = used_size;
+
 			return (p + 1);
 		}
 
@@ -212,6 +247,155 @@ void *umalloc(size_t size)
 	return (NULL);
 }
 
+/**
+ * @brief Checks the heap.
+ *
+ * @param stats Store location for statistics.
+ *
+ * @returns See umalloc_check().
+ *
+ * @note The caller must hold the lock of the free list.
+ */
+static int do_check(struct umalloc_stats *stats)
+{
+	char *addr;          /* Working address.   */
+	struct block *p;     /* Working block.     */
+	struct block *freeb; /* Next free block.   */
+	struct block *lowp;  /* Lowest free block. */
+
+	umemset(stats, 0, sizeof(struct umalloc_stats));
+
+	stats->heap_size = (size_t)(heap_brk - heap_base);
+	stats->used_size = used_size;
+	stats->used_peak = used_peak;
+
+	/* Empty heap. */
+	if (freep == NULL)
+		return (0);
+
+	/* Look for the lowest free block. */
+	lowp = head.nextp;
+	for (p = head.nextp; p != &head; p = p->nextp)
+	{
+		if (!WITHIN((char *) p, heap_base, heap_brk))
+			return (-EFAULT);
+
+		if (p < lowp)
+			lowp = p;
+
+		/* Cycle that skips the list head. */
+		if (++stats->nfree > (unsigned)(stats->heap_size/BLOCK_MIN_SIZE))
+			return (-EFAULT);
+	}
+
+	/*
+	 * Walk over all blocks in address order. Free blocks must show
+	 * up in the same order in the free list, and no two of them may
+	 * be adjacent, otherwise they should have been merged.
+	 */
+	freeb = (lowp == &head) ? NULL : lowp;
+	for (addr = heap_base; addr < heap_brk; addr += p->size)
+	{
+		p = (struct block *) addr;
+
+		if ((p->size < BLOCK_MIN_SIZE) || (p->size > (size_t)(heap_brk - addr)))
+			return (-EFAULT);
+
+		if (p != freeb)
+			continue;
+
+		stats->free_size += p->size;
+		if (p->size > stats->free_max)
+			stats->free_max = p->size;
+
+		freeb = p->nextp;
+		if (freeb == &head)
+			freeb = head.nextp;
+		if (freeb == lowp)
+			freeb = NULL;
+		else if ((freeb <= p) || ((char *) freeb == addr + p->size))
+			return (-EFAULT);
+	}
+
+	/* Free blocks and allocated blocks must cover the whole heap. */
+	if ((freeb != NULL) || (stats->free_size + used_size != stats->heap_size))
+		return (-EFAULT);
+
+	used_peak = used_size;
+
+	return (0);
+}
+
+/**
+ * @brief Frees allocated memory.
+ *
+ * @param ptr Memory area to free.
+ */
+void ufree(void *ptr)
+{
+	/* Nothing to be done. */
+	if (ptr == NULL)
+		return;
+
+	uticketlock_lock(&umalloc_lock);
+	do_free(ptr);
+	uticketlock_unlock(&umalloc_lock);
+}
+
+/**
+ * @brief Allocates memory.
+ *
+ * @param size Number of bytes to allocate.
+ *
+ * @returns Upon successful completion with size not equal to 0, nanvix_malloc()
+ *          returns a pointer to the allocated space. If size is 0, either a
+ *          null pointer or a unique pointer that can be successfully passed to
+ *          nanvix_free() is returned. Otherwise, it returns a null pointer and set
+ *          errno to indicate the error.
+ *
+ * @note The free list is protected by a ticket lock, so threads are
+ * served in arrival order.
+ */
+void *umalloc(size_t size)
+{
+	void *ptr;
+
+	/* Nothing to be done. */
+	if (size == 0)
+		return (NULL);
+
+	uticketlock_lock(&umalloc_lock);
+	ptr = do_malloc(size);
+	uticketlock_unlock(&umalloc_lock);
+
+	return (ptr);
+}
+
+/**
+ * The umalloc_check() function walks over the heap and checks that its
+ * blocks are consistent with the free list. Statistics of the heap are
+ * stored in the location pointed to by @p stats, and the peak of used
+ * bytes is restarted from the current value.
+ *
+ * @returns Upon successful completion, zero is returned. If @p stats
+ * is invalid, -EINVAL is returned instead. If the heap is corrupted,
+ * -EFAULT is returned.
+ */
+int umalloc_check(struct umalloc_stats *stats)
+{
+	int ret;
+
+	/* Invalid argument. */
+	if (stats == NULL)
+		return (-EINVAL);
+
+	uticketlock_lock(&umalloc_lock);
+	ret = do_check(stats);
+	uticketlock_unlock(&umalloc_lock);
+
+	return (ret);
+}
+
 /**
  * @brief Allocates memory to hold @p num elements of size @p size,
  * and initializes it to zero.
@@ -256,17 +440,24 @@ void * ucalloc(unsigned int num, size_t size)
 void *urealloc(void *ptr, size_t size)
 {
 	void *newptr;
+	size_t oldsize;
 
 	/* Nothing to be done. */
 	if (size == 0)
 		return (NULL);
 
-	newptr = umalloc(size);
+	if ((newptr = umalloc(size)) == NULL)
+		return (NULL);
 
 	/* Checks if there are more operations to be done. */
 	if (ptr != NULL)
 	{
-		umemcpy(newptr, ptr, size);
+		/* Do not copy past the end of the old block. */
+		oldsize = ((struct block *) ptr - 1)->size - BLOCK_STRUCT_SIZE;
+		if (oldsize > size)
+			oldsize = size;
+
+		umemcpy(newptr, ptr, oldsize);
 
 		ufree(ptr);
 	}
@@ -0,0 +1,705 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Capacity of the queue of tasks submitted by other threads.
+ */
+#define UPOOL_INJECT_SIZE 128
+
+/**
+ * @brief Maximum number of free tasks cached by a worker thread.
+ */
+#define UPOOL_CACHE_MAX 32
+
+/**
+ * @brief Number of failed attempts to find work before yielding.
+ */
+#define UPOOL_SPINS_MAX 64
+
+/**
+ * @brief Number of chunks per worker picked by the default grain.
+ */
+#define UPOOL_CHUNKS 8
+
+/**
+ * @name States of the Pool
+ */
+/**@{*/
+#define UPOOL_STOPPED  0 /**< Not started.  */
+#define UPOOL_RUNNING  1 /**< Running.      */
+#define UPOOL_STOPPING 2 /**< Shutting down. */
+/**@}*/
+
+/**
+ * @brief Task.
+ */
+struct utask
+{
+	struct utask *next;                      /**< Next free task.       */
+	struct upool_group *group;               /**< Group.                */
+	void (*fn)(void *);                      /**< Task function.        */
+	void *arg;                               /**< Argument.             */
+	void (*body)(size_t, size_t, void *);    /**< Loop body.            */
+	size_t begin;                            /**< First iteration.      */
+	size_t end;                              /**< Past last iteration.  */
+	size_t grain;                            /**< Chunk size.           */
+};
+
+/**
+ * @brief Worker thread.
+ *
+ * @details Each worker owns a Chase-Lev deque: the owner pushes and
+ * takes tasks at the bottom, whereas other threads steal them from the
+ * top.
+ */
+struct uworker
+{
+	struct utask *deque[UPOOL_DEQUE_SIZE]; /**< Deque of tasks.         */
+	unsigned bottom;                       /**< Bottom of the deque.    */
+	char pad0[UCACHE_LINE_SIZE];           /**< Padding.                */
+	unsigned top;                          /**< Top of the deque.       */
+	char pad1[UCACHE_LINE_SIZE];           /**< Padding.                */
+	int owner;                             /**< Thread ID plus one.     */
+	kthread_t tid;                         /**< Thread ID.              */
+	unsigned seed;                         /**< Victim selection state. */
+	struct utask *cache;                   /**< Cached free tasks.      */
+	int ncached;                           /**< Number of cached tasks. */
+};
+
+/**
+ * @brief Worker threads.
+ */
+static struct uworker upool_workers[UPOOL_WORKERS_MAX];
+
+/**
+ * @brief Tasks submitted by threads outside the pool.
+ */
+static struct umpmc upool_inject;
+
+/**
+ * @brief Storage of tasks.
+ */
+static struct utask upool_tasks[UPOOL_TASKS_MAX];
+
+/**
+ * @brief Free tasks.
+ */
+static struct utask *upool_free;
+
+/**
+ * @brief Lock of the free tasks and of the state of the pool.
+ */
+static struct uspinlock upool_lock = USPINLOCK_INITIALIZER;
+
+/**
+ * @brief State of the pool.
+ */
+static int upool_state = UPOOL_STOPPED;
+
+/**
+ * @brief Number of running worker threads.
+ */
+static int upool_nworkers;
+
+static void upool_run(struct uworker *self, struct utask *task);
+
+/*============================================================================*
+ * Deque                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Pushes a task at the bottom of the deque of a worker.
+ *
+ * @param w    Target worker (the caller).
+ * @param task Target task.
+ *
+ * @returns Zero if the task was pushed, and -EAGAIN if the deque is
+ * full.
+ */
+static int udeque_push(struct uworker *w, struct utask *task)
+{
+	unsigned b, t;
+
+	b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED);
+	t = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+
+	if ((b - t) >= UPOOL_DEQUE_SIZE)
+		return (-EAGAIN);
+
+	__atomic_store_n(&w->deque[b % UPOOL_DEQUE_SIZE], task, __ATOMIC_RELAXED);
+	__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELEASE);
+
+	return (0);
+}
+
+/**
+ * @brief Takes a task from the bottom of the deque of a worker.
+ *
+ * @param w Target worker (the caller).
+ *
+ * @returns The task, or NULL if the deque is empty.
+ *
+ * @details The last task may be stolen concurrently, in which case the
+ * owner and the thief race for it on the top index.
+ */
+static struct utask *udeque_take(struct uworker *w)
+{
+	struct utask *task;
+	unsigned b, t;
+
+	/* Sequentially consistent, so that thieves see the new bottom. */
+	b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&w->bottom, b, __ATOMIC_SEQ_CST);
+	t = __atomic_load_n(&w->top, __ATOMIC_SEQ_CST);
+
+	/* Empty deque. */
+	if ((int) (b - t) < 0)
+	{
+		__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+		return (NULL);
+	}
+
+	task = __atomic_load_n(&w->deque[b % UPOOL_DEQUE_SIZE], __ATOMIC_RELAXED);
+
+	/* Last task. */
+	if (b == t)
+	{
+		if (!__atomic_compare_exchange_n(&w->top, &t, t + 1, 0,
+				__ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			task = NULL;
+
+		__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+	}
+
+	return (task);
+}
+
+/**
+ * @brief Steals a task from the top of the deque of a worker.
+ *
+ * @param w Target worker.
+ *
+ * @returns The task, or NULL if the deque is empty or another thread
+ * won the race for the task.
+ */
+static struct utask *udeque_steal(struct uworker *w)
+{
+	struct utask *task;
+	unsigned b, t;
+
+	t = __atomic_load_n(&w->top, __ATOMIC_SEQ_CST);
+	b = __atomic_load_n(&w->bottom, __ATOMIC_SEQ_CST);
+
+	if ((int) (b - t) <= 0)
+		return (NULL);
+
+	task = __atomic_load_n(&w->deque[t % UPOOL_DEQUE_SIZE], __ATOMIC_RELAXED);
+
+	if (!__atomic_compare_exchange_n(&w->top, &t, t + 1, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+		return (NULL);
+
+	return (task);
+}
+
+/*============================================================================*
+ * Tasks                                                                      *
+ *============================================================================*/
+
+/**
+ * @brief Allocates a task.
+ *
+ * @param self Calling worker, or NULL if the caller is not a worker.
+ *
+ * @returns A task, or NULL if there is none left.
+ */
+static struct utask *utask_alloc(struct uworker *self)
+{
+	struct utask *task;
+
+	/* Fast path: take a cached task. */
+	if ((self != NULL) && (self->cache != NULL))
+	{
+		task = self->cache;
+		self->cache = task->next;
+		self->ncached--;
+		return (task);
+	}
+
+	uspinlock_lock(&upool_lock);
+	if ((task = upool_free) != NULL)
+		upool_free = task->next;
+	uspinlock_unlock(&upool_lock);
+
+	return (task);
+}
+
+/**
+ * @brief Releases a task.
+ *
+ * @param self Calling worker, or NULL if the caller is not a worker.
+ * @param task Target task.
+ */
+static void utask_free(struct uworker *self, struct utask *task)
+{
+	/* Fast path: cache the task. */
+	if ((self != NULL) && (self->ncached < UPOOL_CACHE_MAX))
+	{
+		task->next = self->cache;
+		self->cache = task;
+		self->ncached++;
+		return;
+	}
+
+	uspinlock_lock(&upool_lock);
+	task->next = upool_free;
+	upool_free = task;
+	uspinlock_unlock(&upool_lock);
+}
+
+/**
+ * @brief Hands a task over to the pool.
+ *
+ * @param self Calling worker, or NULL if the caller is not a worker.
+ * @param task Target task.
+ *
+ * @details A worker pushes the task on its own deque, whereas other
+ * threads go through the shared queue. If there is no room left, the
+ * task runs at once.
+ */
+static void utask_spawn(struct uworker *self, struct utask *task)
+{
+	__atomic_add_fetch(&task->group->pending, 1, __ATOMIC_RELAXED);
+
+	if (self != NULL)
+	{
+		if (udeque_push(self, task) == 0)
+			return;
+	}
+	else if (umpmc_push(&upool_inject, task) == 0)
+		return;
+
+	upool_run(self, task);
+}
+
+/**
+ * @brief Runs a chunk of a loop.
+ *
+ * @param self  Calling worker, or NULL if the caller is not a worker.
+ * @param group Group of the loop.
+ * @param body  Loop body.
+ * @param arg   Argument of @p body.
+ * @param begin First iteration.
+ * @param end   Iteration past the last one.
+ * @param grain Chunk size.
+ *
+ * @details The range is halved until it fits in a chunk, and the upper
+ * halves are handed over to the pool. Thus, idle workers steal large
+ * pieces of work, and the loop balances itself.
+ */
+static void upool_run_range(
+	struct uworker *self,
+	struct upool_group *group,
+	void (*body)(size_t, size_t, void *),
+	void *arg,
+	size_t begin,
+	size_t end,
+	size_t grain
+)
+{
+	struct utask *task;
+
+	while ((end - begin) > grain)
+	{
+		size_t mid = begin + (end - begin)/2;
+
+		/* Run the rest here. */
+		if ((task = utask_alloc(self)) == NULL)
+			break;
+
+		task->group = group;
+		task->fn = NULL;
+		task->arg = arg;
+		task->body = body;
+		task->begin = mid;
+		task->end = end;
+		task->grain = grain;
+
+		utask_spawn(self, task);
+
+		end = mid;
+	}
+
+	body(begin, end, arg);
+}
+
+/**
+ * @brief Runs a task.
+ *
+ * @param self Calling worker, or NULL if the caller is not a worker.
+ * @param task Target task.
+ *
+ * @details The task is released before it runs, so that it can be
+ * reused by tasks that it spawns.
+ */
+static void upool_run(struct uworker *self, struct utask *task)
+{
+	struct utask t;
+
+	t = *task;
+	utask_free(self, task);
+
+	if (t.fn != NULL)
+		t.fn(t.arg);
+	else
+		upool_run_range(self, t.group, t.body, t.arg, t.begin, t.end, t.grain);
+
+	__atomic_sub_fetch(&t.group->pending, 1, __ATOMIC_RELEASE);
+}
+
+/*============================================================================*
+ * Workers                                                                    *
+ *============================================================================*/
+
+/**
+ * @brief Returns the worker of the calling thread.
+ *
+ * @returns The worker of the calling thread, or NULL if the caller is
+ * not a worker.
+ */
+static struct uworker *upool_self(void)
+{
+	struct uworker *w;
+	int owner;
+
+	/* Fast path: worker in thread-local storage. */
+	if ((w = utls_get(UTLS_KEY_POOL)) != NULL)
+		return (w);
+
+	owner = kthread_self() + 1;
+
+	for (int i = 0; i < UPOOL_WORKERS_MAX; i++)
+	{
+		if (__atomic_load_n(&upool_workers[i].owner, __ATOMIC_RELAXED) == owner)
+			return (&upool_workers[i]);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Looks for a task to run.
+ *
+ * @param self Calling worker, or NULL if the caller is not a worker.
+ *
+ * @returns A task, or NULL if none was found.
+ *
+ * @details A worker first takes its own tasks, in last-in first-out
+ * order. Otherwise, it steals the oldest task of a random victim, and
+ * then looks at the tasks submitted by other threads.
+ */
+static struct utask *upool_find(struct uworker *self)
+{
+	struct utask *task;
+	unsigned first;
+	int n;
+
+	if ((self != NULL) && ((task = udeque_take(self)) != NULL))
+		return (task);
+
+	n = __atomic_load_n(&upool_nworkers, __ATOMIC_ACQUIRE);
+
+	if (n > 0)
+	{
+		if (self != NULL)
+		{
+			self->seed ^= self->seed << 13;
+			self->seed ^= self->seed >> 17;
+			self->seed ^= self->seed << 5;
+			first = self->seed % n;
+		}
+		else
+			first = 0;
+
+		for (int i = 0; i < n; i++)
+		{
+			struct uworker *victim = &upool_workers[(first + i) % n];
+
+			if (victim == self)
+				continue;
+
+			if ((task = udeque_steal(victim)) != NULL)
+				return (task);
+		}
+	}
+
+	if (umpmc_pop(&upool_inject, (void **) &task) == 0)
+		return (task);
+
+	return (NULL);
+}
+
+/**
+ * @brief Main loop of worker threads.
+ *
+ * @param arg Target worker.
+ */
+static void *upool_worker(void *arg)
+{
+	struct uworker *self = arg;
+	struct utask *task;
+	int spins;
+
+	__atomic_store_n(&self->owner, kthread_self() + 1, __ATOMIC_RELEASE);
+	utls_set(UTLS_KEY_POOL, self);
+
+	spins = 0;
+	while (__atomic_load_n(&upool_state, __ATOMIC_ACQUIRE) == UPOOL_RUNNING)
+	{
+		if ((task = upool_find(self)) != NULL)
+		{
+			upool_run(self, task);
+			spins = 0;
+			continue;
+		}
+
+		/* Let other threads run while there is no work. */
+		if (++spins < UPOOL_SPINS_MAX)
+			ucpu_relax();
+		else
+			kthread_yield();
+	}
+
+	/* Give cached tasks back. */
+	while ((task = self->cache) != NULL)
+	{
+		self->cache = task->next;
+		self->ncached--;
+		utask_free(NULL, task);
+	}
+
+	utls_set(UTLS_KEY_POOL, NULL);
+	__atomic_store_n(&self->owner, 0, __ATOMIC_RELEASE);
+
+	return (NULL);
+}
+
+/**
+ * @brief Starts the worker threads, if they are not running.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ */
+static int upool_start(void)
+{
+	int ret;
+
+	/* Fast path: pool running. */
+	if (__atomic_load_n(&upool_state, __ATOMIC_ACQUIRE) == UPOOL_RUNNING)
+		return (0);
+
+	ret = 0;
+	uspinlock_lock(&upool_lock);
+
+	if (upool_state == UPOOL_RUNNING)
+		goto out;
+
+	if (upool_state == UPOOL_STOPPING)
+	{
+		ret = -EBUSY;
+		goto out;
+	}
+
+	/* First start. */
+	if (upool_inject.cells == NULL)
+	{
+		if ((ret = umpmc_init(&upool_inject, UPOOL_INJECT_SIZE)) < 0)
+			goto out;
+
+		for (int i = 0; i < UPOOL_TASKS_MAX; i++)
+		{
+			upool_tasks[i].next = upool_free;
+			upool_free = &upool_tasks[i];
+		}
+	}
+
+	__atomic_store_n(&upool_state, UPOOL_RUNNING, __ATOMIC_RELEASE);
+
+	for (int i = 0; i < UPOOL_WORKERS_MAX; i++)
+	{
+		struct uworker *w = &upool_workers[i];
+
+		w->bottom = 0;
+		w->top = 0;
+		w->seed = i + 1;
+
+		if (uthread_create(&w->tid, upool_worker, w) < 0)
+			break;
+
+		__atomic_store_n(&upool_nworkers, upool_nworkers + 1, __ATOMIC_RELEASE);
+	}
+
+	/* No worker, run tasks in the calling thread. */
+	if (upool_nworkers == 0)
+		__atomic_store_n(&upool_state, UPOOL_STOPPED, __ATOMIC_RELEASE);
+
+out:
+	uspinlock_unlock(&upool_lock);
+
+	return (ret);
+}
+
+/**
+ * The upool_shutdown() function stops the worker threads of the pool
+ * and waits for them to exit. The pool starts again on the next
+ * submission.
+ */
+void upool_shutdown(void)
+{
+	int n;
+
+	uspinlock_lock(&upool_lock);
+	if (upool_state != UPOOL_RUNNING)
+	{
+		uspinlock_unlock(&upool_lock);
+		return;
+	}
+	__atomic_store_n(&upool_state, UPOOL_STOPPING, __ATOMIC_RELEASE);
+	n = upool_nworkers;
+	uspinlock_unlock(&upool_lock);
+
+	for (int i = 0; i < n; i++)
+		kthread_join(upool_workers[i].tid, NULL);
+
+	uspinlock_lock(&upool_lock);
+	__atomic_store_n(&upool_nworkers, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&upool_state, UPOOL_STOPPED, __ATOMIC_RELEASE);
+	uspinlock_unlock(&upool_lock);
+}
+
+/*============================================================================*
+ * Public Interface                                                           *
+ *============================================================================*/
+
+/**
+ * The upool_submit() function submits a task that calls @p fn with @p
+ * arg to the thread pool, as part of the group pointed to by @p group.
+ * The pool is started on the first submission.
+ */
+int upool_submit(struct upool_group *group, void (*fn)(void *), void *arg)
+{
+	struct uworker *self;
+	struct utask *task;
+
+	if ((group == NULL) || (fn == NULL))
+		return (-EINVAL);
+
+	self = upool_self();
+
+	/* Run the task here. */
+	if ((upool_start() < 0) || ((task = utask_alloc(self)) == NULL))
+	{
+		fn(arg);
+		return (0);
+	}
+
+	task->group = group;
+	task->fn = fn;
+	task->arg = arg;
+	task->body = NULL;
+
+	utask_spawn(self, task);
+
+	return (0);
+}
+
+/**
+ * The upool_wait() function waits until all tasks of the group pointed
+ * to by @p group complete. Meanwhile, the caller runs pending tasks of
+ * the pool, thus tasks may wait for tasks that they spawn.
+ */
+void upool_wait(struct upool_group *group)
+{
+	struct uworker *self;
+	struct utask *task;
+
+	self = upool_self();
+
+	while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0)
+	{
+		if ((task = upool_find(self)) != NULL)
+			upool_run(self, task);
+		else
+			ucpu_relax();
+	}
+}
+
+/**
+ * The uparallel_for() function calls @p fn on chunks of the iterations
+ * from @p begin to @p end, with @p arg as the last argument. Chunks run
+ * in parallel, in the calling thread and in the thread pool, and the
+ * function returns once all of them complete.
+ */
+int uparallel_for(
+	size_t begin,
+	size_t end,
+	size_t grain,
+	void (*fn)(size_t, size_t, void *),
+	void *arg
+)
+{
+	struct upool_group group = UPOOL_GROUP_INITIALIZER;
+	int nworkers;
+
+	if ((fn == NULL) || (end < begin))
+		return (-EINVAL);
+
+	if (begin == end)
+		return (0);
+
+	/* Run the loop here. */
+	if (upool_start() < 0)
+	{
+		fn(begin, end, arg);
+		return (0);
+	}
+
+	if (grain == 0)
+	{
+		nworkers = __atomic_load_n(&upool_nworkers, __ATOMIC_ACQUIRE);
+		grain = (end - begin)/((nworkers + 1)*UPOOL_CHUNKS);
+		if (grain == 0)
+			grain = 1;
+	}
+
+	upool_run_range(upool_self(), &group, fn, arg, begin, end, grain);
+	upool_wait(&group);
+
+	return (0);
+}
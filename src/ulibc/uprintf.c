@@ -23,25 +23,337 @@
  */
 
 #include <nanvix/sys/dev.h>
+#include <nanvix/sys/thread.h>
 #include <posix/stdarg.h>
+#include <posix/errno.h>
 #include <nanvix/ulib.h>
 
 /**
- * @todo: TODO provide a detailed description for this function.
+ * @brief Output file descriptor.
+ */
+#define UBUFFER_FD 0
+
+/**
+ * @brief Number of output buffers.
+ */
+#define UBUFFERS_MAX (THREAD_MAX + 1)
+
+/**
+ * @brief Output buffer.
+ */
+struct ubuffer
+{
+	int owner;            /* Owner thread ID plus one (zero if free). */
+	int mode;             /* Buffering mode.                          */
+	unsigned lines;       /* Newlines that trigger a flush.           */
+	unsigned nlines;      /* Buffered newlines.                       */
+	size_t size;          /* Buffer size.                             */
+	size_t len;           /* Buffered bytes.                          */
+	char data[UBUFSIZ+1]; /* Buffered data (plus null byte).          */
+};
+
+/**
+ * @brief Output buffers.
+ */
+static struct ubuffer ubuffers[UBUFFERS_MAX];
+
+/**
+ * @brief Writes all bytes of a buffer to the output device.
+ *
+ * @param buf Target buffer.
+ * @param n   Number of bytes to write.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ *
+ * @note The kernel caps writes at KBUFFER_SIZE bytes, so larger
+ * buffers are written in chunks.
+ */
+static int ubuffer_write(const char *buf, size_t n)
+{
+	size_t len;
+	ssize_t ret;
+
+	while (n > 0)
+	{
+		len = (n > KBUFFER_SIZE) ? KBUFFER_SIZE : n;
+
+		if ((ret = nanvix_write(UBUFFER_FD, buf, len)) < 0)
+			return (ret);
+
+		buf += len;
+		n -= len;
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Gets the output buffer of the calling thread.
+ *
+ * @returns The output buffer of the calling thread. If no buffer is
+ * available, a NULL pointer is returned instead and the caller should
+ * fall back to unbuffered output.
+ */
+static struct ubuffer *ubuffer_get(void)
+{
+	struct ubuffer *b;
+	int owner;
+
+	/* Fast path: buffer in thread-local storage. */
+	if ((b = utls_get(UTLS_KEY_BUFFER)) != NULL)
+		return (b);
+
+	owner = kthread_self() + 1;
+
+	/* Buffer already owned. */
+	for (int i = 0; i < UBUFFERS_MAX; i++)
+	{
+		if (ubuffers[i].owner == owner)
+			return (&ubuffers[i]);
+	}
+
+	/* Slow path: claim a free buffer. */
+	for (int i = 0; i < UBUFFERS_MAX; i++)
+	{
+		if (ubuffers[i].owner != 0)
+			continue;
+
+		if (__sync_bool_compare_and_swap(&ubuffers[i].owner, 0, owner))
+		{
+			ubuffers[i].mode = UBUF_LINE;
+			ubuffers[i].lines = 1;
+			ubuffers[i].nlines = 0;
+			ubuffers[i].size = UBUFSIZ_DEFAULT;
+			ubuffers[i].len = 0;
+
+			utls_set(UTLS_KEY_BUFFER, &ubuffers[i]);
+
+			return (&ubuffers[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Flushes an output buffer.
+ *
+ * @param b Target buffer.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ */
+static int ubuffer_flush(struct ubuffer *b)
+{
+	int ret;
+
+	ret = ubuffer_write(b->data, b->len);
+
+	b->len = 0;
+	b->nlines = 0;
+
+	return (ret);
+}
+
+/**
+ * @brief Commits bytes appended to an output buffer.
+ *
+ * @param b Target buffer.
+ * @param n Number of bytes appended past the buffered ones.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ */
+static int ubuffer_commit(struct ubuffer *b, size_t n)
+{
+	const char *p;
+	const char *end;
+
+	p = &b->data[b->len];
+	end = p + n;
+	b->len += n;
+
+	/* Count newlines. */
+	if (b->mode == UBUF_LINE)
+	{
+		for (/* noop */; (p = umemchr(p, '\n', end - p)) != NULL; p++)
+			b->nlines++;
+
+		if (b->nlines >= b->lines)
+			return (ubuffer_flush(b));
+	}
+
+	/* Buffer is full. */
+	if (b->len == b->size)
+		return (ubuffer_flush(b));
+
+	return (0);
+}
+
+/**
+ * @brief Writes a formatted string to an output buffer.
+ *
+ * @param b    Target buffer.
+ * @param fmt  Formatted string.
+ * @param args Variable arguments list.
+ *
+ * @returns Upon successful completion, the number of characters
+ * written is returned. Upon failure, a negative number is returned
+ * instead.
+ *
+ * @note The string is formatted in place. If it does not fit in the
+ * room that is left, the buffer is flushed and the string formatted
+ * once more.
+ */
+static int ubuffer_vprintf(struct ubuffer *b, const char *fmt, va_list args)
+{
+	int len;
+	va_list args2;
+
+	va_copy(args2, args);
+	len = uvsnprintf(&b->data[b->len], b->size - b->len + 1, fmt, args2);
+	va_end(args2);
+
+	/* Not enough room. */
+	if ((len >= 0) && ((size_t) len > (b->size - b->len)))
+	{
+		if (ubuffer_flush(b) < 0)
+			return (-EIO);
+
+		/* Too large to buffer. */
+		if ((size_t) len > b->size)
+			return (-ENOBUFS);
+
+		len = uvsnprintf(b->data, b->size + 1, fmt, args);
+	}
+
+	if ((len < 0) || (ubuffer_commit(b, len) < 0))
+		return (-EIO);
+
+	return (len);
+}
+
+/**
+ * The uflush() function writes any pending output of the calling
+ * thread to the output device.
+ */
+int uflush(void)
+{
+	struct ubuffer *b;
+
+	if ((b = ubuffer_get()) == NULL)
+		return (0);
+
+	return (ubuffer_flush(b));
+}
+
+/**
+ * The usetvbuf() function sets the buffering mode of the calling
+ * thread to @p mode, the size of its output buffer to @p size and the
+ * number of newlines that trigger a flush in line buffered mode to @p
+ * lines.
+ */
+int usetvbuf(int mode, size_t size, unsigned lines)
+{
+	struct ubuffer *b;
+
+	/* Invalid mode. */
+	if ((mode != UBUF_NONE) && (mode != UBUF_LINE) && (mode != UBUF_FULL))
+		return (-EINVAL);
+
+	/* Invalid size. */
+	if ((size == 0) || (size > UBUFSIZ))
+		return (-EINVAL);
+
+	/* Invalid newline threshold. */
+	if ((mode == UBUF_LINE) && (lines == 0))
+		return (-EINVAL);
+
+	/* No buffer available. */
+	if ((b = ubuffer_get()) == NULL)
+		return (-ENOBUFS);
+
+	if (ubuffer_flush(b) < 0)
+		return (-EIO);
+
+	b->mode = mode;
+	b->size = size;
+	b->lines = lines;
+
+	return (0);
+}
+
+/**
+ * The __ubuffer_flush_all() function flushes the output buffers of all
+ * threads.
+ */
+void __ubuffer_flush_all(void)
+{
+	for (int i = 0; i < UBUFFERS_MAX; i++)
+	{
+		if ((ubuffers[i].owner != 0) && (ubuffers[i].len > 0))
+			ubuffer_flush(&ubuffers[i]);
+	}
+}
+
+/**
+ * The __ubuffer_release() function flushes the output buffer of the
+ * calling thread and makes it available to other threads.
+ */
+void __ubuffer_release(void)
+{
+	int owner;
+
+	owner = kthread_self() + 1;
+
+	for (int i = 0; i < UBUFFERS_MAX; i++)
+	{
+		if (ubuffers[i].owner == owner)
+		{
+			ubuffer_flush(&ubuffers[i]);
+			utls_set(UTLS_KEY_BUFFER, NULL);
+			__sync_lock_release(&ubuffers[i].owner);
+			break;
+		}
+	}
+}
+
+/**
+ * The uprintf() function writes a formatted string to the output
+ * buffer of the calling thread. The buffer is written to the output
+ * device when it fills up or when enough newlines were buffered,
+ * according to the buffering mode set with usetvbuf().
  */
 int uprintf(const char *fmt, ...)
 {
-	size_t len;                    /* String length.           */
+	int len;                       /* String length.           */
 	va_list args;                  /* Variable arguments list. */
+	struct ubuffer *b;             /* Output buffer.           */
 	char buffer[KBUFFER_SIZE + 1]; /* Temporary buffer.        */
 
-	/* Convert to raw string. */
 	va_start(args, fmt);
-	len = uvsprintf(buffer, KBUFFER_SIZE + 1, fmt, args);
-	buffer[++len] = '\0';
+
+	/* Format in place. */
+	if (((b = ubuffer_get()) != NULL) && (b->mode != UBUF_NONE))
+	{
+		if ((len = ubuffer_vprintf(b, fmt, args)) != -ENOBUFS)
+		{
+			va_end(args);
+			return ((len < 0) ? 0 : len);
+		}
+	}
+
+	/* Convert to raw string. */
+	len = uvsnprintf(buffer, KBUFFER_SIZE + 1, fmt, args);
 	va_end(args);
 
-	nanvix_write(0, buffer, ustrlen(buffer));
+	/* Truncated. */
+	if (len > KBUFFER_SIZE)
+		len = KBUFFER_SIZE;
+
+	if ((len <= 0) || (ubuffer_write(buffer, len) < 0))
+		return (0);
 
 	return (len);
 }
@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/perf.h>
+#include <nanvix/ulib.h>
+
+/**
+ * @brief Probe.
+ */
+struct uprof_probe
+{
+	const char *name;      /**< Name (NULL if free).          */
+	struct uspinlock lock; /**< Lock of statistics.           */
+	unsigned count;        /**< Number of regions.            */
+	uint64_t total;        /**< Total cycles.                 */
+	uint64_t min;          /**< Shortest region (in cycles).  */
+	uint64_t max;          /**< Longest region (in cycles).   */
+};
+
+/**
+ * @brief Probes.
+ */
+static struct uprof_probe uprof_probes[UPROF_PROBES_MAX];
+
+/**
+ * @brief Lock of probe registration.
+ */
+static struct uspinlock uprof_lock = USPINLOCK_INITIALIZER;
+
+/**
+ * @brief Was any probe registered?
+ */
+static int uprof_used = 0;
+
+/**
+ * The __ucycles() function reads the clock through the kernel, on
+ * targets that lack a cycle counter readable from user mode.
+ */
+uint64_t __ucycles(void)
+{
+	uint64_t t;
+
+	kclock(&t);
+
+	return (t);
+}
+
+/**
+ * @brief Clears the statistics of a probe.
+ *
+ * @param p Target probe.
+ */
+static void uprof_clear(struct uprof_probe *p)
+{
+	p->count = 0;
+	p->total = 0;
+	p->min = ~((uint64_t) 0);
+	p->max = 0;
+}
+
+/**
+ * @brief Looks up a probe.
+ *
+ * @param name Name of the probe.
+ *
+ * @returns The probe named @p name, or a negative number if the table
+ * of probes is full.
+ *
+ * @details Probes are hashed by the address of their name and never
+ * removed, thus a lookup stops at the first free entry. A new probe is
+ * registered under a lock, and published once it is initialized.
+ */
+static int uprof_lookup(const char *name)
+{
+	unsigned home;
+	const char *n;
+
+	home = (unsigned) ((uintptr_t) name % UPROF_PROBES_MAX);
+
+	/* Fast path: probe already registered. */
+	for (unsigned i = 0; i < UPROF_PROBES_MAX; i++)
+	{
+		unsigned j = (home + i) % UPROF_PROBES_MAX;
+
+		if ((n = __atomic_load_n(&uprof_probes[j].name, __ATOMIC_ACQUIRE)) == name)
+			return (j);
+
+		if (n == NULL)
+			break;
+	}
+
+	/* Slow path: register probe. */
+	uspinlock_lock(&uprof_lock);
+
+	for (unsigned i = 0; i < UPROF_PROBES_MAX; i++)
+	{
+		unsigned j = (home + i) % UPROF_PROBES_MAX;
+		struct uprof_probe *p = &uprof_probes[j];
+
+		if (p->name == name)
+		{
+			uspinlock_unlock(&uprof_lock);
+			return (j);
+		}
+
+		if (p->name == NULL)
+		{
+			uspinlock_init(&p->lock);
+			uprof_clear(p);
+			__atomic_store_n(&p->name, name, __ATOMIC_RELEASE);
+			uprof_used = 1;
+			uspinlock_unlock(&uprof_lock);
+			return (j);
+		}
+	}
+
+	uspinlock_unlock(&uprof_lock);
+
+	return (-1);
+}
+
+/**
+ * The uprof_begin() function enters a region of the probe named @p
+ * name, and stores its state in @p region. The probe is registered the
+ * first time it is entered. The cycle counter is read last, so that the
+ * lookup is not accounted to the region.
+ */
+void uprof_begin(struct uprof_region *region, const char *name)
+{
+	region->probe = uprof_lookup(name);
+	region->start = ucycles();
+}
+
+/**
+ * The uprof_end() function leaves the region pointed to by @p region,
+ * and adds its duration to the statistics of its probe. The cycle
+ * counter is read first, so that the update is not accounted to the
+ * region.
+ */
+void uprof_end(struct uprof_region *region)
+{
+	struct uprof_probe *p;
+	uint64_t cycles;
+
+	cycles = ucycles() - region->start;
+
+	/* Table of probes was full. */
+	if (region->probe < 0)
+		return;
+
+	p = &uprof_probes[region->probe];
+
+	uspinlock_lock(&p->lock);
+	p->count++;
+	p->total += cycles;
+	if (cycles < p->min)
+		p->min = cycles;
+	if (cycles > p->max)
+		p->max = cycles;
+	uspinlock_unlock(&p->lock);
+}
+
+/**
+ * The uprof_report() function prints one line with the statistics of
+ * each probe that was entered. Averages are left to the reader, since
+ * targets with 32-bit registers lack a 64-bit division.
+ */
+void uprof_report(void)
+{
+	struct uprof_probe *p;
+	struct uprof_probe s;
+
+	for (int i = 0; i < UPROF_PROBES_MAX; i++)
+	{
+		p = &uprof_probes[i];
+
+		if (__atomic_load_n(&p->name, __ATOMIC_ACQUIRE) == NULL)
+			continue;
+
+		uspinlock_lock(&p->lock);
+		s = *p;
+		uspinlock_unlock(&p->lock);
+
+		if (s.count == 0)
+			continue;
+
+		uprintf("[uprof] %s count %u total %llu min %llu max %llu cycles\n",
+			s.name, s.count,
+			(unsigned long long) s.total,
+			(unsigned long long) s.min,
+			(unsigned long long) s.max
+		);
+	}
+}
+
+/**
+ * The uprof_reset() function clears the statistics of all probes.
+ */
+void uprof_reset(void)
+{
+	struct uprof_probe *p;
+
+	for (int i = 0; i < UPROF_PROBES_MAX; i++)
+	{
+		p = &uprof_probes[i];
+
+		if (__atomic_load_n(&p->name, __ATOMIC_ACQUIRE) == NULL)
+			continue;
+
+		uspinlock_lock(&p->lock);
+		uprof_clear(p);
+		uspinlock_unlock(&p->lock);
+	}
+}
+
+/**
+ * The __uprof_exit() function prints the statistics of all probes when
+ * the process exits, if any probe was entered.
+ */
+void __uprof_exit(void)
+{
+	if (uprof_used)
+		uprof_report();
+}
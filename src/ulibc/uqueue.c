@@ -0,0 +1,370 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Rounds the capacity of a queue up to a power of two.
+ *
+ * @param capacity Requested capacity.
+ *
+ * @returns The capacity of the queue, or zero if @p capacity is
+ * invalid.
+ */
+static unsigned uqueue_capacity(size_t capacity)
+{
+	unsigned n;
+
+	if ((capacity == 0) || (capacity > UQUEUE_CAPACITY_MAX))
+		return (0);
+
+	for (n = 2; n < capacity; n <<= 1)
+		/* noop */;
+
+	return (n);
+}
+
+/*============================================================================*
+ * Single-Producer Single-Consumer Queue                                      *
+ *============================================================================*/
+
+/**
+ * The uspsc_init() function initializes the single-producer
+ * single-consumer queue pointed to by @p q with room for at least @p
+ * capacity items.
+ */
+int uspsc_init(struct uspsc *q, size_t capacity)
+{
+	unsigned n;
+
+	if (q == NULL)
+		return (-EINVAL);
+
+	if ((n = uqueue_capacity(capacity)) == 0)
+		return (-EINVAL);
+
+	if ((q->slots = umalloc(n*sizeof(void *))) == NULL)
+		return (-ENOMEM);
+
+	q->mask = n - 1;
+	q->tail = 0;
+	q->head_cache = 0;
+	q->head = 0;
+	q->tail_cache = 0;
+
+	return (0);
+}
+
+/**
+ * The uspsc_destroy() function releases the storage of the
+ * single-producer single-consumer queue pointed to by @p q. No thread
+ * may use the queue afterwards.
+ */
+void uspsc_destroy(struct uspsc *q)
+{
+	ufree(q->slots);
+	q->slots = NULL;
+}
+
+/**
+ * The uspsc_push() function enqueues @p item in the single-producer
+ * single-consumer queue pointed to by @p q. Only one thread may push
+ * items at a time.
+ */
+int uspsc_push(struct uspsc *q, void *item)
+{
+	unsigned tail;
+
+	tail = q->tail;
+
+	if ((tail - q->head_cache) > q->mask)
+	{
+		q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+
+		if ((tail - q->head_cache) > q->mask)
+			return (-EAGAIN);
+	}
+
+	q->slots[tail & q->mask] = item;
+	__atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return (0);
+}
+
+/**
+ * The uspsc_pop() function dequeues an item from the single-producer
+ * single-consumer queue pointed to by @p q and stores it in @p item.
+ * Only one thread may pop items at a time.
+ */
+int uspsc_pop(struct uspsc *q, void **item)
+{
+	unsigned head;
+
+	head = q->head;
+
+	if (head == q->tail_cache)
+	{
+		q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+		if (head == q->tail_cache)
+			return (-EAGAIN);
+	}
+
+	*item = q->slots[head & q->mask];
+	__atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+
+	return (0);
+}
+
+/**
+ * The uspsc_push_batch() function enqueues up to @p n items from the
+ * array pointed to by @p items in the single-producer single-consumer
+ * queue pointed to by @p q. All items are published at once.
+ */
+size_t uspsc_push_batch(struct uspsc *q, void *const *items, size_t n)
+{
+	unsigned tail;
+	size_t room;
+
+	tail = q->tail;
+	room = (q->mask + 1) - (tail - q->head_cache);
+
+	if (room < n)
+	{
+		q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+		room = (q->mask + 1) - (tail - q->head_cache);
+
+		if (room < n)
+			n = room;
+	}
+
+	for (size_t i = 0; i < n; i++)
+		q->slots[(tail + i) & q->mask] = items[i];
+
+	__atomic_store_n(&q->tail, tail + n, __ATOMIC_RELEASE);
+
+	return (n);
+}
+
+/**
+ * The uspsc_pop_batch() function dequeues up to @p n items from the
+ * single-producer single-consumer queue pointed to by @p q and stores
+ * them in the array pointed to by @p items. All items are released at
+ * once.
+ */
+size_t uspsc_pop_batch(struct uspsc *q, void **items, size_t n)
+{
+	unsigned head;
+	size_t count;
+
+	head = q->head;
+	count = q->tail_cache - head;
+
+	if (count < n)
+	{
+		q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+		count = q->tail_cache - head;
+
+		if (count < n)
+			n = count;
+	}
+
+	for (size_t i = 0; i < n; i++)
+		items[i] = q->slots[(head + i) & q->mask];
+
+	__atomic_store_n(&q->head, head + n, __ATOMIC_RELEASE);
+
+	return (n);
+}
+
+/*============================================================================*
+ * Multi-Producer Multi-Consumer Queue                                        *
+ *============================================================================*/
+
+/**
+ * The umpmc_init() function initializes the multi-producer
+ * multi-consumer queue pointed to by @p q with room for at least @p
+ * capacity items.
+ */
+int umpmc_init(struct umpmc *q, size_t capacity)
+{
+	unsigned n;
+
+	if (q == NULL)
+		return (-EINVAL);
+
+	if ((n = uqueue_capacity(capacity)) == 0)
+		return (-EINVAL);
+
+	if ((q->cells = umalloc(n*sizeof(struct umpmc_cell))) == NULL)
+		return (-ENOMEM);
+
+	for (unsigned i = 0; i < n; i++)
+		q->cells[i].seq = i;
+
+	q->mask = n - 1;
+	q->tail = 0;
+	__atomic_store_n(&q->head, 0, __ATOMIC_RELEASE);
+
+	return (0);
+}
+
+/**
+ * The umpmc_destroy() function releases the storage of the
+ * multi-producer multi-consumer queue pointed to by @p q. No thread may
+ * use the queue afterwards.
+ */
+void umpmc_destroy(struct umpmc *q)
+{
+	ufree(q->cells);
+	q->cells = NULL;
+}
+
+/**
+ * @brief Claims cells of a multi-producer multi-consumer queue.
+ *
+ * @param q     Target queue.
+ * @param index Index to advance (head or tail).
+ * @param lap   Offset of the sequence number of a claimable cell.
+ * @param n     Maximum number of cells to claim.
+ * @param pos   Store location for the first claimed position.
+ *
+ * @returns The number of claimed cells.
+ *
+ * @details A cell at position p may be written when its sequence
+ * number is p, and read when it is p + 1. The run of claimable cells
+ * that starts at the current index is claimed with a single
+ * compare-and-swap. A claimed cell cannot change under the caller,
+ * because only the thread that owns its position touches it.
+ */
+static size_t umpmc_claim(struct umpmc *q, unsigned *index, unsigned lap, size_t n, unsigned *pos)
+{
+	unsigned p;
+	size_t k;
+	int diff;
+
+	if (n > (size_t) q->mask + 1)
+		n = q->mask + 1;
+
+	p = __atomic_load_n(index, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		for (k = 0; k < n; k++)
+		{
+			struct umpmc_cell *cell = &q->cells[(p + k) & q->mask];
+
+			if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != (p + k + lap))
+				break;
+		}
+
+		if (k == 0)
+		{
+			diff = (int) (__atomic_load_n(&q->cells[p & q->mask].seq, __ATOMIC_ACQUIRE) - (p + lap));
+
+			/* Queue is full (or empty). */
+			if (diff < 0)
+				return (0);
+
+			/* Another thread went ahead. */
+			if (diff > 0)
+				p = __atomic_load_n(index, __ATOMIC_RELAXED);
+
+			continue;
+		}
+
+		if (__atomic_compare_exchange_n(index, &p, p + k, 1,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+	}
+
+	*pos = p;
+
+	return (k);
+}
+
+/**
+ * The umpmc_push() function enqueues @p item in the multi-producer
+ * multi-consumer queue pointed to by @p q.
+ */
+int umpmc_push(struct umpmc *q, void *item)
+{
+	return ((umpmc_push_batch(q, &item, 1) == 1) ? 0 : -EAGAIN);
+}
+
+/**
+ * The umpmc_pop() function dequeues an item from the multi-producer
+ * multi-consumer queue pointed to by @p q and stores it in @p item.
+ */
+int umpmc_pop(struct umpmc *q, void **item)
+{
+	return ((umpmc_pop_batch(q, item, 1) == 1) ? 0 : -EAGAIN);
+}
+
+/**
+ * The umpmc_push_batch() function enqueues up to @p n items from the
+ * array pointed to by @p items in the multi-producer multi-consumer
+ * queue pointed to by @p q. Items are enqueued in order, next to each
+ * other.
+ */
+size_t umpmc_push_batch(struct umpmc *q, void *const *items, size_t n)
+{
+	unsigned pos;
+
+	n = umpmc_claim(q, &q->tail, 0, n, &pos);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		struct umpmc_cell *cell = &q->cells[(pos + i) & q->mask];
+
+		cell->data = items[i];
+		__atomic_store_n(&cell->seq, pos + i + 1, __ATOMIC_RELEASE);
+	}
+
+	return (n);
+}
+
+/**
+ * The umpmc_pop_batch() function dequeues up to @p n items from the
+ * multi-producer multi-consumer queue pointed to by @p q and stores
+ * them in the array pointed to by @p items.
+ */
+size_t umpmc_pop_batch(struct umpmc *q, void **items, size_t n)
+{
+	unsigned pos;
+
+	n = umpmc_claim(q, &q->head, 1, n, &pos);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		struct umpmc_cell *cell = &q->cells[(pos + i) & q->mask];
+
+		items[i] = cell->data;
+		__atomic_store_n(&cell->seq, pos + i + q->mask + 1, __ATOMIC_RELEASE);
+	}
+
+	return (n);
+}
@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+
+/**
+ * @brief Number of buckets of a digit.
+ */
+#define URADIX_BUCKETS (1 << URADIX_BITS)
+
+/**
+ * @brief Extracts a digit of a key.
+ */
+#define URADIX_DIGIT(k, shift) (((k) >> (shift)) & (URADIX_BUCKETS - 1))
+
+/**
+ * @brief Defines a radix sort.
+ *
+ * @param name  Suffix of the function.
+ * @param ktype Type of keys.
+ * @param vtype Type of values.
+ *
+ * @details The defined function sorts @p n keys in @p keys and, if @p
+ * vals is not NULL, moves the values in @p vals along with them. The
+ * histograms of all digits are computed in a single pass over the keys.
+ * Then, each digit is scattered from one buffer to the other, except for
+ * digits that all keys share, which are skipped. Since every pass is
+ * stable, so is the sort.
+ */
+#define URADIX_DEFINE(name, ktype, vtype)                                     \
+	static int uradix_##name(ktype *keys, vtype *vals, size_t n, void *scratch)\
+	{                                                                         \
+		size_t *counts;            /* Histograms, one per digit.     */       \
+		ktype *ksrc, *kdst, *ktmp; /* Source and destination keys.   */       \
+		vtype *vsrc, *vdst, *vtmp; /* Source and destination values. */       \
+		void *buffer = NULL;       /* Allocated scratch buffer.      */       \
+		const int ndigits = URADIX_DIGITS(sizeof(ktype));                     \
+                                                                              \
+		/* Nothing to be done. */                                             \
+		if (n < 2)                                                            \
+			return (0);                                                       \
+                                                                              \
+		if (scratch == NULL)                                                  \
+		{                                                                     \
+			size_t size = URADIX_SCRATCH_SIZE(n, sizeof(ktype),               \
+				(vals != NULL) ? sizeof(vtype) : 0);                          \
+			if ((scratch = buffer = umalloc(size)) == NULL)                   \
+				return (-ENOMEM);                                             \
+		}                                                                     \
+                                                                              \
+		counts = scratch;                                                     \
+		kdst = (ktype *) &counts[ndigits*URADIX_BUCKETS];                     \
+		vdst = (vtype *) &kdst[n];                                            \
+		ksrc = keys;                                                          \
+		vsrc = vals;                                                          \
+                                                                              \
+		/* Histograms of all digits. */                                       \
+		umemset(counts, 0, ndigits*URADIX_BUCKETS*sizeof(size_t));            \
+		for (size_t i = 0; i < n; i++)                                        \
+		{                                                                     \
+			ktype k = keys[i];                                                \
+			for (int d = 0; d < ndigits; d++)                                 \
+				counts[d*URADIX_BUCKETS + URADIX_DIGIT(k, d*URADIX_BITS)]++;  \
+		}                                                                     \
+                                                                              \
+		for (int d = 0; d < ndigits; d++)                                     \
+		{                                                                     \
+			size_t *c = &counts[d*URADIX_BUCKETS];                            \
+			int shift = d*URADIX_BITS;                                        \
+			size_t sum = 0;                                                   \
+                                                                              \
+			/* All keys share this digit. */                                  \
+			if (c[URADIX_DIGIT(ksrc[0], shift)] == n)                         \
+				continue;                                                     \
+                                                                              \
+			/* Offsets of buckets. */                                         \
+			for (int b = 0; b < URADIX_BUCKETS; b++)                          \
+			{                                                                 \
+				size_t t = c[b];                                              \
+				c[b] = sum;                                                   \
+				sum += t;                                                     \
+			}                                                                 \
+                                                                              \
+			/* Scatter. */                                                    \
+			if (vals == NULL)                                                 \
+			{                                                                 \
+				for (size_t i = 0; i < n; i++)                                \
+					kdst[c[URADIX_DIGIT(ksrc[i], shift)]++] = ksrc[i];        \
+			}                                                                 \
+			else                                                              \
+			{                                                                 \
+				for (size_t i = 0; i < n; i++)                                \
+				{                                                             \
+					size_t j = c[URADIX_DIGIT(ksrc[i], shift)]++;             \
+					kdst[j] = ksrc[i];                                        \
+					vdst[j] = vsrc[i];                                        \
+				}                                                             \
+			}                                                                 \
+                                                                              \
+			/* Swap buffers. */                                               \
+			ktmp = ksrc; ksrc = kdst; kdst = ktmp;                            \
+			vtmp = vsrc; vsrc = vdst; vdst = vtmp;                            \
+		}                                                                     \
+                                                                              \
+		/* Sorted data ended up in the scratch buffer. */                     \
+		if (ksrc != keys)                                                     \
+		{                                                                     \
+			umemcpy(keys, ksrc, n*sizeof(ktype));                             \
+			if (vals != NULL)                                                 \
+				umemcpy(vals, vsrc, n*sizeof(vtype));                         \
+		}                                                                     \
+                                                                              \
+		ufree(buffer);                                                        \
+                                                                              \
+		return (0);                                                           \
+	}
+
+URADIX_DEFINE(u32, uint32_t, uint32_t)
+URADIX_DEFINE(u64, uint64_t, uint64_t)
+
+/**
+ * The uradix_sort_u32() function sorts the @p n keys in @p keys in
+ * ascending order with an LSD radix sort. If @p scratch is NULL, a
+ * scratch buffer is allocated with umalloc().
+ *
+ * @returns Upon successful completion, zero is returned. If @p keys is
+ * invalid, -EINVAL is returned. If no scratch buffer could be
+ * allocated, -ENOMEM is returned instead.
+ */
+int uradix_sort_u32(uint32_t *keys, size_t n, void *scratch)
+{
+	/* Invalid argument. */
+	if ((keys == NULL) && (n > 0))
+		return (-EINVAL);
+
+	return (uradix_u32(keys, NULL, n, scratch));
+}
+
+/**
+ * The uradix_sort_u64() function works like uradix_sort_u32() on
+ * 64-bit keys.
+ */
+int uradix_sort_u64(uint64_t *keys, size_t n, void *scratch)
+{
+	/* Invalid argument. */
+	if ((keys == NULL) && (n > 0))
+		return (-EINVAL);
+
+	return (uradix_u64(keys, NULL, n, scratch));
+}
+
+/**
+ * The uradix_sort_u32_kv() function works like uradix_sort_u32() and
+ * moves the values in @p vals along with their keys. Values of equal
+ * keys keep their relative order.
+ */
+int uradix_sort_u32_kv(uint32_t *keys, uint32_t *vals, size_t n, void *scratch)
+{
+	/* Invalid arguments. */
+	if (((keys == NULL) || (vals == NULL)) && (n > 0))
+		return (-EINVAL);
+
+	return (uradix_u32(keys, vals, n, scratch));
+}
+
+/**
+ * The uradix_sort_u64_kv() function works like uradix_sort_u32_kv() on
+ * 64-bit keys and values.
+ */
+int uradix_sort_u64_kv(uint64_t *keys, uint64_t *vals, size_t n, void *scratch)
+{
+	/* Invalid arguments. */
+	if (((keys == NULL) || (vals == NULL)) && (n > 0))
+		return (-EINVAL);
+
+	return (uradix_u64(keys, vals, n, scratch));
+}
@@ -31,10 +31,7 @@
  * SUCH DAMAGE.
  */
 
-/**
- * @brief Next random number.
- */
-static unsigned long next = 2;
+#include <nanvix/ulib.h>
 
 /**
  * @brief Computes a random number.
@@ -67,22 +64,28 @@ static int do_rand(unsigned long *state)
 }
 
 /**
- * @todo TODO: provide a detailed description for this function.
+ * The usrand() function sets the seed of the default streams of all
+ * threads to @p seed. A thread draws the same sequence from urand()
+ * after each call with the same seed.
  */
 void usrand(unsigned seed)
 {
-	next = seed;
-
-	/* Transform to [1, 0x7ffffffe] range. */
-	next = (next % 0x7ffffffe) + 1;
+	__urand_reseed(seed);
 }
 
 /**
- * @todo TODO: provide a detailed description for this function.
+ * The urand() function returns a random number in [0, 2^31 - 1], drawn
+ * from the default stream of the calling thread. Threads do not share
+ * streams, so no locking is needed, unless all streams are taken.
  */
 int urand(void)
 {
-	return (do_rand(&next));
+	struct urand_state *state;
+
+	if ((state = urand_self()) == NULL)
+		return ((int) (__urand_shared() >> 1));
+
+	return ((int) (urand32(state) >> 1));
 }
 
 /**
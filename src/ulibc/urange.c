@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+#include "uarith.h"
+
+/**
+ * The urand_range() function returns a uniformly distributed random
+ * number in [0, @p n), drawn from the generator pointed to by @p state.
+ * If @p n is zero, zero is returned.
+ *
+ * A 32-bit random number x is mapped to the high half of x*n (Lemire).
+ * The low half tells whether x falls in the few values that would bias
+ * the result, and only then the threshold 2^32 mod n is computed with a
+ * division and x is drawn again. Thus, the common case costs one
+ * multiplication and no division.
+ */
+uint32_t urand_range(struct urand_state *state, uint32_t n)
+{
+	uint32_t t;
+	uint64_t m;
+
+	m = (uint64_t) urand32(state)*n;
+
+	/* Possibly biased. */
+	if ((uint32_t) m < n)
+	{
+		t = -n % n;
+		while ((uint32_t) m < t)
+			m = (uint64_t) urand32(state)*n;
+	}
+
+	return ((uint32_t) (m >> 32));
+}
+
+/**
+ * The urand_range64() function returns a uniformly distributed random
+ * number in [0, @p n), drawn from the generator pointed to by @p state.
+ * It works like urand_range() with a 64x64-bit multiplication.
+ */
+uint64_t urand_range64(struct urand_state *state, uint64_t n)
+{
+	uint64_t x;
+	uint64_t t;
+
+	x = urand64(state);
+
+	/* Possibly biased. */
+	if (x*n < n)
+	{
+		t = -n % n;
+		while (x*n < t)
+			x = urand64(state);
+	}
+
+	return (umulh64(x, n));
+}
+
+/**
+ * The urand_between() function returns a uniformly distributed random
+ * number in [@p lo, @p hi], drawn from the generator pointed to by @p
+ * state. The caller must ensure that @p lo is not greater than @p hi.
+ */
+int32_t urand_between(struct urand_state *state, int32_t lo, int32_t hi)
+{
+	uint32_t n;
+
+	n = (uint32_t) hi - (uint32_t) lo + 1;
+
+	/* Whole range. */
+	if (n == 0)
+		return ((int32_t) urand32(state));
+
+	return ((int32_t) ((uint32_t) lo + urand_range(state, n)));
+}
+
+/**
+ * @brief Draws a random index.
+ *
+ * @param state Target generator.
+ * @param n     Number of indexes.
+ *
+ * @returns A uniformly distributed random number in [0, @p n).
+ */
+static inline size_t urand_index(struct urand_state *state, size_t n)
+{
+	if (n <= 0xffffffffUL)
+		return (urand_range(state, (uint32_t) n));
+
+	return ((size_t) urand_range64(state, n));
+}
+
+/**
+ * @brief Swaps two elements.
+ *
+ * @param a    First element.
+ * @param b    Second element.
+ * @param size Size of an element.
+ */
+static inline void uswap(unsigned char *a, unsigned char *b, size_t size)
+{
+	unsigned char t;
+
+	while (size-- > 0)
+	{
+		t = *a;
+		*a++ = *b;
+		*b++ = t;
+	}
+}
+
+/**
+ * The ushuffle() function randomly permutes the @p nmemb elements of
+ * @p size bytes in the array @p base, with the Fisher-Yates algorithm.
+ * All permutations are equally likely.
+ */
+void ushuffle(struct urand_state *state, void *base, size_t nmemb, size_t size)
+{
+	size_t j;
+	unsigned char *p;
+
+	p = base;
+
+	for (size_t i = nmemb; i > 1; i--)
+	{
+		j = urand_index(state, i);
+		if (j != i - 1)
+			uswap(&p[j*size], &p[(i - 1)*size], size);
+	}
+}
+
+/**
+ * The usample() function copies to @p dst a random sample of @p k
+ * elements of @p size bytes, taken without replacement from the @p n
+ * elements of @p src, with reservoir sampling. Each subset of @p k
+ * elements is equally likely, and @p src is scanned once.
+ *
+ * @returns The number of elements copied, which is the smallest of @p
+ * k and @p n.
+ */
+size_t usample(
+	struct urand_state *state,
+	void *dst,
+	size_t k,
+	const void *src,
+	size_t n,
+	size_t size
+)
+{
+	size_t j;
+	unsigned char *d;
+	const unsigned char *s;
+
+	d = dst;
+	s = src;
+
+	if (k > n)
+		k = n;
+
+	/* Fill the reservoir. */
+	umemcpy(d, s, k*size);
+
+	/* Replace elements with decreasing probability. */
+	for (size_t i = k; i < n; i++)
+	{
+		if ((j = urand_index(state, i + 1)) < k)
+			umemcpy(&d[j*size], &s[i*size], size);
+	}
+
+	return (k);
+}
@@ -0,0 +1,316 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+
+/**
+ * @brief Swaps two elements.
+ *
+ * @param a     First element.
+ * @param b     Second element.
+ * @param size  Size of an element.
+ * @param words Size of the aligned words that make up elements (1 if
+ * elements are swapped byte by byte).
+ */
+static inline void uqsort_swap(char *a, char *b, size_t size, size_t words)
+{
+	/* Long words. */
+	if (words == sizeof(long))
+	{
+		long *x = (long *) a;
+		long *y = (long *) b;
+
+		for (size_t n = size/sizeof(long); n > 0; n--)
+		{
+			long t = *x;
+			*x++ = *y;
+			*y++ = t;
+		}
+	}
+
+	/* Words. */
+	else if (words == sizeof(int))
+	{
+		int *x = (int *) a;
+		int *y = (int *) b;
+
+		for (size_t n = size/sizeof(int); n > 0; n--)
+		{
+			int t = *x;
+			*x++ = *y;
+			*y++ = t;
+		}
+	}
+
+	/* Bytes. */
+	else
+	{
+		while (size-- > 0)
+		{
+			char t = *a;
+			*a++ = *b;
+			*b++ = t;
+		}
+	}
+}
+
+/**
+ * @brief Sorts a small array by insertion.
+ */
+static void uqsort_insertion(
+	char *base,
+	size_t n,
+	size_t size,
+	int (*compar)(const void *, const void *),
+	size_t words
+)
+{
+	for (size_t i = 1; i < n; i++)
+	{
+		for (char *p = base + i*size; (p > base) && (compar(p, p - size) < 0); p -= size)
+			uqsort_swap(p, p - size, size, words);
+	}
+}
+
+/**
+ * @brief Sifts an element down a heap.
+ */
+static void uqsort_sift(
+	char *base,
+	size_t i,
+	size_t n,
+	size_t size,
+	int (*compar)(const void *, const void *),
+	size_t words
+)
+{
+	for (size_t c = 2*i + 1; c < n; i = c, c = 2*i + 1)
+	{
+		if ((c + 1 < n) && (compar(base + c*size, base + (c + 1)*size) < 0))
+			c++;
+
+		if (compar(base + i*size, base + c*size) >= 0)
+			break;
+
+		uqsort_swap(base + i*size, base + c*size, size, words);
+	}
+}
+
+/**
+ * @brief Sorts an array with heapsort.
+ */
+static void uqsort_heap(
+	char *base,
+	size_t n,
+	size_t size,
+	int (*compar)(const void *, const void *),
+	size_t words
+)
+{
+	for (size_t i = n/2; i > 0; i--)
+		uqsort_sift(base, i - 1, n, size, compar, words);
+
+	for (size_t i = n; i > 1; i--)
+	{
+		uqsort_swap(base, base + (i - 1)*size, size, words);
+		uqsort_sift(base, 0, i - 1, size, compar, words);
+	}
+}
+
+/**
+ * @brief Sorts an array with introsort.
+ *
+ * @param base   Target array.
+ * @param n      Number of elements in @p base.
+ * @param size   Size of an element.
+ * @param compar Comparison function.
+ * @param words  Size of the aligned words that make up elements.
+ * @param depth  Number of partitions left before falling back to
+ * heapsort.
+ */
+static void uqsort_intro(
+	char *base,
+	size_t n,
+	size_t size,
+	int (*compar)(const void *, const void *),
+	size_t words,
+	int depth
+)
+{
+	while (n > USORT_THRESHOLD)
+	{
+		char *mid, *last, *i, *j;
+		size_t left;
+
+		/* Too many bad pivots. */
+		if (depth-- == 0)
+		{
+			uqsort_heap(base, n, size, compar, words);
+			return;
+		}
+
+		mid = base + (n/2)*size;
+		last = base + (n - 1)*size;
+
+		/* Median of three goes to the front, maximum to the back. */
+		if (compar(mid, base) < 0)
+			uqsort_swap(mid, base, size, words);
+		if (compar(last, mid) < 0)
+			uqsort_swap(last, mid, size, words);
+		if (compar(mid, base) < 0)
+			uqsort_swap(mid, base, size, words);
+		uqsort_swap(mid, base, size, words);
+
+		/*
+		 * Hoare partition around the pivot at the front. The last
+		 * element bounds the first upward scan, and the pivot bounds
+		 * downward scans. Both scans stop on elements equal to the
+		 * pivot, which keeps partitions balanced on duplicates.
+		 */
+		for (i = base + size, j = last; /* noop */; i += size, j -= size)
+		{
+			while (compar(i, base) < 0)
+				i += size;
+			while (compar(base, j) < 0)
+				j -= size;
+
+			if (i >= j)
+				break;
+
+			uqsort_swap(i, j, size, words);
+		}
+		uqsort_swap(base, j, size, words);
+
+		left = (size_t) (j - base)/size;
+
+		/* Recurse into the smaller side, loop on the larger. */
+		if (left < n - left - 1)
+		{
+			uqsort_intro(base, left, size, compar, words, depth);
+			base = j + size;
+			n -= left + 1;
+		}
+		else
+		{
+			uqsort_intro(j + size, n - left - 1, size, compar, words, depth);
+			n = left;
+		}
+	}
+
+	uqsort_insertion(base, n, size, compar, words);
+}
+
+/**
+ * The uqsort() function sorts the @p nmemb elements of @p size bytes in
+ * the array @p base in ascending order, according to @p compar.
+ *
+ * The array is sorted with introsort: quicksort with median-of-three
+ * pivots, insertion sort for partitions of up to USORT_THRESHOLD
+ * elements, and heapsort once partitions get 2*log2(nmemb) levels deep.
+ * Thus, the worst case is O(n log n). Elements are swapped a word at a
+ * time when the array and @p size allow it.
+ */
+void uqsort(
+	void *base,
+	size_t nmemb,
+	size_t size,
+	int (*compar)(const void *, const void *)
+)
+{
+	int depth;
+	size_t words;
+
+	/* Nothing to be done. */
+	if ((base == NULL) || (compar == NULL) || (size == 0) || (nmemb < 2))
+		return;
+
+	/* Largest word that both the array and its elements are aligned to. */
+	if ((((uintptr_t) base | size) & (sizeof(long) - 1)) == 0)
+		words = sizeof(long);
+	else if ((((uintptr_t) base | size) & (sizeof(int) - 1)) == 0)
+		words = sizeof(int);
+	else
+		words = 1;
+
+	depth = 0;
+	for (size_t m = nmemb; m > 1; m >>= 1)
+		depth += 2;
+
+	uqsort_intro(base, nmemb, size, compar, words, depth);
+}
+
+/**
+ * The ubsearch() function searches the @p nmemb elements of @p size
+ * bytes in the array @p base, which is sorted in ascending order
+ * according to @p compar, for an element equal to @p key. If several
+ * elements match, any of them may be returned.
+ */
+void *ubsearch(
+	const void *key,
+	const void *base,
+	size_t nmemb,
+	size_t size,
+	int (*compar)(const void *, const void *)
+)
+{
+	const char *p;
+	int c;
+
+	/* Invalid arguments. */
+	if ((base == NULL) || (compar == NULL))
+		return (NULL);
+
+	p = base;
+
+	while (nmemb > 0)
+	{
+		const char *q = p + (nmemb/2)*size;
+
+		if ((c = compar(key, q)) == 0)
+			return ((void *) (uintptr_t) q);
+
+		/* Upper half. */
+		if (c > 0)
+		{
+			p = q + size;
+			nmemb -= nmemb/2 + 1;
+		}
+
+		/* Lower half. */
+		else
+			nmemb /= 2;
+	}
+
+	return (NULL);
+}
+
+/*============================================================================*
+ * Type-Specialised Sort and Search                                           *
+ *============================================================================*/
+
+USORT_DEFINE(, int, int, USORT_LESS)
+USORT_DEFINE(, u32, uint32_t, USORT_LESS)
+USORT_DEFINE(, u64, uint64_t, USORT_LESS)
+USORT_DEFINE(, ptr, void *, USORT_LESS_PTR)
@@ -0,0 +1,426 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/dev.h>
+#include <posix/errno.h>
+#include <nanvix/ulib.h>
+
+/**
+ * @brief Writes to a file, at most one kernel buffer at a time.
+ *
+ * @note The kernel caps writes at KBUFFER_SIZE bytes.
+ */
+static ssize_t ustream_kwrite(int fd, const void *buf, size_t n)
+{
+	return (__nanvix_write(fd, buf, (n > KBUFFER_SIZE) ? KBUFFER_SIZE : n));
+}
+
+/**
+ * @brief Default input and output routines.
+ */
+static const struct ustream_io ustream_kernel = {
+	__nanvix_read, ustream_kwrite
+};
+
+/**
+ * @brief Writes a buffer to the file of a stream.
+ *
+ * @param s   Target stream.
+ * @param buf Target buffer.
+ * @param n   Number of bytes to write.
+ *
+ * @returns The number of bytes written. If writing fails before any
+ * byte is written, a negative error code is returned instead.
+ */
+static ssize_t ustream_put(const struct ustream *s, const char *buf, size_t n)
+{
+	size_t done = 0;
+	ssize_t ret;
+
+	while (done < n)
+	{
+		if ((ret = s->io->write(s->fd, buf + done, n - done)) <= 0)
+		{
+			/* No progress. */
+			if (ret == 0)
+				ret = -EIO;
+
+			return ((done > 0) ? (ssize_t) done : ret);
+		}
+
+		done += ret;
+	}
+
+	return (done);
+}
+
+/**
+ * @brief Reads ahead into the buffer of a stream.
+ *
+ * @param s Target stream.
+ *
+ * @returns The number of bytes read, zero at the end of the input, or a
+ * negative error code.
+ *
+ * @details Pending bytes are moved to the start of the buffer, and then
+ * the rest of the buffer is filled with a single read.
+ */
+static ssize_t ustream_fill(struct ustream *s)
+{
+	ssize_t ret;
+
+	if (s->eof)
+		return (0);
+
+	if (s->pos > 0)
+	{
+		umemmove(s->buf, s->buf + s->pos, s->len - s->pos);
+		s->len -= s->pos;
+		s->pos = 0;
+	}
+
+	if ((ret = s->io->read(s->fd, s->buf + s->len, s->size - s->len)) < 0)
+		return (ret);
+
+	if (ret == 0)
+		s->eof = 1;
+
+	s->len += ret;
+
+	return (ret);
+}
+
+/**
+ * The ustream_open() function opens the stream pointed to by @p s on
+ * the file descriptor @p fd. If @p buf is NULL, a buffer of @p size
+ * bytes is allocated with umalloc(), and released on ustream_close().
+ */
+int ustream_open(struct ustream *s, int fd, int mode, void *buf, size_t size)
+{
+	/* Invalid arguments. */
+	if ((s == NULL) || ((mode != USTREAM_READ) && (mode != USTREAM_WRITE)))
+		return (-EINVAL);
+	if ((buf != NULL) && (size == 0))
+		return (-EINVAL);
+
+	if (size == 0)
+		size = USTREAM_BUFSIZ_DEFAULT;
+
+	s->allocated = NULL;
+	if ((buf == NULL) && ((buf = s->allocated = umalloc(size)) == NULL))
+		return (-ENOMEM);
+
+	s->fd = fd;
+	s->mode = mode;
+	s->eof = 0;
+	s->buf = buf;
+	s->size = size;
+	s->pos = 0;
+	s->len = 0;
+	s->io = &ustream_kernel;
+
+	return (0);
+}
+
+/**
+ * The ustream_setio() function makes the stream pointed to by @p s
+ * transfer data with the routines in @p io.
+ */
+void ustream_setio(struct ustream *s, const struct ustream_io *io)
+{
+	s->io = (io != NULL) ? io : &ustream_kernel;
+}
+
+/**
+ * The ustream_close() function writes pending bytes of the stream
+ * pointed to by @p s, if it is an output stream, and releases its
+ * buffer, if it was allocated on ustream_open().
+ */
+int ustream_close(struct ustream *s)
+{
+	int ret = 0;
+
+	if (s == NULL)
+		return (-EINVAL);
+
+	if (s->mode == USTREAM_WRITE)
+		ret = ustream_flush(s);
+
+	ufree(s->allocated);
+	s->allocated = NULL;
+	s->buf = NULL;
+	s->size = 0;
+	s->pos = 0;
+	s->len = 0;
+
+	return (ret);
+}
+
+/**
+ * The ustream_read() function reads @p n bytes from the stream pointed
+ * to by @p s into @p buf. Buffered bytes are copied first. Reads of at
+ * least a buffer's worth then go straight to the file, and smaller ones
+ * read ahead into the buffer.
+ */
+ssize_t ustream_read(struct ustream *s, void *buf, size_t n)
+{
+	char *p = buf;
+	size_t total = 0;
+	ssize_t ret;
+
+	/* Invalid arguments. */
+	if ((s == NULL) || ((buf == NULL) && (n > 0)))
+		return (-EINVAL);
+	if (s->mode != USTREAM_READ)
+		return (-EBADF);
+
+	while (total < n)
+	{
+		size_t avail = s->len - s->pos;
+
+		/* Buffered bytes. */
+		if (avail > 0)
+		{
+			size_t k = (avail < n - total) ? avail : n - total;
+
+			umemcpy(p + total, s->buf + s->pos, k);
+			s->pos += k;
+			total += k;
+
+			continue;
+		}
+
+		if (s->eof)
+			break;
+
+		/* Large read, straight into the caller's buffer. */
+		if (n - total >= s->size)
+		{
+			if ((ret = s->io->read(s->fd, p + total, n - total)) > 0)
+				total += ret;
+			else if (ret == 0)
+				s->eof = 1;
+		}
+
+		/* Read ahead. */
+		else
+			ret = ustream_fill(s);
+
+		/* Bytes read so far are returned first. */
+		if (ret < 0)
+			return ((total > 0) ? (ssize_t) total : ret);
+	}
+
+	return (total);
+}
+
+/**
+ * The ustream_getline() function reads bytes from the stream pointed to
+ * by @p s into @p line, up to and including a newline. Buffered bytes
+ * are searched for the newline with umemchr() and copied in bulk.
+ */
+ssize_t ustream_getline(struct ustream *s, char *line, size_t size)
+{
+	size_t total = 0;
+	ssize_t ret;
+
+	/* Invalid arguments. */
+	if ((s == NULL) || (line == NULL) || (size == 0))
+		return (-EINVAL);
+	if (s->mode != USTREAM_READ)
+		return (-EBADF);
+
+	while (total < size - 1)
+	{
+		size_t avail = s->len - s->pos;
+		size_t k = size - 1 - total;
+		const char *nl;
+
+		if (avail == 0)
+		{
+			if (s->eof)
+				break;
+
+			/* Bytes read so far are returned first. */
+			if ((ret = ustream_fill(s)) < 0)
+			{
+				if (total == 0)
+					return (ret);
+				break;
+			}
+
+			continue;
+		}
+
+		if (k > avail)
+			k = avail;
+
+		if ((nl = umemchr(s->buf + s->pos, '\n', k)) != NULL)
+			k = nl - (s->buf + s->pos) + 1;
+
+		umemcpy(line + total, s->buf + s->pos, k);
+		s->pos += k;
+		total += k;
+
+		if (nl != NULL)
+			break;
+	}
+
+	line[total] = '\0';
+
+	return (total);
+}
+
+/**
+ * The ustream_peek() function stores in @p data the address of the
+ * pending bytes in the buffer of the stream pointed to by @p s, after
+ * reading ahead until there are at least @p n of them, or at least one
+ * if @p n is zero.
+ */
+ssize_t ustream_peek(struct ustream *s, const char **data, size_t n)
+{
+	ssize_t ret;
+
+	/* Invalid arguments. */
+	if ((s == NULL) || (data == NULL))
+		return (-EINVAL);
+	if (s->mode != USTREAM_READ)
+		return (-EBADF);
+	if (n > s->size)
+		return (-EINVAL);
+
+	while (((s->len - s->pos) < n) || (s->len == s->pos))
+	{
+		if (s->eof)
+			break;
+
+		if ((ret = ustream_fill(s)) < 0)
+			return (ret);
+	}
+
+	*data = s->buf + s->pos;
+
+	return (s->len - s->pos);
+}
+
+/**
+ * The ustream_consume() function discards the first @p n pending bytes
+ * of the stream pointed to by @p s, which were seen by ustream_peek().
+ */
+int ustream_consume(struct ustream *s, size_t n)
+{
+	/* Invalid arguments. */
+	if (s == NULL)
+		return (-EINVAL);
+	if (s->mode != USTREAM_READ)
+		return (-EBADF);
+	if (n > s->len - s->pos)
+		return (-EINVAL);
+
+	s->pos += n;
+
+	return (0);
+}
+
+/**
+ * The ustream_write() function writes @p n bytes of @p buf to the
+ * stream pointed to by @p s. Bytes are copied into the buffer, which is
+ * written to the file when full. Writes of at least a buffer's worth
+ * that remain after that go straight to the file. If writing fails
+ * after some bytes were accepted, that is, buffered or written, their
+ * number is returned, so that callers do not write them again.
+ */
+ssize_t ustream_write(struct ustream *s, const void *buf, size_t n)
+{
+	const char *p = buf;
+	size_t left = n;
+	size_t room;
+	ssize_t ret;
+
+	/* Invalid arguments. */
+	if ((s == NULL) || ((buf == NULL) && (n > 0)))
+		return (-EINVAL);
+	if (s->mode != USTREAM_WRITE)
+		return (-EBADF);
+
+	/* Top off the buffer and write it. */
+	if (left > s->size - s->len)
+	{
+		room = s->size - s->len;
+
+		umemcpy(s->buf + s->len, p, room);
+		s->len += room;
+		p += room;
+		left -= room;
+
+		if ((ret = ustream_flush(s)) < 0)
+			return ((room > 0) ? (ssize_t) room : ret);
+
+		/* Large write. */
+		if (left >= s->size)
+		{
+			if ((ret = ustream_put(s, p, left)) < 0)
+				return ((room > 0) ? (ssize_t) room : ret);
+
+			return (room + ret);
+		}
+	}
+
+	umemcpy(s->buf + s->len, p, left);
+	s->len += left;
+
+	return (n);
+}
+
+/**
+ * The ustream_flush() function writes the pending bytes of the stream
+ * pointed to by @p s. Bytes that could not be written remain pending.
+ */
+int ustream_flush(struct ustream *s)
+{
+	ssize_t ret;
+
+	/* Invalid arguments. */
+	if (s == NULL)
+		return (-EINVAL);
+	if (s->mode != USTREAM_WRITE)
+		return (-EBADF);
+
+	while (s->pos < s->len)
+	{
+		if ((ret = s->io->write(s->fd, s->buf + s->pos, s->len - s->pos)) < 0)
+			return (ret);
+
+		/* No progress. */
+		if (ret == 0)
+			return (-EIO);
+
+		s->pos += ret;
+	}
+
+	s->pos = 0;
+	s->len = 0;
+
+	return (0);
+}
@@ -266,7 +266,7 @@ char *ustrerror(int errnum)
 		case ENOTSOCK:
 			error = "Not a socket";
 			break;
-#ifndef __unix64__
+#if (EOPNOTSUPP != ENOTSUP)
 		case EOPNOTSUPP:
 #endif
 		case ENOTSUP:
@@ -0,0 +1,472 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "uarith.h"
+#include "udecimal.h"
+
+/**
+ * @brief Asserts if a character is a decimal digit.
+ */
+#define uisdigit(c) ((unsigned char) ((c) - '0') < 10)
+
+/**
+ * @brief Asserts if eight characters are decimal digits.
+ */
+#define uisdigit8(s)                                     \
+	(uisdigit((s)[0]) && uisdigit((s)[1]) &&             \
+	 uisdigit((s)[2]) && uisdigit((s)[3]) &&             \
+	 uisdigit((s)[4]) && uisdigit((s)[5]) &&             \
+	 uisdigit((s)[6]) && uisdigit((s)[7]))
+
+/**
+ * @brief Asserts if a character is a white space.
+ */
+#define uisspace(c) (((c) == ' ') || ((unsigned char) ((c) - '\t') < 5))
+
+/**
+ * @brief Significant digits that fit in the mantissa of the fast path.
+ */
+#define USTRTOD_DIGITS_FAST 19
+
+/**
+ * @brief Largest decimal exponent accepted (in magnitude).
+ */
+#define USTRTOD_EXP_MAX 100000
+
+/**
+ * @brief Binary shifts needed to bring a decimal with a given decimal
+ * point below one.
+ */
+static const int upowtab[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+
+/**
+ * @brief Rounds a decimal to its integer part.
+ *
+ * @param a Target decimal.
+ *
+ * @returns The integer part of @p a, rounded to nearest, ties to even.
+ */
+static uint64_t udecimal_integer(const struct udecimal *a)
+{
+	int i;
+	int up;
+	uint64_t n;
+
+	if (a->dp > 20)
+		return (~0ULL);
+
+	n = 0;
+	for (i = 0; (i < a->dp) && (i < a->nd); i++)
+		n = n*10 + a->d[i];
+	for (/* noop */; i < a->dp; i++)
+		n *= 10;
+
+	/* Round. */
+	up = 0;
+	if ((a->dp >= 0) && (a->dp < a->nd))
+	{
+		/* Exactly halfway, so round to even. */
+		if ((a->d[a->dp] == 5) && (a->dp + 1 == a->nd))
+			up = a->trunc || ((a->dp > 0) && (a->d[a->dp - 1] & 1));
+		else
+			up = (a->d[a->dp] >= 5);
+	}
+
+	return (n + up);
+}
+
+/**
+ * @brief Converts a decimal to the bits of a double.
+ *
+ * @param a        Target decimal.
+ * @param overflow Set to one on overflow.
+ *
+ * @returns The bits of the double closest to @p a.
+ *
+ * @details The decimal is scaled by powers of two until it lies in
+ * [0.5, 1), then multiplied by 2^53 and rounded. Every step is exact,
+ * so the result is correctly rounded.
+ */
+static uint64_t udecimal_bits(struct udecimal *a, int *overflow)
+{
+	int n;
+	int exp;
+	uint64_t mant;
+
+	*overflow = 0;
+
+	/* Zero. */
+	if ((a->nd == 0) || (a->dp < -330))
+		return (0);
+
+	/* Infinity. */
+	if (a->dp > 310)
+		goto inf;
+
+	/* Scale to [0.5, 1). */
+	exp = 0;
+	while (a->dp > 0)
+	{
+		n = (a->dp >= 9) ? 27 : upowtab[a->dp];
+		__udecimal_shift(a, -n);
+		exp += n;
+	}
+	while ((a->dp < 0) || ((a->dp == 0) && (a->d[0] < 5)))
+	{
+		n = (-a->dp >= 9) ? 27 : upowtab[-a->dp];
+		__udecimal_shift(a, n);
+		exp -= n;
+	}
+
+	/* Double range is [1, 2). */
+	exp--;
+
+	/* Denormal. */
+	if (exp < UDBL_BIAS + 1)
+	{
+		n = UDBL_BIAS + 1 - exp;
+		__udecimal_shift(a, -n);
+		exp += n;
+	}
+
+	if ((exp - UDBL_BIAS) >= ((1 << UDBL_EXPBITS) - 1))
+		goto inf;
+
+	/* Extract mantissa. */
+	__udecimal_shift(a, 1 + UDBL_MANTBITS);
+	mant = udecimal_integer(a);
+
+	/* Rounding carried over. */
+	if (mant == (2ULL << UDBL_MANTBITS))
+	{
+		mant >>= 1;
+		if ((++exp - UDBL_BIAS) >= ((1 << UDBL_EXPBITS) - 1))
+			goto inf;
+	}
+
+	/* Denormal. */
+	if (!(mant & (1ULL << UDBL_MANTBITS)))
+		exp = UDBL_BIAS;
+
+	return ((mant & ((1ULL << UDBL_MANTBITS) - 1)) |
+		((uint64_t) ((exp - UDBL_BIAS) & ((1 << UDBL_EXPBITS) - 1)) << UDBL_MANTBITS));
+
+inf:
+	*overflow = 1;
+	return ((uint64_t) ((1 << UDBL_EXPBITS) - 1) << UDBL_MANTBITS);
+}
+
+/**
+ * @brief Converts bits to a double.
+ *
+ * @param bits Target bits.
+ * @param neg  Negative?
+ *
+ * @returns The double whose bits are @p bits.
+ */
+static inline double ubits_to_double(uint64_t bits, int neg)
+{
+	double d;
+
+	if (neg)
+		bits |= 1ULL << 63;
+
+	__builtin_memcpy(&d, &bits, sizeof(double));
+
+	return (d);
+}
+
+/**
+ * @brief Matches a case-insensitive prefix.
+ *
+ * @param s      Target string.
+ * @param prefix Lowercase prefix.
+ *
+ * @returns The length of @p prefix if it matches, zero otherwise.
+ */
+static size_t uprefix(const char *s, const char *prefix)
+{
+	size_t n;
+
+	for (n = 0; prefix[n] != '\0'; n++)
+	{
+		if ((s[n] | 0x20) != prefix[n])
+			return (0);
+	}
+
+	return (n);
+}
+
+#if !defined(__FLT_EVAL_METHOD__) || (__FLT_EVAL_METHOD__ == 0)
+
+/**
+ * @brief Powers of ten that are exactly representable in a double.
+ */
+static const double upow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#endif
+
+/**
+ * @brief Converts a decimal number with the fast path.
+ *
+ * @param mant Mantissa.
+ * @param exp  Decimal exponent.
+ * @param d    Converted number.
+ *
+ * @returns Non-zero if the conversion succeeded, zero otherwise.
+ *
+ * @details If the mantissa and the power of ten are both exactly
+ * representable, a single floating-point operation yields the
+ * correctly rounded result (Clinger). On targets that evaluate in
+ * extended precision, results would be rounded twice, so only exact
+ * integer results are accepted.
+ */
+static int ustrtod_fast(uint64_t mant, int exp, double *d)
+{
+	/* Mantissa must fit in 53 bits. */
+	if (mant > (1ULL << 53))
+		return (0);
+
+	/* Move excess exponent to the mantissa. */
+	for (/* noop */; exp > 22; exp--)
+	{
+		if ((mant *= 10) > (1ULL << 53))
+			return (0);
+	}
+
+#if defined(__FLT_EVAL_METHOD__) && (__FLT_EVAL_METHOD__ != 0)
+	for (/* noop */; exp > 0; exp--)
+	{
+		if ((mant *= 10) > (1ULL << 53))
+			return (0);
+	}
+
+	if (exp < 0)
+		return (0);
+
+	*d = (double) mant;
+#else
+	if (exp < -22)
+		return (0);
+
+	*d = (exp >= 0) ? (double) mant*upow10[exp] : (double) mant/upow10[-exp];
+#endif
+
+	return (1);
+}
+
+/**
+ * The ustrtod() function converts the initial portion of the string
+ * @p nptr to a double. Decimal numbers, infinities and NaNs are
+ * recognized. Mantissas of up to 19 significant digits are accumulated
+ * with uparse8() while parsing, and converted with a single
+ * floating-point operation when possible. Otherwise, the number is
+ * converted exactly with an arbitrary-precision decimal.
+ */
+double ustrtod(const char *nptr, char **endptr)
+{
+	int neg;
+	int exp;
+	int exp10;
+	int esign;
+	int ndigits;
+	int trunc;
+	int sawdot;
+	int overflow;
+	uint64_t mant;
+	uint64_t bits;
+	const char *s;
+	const char *start;
+	const char *end;
+	double d;
+	size_t n;
+	struct udecimal a;
+
+	for (s = nptr; uisspace(*s); s++)
+		/* noop */ ;
+
+	/* Sign. */
+	neg = 0;
+	if ((*s == '-') || (*s == '+'))
+		neg = (*s++ == '-');
+
+	/* Infinity. */
+	if ((n = uprefix(s, "inf")) > 0)
+	{
+		s += n;
+		s += uprefix(s, "inity");
+		bits = (uint64_t) ((1 << UDBL_EXPBITS) - 1) << UDBL_MANTBITS;
+		goto out;
+	}
+
+	/* Not a number. */
+	if ((n = uprefix(s, "nan")) > 0)
+	{
+		s += n;
+
+		/* Skip payload. */
+		if (*s == '(')
+		{
+			for (n = 1; uisdigit(s[n]) || (((s[n] | 0x20) >= 'a') && ((s[n] | 0x20) <= 'z')) || (s[n] == '_'); n++)
+				/* noop */ ;
+			if (s[n] == ')')
+				s += n + 1;
+		}
+
+		bits = (((uint64_t) ((1 << UDBL_EXPBITS) - 1) << UDBL_MANTBITS)) |
+			(1ULL << (UDBL_MANTBITS - 1));
+		goto out;
+	}
+
+	/* Mantissa. */
+	start = s;
+	mant = 0;
+	exp10 = 0;
+	ndigits = 0;
+	trunc = 0;
+	sawdot = 0;
+	for (/* noop */; uisdigit(*s) || ((*s == '.') && !sawdot); s++)
+	{
+		if (*s == '.')
+		{
+			sawdot = 1;
+			continue;
+		}
+
+		/* Leading zero. */
+		if ((*s == '0') && (ndigits == 0))
+		{
+			exp10 -= sawdot;
+			continue;
+		}
+
+		/* Eight digits at once. */
+		if (((ndigits + 8) <= USTRTOD_DIGITS_FAST) && uisdigit8(s))
+		{
+			mant = mant*100000000 + uparse8(s);
+			ndigits += 8;
+			exp10 -= 8*sawdot;
+			s += 7;
+			continue;
+		}
+
+		if (ndigits < USTRTOD_DIGITS_FAST)
+		{
+			mant = mant*10 + (*s - '0');
+			exp10 -= sawdot;
+		}
+		else
+		{
+			exp10 += !sawdot;
+			trunc |= (*s != '0');
+		}
+		ndigits++;
+	}
+	end = s;
+
+	/* No digits. */
+	if ((end == start) || ((end - start == 1) && sawdot))
+	{
+		s = nptr;
+		bits = 0;
+		goto out;
+	}
+
+	/* Exponent. */
+	exp = 0;
+	if ((*s == 'e') || (*s == 'E'))
+	{
+		n = 1;
+		esign = 1;
+		if ((s[n] == '-') || (s[n] == '+'))
+			esign = (s[n++] == '-') ? -1 : 1;
+
+		if (uisdigit(s[n]))
+		{
+			for (s += n; uisdigit(*s); s++)
+			{
+				if (exp < USTRTOD_EXP_MAX)
+					exp = exp*10 + (*s - '0');
+			}
+			exp *= esign;
+		}
+	}
+
+	/* Zero. */
+	if (mant == 0)
+	{
+		bits = 0;
+		goto out;
+	}
+
+	/* Fast path. */
+	if (!trunc && ustrtod_fast(mant, exp10 + exp, &d))
+	{
+		if (endptr != NULL)
+			*endptr = (char *) s;
+		return ((neg) ? -d : d);
+	}
+
+	/* Slow path. */
+	a.nd = 0;
+	a.dp = 0;
+	a.trunc = 0;
+	sawdot = 0;
+	for (const char *p = start; p < end; p++)
+	{
+		if (*p == '.')
+		{
+			sawdot = 1;
+			a.dp = a.nd;
+		}
+		else if ((*p == '0') && (a.nd == 0))
+			a.dp--;
+		else if (a.nd < UDECIMAL_DIGITS)
+			a.d[a.nd++] = *p - '0';
+		else
+			a.trunc |= (*p != '0');
+	}
+	if (!sawdot)
+		a.dp = a.nd;
+	a.dp += exp;
+	__udecimal_trim(&a);
+
+	bits = udecimal_bits(&a, &overflow);
+
+	/* Out of range. */
+	if (overflow || (bits == 0))
+		errno = ERANGE;
+
+out:
+	if (endptr != NULL)
+		*endptr = (char *) s;
+
+	return (ubits_to_double(bits, neg));
+}
@@ -0,0 +1,306 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+#include <posix/stdint.h>
+#include "uarith.h"
+
+/**
+ * @name Limits
+ */
+/**@{*/
+#define ULONG_MAX_  (~0UL)                             /**< ULONG_MAX  */
+#define LONG_MAX_   ((long) (ULONG_MAX_ >> 1))         /**< LONG_MAX   */
+#define ULLONG_MAX_ (~0ULL)                            /**< ULLONG_MAX */
+#define LLONG_MAX_  ((long long) (ULLONG_MAX_ >> 1))   /**< LLONG_MAX  */
+/**@}*/
+
+/**
+ * @brief Asserts if a character is a decimal digit.
+ */
+#define uisdigit(c) ((unsigned char) ((c) - '0') < 10)
+
+/**
+ * @brief Asserts if eight characters are decimal digits.
+ */
+#define uisdigit8(s)                                     \
+	(uisdigit((s)[0]) && uisdigit((s)[1]) &&             \
+	 uisdigit((s)[2]) && uisdigit((s)[3]) &&             \
+	 uisdigit((s)[4]) && uisdigit((s)[5]) &&             \
+	 uisdigit((s)[6]) && uisdigit((s)[7]))
+
+/**
+ * @brief Asserts if a character is a white space.
+ */
+#define uisspace(c) (((c) == ' ') || ((unsigned char) ((c) - '\t') < 5))
+
+/**
+ * @brief Parsed integer.
+ */
+struct uint_parse
+{
+	uint64_t val;     /* Absolute value.    */
+	int neg;          /* Negative?          */
+	int overflow;     /* Out of range?      */
+	const char *end;  /* End of the number. */
+};
+
+/**
+ * @brief Gets the value of a digit.
+ *
+ * @param c Target digit.
+ *
+ * @returns The value of @p c, or 36 if @p c is not a digit.
+ */
+static inline unsigned udigit(char c)
+{
+	if (uisdigit(c))
+		return (c - '0');
+	if ((c >= 'a') && (c <= 'z'))
+		return (c - 'a' + 10);
+	if ((c >= 'A') && (c <= 'Z'))
+		return (c - 'A' + 10);
+
+	return (36);
+}
+
+/**
+ * @brief Parses a decimal number.
+ *
+ * @param s Target string (starts with a digit).
+ * @param r Parsed integer.
+ *
+ * @details Up to 19 digits cannot overflow, so they are converted
+ * eight at a time with uparse8() whenever eight digits are available.
+ * Only digits past the 19th need an overflow check.
+ */
+static void uparse10(const char *s, struct uint_parse *r)
+{
+	int n;
+	unsigned d;
+	uint64_t v;
+
+	while (*s == '0')
+		s++;
+
+	/* Eight digits at once. */
+	for (v = 0, n = 0; ((n + 8) <= 19) && uisdigit8(s); n += 8, s += 8)
+		v = v*100000000 + uparse8(s);
+
+	/* Remaining digits. */
+	for (/* noop */; uisdigit(*s); s++, n++)
+	{
+		d = *s - '0';
+
+		if ((n >= 19) && ((v > (ULLONG_MAX_ / 10)) ||
+			((v == (ULLONG_MAX_ / 10)) && (d > (ULLONG_MAX_ % 10)))))
+			r->overflow = 1;
+		else
+			v = v*10 + d;
+	}
+
+	r->val = v;
+	r->end = s;
+}
+
+/**
+ * @brief Parses an integer.
+ *
+ * @param nptr Target string.
+ * @param base Base of the number (zero to detect it).
+ * @param r    Parsed integer.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ */
+static int uparse_int(const char *nptr, int base, struct uint_parse *r)
+{
+	unsigned d;
+	uint64_t v;
+	uint64_t cutoff;
+	unsigned cutlim;
+	const char *s;
+
+	r->val = 0;
+	r->neg = 0;
+	r->overflow = 0;
+	r->end = nptr;
+
+	/* Invalid base. */
+	if ((base < 0) || (base == 1) || (base > 36))
+		return (-EINVAL);
+
+	for (s = nptr; uisspace(*s); s++)
+		/* noop */ ;
+
+	/* Sign. */
+	if ((*s == '-') || (*s == '+'))
+		r->neg = (*s++ == '-');
+
+	/* Prefix. */
+	if ((*s == '0') && ((s[1] == 'x') || (s[1] == 'X')))
+	{
+		if (((base == 0) || (base == 16)) && (udigit(s[2]) < 16))
+		{
+			s += 2;
+			base = 16;
+		}
+	}
+	if (base == 0)
+		base = (*s == '0') ? 8 : 10;
+
+	/* No digits. */
+	if (udigit(*s) >= (unsigned) base)
+		return (0);
+
+	/* Fast path. */
+	if (base == 10)
+	{
+		uparse10(s, r);
+		return (0);
+	}
+
+	cutoff = ULLONG_MAX_ / base;
+	cutlim = ULLONG_MAX_ % base;
+
+	for (v = 0; (d = udigit(*s)) < (unsigned) base; s++)
+	{
+		if ((v > cutoff) || ((v == cutoff) && (d > cutlim)))
+			r->overflow = 1;
+		else
+			v = v*base + d;
+	}
+
+	r->val = v;
+	r->end = s;
+
+	return (0);
+}
+
+/**
+ * @brief Sets the end pointer of a conversion.
+ */
+#define uparse_end(endptr, r)              \
+	{                                      \
+		if ((endptr) != NULL)              \
+			*(endptr) = (char *) (r).end;  \
+	}
+
+/**
+ * The ustrtoull() function converts the initial portion of the string
+ * @p nptr to an unsigned long long integer in the base @p base.
+ */
+unsigned long long ustrtoull(const char *nptr, char **endptr, int base)
+{
+	struct uint_parse r;
+
+	if (uparse_int(nptr, base, &r) < 0)
+		errno = EINVAL;
+
+	uparse_end(endptr, r);
+
+	if (r.overflow)
+	{
+		errno = ERANGE;
+		return (ULLONG_MAX_);
+	}
+
+	return ((r.neg) ? -r.val : r.val);
+}
+
+/**
+ * The ustrtoll() function converts the initial portion of the string
+ * @p nptr to a long long integer in the base @p base.
+ */
+long long ustrtoll(const char *nptr, char **endptr, int base)
+{
+	struct uint_parse r;
+
+	if (uparse_int(nptr, base, &r) < 0)
+		errno = EINVAL;
+
+	uparse_end(endptr, r);
+
+	if (r.overflow || (r.val > (uint64_t) LLONG_MAX_ + r.neg))
+	{
+		errno = ERANGE;
+		return ((r.neg) ? -LLONG_MAX_ - 1 : LLONG_MAX_);
+	}
+
+	return ((r.neg) ? (long long) -r.val : (long long) r.val);
+}
+
+/**
+ * The ustrtoul() function converts the initial portion of the string
+ * @p nptr to an unsigned long integer in the base @p base.
+ */
+unsigned long ustrtoul(const char *nptr, char **endptr, int base)
+{
+	struct uint_parse r;
+
+	if (uparse_int(nptr, base, &r) < 0)
+		errno = EINVAL;
+
+	uparse_end(endptr, r);
+
+	if (r.overflow || (r.val > ULONG_MAX_))
+	{
+		errno = ERANGE;
+		return (ULONG_MAX_);
+	}
+
+	return ((r.neg) ? -(unsigned long) r.val : (unsigned long) r.val);
+}
+
+/**
+ * The ustrtol() function converts the initial portion of the string
+ * @p nptr to a long integer in the base @p base.
+ */
+long ustrtol(const char *nptr, char **endptr, int base)
+{
+	struct uint_parse r;
+
+	if (uparse_int(nptr, base, &r) < 0)
+		errno = EINVAL;
+
+	uparse_end(endptr, r);
+
+	if (r.overflow || (r.val > (uint64_t) LONG_MAX_ + r.neg))
+	{
+		errno = ERANGE;
+		return ((r.neg) ? -LONG_MAX_ - 1 : LONG_MAX_);
+	}
+
+	return ((r.neg) ? (long) -r.val : (long) r.val);
+}
+
+/**
+ * The uatoi() function converts the initial portion of the string @p
+ * nptr to an integer.
+ */
+int uatoi(const char *nptr)
+{
+	return ((int) ustrtol(nptr, NULL, 10));
+}
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Number of pending thread starts.
+ */
+#define UTHREAD_STARTS_MAX (THREAD_MAX + 1)
+
+/**
+ * @brief Pending thread start.
+ */
+struct uthread_start
+{
+	int used;                 /**< Is the start pending?  */
+	void *(*start)(void *);   /**< Start routine.         */
+	void *arg;                /**< Argument of the start. */
+};
+
+/**
+ * @brief Pending thread starts.
+ */
+static struct uthread_start uthread_starts[UTHREAD_STARTS_MAX];
+
+/**
+ * @brief Runs a thread.
+ *
+ * @param arg Pending start of the thread.
+ *
+ * @returns The value returned by the start routine of the thread.
+ */
+static void *uthread_main(void *arg)
+{
+	struct uthread_start *s = arg;
+	void *(*start)(void *);
+	void *ret;
+
+	start = s->start;
+	arg = s->arg;
+	__sync_lock_release(&s->used);
+
+	ret = start(arg);
+
+	__uthread_release();
+
+	return (ret);
+}
+
+/**
+ * The uthread_create() function creates a thread that runs @p start
+ * with @p arg and stores its ID in @p tid. The thread releases its
+ * resources when @p start returns.
+ */
+int uthread_create(kthread_t *tid, void *(*start)(void *), void *arg)
+{
+	int ret;
+
+	if ((tid == NULL) || (start == NULL))
+		return (-EINVAL);
+
+	for (int i = 0; i < UTHREAD_STARTS_MAX; i++)
+	{
+		struct uthread_start *s = &uthread_starts[i];
+
+		if (__atomic_load_n(&s->used, __ATOMIC_RELAXED) != 0)
+			continue;
+
+		if (!__sync_bool_compare_and_swap(&s->used, 0, 1))
+			continue;
+
+		s->start = start;
+		s->arg = arg;
+
+		/* The thread releases the start once it runs. */
+		if ((ret = kthread_create(tid, uthread_main, s)) < 0)
+			__sync_lock_release(&s->used);
+
+		return (ret);
+	}
+
+	return (-EAGAIN);
+}
+
+/**
+ * The __uthread_release() function flushes and releases the output
+ * buffer of the calling thread, and releases its log ring, its random
+ * stream and its thread-local storage.
+ */
+void __uthread_release(void)
+{
+	__ulog_release();
+	__ubuffer_release();
+	__urand_release();
+	__utls_release();
+}
@@ -0,0 +1,278 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/errno.h>
+
+/**
+ * @brief Number of thread-local storage blocks.
+ */
+#define UTLS_BLOCKS_MAX (THREAD_MAX + 1)
+
+/**
+ * @brief Thread-local storage block.
+ */
+struct utls_block
+{
+	int owner;                    /**< Thread ID plus one (zero if free). */
+	void *values[UTLS_KEYS_MAX];  /**< Values of keys.                    */
+};
+
+/**
+ * @brief Thread-local storage key.
+ */
+struct utls_key
+{
+	int used;                     /**< Is the key in use?                 */
+	void (*destructor)(void *);   /**< Destructor of values.              */
+};
+
+/**
+ * @brief Thread-local storage blocks.
+ */
+static struct utls_block utls_blocks[UTLS_BLOCKS_MAX];
+
+/**
+ * @brief Thread-local storage keys.
+ */
+static struct utls_key utls_keys[UTLS_KEYS_MAX];
+
+/**
+ * @brief Lock of keys.
+ */
+static struct uspinlock utls_lock = USPINLOCK_INITIALIZER;
+
+#if defined(UTLS_THREAD)
+
+/**
+ * @brief Block of the calling thread.
+ */
+static UTLS_THREAD struct utls_block *utls_self;
+
+#endif
+
+/**
+ * @brief Gets the thread-local storage block of the calling thread.
+ *
+ * @param claim Claim a block if the thread has none?
+ *
+ * @returns The block of the calling thread, or NULL if it has none (or
+ * there is none left).
+ *
+ * @details Blocks are hashed by thread ID, thus the block of a thread
+ * is usually found at the first probe. Where the toolchain supports
+ * static thread-local variables, the block is also cached in one.
+ */
+static struct utls_block *utls_block_get(int claim)
+{
+	struct utls_block *b;
+	unsigned home;
+	int owner;
+
+#if defined(UTLS_THREAD)
+	if (utls_self != NULL)
+		return (utls_self);
+#endif
+
+	owner = kthread_self() + 1;
+	home = (unsigned) owner % UTLS_BLOCKS_MAX;
+
+	/* Fast path: block already owned. */
+	for (unsigned i = 0; i < UTLS_BLOCKS_MAX; i++)
+	{
+		b = &utls_blocks[(home + i) % UTLS_BLOCKS_MAX];
+
+		if (__atomic_load_n(&b->owner, __ATOMIC_RELAXED) == owner)
+			goto found;
+	}
+
+	if (!claim)
+		return (NULL);
+
+	/* Slow path: claim a free block. */
+	for (unsigned i = 0; i < UTLS_BLOCKS_MAX; i++)
+	{
+		b = &utls_blocks[(home + i) % UTLS_BLOCKS_MAX];
+
+		if (__atomic_load_n(&b->owner, __ATOMIC_RELAXED) != 0)
+			continue;
+
+		if (__sync_bool_compare_and_swap(&b->owner, 0, owner))
+		{
+			umemset(b->values, 0, sizeof(b->values));
+			goto found;
+		}
+	}
+
+	return (NULL);
+
+found:
+#if defined(UTLS_THREAD)
+	utls_self = b;
+#endif
+	return (b);
+}
+
+/**
+ * The utls_key_create() function creates a thread-local storage key and
+ * stores it in @p key. The value of the new key is NULL in all threads.
+ */
+int utls_key_create(unsigned *key, void (*destructor)(void *))
+{
+	if (key == NULL)
+		return (-EINVAL);
+
+	uspinlock_lock(&utls_lock);
+
+	for (unsigned k = UTLS_KEYS_RESERVED; k < UTLS_KEYS_MAX; k++)
+	{
+		if (utls_keys[k].used)
+			continue;
+
+		utls_keys[k].used = 1;
+		utls_keys[k].destructor = destructor;
+		uspinlock_unlock(&utls_lock);
+
+		*key = k;
+
+		return (0);
+	}
+
+	uspinlock_unlock(&utls_lock);
+
+	return (-EAGAIN);
+}
+
+/**
+ * The utls_key_delete() function deletes the thread-local storage key
+ * @p key and clears its values in all threads. Destructors are not
+ * called for its values.
+ */
+int utls_key_delete(unsigned key)
+{
+	if ((key < UTLS_KEYS_RESERVED) || (key >= UTLS_KEYS_MAX))
+		return (-EINVAL);
+
+	uspinlock_lock(&utls_lock);
+
+	if (!utls_keys[key].used)
+	{
+		uspinlock_unlock(&utls_lock);
+		return (-EINVAL);
+	}
+
+	/* Clear values, so that the key is reused with none. */
+	for (int i = 0; i < UTLS_BLOCKS_MAX; i++)
+		__atomic_store_n(&utls_blocks[i].values[key], NULL, __ATOMIC_RELAXED);
+
+	utls_keys[key].used = 0;
+	utls_keys[key].destructor = NULL;
+
+	uspinlock_unlock(&utls_lock);
+
+	return (0);
+}
+
+/**
+ * The utls_get() function returns the value of the key @p key for the
+ * calling thread.
+ */
+void *utls_get(unsigned key)
+{
+	struct utls_block *b;
+
+	if (key >= UTLS_KEYS_MAX)
+		return (NULL);
+
+	if ((b = utls_block_get(0)) == NULL)
+		return (NULL);
+
+	return (__atomic_load_n(&b->values[key], __ATOMIC_RELAXED));
+}
+
+/**
+ * The utls_set() function sets the value of the key @p key for the
+ * calling thread to @p value. The first value set by a thread claims a
+ * storage block for it.
+ */
+int utls_set(unsigned key, const void *value)
+{
+	struct utls_block *b;
+
+	if (key >= UTLS_KEYS_MAX)
+		return (-EINVAL);
+
+	if ((b = utls_block_get(value != NULL)) == NULL)
+		return ((value == NULL) ? 0 : -EAGAIN);
+
+	__atomic_store_n(&b->values[key], (void *) value, __ATOMIC_RELAXED);
+
+	return (0);
+}
+
+/**
+ * The __utls_init() function initializes thread-local storage. It
+ * claims the storage block of the calling thread, thus lookups of the
+ * leader thread take the fast path from the start.
+ */
+void __utls_init(void)
+{
+	utls_block_get(1);
+}
+
+/**
+ * The __utls_release() function calls the destructors of the non-NULL
+ * values of the calling thread, and makes its storage block available
+ * to other threads.
+ */
+void __utls_release(void)
+{
+	struct utls_block *b;
+	void (*destructor)(void *);
+	void *value;
+
+	if ((b = utls_block_get(0)) == NULL)
+		return;
+
+	for (unsigned k = UTLS_KEYS_RESERVED; k < UTLS_KEYS_MAX; k++)
+	{
+		if ((value = __atomic_exchange_n(&b->values[k], NULL, __ATOMIC_RELAXED)) == NULL)
+			continue;
+
+		uspinlock_lock(&utls_lock);
+		destructor = utls_keys[k].used ? utls_keys[k].destructor : NULL;
+		uspinlock_unlock(&utls_lock);
+
+		if (destructor != NULL)
+			destructor(value);
+	}
+
+#if defined(UTLS_THREAD)
+	utls_self = NULL;
+#endif
+
+	__sync_lock_release(&b->owner);
+}
@@ -0,0 +1,702 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/ulib.h>
+#include <posix/stdarg.h>
+#include <posix/stdint.h>
+#include "udecimal.h"
+
+/**
+ * @name Conversion Flags
+ */
+/**@{*/
+#define UFMT_LEFT  (1 << 0) /**< Left-justify.                  */
+#define UFMT_PLUS  (1 << 1) /**< Always print sign.             */
+#define UFMT_SPACE (1 << 2) /**< Space in place of plus sign.   */
+#define UFMT_ALT   (1 << 3) /**< Alternative form.              */
+#define UFMT_ZERO  (1 << 4) /**< Pad with zeros.                */
+#define UFMT_UPPER (1 << 5) /**< Uppercase digits.              */
+/**@}*/
+
+/**
+ * @name Length Modifiers
+ */
+/**@{*/
+#define ULEN_HH   0 /**< char.      */
+#define ULEN_H    1 /**< short.     */
+#define ULEN_NONE 2 /**< int.       */
+#define ULEN_L    3 /**< long.      */
+#define ULEN_LL   4 /**< long long. */
+/**@}*/
+
+/**
+ * @brief Maximum number of digits in a converted integer.
+ */
+#define UFMT_DIGITS_MAX 24
+
+/**
+ * @brief Default precision of floating-point conversions.
+ */
+#define UFMT_PRECISION_DEFAULT 6
+
+/**
+ * @brief Output of a conversion.
+ */
+struct uformat
+{
+	char *str;   /* Output buffer.                    */
+	size_t size; /* Capacity of the output buffer.    */
+	size_t len;  /* Characters that would be written. */
+};
+
+/**
+ * @brief Conversion specification.
+ */
+struct uspec
+{
+	int flags;     /* Conversion flags.                 */
+	int length;    /* Length modifier.                  */
+	size_t width;  /* Minimum field width.              */
+	int precision; /* Precision (negative if omitted).  */
+};
+
+/**
+ * @brief Writes a string to the output of a conversion.
+ *
+ * @param f Target output.
+ * @param s Target string.
+ * @param n Length of @p s.
+ */
+static void uformat_puts(struct uformat *f, const char *s, size_t n)
+{
+	size_t room;
+
+	/* Copy what fits. */
+	if (f->len < f->size)
+	{
+		room = f->size - f->len;
+		umemcpy(&f->str[f->len], s, (n < room) ? n : room);
+	}
+
+	f->len += n;
+}
+
+/**
+ * @brief Pads the output of a conversion.
+ *
+ * @param f Target output.
+ * @param c Padding character.
+ * @param n Number of padding characters.
+ */
+static void uformat_pad(struct uformat *f, char c, size_t n)
+{
+	size_t room;
+
+	/* Fill what fits. */
+	if (f->len < f->size)
+	{
+		room = f->size - f->len;
+		umemset(&f->str[f->len], c, (n < room) ? n : room);
+	}
+
+	f->len += n;
+}
+
+/**
+ * @brief Writes a converted field to the output of a conversion.
+ *
+ * @param f      Target output.
+ * @param spec   Conversion specification.
+ * @param prefix Prefix (sign or base indicator).
+ * @param plen   Length of @p prefix.
+ * @param zeros  Number of leading zeros.
+ * @param body   Converted value.
+ * @param blen   Length of @p body.
+ */
+static void uformat_field(
+	struct uformat *f,
+	const struct uspec *spec,
+	const char *prefix,
+	size_t plen,
+	size_t zeros,
+	const char *body,
+	size_t blen
+)
+{
+	size_t len;
+	size_t padding;
+
+	len = plen + zeros + blen;
+	padding = (spec->width > len) ? spec->width - len : 0;
+
+	/* Pad with zeros between prefix and body. */
+	if ((spec->flags & (UFMT_ZERO | UFMT_LEFT)) == UFMT_ZERO)
+	{
+		zeros += padding;
+		padding = 0;
+	}
+
+	if (!(spec->flags & UFMT_LEFT))
+		uformat_pad(f, ' ', padding);
+
+	uformat_puts(f, prefix, plen);
+	uformat_pad(f, '0', zeros);
+	uformat_puts(f, body, blen);
+
+	if (spec->flags & UFMT_LEFT)
+		uformat_pad(f, ' ', padding);
+}
+
+/**
+ * @brief Converts an integer.
+ *
+ * @param f    Target output.
+ * @param spec Conversion specification.
+ * @param conv Conversion specifier.
+ * @param val  Absolute value of the integer.
+ * @param neg  Is the integer negative?
+ */
+static void uformat_int(
+	struct uformat *f,
+	struct uspec *spec,
+	char conv,
+	uint64_t val,
+	int neg
+)
+{
+	size_t n;
+	size_t zeros;
+	size_t plen;
+	char prefix[2];
+	char digits[UFMT_DIGITS_MAX];
+
+	plen = 0;
+
+	/* Sign. */
+	if (neg)
+		prefix[plen++] = '-';
+	else if (spec->flags & UFMT_PLUS)
+		prefix[plen++] = '+';
+	else if (spec->flags & UFMT_SPACE)
+		prefix[plen++] = ' ';
+
+	/* Zero precision and zero value prints no digits. */
+	if ((spec->precision == 0) && (val == 0))
+		n = 0;
+	else
+	{
+		switch (conv)
+		{
+			case 'x':
+			case 'X':
+				n = uxtoa(val, digits, conv == 'X');
+				if ((spec->flags & UFMT_ALT) && (val != 0))
+				{
+					prefix[plen++] = '0';
+					prefix[plen++] = conv;
+				}
+				break;
+
+			case 'o':
+				n = UFMT_DIGITS_MAX;
+				do
+				{
+					digits[--n] = '0' + (val & 7);
+					val >>= 3;
+				} while (val != 0);
+				umemmove(digits, &digits[n], UFMT_DIGITS_MAX - n);
+				n = UFMT_DIGITS_MAX - n;
+				break;
+
+			default:
+				n = uutoa(val, digits);
+				break;
+		}
+	}
+
+	/* Precision sets the minimum number of digits. */
+	zeros = 0;
+	if (spec->precision >= 0)
+	{
+		if ((size_t) spec->precision > n)
+			zeros = spec->precision - n;
+		spec->flags &= ~UFMT_ZERO;
+	}
+
+	/* Alternative form of octal starts with zero. */
+	if ((conv == 'o') && (spec->flags & UFMT_ALT) && (zeros == 0))
+	{
+		if ((n == 0) || (digits[0] != '0'))
+			zeros = 1;
+	}
+
+	uformat_field(f, spec, prefix, plen, zeros, digits, n);
+}
+
+/**
+ * @brief Writes digits of a decimal to the output of a conversion.
+ *
+ * @param f    Target output.
+ * @param a    Target decimal.
+ * @param from Position of the first digit.
+ * @param to   Position past the last digit.
+ *
+ * @details Positions outside the digits of @p a are written as zeros.
+ */
+static void uformat_digits(
+	struct uformat *f,
+	const struct udecimal *a,
+	int from,
+	int to
+)
+{
+	int n;
+	char buf[32];
+
+	/* Leading zeros. */
+	if (from < 0)
+	{
+		uformat_pad(f, '0', ((to < 0) ? to : 0) - from);
+		from = 0;
+	}
+
+	/* Digits. */
+	while ((from < to) && (from < a->nd))
+	{
+		for (n = 0; (n < (int) sizeof(buf)) && (from < to) && (from < a->nd); n++)
+			buf[n] = '0' + a->d[from++];
+		uformat_puts(f, buf, n);
+	}
+
+	/* Trailing zeros. */
+	if (from < to)
+		uformat_pad(f, '0', to - from);
+}
+
+/**
+ * @brief Converts a floating-point number.
+ *
+ * @param f    Target output.
+ * @param spec Conversion specification.
+ * @param conv Conversion specifier.
+ * @param v    Target number.
+ *
+ * @details Digits are computed by __udtoa() and written straight
+ * from the decimal, so that wide conversions need no extra buffer.
+ */
+static void uformat_float(
+	struct uformat *f,
+	struct uspec *spec,
+	char conv,
+	double v
+)
+{
+	int exp10;
+	int precision;
+	int point;
+	int sci;
+	size_t len;
+	size_t padding;
+	size_t plen;
+	size_t elen;
+	uint64_t bits;
+	char prefix[1];
+	char ebuf[UITOA_BUFSIZ + 2];
+	struct udecimal a;
+
+	__builtin_memcpy(&bits, &v, sizeof(uint64_t));
+
+	plen = 0;
+
+	/* Sign. */
+	if (bits >> 63)
+	{
+		prefix[plen++] = '-';
+		bits &= ~(1ULL << 63);
+		__builtin_memcpy(&v, &bits, sizeof(double));
+	}
+	else if (spec->flags & UFMT_PLUS)
+		prefix[plen++] = '+';
+	else if (spec->flags & UFMT_SPACE)
+		prefix[plen++] = ' ';
+
+	/* Infinity and not a number. */
+	if ((bits >> UDBL_MANTBITS) == ((1 << UDBL_EXPBITS) - 1))
+	{
+		spec->flags &= ~UFMT_ZERO;
+		if (bits << (64 - UDBL_MANTBITS))
+			uformat_field(f, spec, prefix, plen, 0, (conv < 'a') ? "NAN" : "nan", 3);
+		else
+			uformat_field(f, spec, prefix, plen, 0, (conv < 'a') ? "INF" : "inf", 3);
+		return;
+	}
+
+	precision = (spec->precision >= 0) ? spec->precision : UFMT_PRECISION_DEFAULT;
+
+	switch (conv | 0x20)
+	{
+		case 'e':
+			__udtoa(v, UDTOA_DIGITS, precision + 1, &a);
+			sci = 1;
+			break;
+
+		case 'g':
+			if (precision == 0)
+				precision = 1;
+			__udtoa(v, UDTOA_DIGITS, precision, &a);
+			exp10 = (a.nd > 0) ? a.dp - 1 : 0;
+			sci = ((exp10 < -4) || (exp10 >= precision));
+			precision -= (sci) ? 1 : exp10 + 1;
+
+			/* Trailing zeros are removed. */
+			if (!(spec->flags & UFMT_ALT))
+			{
+				if (sci && (precision > a.nd - 1))
+					precision = (a.nd > 1) ? a.nd - 1 : 0;
+				else if (!sci && (precision > a.nd - a.dp))
+					precision = (a.nd > a.dp) ? a.nd - a.dp : 0;
+			}
+			break;
+
+		default:
+			__udtoa(v, UDTOA_FIXED, precision, &a);
+			sci = 0;
+			break;
+	}
+
+	point = ((precision > 0) || (spec->flags & UFMT_ALT));
+
+	/* Exponent. */
+	elen = 0;
+	if (sci)
+	{
+		exp10 = (a.nd > 0) ? a.dp - 1 : 0;
+		ebuf[elen++] = (conv < 'a') ? 'E' : 'e';
+		ebuf[elen++] = (exp10 < 0) ? '-' : '+';
+		if (exp10 < 0)
+			exp10 = -exp10;
+		if (exp10 < 10)
+			ebuf[elen++] = '0';
+		elen += uutoa(exp10, &ebuf[elen]);
+		len = 1 + point + precision + elen;
+	}
+	else
+		len = ((a.dp > 0) ? a.dp : 1) + point + precision;
+
+	len += plen;
+	padding = (spec->width > len) ? spec->width - len : 0;
+
+	if (!(spec->flags & (UFMT_LEFT | UFMT_ZERO)))
+		uformat_pad(f, ' ', padding);
+
+	uformat_puts(f, prefix, plen);
+
+	if ((spec->flags & (UFMT_LEFT | UFMT_ZERO)) == UFMT_ZERO)
+		uformat_pad(f, '0', padding);
+
+	/* Scientific notation. */
+	if (sci)
+	{
+		uformat_digits(f, &a, 0, 1);
+		if (point)
+			uformat_puts(f, ".", 1);
+		uformat_digits(f, &a, 1, 1 + precision);
+		uformat_puts(f, ebuf, elen);
+	}
+
+	/* Decimal notation. */
+	else
+	{
+		uformat_digits(f, &a, (a.dp > 0) ? 0 : -1, (a.dp > 0) ? a.dp : 0);
+		if (point)
+			uformat_puts(f, ".", 1);
+		uformat_digits(f, &a, a.dp, a.dp + precision);
+	}
+
+	if (spec->flags & UFMT_LEFT)
+		uformat_pad(f, ' ', padding);
+}
+
+/**
+ * @brief Parses a decimal number in a format string.
+ *
+ * @param fmt Target format string.
+ *
+ * @returns The parsed number.
+ */
+static int uformat_atoi(const char **fmt)
+{
+	int n;
+
+	for (n = 0; (**fmt >= '0') && (**fmt <= '9'); (*fmt)++)
+		n = n*10 + (**fmt - '0');
+
+	return (n);
+}
+
+/**
+ * The uvsnprintf() function writes the formatted string @p fmt to @p
+ * str, converting the arguments in @p args. At most @p size bytes are
+ * written, including the terminating null byte. The conversion
+ * specifiers d, i, u, o, x, X, f, F, e, E, g, G, p, c, s and % are
+ * supported, along with the -, +, space, # and 0 flags, field width,
+ * precision and the hh, h, l, ll, j, z and t length modifiers. Integers
+ * are converted with uutoa() and uxtoa(), and floating-point numbers
+ * with __udtoa().
+ *
+ * @returns The number of characters that would have been written if
+ * @p size had been large enough, not counting the terminating null
+ * byte.
+ */
+int uvsnprintf(char *str, size_t size, const char *fmt, va_list args)
+{
+	int n;
+	uint64_t uval;
+	int64_t sval;
+	struct uspec spec;
+	struct uformat f;
+	const char *s;
+	const char *p;
+	char c;
+
+	f.str = str;
+	f.size = (size > 0) ? size - 1 : 0;
+	f.len = 0;
+
+	while (*fmt != '\0')
+	{
+		/* Copy plain characters. */
+		for (p = fmt; (*p != '\0') && (*p != '%'); p++)
+			/* noop */ ;
+		if (p != fmt)
+		{
+			uformat_puts(&f, fmt, p - fmt);
+			fmt = p;
+			continue;
+		}
+
+		/* Skip '%'. */
+		p = fmt++;
+
+		/* Flags. */
+		for (spec.flags = 0; /* noop */ ; fmt++)
+		{
+			if (*fmt == '-')
+				spec.flags |= UFMT_LEFT;
+			else if (*fmt == '+')
+				spec.flags |= UFMT_PLUS;
+			else if (*fmt == ' ')
+				spec.flags |= UFMT_SPACE;
+			else if (*fmt == '#')
+				spec.flags |= UFMT_ALT;
+			else if (*fmt == '0')
+				spec.flags |= UFMT_ZERO;
+			else
+				break;
+		}
+
+		/* Field width. */
+		if (*fmt == '*')
+		{
+			fmt++;
+			if ((n = va_arg(args, int)) < 0)
+			{
+				spec.flags |= UFMT_LEFT;
+				n = -n;
+			}
+			spec.width = n;
+		}
+		else
+			spec.width = uformat_atoi(&fmt);
+
+		/* Precision. */
+		spec.precision = -1;
+		if (*fmt == '.')
+		{
+			fmt++;
+			if (*fmt == '*')
+			{
+				fmt++;
+				spec.precision = va_arg(args, int);
+				if (spec.precision < 0)
+					spec.precision = -1;
+			}
+			else
+				spec.precision = uformat_atoi(&fmt);
+		}
+
+		/* Length modifier. */
+		spec.length = ULEN_NONE;
+		switch (*fmt)
+		{
+			case 'h':
+				spec.length = ULEN_H;
+				if (*++fmt == 'h')
+				{
+					spec.length = ULEN_HH;
+					fmt++;
+				}
+				break;
+			case 'l':
+				spec.length = ULEN_L;
+				if (*++fmt == 'l')
+				{
+					spec.length = ULEN_LL;
+					fmt++;
+				}
+				break;
+			case 'j':
+				spec.length = ULEN_LL;
+				fmt++;
+				break;
+			case 'z':
+			case 't':
+				spec.length = ULEN_L;
+				fmt++;
+				break;
+			default:
+				break;
+		}
+
+		/* Conversion specifier. */
+		switch (c = *fmt++)
+		{
+			case 'd':
+			case 'i':
+				if (spec.length == ULEN_LL)
+					sval = va_arg(args, long long);
+				else if (spec.length == ULEN_L)
+					sval = va_arg(args, long);
+				else
+					sval = va_arg(args, int);
+
+				if (spec.length == ULEN_HH)
+					sval = (signed char) sval;
+				else if (spec.length == ULEN_H)
+					sval = (short) sval;
+
+				uval = (sval < 0) ? -((uint64_t) sval) : (uint64_t) sval;
+				uformat_int(&f, &spec, c, uval, sval < 0);
+				break;
+
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+				if (spec.length == ULEN_LL)
+					uval = va_arg(args, unsigned long long);
+				else if (spec.length == ULEN_L)
+					uval = va_arg(args, unsigned long);
+				else
+					uval = va_arg(args, unsigned);
+
+				if (spec.length == ULEN_HH)
+					uval = (unsigned char) uval;
+				else if (spec.length == ULEN_H)
+					uval = (unsigned short) uval;
+
+				spec.flags &= ~(UFMT_PLUS | UFMT_SPACE);
+				uformat_int(&f, &spec, c, uval, 0);
+				break;
+
+			case 'p':
+				uval = (unsigned long) va_arg(args, void *);
+				spec.flags = (spec.flags & ~(UFMT_PLUS | UFMT_SPACE)) | UFMT_ALT;
+				uformat_int(&f, &spec, 'x', uval, 0);
+				break;
+
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+				uformat_float(&f, &spec, c, va_arg(args, double));
+				break;
+
+			case 'c':
+				c = (char) va_arg(args, int);
+				spec.flags &= ~UFMT_ZERO;
+				uformat_field(&f, &spec, NULL, 0, 0, &c, 1);
+				break;
+
+			case 's':
+				if ((s = va_arg(args, const char *)) == NULL)
+					s = "(null)";
+				n = (spec.precision >= 0) ?
+					(int) ustrnlen(s, spec.precision) : (int) ustrlen(s);
+				spec.flags &= ~UFMT_ZERO;
+				uformat_field(&f, &spec, NULL, 0, 0, s, n);
+				break;
+
+			case '%':
+				uformat_puts(&f, "%", 1);
+				break;
+
+			/* Unknown conversion, so print it verbatim. */
+			default:
+				fmt = p + 1;
+				uformat_puts(&f, p, 1);
+				break;
+		}
+	}
+
+	/* Terminate string. */
+	if (size > 0)
+		str[(f.len < f.size) ? f.len : f.size] = '\0';
+
+	return ((int) f.len);
+}
+
+/**
+ * The usnprintf() function writes the formatted string @p fmt to @p s,
+ * writing at most @p n bytes, including the terminating null byte.
+ */
+int usnprintf(char *s, size_t n, const char * restrict fmt, ...)
+{
+	int ret;
+	va_list args;
+
+	va_start(args, fmt);
+	ret = uvsnprintf(s, n, fmt, args);
+	va_end(args);
+
+	return (ret);
+}
+
+/**
+ * The usprintf() function writes the formatted string @p fmt to @p
+ * str. The caller must ensure that @p str is large enough.
+ */
+int usprintf(char *str, const char * restrict fmt, ...)
+{
+	int ret;
+	va_list args;
+
+	va_start(args, fmt);
+	ret = uvsnprintf(str, (size_t) -1, fmt, args);
+	va_end(args);
+
+	return (ret);
+}
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2020 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <nanvix/sys/dev.h>
+#include <posix/errno.h>
+#include <nanvix/ulib.h>
+
+/**
+ * @brief Size of the coalescing buffer.
+ *
+ * @note The kernel caps writes at KBUFFER_SIZE bytes, and the buffer
+ * lives on the stack of the caller, which may be a small fiber stack.
+ */
+#define UWRITEV_BUFSIZ ((KBUFFER_SIZE < 256) ? KBUFFER_SIZE : 256)
+
+/**
+ * @brief Fragments up to this length are copied into the coalescing
+ * buffer. Longer ones are written in place.
+ */
+#define UWRITEV_COPY_MAX (UWRITEV_BUFSIZ/4)
+
+/**
+ * @brief Writes a buffer to a file.
+ *
+ * @param output Output routine.
+ * @param fd     Target file descriptor.
+ * @param buf    Target buffer.
+ * @param n      Number of bytes to write.
+ * @param done   Number of bytes written so far, updated as bytes of
+ *               @p buf are written.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure,
+ * a negative error code is returned instead.
+ */
+static int uwritev_write(
+	ssize_t (*output)(int, const void *, size_t),
+	int fd,
+	const char *buf,
+	size_t n,
+	ssize_t *done
+)
+{
+	size_t len;
+	ssize_t ret;
+
+	while (n > 0)
+	{
+		len = (n > KBUFFER_SIZE) ? KBUFFER_SIZE : n;
+
+		if ((ret = output(fd, buf, len)) < 0)
+			return (ret);
+
+		/* No progress. */
+		if (ret == 0)
+			return (-EIO);
+
+		buf += ret;
+		n -= ret;
+		*done += ret;
+	}
+
+	return (0);
+}
+
+/**
+ * The uwritev() function writes the @p n buffers described by @p iov
+ * to the file @p fd, in order.
+ */
+ssize_t uwritev(int fd, const struct uiovec *iov, int n)
+{
+	return (uwritev_to(__nanvix_write, fd, iov, n));
+}
+
+/**
+ * The uwritev_to() function writes the @p n buffers described by @p
+ * iov to the file @p fd with @p output, in order. The kernel has no
+ * native gather write, thus small fragments are coalesced into a local
+ * buffer and written with a single call. Large fragments are written in
+ * place, once pending bytes are out. Only a short tail past the last
+ * full kernel write of a large fragment is copied, so that it joins the
+ * fragments that follow.
+ */
+ssize_t uwritev_to(
+	ssize_t (*output)(int fd, const void *buf, size_t n),
+	int fd,
+	const struct uiovec *iov,
+	int n
+)
+{
+	int ret;
+	size_t len;
+	size_t tail;
+	size_t pending;
+	ssize_t done;
+	const char *base;
+	char buf[UWRITEV_BUFSIZ];
+
+	/* Invalid arguments. */
+	if ((output == NULL) || (n < 0) || (n > UIOV_MAX) || ((iov == NULL) && (n > 0)))
+		return (-EINVAL);
+
+	done = 0;
+	pending = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		base = iov[i].iov_base;
+		len = iov[i].iov_len;
+
+		/* Small fragment, so coalesce it. */
+		if (len <= UWRITEV_COPY_MAX)
+		{
+			if (len > (UWRITEV_BUFSIZ - pending))
+			{
+				if ((ret = uwritev_write(output, fd, buf, pending, &done)) < 0)
+					goto error;
+				pending = 0;
+			}
+
+			umemcpy(&buf[pending], base, len);
+			pending += len;
+
+			continue;
+		}
+
+		/* Large fragment, so write pending bytes and then the fragment in place. */
+		if ((ret = uwritev_write(output, fd, buf, pending, &done)) < 0)
+			goto error;
+
+		tail = len % KBUFFER_SIZE;
+		if (tail > UWRITEV_COPY_MAX)
+			tail = 0;
+
+		if ((ret = uwritev_write(output, fd, base, len - tail, &done)) < 0)
+			goto error;
+
+		umemcpy(buf, &base[len - tail], tail);
+		pending = tail;
+	}
+
+	/* Write remaining bytes. */
+	if ((ret = uwritev_write(output, fd, buf, pending, &done)) < 0)
+		goto error;
+
+	return (done);
+
+error:
+	/* Report bytes that went out, so that they are not written again. */
+	return ((done > 0) ? done : ret);
+}
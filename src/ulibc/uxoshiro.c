@@ -0,0 +1,450 @@
+/*
+ * MIT License
+ *
+ * Copyright(c) 2011-2019 The Maintainers of Nanvix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <nanvix/sys/thread.h>
+#include <nanvix/ulib.h>
+#include <posix/stdint.h>
+
+/**
+ * @brief Number of per-thread streams.
+ */
+#define URAND_THREADS_MAX (THREAD_MAX + 1)
+
+/**
+ * @brief Seed of per-thread streams if usrand() is never called.
+ */
+#define URAND_SEED_DEFAULT 1
+
+/**
+ * @brief Per-thread stream.
+ */
+struct urand_thread
+{
+	int owner;                /* Owner thread ID plus one (zero if free). */
+	unsigned gen;             /* Seed generation of the stream.           */
+	struct urand_state state; /* Stream.                                  */
+};
+
+/**
+ * @brief Per-thread streams.
+ */
+static struct urand_thread urand_threads[URAND_THREADS_MAX];
+
+/**
+ * @brief Stream used when no per-thread stream is available.
+ */
+static struct urand_thread urand_shared;
+
+/**
+ * @brief Lock of the shared stream.
+ */
+static struct uspinlock urand_shared_lock = USPINLOCK_INITIALIZER;
+
+/**
+ * @brief Seed of per-thread streams.
+ */
+static uint64_t urand_base = URAND_SEED_DEFAULT;
+
+/**
+ * @brief Seed generation, incremented by usrand().
+ */
+static unsigned urand_gen = 1;
+
+/**
+ * @brief Next stream to hand out to a thread.
+ */
+static struct urand_state urand_next;
+
+/**
+ * @brief Seed generation of the next stream (zero if not derived).
+ */
+static unsigned urand_next_gen;
+
+/**
+ * @brief Lock of the seed, of its generation and of the next stream.
+ */
+static struct uspinlock urand_lock = USPINLOCK_INITIALIZER;
+
+/**
+ * @brief Jump polynomial for 2^128 steps.
+ */
+static const uint64_t urand_jump_poly[4] = {
+	0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+	0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+};
+
+/**
+ * @brief Jump polynomial for 2^192 steps.
+ */
+static const uint64_t urand_long_jump_poly[4] = {
+	0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+	0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+};
+
+/**
+ * @brief Rotates a 64-bit word left.
+ *
+ * @param x Target word.
+ * @param k Rotation amount (in [1, 63]).
+ */
+#define urotl64(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+/**
+ * @brief Advances a xoshiro256** generator.
+ *
+ * @param s Target state.
+ *
+ * @returns The next 64-bit output of @p s.
+ *
+ * @details From "Scrambled Linear Pseudorandom Number Generators",
+ * Blackman and Vigna, ACM Transactions on Mathematical Software, vol.
+ * 47, no. 4, 2021. The generator has a period of 2^256 - 1 and passes
+ * BigCrush, yet costs only shifts, rotations, xors and two
+ * multiplications by small constants per output.
+ */
+static inline uint64_t uxoshiro_next(uint64_t *s)
+{
+	uint64_t r, t;
+
+	r = urotl64(s[1]*5, 7)*9;
+	t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = urotl64(s[3], 45);
+
+	return (r);
+}
+
+/**
+ * @brief Advances a splitmix64 generator.
+ *
+ * @param x Target state.
+ *
+ * @returns The next 64-bit output of @p x.
+ */
+static inline uint64_t usplitmix64(uint64_t *x)
+{
+	uint64_t z;
+
+	z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+
+	return (z ^ (z >> 31));
+}
+
+/**
+ * The urand_seed() function initializes the generator pointed to by @p
+ * state with @p seed. The seed is expanded with splitmix64, so that
+ * similar seeds yield unrelated states, and the state is never all
+ * zeros.
+ */
+void urand_seed(struct urand_state *state, uint64_t seed)
+{
+	for (int i = 0; i < 4; i++)
+		state->s[i] = usplitmix64(&seed);
+}
+
+/**
+ * The urand64() function returns the next 64-bit output of the
+ * generator pointed to by @p state.
+ */
+uint64_t urand64(struct urand_state *state)
+{
+	return (uxoshiro_next(state->s));
+}
+
+/**
+ * The urand32() function returns the next 32-bit output of the
+ * generator pointed to by @p state. The upper half of a 64-bit output
+ * is used, since the lower bits of linear generators are the weakest.
+ */
+uint32_t urand32(struct urand_state *state)
+{
+	return ((uint32_t) (uxoshiro_next(state->s) >> 32));
+}
+
+/**
+ * The urand_fill() function fills @p n bytes of @p buf with outputs of
+ * the generator pointed to by @p state. The state is kept in local
+ * variables while filling, so that it stays in registers, and outputs
+ * are stored a whole word at a time. The alignment of @p buf does not
+ * matter.
+ */
+void urand_fill(struct urand_state *state, void *buf, size_t n)
+{
+	uint64_t r;
+	uint64_t s[4];
+	unsigned char *p;
+
+	p = buf;
+	s[0] = state->s[0];
+	s[1] = state->s[1];
+	s[2] = state->s[2];
+	s[3] = state->s[3];
+
+	for (/* noop */; n >= 2*sizeof(uint64_t); n -= 2*sizeof(uint64_t))
+	{
+		r = uxoshiro_next(s);
+		__builtin_memcpy(p, &r, sizeof(uint64_t));
+		r = uxoshiro_next(s);
+		__builtin_memcpy(p + sizeof(uint64_t), &r, sizeof(uint64_t));
+		p += 2*sizeof(uint64_t);
+	}
+
+	/* Remaining bytes. */
+	for (/* noop */; n > 0; n -= (n < sizeof(uint64_t)) ? n : sizeof(uint64_t))
+	{
+		r = uxoshiro_next(s);
+		umemcpy(p, &r, (n < sizeof(uint64_t)) ? n : sizeof(uint64_t));
+		p += sizeof(uint64_t);
+	}
+
+	state->s[0] = s[0];
+	state->s[1] = s[1];
+	state->s[2] = s[2];
+	state->s[3] = s[3];
+}
+
+/**
+ * @brief Advances a generator by a jump polynomial.
+ *
+ * @param state Target generator.
+ * @param poly  Jump polynomial.
+ *
+ * @details The state after the jump is the sum of the states selected
+ * by the bits of @p poly, which takes 256 steps instead of 2^128.
+ */
+static void urand_jump_by(struct urand_state *state, const uint64_t *poly)
+{
+	uint64_t t[4] = { 0, 0, 0, 0 };
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			if (poly[i] & (1ULL << b))
+			{
+				t[0] ^= state->s[0];
+				t[1] ^= state->s[1];
+				t[2] ^= state->s[2];
+				t[3] ^= state->s[3];
+			}
+			uxoshiro_next(state->s);
+		}
+	}
+
+	state->s[0] = t[0];
+	state->s[1] = t[1];
+	state->s[2] = t[2];
+	state->s[3] = t[3];
+}
+
+/**
+ * The urand_jump() function advances the generator pointed to by @p
+ * state by 2^128 outputs, as if urand64() was called 2^128 times.
+ */
+void urand_jump(struct urand_state *state)
+{
+	urand_jump_by(state, urand_jump_poly);
+}
+
+/**
+ * The urand_long_jump() function advances the generator pointed to by
+ * @p state by 2^192 outputs. It splits the sequence in 2^64 blocks, each
+ * of which may be further split by urand_jump().
+ */
+void urand_long_jump(struct urand_state *state)
+{
+	urand_jump_by(state, urand_long_jump_poly);
+}
+
+/**
+ * The urand_streams() function initializes @p n generators in the
+ * array @p streams from a single @p seed. Generator i starts 2^128*i
+ * outputs into the sequence of @p seed, thus streams do not overlap
+ * unless more than 2^128 numbers are drawn from one of them.
+ */
+void urand_streams(struct urand_state *streams, int n, uint64_t seed)
+{
+	if (n <= 0)
+		return;
+
+	urand_seed(&streams[0], seed);
+
+	for (int i = 1; i < n; i++)
+	{
+		streams[i] = streams[i - 1];
+		urand_jump(&streams[i]);
+	}
+}
+
+/**
+ * @brief Derives a per-thread stream.
+ *
+ * @param t Target per-thread stream.
+ *
+ * @details The shared stream is stream zero of the seed. Other
+ * streams are handed out in claim order: each one is the previous
+ * one jumped once, and the sequence only restarts when the seed
+ * changes. A stream is thus never handed out twice for the same seed,
+ * even if its slot is released and claimed again.
+ */
+static void urand_thread_init(struct urand_thread *t)
+{
+	uspinlock_lock(&urand_lock);
+
+	t->gen = urand_gen;
+
+	if (t == &urand_shared)
+		urand_seed(&t->state, urand_base);
+	else
+	{
+		if (urand_next_gen != urand_gen)
+		{
+			urand_seed(&urand_next, urand_base);
+			urand_jump(&urand_next);
+			urand_next_gen = urand_gen;
+		}
+
+		t->state = urand_next;
+		urand_jump(&urand_next);
+	}
+
+	uspinlock_unlock(&urand_lock);
+}
+
+/**
+ * The urand_self() function returns the default stream of the calling
+ * thread, or NULL if all streams are taken. Each thread draws from its
+ * own stream, thus no locking is needed. A thread derives a new stream
+ * the first time it draws, and again after a call to usrand().
+ */
+struct urand_state *urand_self(void)
+{
+	struct urand_thread *t;
+	int owner;
+	unsigned gen;
+
+	gen = __atomic_load_n(&urand_gen, __ATOMIC_ACQUIRE);
+
+	/* Fast path: stream in thread-local storage. */
+	if ((t = utls_get(UTLS_KEY_RAND)) != NULL)
+		goto found;
+
+	owner = kthread_self() + 1;
+
+	/* Stream already owned. */
+	for (int i = 0; i < URAND_THREADS_MAX; i++)
+	{
+		if (urand_threads[i].owner == owner)
+		{
+			t = &urand_threads[i];
+			goto found;
+		}
+	}
+
+	/* Slow path: claim a free stream. */
+	for (int i = 0; i < URAND_THREADS_MAX; i++)
+	{
+		if (urand_threads[i].owner != 0)
+			continue;
+
+		if (__sync_bool_compare_and_swap(&urand_threads[i].owner, 0, owner))
+		{
+			t = &urand_threads[i];
+			urand_thread_init(t);
+			utls_set(UTLS_KEY_RAND, t);
+			return (&t->state);
+		}
+	}
+
+	return (NULL);
+
+found:
+	if (t->gen != gen)
+		urand_thread_init(t);
+
+	return (&t->state);
+}
+
+/**
+ * The __urand_shared() function draws a 32-bit random number from the
+ * shared stream, which threads use when all per-thread streams are
+ * taken. Unlike per-thread streams, the shared stream is locked.
+ */
+uint32_t __urand_shared(void)
+{
+	uint32_t x;
+
+	uspinlock_lock(&urand_shared_lock);
+
+	if (urand_shared.gen != __atomic_load_n(&urand_gen, __ATOMIC_ACQUIRE))
+		urand_thread_init(&urand_shared);
+
+	x = urand32(&urand_shared.state);
+
+	uspinlock_unlock(&urand_shared_lock);
+
+	return (x);
+}
+
+/**
+ * The __urand_reseed() function sets the seed of all per-thread
+ * streams to @p seed. Streams are derived again when their threads
+ * next draw.
+ */
+void __urand_reseed(uint64_t seed)
+{
+	uspinlock_lock(&urand_lock);
+	urand_base = seed;
+	__atomic_add_fetch(&urand_gen, 1, __ATOMIC_RELEASE);
+	uspinlock_unlock(&urand_lock);
+}
+
+/**
+ * The __urand_release() function makes the stream of the calling
+ * thread available to other threads.
+ */
+void __urand_release(void)
+{
+	int owner;
+
+	owner = kthread_self() + 1;
+
+	for (int i = 0; i < URAND_THREADS_MAX; i++)
+	{
+		if (urand_threads[i].owner == owner)
+		{
+			utls_set(UTLS_KEY_RAND, NULL);
+			__sync_lock_release(&urand_threads[i].owner);
+			break;
+		}
+	}
+}